@@ -0,0 +1,298 @@
+
+/*  -- Level 3 BLAS routine for the internal C-BLAS library.
+      Follows the interface of the reference Fortran CGEMM; the
+      C := C + alpha*A*B case is blocked for cache reuse.
+*/
+#include <string.h>
+#include "f2c.h"
+
+/* Blocking parameters of the A*B kernel: a CGEMM_MB by CGEMM_KB block
+   of A is kept in cache while it updates 2 columns of C at a time. */
+#define CGEMM_MB 64
+#define CGEMM_KB 128
+
+/* C(1:m,1:n) += alpha * A(1:m,1:k) * B(1:k,1:n), column-major. */
+static void cgemm_nn(integer m, integer n, integer k, complex alpha,
+		     complex *a, integer lda, complex *b,
+		     integer ldb, complex *c, integer ldc)
+{
+    integer ii, kk, mb, kb, i, j, l;
+    complex b0, b1, t, *bp, *ap, *c0, *c1;
+
+    for (kk = 0; kk < k; kk += CGEMM_KB) {
+	kb = min(CGEMM_KB, k - kk);
+	for (ii = 0; ii < m; ii += CGEMM_MB) {
+	    mb = min(CGEMM_MB, m - ii);
+
+	    for (j = 0; j + 2 <= n; j += 2) {
+		c0 = &c[ii + j * ldc];
+		c1 = c0 + ldc;
+		for (l = kk; l < kk + kb; ++l) {
+		    bp = &b[l + j * ldb];
+		    b0.r = alpha.r * bp->r - alpha.i * bp->i;
+		    b0.i = alpha.r * bp->i + alpha.i * bp->r;
+		    bp += ldb;
+		    b1.r = alpha.r * bp->r - alpha.i * bp->i;
+		    b1.i = alpha.r * bp->i + alpha.i * bp->r;
+		    ap = &a[ii + l * lda];
+		    for (i = 0; i < mb; ++i) {
+			t = ap[i];
+			c0[i].r += t.r * b0.r - t.i * b0.i;
+			c0[i].i += t.r * b0.i + t.i * b0.r;
+			c1[i].r += t.r * b1.r - t.i * b1.i;
+			c1[i].i += t.r * b1.i + t.i * b1.r;
+		    }
+		}
+	    }
+
+	    for (; j < n; ++j) {
+		c0 = &c[ii + j * ldc];
+		for (l = kk; l < kk + kb; ++l) {
+		    bp = &b[l + j * ldb];
+		    if (bp->r == 0. && bp->i == 0.) continue;
+		    b0.r = alpha.r * bp->r - alpha.i * bp->i;
+		    b0.i = alpha.r * bp->i + alpha.i * bp->r;
+		    ap = &a[ii + l * lda];
+		    for (i = 0; i < mb; ++i) {
+			t = ap[i];
+			c0[i].r += t.r * b0.r - t.i * b0.i;
+			c0[i].i += t.r * b0.i + t.i * b0.r;
+		    }
+		}
+	    }
+	}
+    }
+}
+
+/* Subroutine */ int cgemm_(char *transa, char *transb, integer *m, integer *
+	n, integer *k, complex *alpha, complex *a, integer *lda,
+	complex *b, integer *ldb, complex *beta, complex *
+	c, integer *ldc)
+{
+
+    /* Local variables */
+    integer info;
+    logical nota, notb, conja, conjb;
+    complex temp, ta, tb, q__1;
+    integer i, j, l, nrowa, nrowb;
+
+    extern int input_error(char *, int *);
+
+/*  Purpose
+    =======
+
+    CGEMM  performs one of the matrix-matrix operations
+
+       C := alpha*op( A )*op( B ) + beta*C,
+
+    where  op( X ) is one of
+
+       op( X ) = X   or   op( X ) = X'   or   op( X ) = conjg( X' ),
+
+    alpha and beta are scalars, and A, B and C are matrices, with op( A )
+    an m by k matrix,  op( B )  a  k by n matrix and  C an m by n matrix.
+
+    Parameters
+    ==========
+
+    TRANSA - CHARACTER*1.
+             On entry, TRANSA specifies the form of op( A ) to be used in
+             the matrix multiplication as follows:
+
+                TRANSA = 'N' or 'n',  op( A ) = A.
+
+                TRANSA = 'T' or 't',  op( A ) = A'.
+
+                TRANSA = 'C' or 'c',  op( A ) = conjg( A' ).
+
+             Unchanged on exit.
+
+    TRANSB - CHARACTER*1.
+             On entry, TRANSB specifies the form of op( B ) to be used in
+             the matrix multiplication, as for TRANSA.
+             Unchanged on exit.
+
+    M      - INTEGER.
+             On entry,  M  specifies  the number  of rows  of the  matrix
+             op( A )  and of the  matrix  C.  M  must  be at least  zero.
+             Unchanged on exit.
+
+    N      - INTEGER.
+             On entry,  N  specifies the number  of columns of the matrix
+             op( B ) and the number of columns of the matrix C. N must be
+             at least zero.
+             Unchanged on exit.
+
+    K      - INTEGER.
+             On entry,  K  specifies  the number of columns of the matrix
+             op( A ) and the number of rows of the matrix op( B ). K must
+             be at least  zero.
+             Unchanged on exit.
+
+    ALPHA  - COMPLEX         .
+             On entry, ALPHA specifies the scalar alpha.
+             Unchanged on exit.
+
+    A      - COMPLEX          array of DIMENSION ( LDA, ka ), where ka is
+             k  when  TRANSA = 'N' or 'n',  and is  m  otherwise.
+             Unchanged on exit.
+
+    LDA    - INTEGER.
+             On entry, LDA specifies the first dimension of A as declared
+             in the calling (sub) program. When  TRANSA = 'N' or 'n' then
+             LDA must be at least  max( 1, m ), otherwise  LDA must be at
+             least  max( 1, k ).
+             Unchanged on exit.
+
+    B      - COMPLEX          array of DIMENSION ( LDB, kb ), where kb is
+             n  when  TRANSB = 'N' or 'n',  and is  k  otherwise.
+             Unchanged on exit.
+
+    LDB    - INTEGER.
+             On entry, LDB specifies the first dimension of B as declared
+             in the calling (sub) program. When  TRANSB = 'N' or 'n' then
+             LDB must be at least  max( 1, k ), otherwise  LDB must be at
+             least  max( 1, n ).
+             Unchanged on exit.
+
+    BETA   - COMPLEX         .
+             On entry,  BETA  specifies the scalar  beta.  When  BETA  is
+             supplied as zero then C need not be set on input.
+             Unchanged on exit.
+
+    C      - COMPLEX          array of DIMENSION ( LDC, n ).
+             On exit, the array  C  is overwritten by the  m by n  matrix
+             ( alpha*op( A )*op( B ) + beta*C ).
+
+    LDC    - INTEGER.
+             On entry, LDC specifies the first dimension of C as declared
+             in  the  calling  (sub)  program.   LDC  must  be  at  least
+             max( 1, m ).
+             Unchanged on exit.
+
+
+    Level 3 Blas routine.
+
+       Test the input parameters.
+
+   Parameter adjustments
+       Function Body */
+#define A(I,J) a[(I)-1 + ((J)-1)* ( *lda)]
+#define B(I,J) b[(I)-1 + ((J)-1)* ( *ldb)]
+#define C(I,J) c[(I)-1 + ((J)-1)* ( *ldc)]
+
+    nota = (strncmp(transa, "N", 1)==0);
+    notb = (strncmp(transb, "N", 1)==0);
+    conja = (strncmp(transa, "C", 1)==0);
+    conjb = (strncmp(transb, "C", 1)==0);
+    nrowa = nota ? *m : *k;
+    nrowb = notb ? *k : *n;
+
+    info = 0;
+    if ( ! nota && ! conja && strncmp(transa, "T", 1)!=0 ) {
+	info = 1;
+    } else if ( ! notb && ! conjb && strncmp(transb, "T", 1)!=0 ) {
+	info = 2;
+    } else if (*m < 0) {
+	info = 3;
+    } else if (*n < 0) {
+	info = 4;
+    } else if (*k < 0) {
+	info = 5;
+    } else if (*lda < max(1,nrowa)) {
+	info = 8;
+    } else if (*ldb < max(1,nrowb)) {
+	info = 10;
+    } else if (*ldc < max(1,*m)) {
+	info = 13;
+    }
+    if (info != 0) {
+	input_error("CGEMM ", &info);
+	return 0;
+    }
+
+/*     Quick return if possible. */
+
+    if (*m == 0 || *n == 0 ||
+	(((alpha->r == 0. && alpha->i == 0.) || *k == 0) &&
+	 (beta->r == 1. && beta->i == 0.))) {
+	return 0;
+    }
+
+/*     First form  C := beta*C. */
+
+    if (beta->r != 1. || beta->i != 0.) {
+	for (j = 1; j <= *n; ++j) {
+	    if (beta->r == 0. && beta->i == 0.) {
+		for (i = 1; i <= *m; ++i) C(i,j).r = 0., C(i,j).i = 0.;
+	    } else {
+		for (i = 1; i <= *m; ++i) {
+		    q__1.r = beta->r * C(i,j).r - beta->i * C(i,j).i;
+		    q__1.i = beta->r * C(i,j).i + beta->i * C(i,j).r;
+		    C(i,j).r = q__1.r, C(i,j).i = q__1.i;
+		}
+	    }
+	}
+    }
+    if (alpha->r == 0. && alpha->i == 0.) {
+	return 0;
+    }
+
+/*     Start the operations. */
+
+    if (nota && notb) {
+
+/*        Form  C := alpha*A*B + C. */
+
+	cgemm_nn(*m, *n, *k, *alpha, a, *lda, b, *ldb, c, *ldc);
+
+    } else if (nota) {
+
+/*        Form  C := alpha*A*op( B ) + C, op( B ) = B' or conjg( B' ). */
+
+	for (j = 1; j <= *n; ++j) {
+	    for (l = 1; l <= *k; ++l) {
+		tb.r = B(j,l).r;
+		tb.i = conjb ? -B(j,l).i : B(j,l).i;
+		if (tb.r != 0. || tb.i != 0.) {
+		    temp.r = alpha->r * tb.r - alpha->i * tb.i;
+		    temp.i = alpha->r * tb.i + alpha->i * tb.r;
+		    for (i = 1; i <= *m; ++i) {
+			C(i,j).r += temp.r * A(i,l).r - temp.i * A(i,l).i;
+			C(i,j).i += temp.r * A(i,l).i + temp.i * A(i,l).r;
+		    }
+		}
+	    }
+	}
+
+    } else {
+
+/*        Form  C := alpha*op( A )*op( B ) + C, op( A ) = A' or conjg( A' ). */
+
+	for (j = 1; j <= *n; ++j) {
+	    for (i = 1; i <= *m; ++i) {
+		temp.r = 0., temp.i = 0.;
+		for (l = 1; l <= *k; ++l) {
+		    ta.r = A(l,i).r;
+		    ta.i = conja ? -A(l,i).i : A(l,i).i;
+		    if (notb) {
+			tb = B(l,j);
+		    } else {
+			tb.r = B(j,l).r;
+			tb.i = conjb ? -B(j,l).i : B(j,l).i;
+		    }
+		    temp.r += ta.r * tb.r - ta.i * tb.i;
+		    temp.i += ta.r * tb.i + ta.i * tb.r;
+		}
+		C(i,j).r += alpha->r * temp.r - alpha->i * temp.i;
+		C(i,j).i += alpha->r * temp.i + alpha->i * temp.r;
+	    }
+	}
+    }
+
+    return 0;
+
+/*     End of CGEMM . */
+
+} /* cgemm_ */
+
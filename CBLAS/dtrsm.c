@@ -0,0 +1,394 @@
+
+/*  -- Level 3 BLAS routine for the internal C-BLAS library.
+      Follows the interface of the reference Fortran DTRSM; the
+      B := inv( A )*B cases are blocked so that most of the work is
+      done by DGEMM.
+*/
+#include <string.h>
+#include "f2c.h"
+
+/* Order of the diagonal blocks of A in the blocked B := inv( A )*B. */
+#define DTRSM_NB 64
+
+/* Solve A*x = b for one column, A the n by n diagonal block of a
+   triangular matrix.  Four unknowns are eliminated at a time, and their
+   update of the rest of x is done in a single pass. */
+static void dtrsm_diag(logical upper, logical nounit, integer n,
+		       doublereal *a, integer lda, doublereal *x)
+{
+    integer i, k;
+    doublereal x0, x1, x2, x3;
+    doublereal *a0, *a1, *a2, *a3;
+
+#define AD(I,J) a[(I) + (J) * lda]
+
+    if ( !upper ) {
+	for (k = 0; k + 4 <= n; k += 4) {
+	    x0 = x[k];
+	    if (nounit) x0 /= AD(k,k);
+	    x1 = x[k+1] - x0 * AD(k+1,k);
+	    if (nounit) x1 /= AD(k+1,k+1);
+	    x2 = x[k+2] - x0 * AD(k+2,k) - x1 * AD(k+2,k+1);
+	    if (nounit) x2 /= AD(k+2,k+2);
+	    x3 = x[k+3] - x0 * AD(k+3,k) - x1 * AD(k+3,k+1) - x2 * AD(k+3,k+2);
+	    if (nounit) x3 /= AD(k+3,k+3);
+	    x[k] = x0;
+	    x[k+1] = x1;
+	    x[k+2] = x2;
+	    x[k+3] = x3;
+	    a0 = &AD(0,k);
+	    a1 = a0 + lda;
+	    a2 = a1 + lda;
+	    a3 = a2 + lda;
+	    for (i = k + 4; i < n; ++i)
+		x[i] -= x0 * a0[i] + x1 * a1[i] + x2 * a2[i] + x3 * a3[i];
+	}
+	for (; k < n; ++k) {
+	    if (nounit) x[k] /= AD(k,k);
+	    x0 = x[k];
+	    for (i = k + 1; i < n; ++i) x[i] -= x0 * AD(i,k);
+	}
+    } else {
+	for (k = n - 1; k >= 3; k -= 4) {
+	    x3 = x[k];
+	    if (nounit) x3 /= AD(k,k);
+	    x2 = x[k-1] - x3 * AD(k-1,k);
+	    if (nounit) x2 /= AD(k-1,k-1);
+	    x1 = x[k-2] - x3 * AD(k-2,k) - x2 * AD(k-2,k-1);
+	    if (nounit) x1 /= AD(k-2,k-2);
+	    x0 = x[k-3] - x3 * AD(k-3,k) - x2 * AD(k-3,k-1) - x1 * AD(k-3,k-2);
+	    if (nounit) x0 /= AD(k-3,k-3);
+	    x[k] = x3;
+	    x[k-1] = x2;
+	    x[k-2] = x1;
+	    x[k-3] = x0;
+	    a0 = &AD(0,k-3);
+	    a1 = a0 + lda;
+	    a2 = a1 + lda;
+	    a3 = a2 + lda;
+	    for (i = 0; i < k - 3; ++i)
+		x[i] -= x0 * a0[i] + x1 * a1[i] + x2 * a2[i] + x3 * a3[i];
+	}
+	for (; k >= 0; --k) {
+	    if (nounit) x[k] /= AD(k,k);
+	    x0 = x[k];
+	    for (i = 0; i < k; ++i) x[i] -= x0 * AD(i,k);
+	}
+    }
+
+#undef AD
+}
+
+/* Subroutine */ int dtrsm_(char *side, char *uplo, char *transa, char *diag,
+	integer *m, integer *n, doublereal *alpha, doublereal *a, integer *
+	lda, doublereal *b, integer *ldb)
+{
+
+    /* Local variables */
+    integer info;
+    doublereal temp;
+    integer i, j, k, kk, kb, nrowa, nrest;
+    logical lside, upper, nounit;
+    doublereal one = 1., mone = -1.;
+
+    extern int input_error(char *, int *);
+    extern int dgemm_(char *, char *, integer *, integer *, integer *,
+		      doublereal *, doublereal *, integer *, doublereal *,
+		      integer *, doublereal *, doublereal *, integer *);
+
+/*  Purpose
+    =======
+
+    DTRSM  solves one of the matrix equations
+
+       op( A )*X = alpha*B,   or   X*op( A ) = alpha*B,
+
+    where alpha is a scalar, X and B are m by n matrices, A is a unit, or
+    non-unit,  upper or lower triangular matrix  and  op( A )  is one  of
+
+       op( A ) = A   or   op( A ) = A'.
+
+    The matrix X is overwritten on B.
+
+    Parameters
+    ==========
+
+    SIDE   - CHARACTER*1.
+             On entry, SIDE specifies whether op( A ) appears on the left
+             or right of X as follows:
+
+                SIDE = 'L' or 'l'   op( A )*X = alpha*B.
+
+                SIDE = 'R' or 'r'   X*op( A ) = alpha*B.
+
+             Unchanged on exit.
+
+    UPLO   - CHARACTER*1.
+             On entry, UPLO specifies whether the matrix A is an upper or
+             lower triangular matrix as follows:
+
+                UPLO = 'U' or 'u'   A is an upper triangular matrix.
+
+                UPLO = 'L' or 'l'   A is a lower triangular matrix.
+
+             Unchanged on exit.
+
+    TRANSA - CHARACTER*1.
+             On entry, TRANSA specifies the form of op( A ) to be used in
+             the matrix multiplication as follows:
+
+                TRANSA = 'N' or 'n'   op( A ) = A.
+
+                TRANSA = 'T' or 't'   op( A ) = A'.
+
+                TRANSA = 'C' or 'c'   op( A ) = A'.
+
+             Unchanged on exit.
+
+    DIAG   - CHARACTER*1.
+             On entry, DIAG specifies whether or not A is unit triangular
+             as follows:
+
+                DIAG = 'U' or 'u'   A is assumed to be unit triangular.
+
+                DIAG = 'N' or 'n'   A is not assumed to be unit
+                                    triangular.
+
+             Unchanged on exit.
+
+    M      - INTEGER.
+             On entry, M specifies the number of rows of B. M must be at
+             least zero.
+             Unchanged on exit.
+
+    N      - INTEGER.
+             On entry, N specifies the number of columns of B.  N must be
+             at least zero.
+             Unchanged on exit.
+
+    ALPHA  - DOUBLE PRECISION.
+             On entry,  ALPHA specifies the scalar  alpha. When  alpha is
+             zero then  A is not referenced and  B need not be set before
+             entry.
+             Unchanged on exit.
+
+    A      - DOUBLE PRECISION array of DIMENSION ( LDA, k ), where k is m
+             when  SIDE = 'L' or 'l'  and is  n  when  SIDE = 'R' or 'r'.
+             Only the triangle of A given by UPLO is referenced.
+             Unchanged on exit.
+
+    LDA    - INTEGER.
+             On entry, LDA specifies the first dimension of A as declared
+             in the calling (sub) program.  When  SIDE = 'L' or 'l'  then
+             LDA  must be at least  max( 1, m ),  when  SIDE = 'R' or 'r'
+             then LDA must be at least max( 1, n ).
+             Unchanged on exit.
+
+    B      - DOUBLE PRECISION array of DIMENSION ( LDB, n ).
+             Before entry,  the leading  m by n part of the array  B must
+             contain  the  right-hand  side  matrix  B,  and  on exit  is
+             overwritten by the solution matrix  X.
+
+    LDB    - INTEGER.
+             On entry, LDB specifies the first dimension of B as declared
+             in  the  calling  (sub)  program.   LDB  must  be  at  least
+             max( 1, m ).
+             Unchanged on exit.
+
+
+    Level 3 Blas routine.
+
+       Test the input parameters.
+
+   Parameter adjustments
+       Function Body */
+#define A(I,J) a[(I)-1 + ((J)-1)* ( *lda)]
+#define B(I,J) b[(I)-1 + ((J)-1)* ( *ldb)]
+
+    lside = (strncmp(side, "L", 1)==0);
+    nrowa = lside ? *m : *n;
+    nounit = (strncmp(diag, "N", 1)==0);
+    upper = (strncmp(uplo, "U", 1)==0);
+
+    info = 0;
+    if ( ! lside && strncmp(side, "R", 1)!=0 ) {
+	info = 1;
+    } else if ( ! upper && strncmp(uplo, "L", 1)!=0 ) {
+	info = 2;
+    } else if ( strncmp(transa, "N", 1)!=0 && strncmp(transa, "T", 1)!=0 &&
+		strncmp(transa, "C", 1)!=0 ) {
+	info = 3;
+    } else if ( strncmp(diag, "U", 1)!=0 && strncmp(diag, "N", 1)!=0 ) {
+	info = 4;
+    } else if (*m < 0) {
+	info = 5;
+    } else if (*n < 0) {
+	info = 6;
+    } else if (*lda < max(1,nrowa)) {
+	info = 9;
+    } else if (*ldb < max(1,*m)) {
+	info = 11;
+    }
+    if (info != 0) {
+	input_error("DTRSM ", &info);
+	return 0;
+    }
+
+/*     Quick return if possible. */
+
+    if (*m == 0 || *n == 0) {
+	return 0;
+    }
+
+/*     And when  alpha.eq.zero. */
+
+    if (*alpha == 0.) {
+	for (j = 1; j <= *n; ++j)
+	    for (i = 1; i <= *m; ++i) B(i,j) = 0.;
+	return 0;
+    }
+
+/*     Start the operations. */
+
+    if (lside) {
+	if (strncmp(transa, "N", 1)==0) {
+
+/*           Form  B := alpha*inv( A )*B.
+             A is split into diagonal blocks of order DTRSM_NB; each block
+             row of B is solved with the diagonal block, and the rest of B
+             is updated with a DGEMM call. */
+
+	    if (*alpha != 1.) {
+		for (j = 1; j <= *n; ++j)
+		    for (i = 1; i <= *m; ++i) B(i,j) = *alpha * B(i,j);
+	    }
+	    if (upper) {
+		for (kk = ((*m - 1) / DTRSM_NB) * DTRSM_NB + 1; kk >= 1;
+		     kk -= DTRSM_NB) {
+		    kb = min(DTRSM_NB, *m - kk + 1);
+		    for (j = 1; j <= *n; ++j)
+			dtrsm_diag(upper, nounit, kb, &A(kk,kk), *lda, &B(kk,j));
+		    nrest = kk - 1;
+		    if (nrest > 0)
+			dgemm_("N", "N", &nrest, n, &kb, &mone, &A(1,kk), lda,
+			       &B(kk,1), ldb, &one, &B(1,1), ldb);
+		}
+	    } else {
+		for (kk = 1; kk <= *m; kk += DTRSM_NB) {
+		    kb = min(DTRSM_NB, *m - kk + 1);
+		    for (j = 1; j <= *n; ++j)
+			dtrsm_diag(upper, nounit, kb, &A(kk,kk), *lda, &B(kk,j));
+		    nrest = *m - kk - kb + 1;
+		    if (nrest > 0)
+			dgemm_("N", "N", &nrest, n, &kb, &mone, &A(kk+kb,kk),
+			       lda, &B(kk,1), ldb, &one, &B(kk+kb,1), ldb);
+		}
+	    }
+	} else {
+
+/*           Form  B := alpha*inv( A' )*B. */
+
+	    if (upper) {
+		for (j = 1; j <= *n; ++j) {
+		    for (i = 1; i <= *m; ++i) {
+			temp = *alpha * B(i,j);
+			for (k = 1; k < i; ++k) temp -= A(k,i) * B(k,j);
+			if (nounit) temp /= A(i,i);
+			B(i,j) = temp;
+		    }
+		}
+	    } else {
+		for (j = 1; j <= *n; ++j) {
+		    for (i = *m; i >= 1; --i) {
+			temp = *alpha * B(i,j);
+			for (k = i + 1; k <= *m; ++k) temp -= A(k,i) * B(k,j);
+			if (nounit) temp /= A(i,i);
+			B(i,j) = temp;
+		    }
+		}
+	    }
+	}
+    } else {
+	if (strncmp(transa, "N", 1)==0) {
+
+/*           Form  B := alpha*B*inv( A ). */
+
+	    if (upper) {
+		for (j = 1; j <= *n; ++j) {
+		    if (*alpha != 1.) {
+			for (i = 1; i <= *m; ++i) B(i,j) = *alpha * B(i,j);
+		    }
+		    for (k = 1; k < j; ++k) {
+			if (A(k,j) != 0.) {
+			    temp = A(k,j);
+			    for (i = 1; i <= *m; ++i) B(i,j) -= temp * B(i,k);
+			}
+		    }
+		    if (nounit) {
+			temp = 1. / A(j,j);
+			for (i = 1; i <= *m; ++i) B(i,j) = temp * B(i,j);
+		    }
+		}
+	    } else {
+		for (j = *n; j >= 1; --j) {
+		    if (*alpha != 1.) {
+			for (i = 1; i <= *m; ++i) B(i,j) = *alpha * B(i,j);
+		    }
+		    for (k = j + 1; k <= *n; ++k) {
+			if (A(k,j) != 0.) {
+			    temp = A(k,j);
+			    for (i = 1; i <= *m; ++i) B(i,j) -= temp * B(i,k);
+			}
+		    }
+		    if (nounit) {
+			temp = 1. / A(j,j);
+			for (i = 1; i <= *m; ++i) B(i,j) = temp * B(i,j);
+		    }
+		}
+	    }
+	} else {
+
+/*           Form  B := alpha*B*inv( A' ). */
+
+	    if (upper) {
+		for (k = *n; k >= 1; --k) {
+		    if (nounit) {
+			temp = 1. / A(k,k);
+			for (i = 1; i <= *m; ++i) B(i,k) = temp * B(i,k);
+		    }
+		    for (j = 1; j < k; ++j) {
+			if (A(j,k) != 0.) {
+			    temp = A(j,k);
+			    for (i = 1; i <= *m; ++i) B(i,j) -= temp * B(i,k);
+			}
+		    }
+		    if (*alpha != 1.) {
+			for (i = 1; i <= *m; ++i) B(i,k) = *alpha * B(i,k);
+		    }
+		}
+	    } else {
+		for (k = 1; k <= *n; ++k) {
+		    if (nounit) {
+			temp = 1. / A(k,k);
+			for (i = 1; i <= *m; ++i) B(i,k) = temp * B(i,k);
+		    }
+		    for (j = k + 1; j <= *n; ++j) {
+			if (A(j,k) != 0.) {
+			    temp = A(j,k);
+			    for (i = 1; i <= *m; ++i) B(i,j) -= temp * B(i,k);
+			}
+		    }
+		    if (*alpha != 1.) {
+			for (i = 1; i <= *m; ++i) B(i,k) = *alpha * B(i,k);
+		    }
+		}
+	    }
+	}
+    }
+
+    return 0;
+
+/*     End of DTRSM . */
+
+} /* dtrsm_ */
+
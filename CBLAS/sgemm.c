@@ -0,0 +1,316 @@
+
+/*  -- Level 3 BLAS routine for the internal C-BLAS library.
+      Follows the interface of the reference Fortran SGEMM; the
+      C := C + alpha*A*B case is blocked for cache reuse.
+*/
+#include <string.h>
+#include "f2c.h"
+
+/* Blocking parameters of the A*B kernel: a SGEMM_MB by SGEMM_KB block
+   of A is kept in cache while it updates 2 columns of C at a time. */
+#define SGEMM_MB 256
+#define SGEMM_KB 128
+
+/* C(1:m,1:n) += alpha * A(1:m,1:k) * B(1:k,1:n), column-major.  Each
+   pass of the inner loop applies four columns of A to two columns of C,
+   so that every load and store of C is shared by four multiply-adds.
+   The inner loops run with unit stride and are kept simple enough for
+   the compiler to vectorize them. */
+static void sgemm_nn(integer m, integer n, integer k, real alpha,
+		     real *a, integer lda, real *b, integer ldb,
+		     real *c, integer ldc)
+{
+    integer ii, kk, mb, kb, i, j, l;
+    real p0, p1, p2, p3, q0, q1, q2, q3, t0, t1, t2, t3;
+    real *a0, *a1, *a2, *a3, *bp, *c0, *c1;
+
+    for (kk = 0; kk < k; kk += SGEMM_KB) {
+	kb = min(SGEMM_KB, k - kk);
+	for (ii = 0; ii < m; ii += SGEMM_MB) {
+	    mb = min(SGEMM_MB, m - ii);
+
+	    for (j = 0; j + 2 <= n; j += 2) {
+		c0 = &c[ii + j * ldc];
+		c1 = c0 + ldc;
+		for (l = kk; l + 4 <= kk + kb; l += 4) {
+		    bp = &b[l + j * ldb];
+		    p0 = alpha * bp[0];
+		    p1 = alpha * bp[1];
+		    p2 = alpha * bp[2];
+		    p3 = alpha * bp[3];
+		    bp += ldb;
+		    q0 = alpha * bp[0];
+		    q1 = alpha * bp[1];
+		    q2 = alpha * bp[2];
+		    q3 = alpha * bp[3];
+		    a0 = &a[ii + l * lda];
+		    a1 = a0 + lda;
+		    a2 = a1 + lda;
+		    a3 = a2 + lda;
+		    for (i = 0; i < mb; ++i) {
+			t0 = a0[i];
+			t1 = a1[i];
+			t2 = a2[i];
+			t3 = a3[i];
+			c0[i] += t0 * p0 + t1 * p1 + t2 * p2 + t3 * p3;
+			c1[i] += t0 * q0 + t1 * q1 + t2 * q2 + t3 * q3;
+		    }
+		}
+		for (; l < kk + kb; ++l) {
+		    p0 = alpha * b[l + j * ldb];
+		    q0 = alpha * b[l + (j + 1) * ldb];
+		    a0 = &a[ii + l * lda];
+		    for (i = 0; i < mb; ++i) {
+			t0 = a0[i];
+			c0[i] += t0 * p0;
+			c1[i] += t0 * q0;
+		    }
+		}
+	    }
+
+	    /* Last column of C, if n is odd */
+	    if (j < n) {
+		c0 = &c[ii + j * ldc];
+		bp = &b[j * ldb];
+		for (l = kk; l + 4 <= kk + kb; l += 4) {
+		    p0 = alpha * bp[l];
+		    p1 = alpha * bp[l + 1];
+		    p2 = alpha * bp[l + 2];
+		    p3 = alpha * bp[l + 3];
+		    a0 = &a[ii + l * lda];
+		    a1 = a0 + lda;
+		    a2 = a1 + lda;
+		    a3 = a2 + lda;
+		    for (i = 0; i < mb; ++i)
+			c0[i] += a0[i] * p0 + a1[i] * p1 + a2[i] * p2 + a3[i] * p3;
+		}
+		for (; l < kk + kb; ++l) {
+		    p0 = alpha * bp[l];
+		    a0 = &a[ii + l * lda];
+		    for (i = 0; i < mb; ++i) c0[i] += a0[i] * p0;
+		}
+	    }
+	}
+    }
+}
+
+/* Subroutine */ int sgemm_(char *transa, char *transb, integer *m, integer *
+	n, integer *k, real *alpha, real *a, integer *lda,
+	real *b, integer *ldb, real *beta, real *c,
+	integer *ldc)
+{
+
+    /* Local variables */
+    integer info;
+    logical nota, notb;
+    real temp;
+    integer i, j, l, nrowa, nrowb;
+
+    extern int input_error(char *, int *);
+
+/*  Purpose
+    =======
+
+    SGEMM  performs one of the matrix-matrix operations
+
+       C := alpha*op( A )*op( B ) + beta*C,
+
+    where  op( X ) is one of
+
+       op( X ) = X   or   op( X ) = X',
+
+    alpha and beta are scalars, and A, B and C are matrices, with op( A )
+    an m by k matrix,  op( B )  a  k by n matrix and  C an m by n matrix.
+
+    Parameters
+    ==========
+
+    TRANSA - CHARACTER*1.
+             On entry, TRANSA specifies the form of op( A ) to be used in
+             the matrix multiplication as follows:
+
+                TRANSA = 'N' or 'n',  op( A ) = A.
+
+                TRANSA = 'T' or 't',  op( A ) = A'.
+
+                TRANSA = 'C' or 'c',  op( A ) = A'.
+
+             Unchanged on exit.
+
+    TRANSB - CHARACTER*1.
+             On entry, TRANSB specifies the form of op( B ) to be used in
+             the matrix multiplication, as for TRANSA.
+             Unchanged on exit.
+
+    M      - INTEGER.
+             On entry,  M  specifies  the number  of rows  of the  matrix
+             op( A )  and of the  matrix  C.  M  must  be at least  zero.
+             Unchanged on exit.
+
+    N      - INTEGER.
+             On entry,  N  specifies the number  of columns of the matrix
+             op( B ) and the number of columns of the matrix C. N must be
+             at least zero.
+             Unchanged on exit.
+
+    K      - INTEGER.
+             On entry,  K  specifies  the number of columns of the matrix
+             op( A ) and the number of rows of the matrix op( B ). K must
+             be at least  zero.
+             Unchanged on exit.
+
+    ALPHA  - REAL.
+             On entry, ALPHA specifies the scalar alpha.
+             Unchanged on exit.
+
+    A      - REAL             array of DIMENSION ( LDA, ka ), where ka is
+             k  when  TRANSA = 'N' or 'n',  and is  m  otherwise.
+             Unchanged on exit.
+
+    LDA    - INTEGER.
+             On entry, LDA specifies the first dimension of A as declared
+             in the calling (sub) program. When  TRANSA = 'N' or 'n' then
+             LDA must be at least  max( 1, m ), otherwise  LDA must be at
+             least  max( 1, k ).
+             Unchanged on exit.
+
+    B      - REAL             array of DIMENSION ( LDB, kb ), where kb is
+             n  when  TRANSB = 'N' or 'n',  and is  k  otherwise.
+             Unchanged on exit.
+
+    LDB    - INTEGER.
+             On entry, LDB specifies the first dimension of B as declared
+             in the calling (sub) program. When  TRANSB = 'N' or 'n' then
+             LDB must be at least  max( 1, k ), otherwise  LDB must be at
+             least  max( 1, n ).
+             Unchanged on exit.
+
+    BETA   - REAL.
+             On entry,  BETA  specifies the scalar  beta.  When  BETA  is
+             supplied as zero then C need not be set on input.
+             Unchanged on exit.
+
+    C      - REAL             array of DIMENSION ( LDC, n ).
+             On exit, the array  C  is overwritten by the  m by n  matrix
+             ( alpha*op( A )*op( B ) + beta*C ).
+
+    LDC    - INTEGER.
+             On entry, LDC specifies the first dimension of C as declared
+             in  the  calling  (sub)  program.   LDC  must  be  at  least
+             max( 1, m ).
+             Unchanged on exit.
+
+
+    Level 3 Blas routine.
+
+       Test the input parameters.
+
+   Parameter adjustments
+       Function Body */
+#define A(I,J) a[(I)-1 + ((J)-1)* ( *lda)]
+#define B(I,J) b[(I)-1 + ((J)-1)* ( *ldb)]
+#define C(I,J) c[(I)-1 + ((J)-1)* ( *ldc)]
+
+    nota = (strncmp(transa, "N", 1)==0);
+    notb = (strncmp(transb, "N", 1)==0);
+    nrowa = nota ? *m : *k;
+    nrowb = notb ? *k : *n;
+
+    info = 0;
+    if ( ! nota && strncmp(transa, "T", 1)!=0 && strncmp(transa, "C", 1)!=0 ) {
+	info = 1;
+    } else if ( ! notb && strncmp(transb, "T", 1)!=0 &&
+		strncmp(transb, "C", 1)!=0 ) {
+	info = 2;
+    } else if (*m < 0) {
+	info = 3;
+    } else if (*n < 0) {
+	info = 4;
+    } else if (*k < 0) {
+	info = 5;
+    } else if (*lda < max(1,nrowa)) {
+	info = 8;
+    } else if (*ldb < max(1,nrowb)) {
+	info = 10;
+    } else if (*ldc < max(1,*m)) {
+	info = 13;
+    }
+    if (info != 0) {
+	input_error("SGEMM ", &info);
+	return 0;
+    }
+
+/*     Quick return if possible. */
+
+    if (*m == 0 || *n == 0 || ((*alpha == 0. || *k == 0) && *beta == 1.)) {
+	return 0;
+    }
+
+/*     First form  C := beta*C. */
+
+    if (*beta != 1.) {
+	for (j = 1; j <= *n; ++j) {
+	    if (*beta == 0.) {
+		for (i = 1; i <= *m; ++i) C(i,j) = 0.;
+	    } else {
+		for (i = 1; i <= *m; ++i) C(i,j) = *beta * C(i,j);
+	    }
+	}
+    }
+    if (*alpha == 0.) {
+	return 0;
+    }
+
+/*     Start the operations. */
+
+    if (notb) {
+	if (nota) {
+
+/*           Form  C := alpha*A*B + C. */
+
+	    sgemm_nn(*m, *n, *k, *alpha, a, *lda, b, *ldb, c, *ldc);
+	} else {
+
+/*           Form  C := alpha*A'*B + C */
+
+	    for (j = 1; j <= *n; ++j) {
+		for (i = 1; i <= *m; ++i) {
+		    temp = 0.;
+		    for (l = 1; l <= *k; ++l) temp += A(l,i) * B(l,j);
+		    C(i,j) += *alpha * temp;
+		}
+	    }
+	}
+    } else {
+	if (nota) {
+
+/*           Form  C := alpha*A*B' + C */
+
+	    for (j = 1; j <= *n; ++j) {
+		for (l = 1; l <= *k; ++l) {
+		    if (B(j,l) != 0.) {
+			temp = *alpha * B(j,l);
+			for (i = 1; i <= *m; ++i) C(i,j) += temp * A(i,l);
+		    }
+		}
+	    }
+	} else {
+
+/*           Form  C := alpha*A'*B' + C */
+
+	    for (j = 1; j <= *n; ++j) {
+		for (i = 1; i <= *m; ++i) {
+		    temp = 0.;
+		    for (l = 1; l <= *k; ++l) temp += A(l,i) * B(j,l);
+		    C(i,j) += *alpha * temp;
+		}
+	    }
+	}
+    }
+
+    return 0;
+
+/*     End of SGEMM . */
+
+} /* sgemm_ */
+
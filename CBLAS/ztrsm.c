@@ -0,0 +1,337 @@
+
+/*  -- Level 3 BLAS routine for the internal C-BLAS library.
+      Follows the interface of the reference Fortran ZTRSM; the
+      B := inv( A )*B cases are blocked so that most of the work is
+      done by ZGEMM.
+*/
+#include <string.h>
+#include "f2c.h"
+
+/* Order of the diagonal blocks of A in the blocked B := inv( A )*B. */
+#define ZTRSM_NB 48
+
+/* Subroutine */ int ztrsm_(char *side, char *uplo, char *transa, char *diag,
+	integer *m, integer *n, doublecomplex *alpha, doublecomplex *a,
+	integer *lda, doublecomplex *b, integer *ldb)
+{
+
+    /* Builtin functions */
+    void z_div(doublecomplex *, doublecomplex *, doublecomplex *);
+
+    /* Local variables */
+    integer info;
+    doublecomplex temp, ta, z__1;
+    integer i, j, k, kk, kb, nrowa, nrest;
+    logical lside, upper, nounit, noconj;
+    doublecomplex one = {1., 0.}, mone = {-1., 0.};
+
+    extern int input_error(char *, int *);
+    extern int zgemm_(char *, char *, integer *, integer *, integer *,
+		      doublecomplex *, doublecomplex *, integer *,
+		      doublecomplex *, integer *, doublecomplex *,
+		      doublecomplex *, integer *);
+
+/*  Purpose
+    =======
+
+    ZTRSM  solves one of the matrix equations
+
+       op( A )*X = alpha*B,   or   X*op( A ) = alpha*B,
+
+    where alpha is a scalar, X and B are m by n matrices, A is a unit, or
+    non-unit,  upper or lower triangular matrix  and  op( A )  is one  of
+
+       op( A ) = A   or   op( A ) = A'   or   op( A ) = conjg( A' ).
+
+    The matrix X is overwritten on B.
+
+    Parameters
+    ==========
+
+    SIDE   - CHARACTER*1.
+             On entry, SIDE specifies whether op( A ) appears on the left
+             or right of X as follows:
+
+                SIDE = 'L' or 'l'   op( A )*X = alpha*B.
+
+                SIDE = 'R' or 'r'   X*op( A ) = alpha*B.
+
+             Unchanged on exit.
+
+    UPLO   - CHARACTER*1.
+             On entry, UPLO specifies whether the matrix A is an upper or
+             lower triangular matrix as follows:
+
+                UPLO = 'U' or 'u'   A is an upper triangular matrix.
+
+                UPLO = 'L' or 'l'   A is a lower triangular matrix.
+
+             Unchanged on exit.
+
+    TRANSA - CHARACTER*1.
+             On entry, TRANSA specifies the form of op( A ) to be used in
+             the matrix multiplication as follows:
+
+                TRANSA = 'N' or 'n'   op( A ) = A.
+
+                TRANSA = 'T' or 't'   op( A ) = A'.
+
+                TRANSA = 'C' or 'c'   op( A ) = conjg( A' ).
+
+             Unchanged on exit.
+
+    DIAG   - CHARACTER*1.
+             On entry, DIAG specifies whether or not A is unit triangular
+             as follows:
+
+                DIAG = 'U' or 'u'   A is assumed to be unit triangular.
+
+                DIAG = 'N' or 'n'   A is not assumed to be unit
+                                    triangular.
+
+             Unchanged on exit.
+
+    M      - INTEGER.
+             On entry, M specifies the number of rows of B. M must be at
+             least zero.
+             Unchanged on exit.
+
+    N      - INTEGER.
+             On entry, N specifies the number of columns of B.  N must be
+             at least zero.
+             Unchanged on exit.
+
+    ALPHA  - COMPLEX*16      .
+             On entry,  ALPHA specifies the scalar  alpha. When  alpha is
+             zero then  A is not referenced and  B need not be set before
+             entry.
+             Unchanged on exit.
+
+    A      - COMPLEX*16       array of DIMENSION ( LDA, k ), where k is m
+             when  SIDE = 'L' or 'l'  and is  n  when  SIDE = 'R' or 'r'.
+             Only the triangle of A given by UPLO is referenced.
+             Unchanged on exit.
+
+    LDA    - INTEGER.
+             On entry, LDA specifies the first dimension of A as declared
+             in the calling (sub) program.  When  SIDE = 'L' or 'l'  then
+             LDA  must be at least  max( 1, m ),  when  SIDE = 'R' or 'r'
+             then LDA must be at least max( 1, n ).
+             Unchanged on exit.
+
+    B      - COMPLEX*16       array of DIMENSION ( LDB, n ).
+             Before entry,  the leading  m by n part of the array  B must
+             contain  the  right-hand  side  matrix  B,  and  on exit  is
+             overwritten by the solution matrix  X.
+
+    LDB    - INTEGER.
+             On entry, LDB specifies the first dimension of B as declared
+             in  the  calling  (sub)  program.   LDB  must  be  at  least
+             max( 1, m ).
+             Unchanged on exit.
+
+
+    Level 3 Blas routine.
+
+       Test the input parameters.
+
+   Parameter adjustments
+       Function Body */
+#define A(I,J) a[(I)-1 + ((J)-1)* ( *lda)]
+#define B(I,J) b[(I)-1 + ((J)-1)* ( *ldb)]
+
+/* X := op( A(I,J) ): conjugated unless TRANSA = 'T'. */
+#define OPA(X,I,J) ( (X).r = A(I,J).r, (X).i = noconj ? A(I,J).i : -A(I,J).i )
+
+    lside = (strncmp(side, "L", 1)==0);
+    nrowa = lside ? *m : *n;
+    noconj = (strncmp(transa, "T", 1)==0);
+    nounit = (strncmp(diag, "N", 1)==0);
+    upper = (strncmp(uplo, "U", 1)==0);
+
+    info = 0;
+    if ( ! lside && strncmp(side, "R", 1)!=0 ) {
+	info = 1;
+    } else if ( ! upper && strncmp(uplo, "L", 1)!=0 ) {
+	info = 2;
+    } else if ( strncmp(transa, "N", 1)!=0 && strncmp(transa, "T", 1)!=0 &&
+		strncmp(transa, "C", 1)!=0 ) {
+	info = 3;
+    } else if ( strncmp(diag, "U", 1)!=0 && strncmp(diag, "N", 1)!=0 ) {
+	info = 4;
+    } else if (*m < 0) {
+	info = 5;
+    } else if (*n < 0) {
+	info = 6;
+    } else if (*lda < max(1,nrowa)) {
+	info = 9;
+    } else if (*ldb < max(1,*m)) {
+	info = 11;
+    }
+    if (info != 0) {
+	input_error("ZTRSM ", &info);
+	return 0;
+    }
+
+/*     Quick return if possible. */
+
+    if (*m == 0 || *n == 0) {
+	return 0;
+    }
+
+/*     And when  alpha.eq.zero. */
+
+    if (alpha->r == 0. && alpha->i == 0.) {
+	for (j = 1; j <= *n; ++j)
+	    for (i = 1; i <= *m; ++i) B(i,j).r = 0., B(i,j).i = 0.;
+	return 0;
+    }
+
+/*     Form  B := alpha*B  first; every case below then solves with
+       alpha = 1. */
+
+    if (alpha->r != 1. || alpha->i != 0.) {
+	for (j = 1; j <= *n; ++j) {
+	    for (i = 1; i <= *m; ++i) {
+		z__1.r = alpha->r * B(i,j).r - alpha->i * B(i,j).i;
+		z__1.i = alpha->r * B(i,j).i + alpha->i * B(i,j).r;
+		B(i,j).r = z__1.r, B(i,j).i = z__1.i;
+	    }
+	}
+    }
+
+/*     Start the operations. */
+
+    if (lside) {
+	if (strncmp(transa, "N", 1)==0) {
+
+/*           Form  B := inv( A )*B.
+             A is split into diagonal blocks of order ZTRSM_NB; each block
+             row of B is solved with the diagonal block, and the rest of B
+             is updated with a ZGEMM call. */
+
+	    if (upper) {
+		for (kk = ((*m - 1) / ZTRSM_NB) * ZTRSM_NB + 1; kk >= 1;
+		     kk -= ZTRSM_NB) {
+		    kb = min(ZTRSM_NB, *m - kk + 1);
+		    for (j = 1; j <= *n; ++j) {
+			for (k = kk + kb - 1; k >= kk; --k) {
+			    if (B(k,j).r != 0. || B(k,j).i != 0.) {
+				if (nounit) {
+				    z_div(&z__1, &B(k,j), &A(k,k));
+				    B(k,j).r = z__1.r, B(k,j).i = z__1.i;
+				}
+				temp = B(k,j);
+				for (i = kk; i < k; ++i) {
+				    B(i,j).r -= temp.r * A(i,k).r - temp.i * A(i,k).i;
+				    B(i,j).i -= temp.r * A(i,k).i + temp.i * A(i,k).r;
+				}
+			    }
+			}
+		    }
+		    nrest = kk - 1;
+		    if (nrest > 0)
+			zgemm_("N", "N", &nrest, n, &kb, &mone, &A(1,kk), lda,
+			       &B(kk,1), ldb, &one, &B(1,1), ldb);
+		}
+	    } else {
+		for (kk = 1; kk <= *m; kk += ZTRSM_NB) {
+		    kb = min(ZTRSM_NB, *m - kk + 1);
+		    for (j = 1; j <= *n; ++j) {
+			for (k = kk; k < kk + kb; ++k) {
+			    if (B(k,j).r != 0. || B(k,j).i != 0.) {
+				if (nounit) {
+				    z_div(&z__1, &B(k,j), &A(k,k));
+				    B(k,j).r = z__1.r, B(k,j).i = z__1.i;
+				}
+				temp = B(k,j);
+				for (i = k + 1; i < kk + kb; ++i) {
+				    B(i,j).r -= temp.r * A(i,k).r - temp.i * A(i,k).i;
+				    B(i,j).i -= temp.r * A(i,k).i + temp.i * A(i,k).r;
+				}
+			    }
+			}
+		    }
+		    nrest = *m - kk - kb + 1;
+		    if (nrest > 0)
+			zgemm_("N", "N", &nrest, n, &kb, &mone, &A(kk+kb,kk),
+			       lda, &B(kk,1), ldb, &one, &B(kk+kb,1), ldb);
+		}
+	    }
+	} else {
+
+/*           Form  B := inv( A' )*B   or   B := inv( conjg( A' ) )*B. */
+
+	    for (j = 1; j <= *n; ++j) {
+		for (i = (upper ? 1 : *m); i >= 1 && i <= *m;
+		     i += (upper ? 1 : -1)) {
+		    temp = B(i,j);
+		    for (k = (upper ? 1 : i + 1); k <= (upper ? i - 1 : *m); ++k) {
+			OPA(ta,k,i);
+			temp.r -= ta.r * B(k,j).r - ta.i * B(k,j).i;
+			temp.i -= ta.r * B(k,j).i + ta.i * B(k,j).r;
+		    }
+		    if (nounit) {
+			OPA(ta,i,i);
+			z_div(&z__1, &temp, &ta);
+			temp = z__1;
+		    }
+		    B(i,j) = temp;
+		}
+	    }
+	}
+    } else {
+	if (strncmp(transa, "N", 1)==0) {
+
+/*           Form  B := B*inv( A ). */
+
+	    for (j = (upper ? 1 : *n); j >= 1 && j <= *n;
+		 j += (upper ? 1 : -1)) {
+		for (k = (upper ? 1 : j + 1); k <= (upper ? j - 1 : *n); ++k) {
+		    if (A(k,j).r != 0. || A(k,j).i != 0.) {
+			temp = A(k,j);
+			for (i = 1; i <= *m; ++i) {
+			    B(i,j).r -= temp.r * B(i,k).r - temp.i * B(i,k).i;
+			    B(i,j).i -= temp.r * B(i,k).i + temp.i * B(i,k).r;
+			}
+		    }
+		}
+		if (nounit) {
+		    for (i = 1; i <= *m; ++i) {
+			z_div(&z__1, &B(i,j), &A(j,j));
+			B(i,j) = z__1;
+		    }
+		}
+	    }
+	} else {
+
+/*           Form  B := B*inv( A' )   or   B := B*inv( conjg( A' ) ). */
+
+	    for (k = (upper ? *n : 1); k >= 1 && k <= *n;
+		 k += (upper ? -1 : 1)) {
+		if (nounit) {
+		    OPA(ta,k,k);
+		    for (i = 1; i <= *m; ++i) {
+			z_div(&z__1, &B(i,k), &ta);
+			B(i,k) = z__1;
+		    }
+		}
+		for (j = (upper ? 1 : k + 1); j <= (upper ? k - 1 : *n); ++j) {
+		    if (A(j,k).r != 0. || A(j,k).i != 0.) {
+			OPA(temp,j,k);
+			for (i = 1; i <= *m; ++i) {
+			    B(i,j).r -= temp.r * B(i,k).r - temp.i * B(i,k).i;
+			    B(i,j).i -= temp.r * B(i,k).i + temp.i * B(i,k).r;
+			}
+		    }
+		}
+	    }
+	}
+    }
+
+    return 0;
+
+/*     End of ZTRSM . */
+
+} /* ztrsm_ */
+
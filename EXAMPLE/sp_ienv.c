@@ -56,7 +56,13 @@ at the top-level directory.
 	    = 4: the minimum row dimension for 2-D blocking to be used;
 	    = 5: the minimum column dimension for 2-D blocking to be used;
 	    = 6: the estimated fills factor for L and U, compared with A;
-	    = 7: the maximum size for a supernode in ILU.
+	    = 7: the maximum size for a supernode in ILU;
+	    = 8: the number of vectors t used at a time by the block 1-norm
+	         estimator in condition estimation (xGSCON);
+	    = 9: the same, per right-hand side, for the forward error
+	         bounds in iterative refinement (xGSRFS);
+	    = 10: the budget for supernode amalgamation in complete LU, in
+	         percent (see dcolumn_dfs). 0 turns it off.
 	    
    (SP_IENV) (output) int
             >= 0: the value of the parameter specified by ISPEC   
@@ -78,6 +84,9 @@ sp_ienv(int ispec)
 	case 5: return (100);
         case 6: return (30);
         case 7: return (10);
+        case 8: return (2);
+        case 9: return (1);
+        case 10: return (0);
     }
 
     /* Invalid value for ISPEC */
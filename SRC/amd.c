@@ -0,0 +1,393 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file amd.c
+ * \brief Approximate minimum degree ordering of a symmetric graph
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include <math.h>
+#include "slu_ddefs.h"
+
+/* A pointer ip[] that is negative points to FLIP(ip[]) instead: an
+   absorbed element or a merged variable points to its parent element. */
+#define FLIP(i)  (-(i) - 2)
+
+/*! \brief Resets the workspace w[] when mark is about to overflow. All the
+ *  entries that are not zero (dead) become 1.
+ */
+static int_t
+amd_wclear(int_t mark, int_t lemax, int_t *w, int_t n)
+{
+    int_t k;
+
+    if ( mark < 2 || mark + lemax < 0 ) {
+	for (k = 0; k < n; ++k)
+	    if ( w[k] != 0 ) w[k] = 1;
+	mark = 2;
+    }
+    return mark;
+}
+
+/*! \brief Numbers the nodes of the tree rooted at j in postorder, in
+ *  post[k], post[k+1], ..., and returns the next free position.
+ */
+static int_t
+amd_postorder(int_t j, int_t k, int_t *head, int_t *next, int_t *post,
+	      int_t *stack)
+{
+    int_t i, p, top = 0;
+
+    stack[0] = j;
+    while ( top >= 0 ) {
+	p = stack[top];
+	i = head[p];
+	if ( i == EMPTY ) {
+	    --top;
+	    post[k++] = p;
+	} else {
+	    head[p] = next[i];
+	    stack[++top] = i;
+	}
+    }
+    return k;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GET_AMD computes an approximate minimum degree ordering (Amestoy, Davis
+ * and Duff) of a symmetric graph, such as the structure of A'+A or A'*A
+ * without the diagonal from AT_PLUS_A or GETATA.
+ *
+ * Elimination is simulated on a quotient graph: an eliminated vertex
+ * becomes an element that stands for the clique it creates, elements
+ * adjacent to a new element are absorbed into it, and the storage never
+ * exceeds that of the graph plus some elbow room. Vertices with identical
+ * adjacency are merged into supervariables, and the degree of a variable
+ * is replaced by an upper bound that is cheap to update, instead of the
+ * exact external degree that GENMMD recomputes. Dense vertices (degree
+ * above 10*sqrt(n)) are ordered last. The elimination tree of the
+ * elements is postordered at the end.
+ *
+ * Arguments
+ * =========
+ *
+ * n       (input) int_t
+ *         The number of vertices.
+ *
+ * bnz     (input) int_t
+ *         The number of entries in the adjacency lists.
+ *
+ * b_colptr, b_rowind (input) int_t*
+ *         The adjacency lists of the graph, in column oriented format,
+ *         without self-loops.
+ *
+ * perm_c  (output) int_t*, dimension (n)
+ *         The ordering; perm_c[i] = j means vertex i is in position j.
+ * </pre>
+ */
+void
+get_amd(int_t n, int_t bnz, int_t *b_colptr, int_t *b_rowind, int_t *perm_c)
+{
+    int_t *Cp, *Ci, *W, *len, *nv, *next, *head, *elen, *degree, *w;
+    int_t *hhead, *last;
+    int_t d, dk, dext, lemax = 0, e, elenk, eln, i, j, k, k1, k2, k3;
+    int_t jlast, ln, dense, nzmax, mindeg = 0, nvi, nvj, nvk, mark;
+    int_t wnvi, ok, cnz, nel = 0, p, p1, p2, p3, p4, pj, pk, pk1, pk2, pn;
+    unsigned long h;
+
+    if ( n == 0 ) return;
+
+    /* Dense vertices are removed from the graph and ordered last. */
+    dense = (int_t) SUPERLU_MAX(16, 10 * sqrt((double) n));
+    dense = SUPERLU_MIN(n - 2, dense);
+
+    /* The graph, with elbow room for new elements. */
+    cnz = bnz;
+    nzmax = cnz + cnz / 5 + 2 * n;
+    Cp = intMalloc(n + 1);
+    Ci = intMalloc(nzmax);
+    W  = intMalloc(8 * (n + 1));
+    if ( !Cp || !Ci || !W ) ABORT("Malloc fails for get_amd work arrays.");
+    for (j = 0; j <= n; ++j) Cp[j] = b_colptr[j];
+    for (p = 0; p < cnz; ++p) Ci[p] = b_rowind[p];
+
+    len    = W;             /* len[i]: length of the list of i */
+    nv     = W + (n + 1);   /* nv[i]: size of supervariable i, or 0 */
+    next   = W + 2*(n + 1); /* degree lists and hash buckets */
+    head   = W + 3*(n + 1);
+    elen   = W + 4*(n + 1); /* elen[i]: number of elements in list i */
+    degree = W + 5*(n + 1);
+    w      = W + 6*(n + 1);
+    hhead  = W + 7*(n + 1);
+    last   = perm_c;        /* perm_c[] is used as workspace until the end;
+			       it holds n+1 entries only through last[n],
+			       which is never accessed */
+
+    /* --- Initialize the quotient graph --------------------------------- */
+    for (k = 0; k < n; ++k) len[k] = Cp[k+1] - Cp[k];
+    len[n] = 0;
+    for (i = 0; i <= n; ++i) {
+	head[i] = EMPTY;
+	if ( i < n ) last[i] = EMPTY;
+	next[i] = EMPTY;
+	hhead[i] = EMPTY;
+	nv[i] = 1;
+	w[i] = 1;
+	elen[i] = 0;
+	degree[i] = len[i];
+    }
+    mark = amd_wclear(0, 0, w, n);
+    elen[n] = -2;               /* n is the dead element holding dense rows */
+    Cp[n] = EMPTY;
+    w[n] = 0;
+
+    /* Initialize the degree lists. */
+    for (i = 0; i < n; ++i) {
+	d = degree[i];
+	if ( d == 0 ) {                 /* an empty variable: eliminate now */
+	    elen[i] = -2;
+	    ++nel;
+	    Cp[i] = EMPTY;
+	    w[i] = 0;
+	} else if ( d > dense ) {       /* a dense variable: absorb into n */
+	    nv[i] = 0;
+	    elen[i] = EMPTY;
+	    ++nel;
+	    Cp[i] = FLIP(n);
+	    ++nv[n];
+	} else {
+	    if ( head[d] != EMPTY ) last[head[d]] = i;
+	    next[i] = head[d];
+	    head[d] = i;
+	}
+    }
+
+    while ( nel < n ) {
+
+	/* --- Select the variable of minimum approximate degree ---------- */
+	for (k = EMPTY; mindeg < n && (k = head[mindeg]) == EMPTY; ++mindeg) ;
+	if ( next[k] != EMPTY ) last[next[k]] = EMPTY;
+	head[mindeg] = next[k];
+	elenk = elen[k];
+	nvk = nv[k];
+	nel += nvk;
+
+	/* --- Garbage collection ----------------------------------------- */
+	if ( elenk > 0 && cnz + mindeg >= nzmax ) {
+	    for (j = 0; j < n; ++j) {
+		if ( (p = Cp[j]) >= 0 ) {   /* j is a live variable/element */
+		    Cp[j] = Ci[p];          /* save the first entry */
+		    Ci[p] = FLIP(j);        /* and mark the start of list j */
+		}
+	    }
+	    for (p = 0, pk = 0; p < cnz; ) {
+		if ( (j = FLIP(Ci[p++])) >= 0 ) {
+		    Ci[pk] = Cp[j];         /* restore the first entry */
+		    Cp[j] = pk++;
+		    for (k3 = 0; k3 < len[j] - 1; ++k3) Ci[pk++] = Ci[p++];
+		}
+	    }
+	    cnz = pk;
+	}
+
+	/* --- Construct the new element k -------------------------------- */
+	dk = 0;
+	nv[k] = -nvk;               /* k is in the pattern of element k */
+	p = Cp[k];
+	pk1 = ( elenk == 0 ) ? p : cnz;  /* built in place if possible */
+	pk2 = pk1;
+	for (k1 = 1; k1 <= elenk + 1; ++k1) {
+	    if ( k1 > elenk ) {     /* the variables adjacent to k */
+		e = k;
+		pj = p;
+		ln = len[k] - elenk;
+	    } else {                /* the elements adjacent to k */
+		e = Ci[p++];
+		pj = Cp[e];
+		ln = len[e];
+	    }
+	    for (k2 = 1; k2 <= ln; ++k2) {
+		i = Ci[pj++];
+		if ( (nvi = nv[i]) <= 0 ) continue;  /* dead, or seen */
+		dk += nvi;
+		nv[i] = -nvi;       /* i is in the pattern of element k */
+		Ci[pk2++] = i;
+		/* Remove i from its degree list */
+		if ( next[i] != EMPTY ) last[next[i]] = last[i];
+		if ( last[i] != EMPTY ) next[last[i]] = next[i];
+		else head[degree[i]] = next[i];
+	    }
+	    if ( e != k ) {
+		Cp[e] = FLIP(k);    /* absorb element e into k */
+		w[e] = 0;
+	    }
+	}
+	if ( elenk != 0 ) cnz = pk2;
+	degree[k] = dk;
+	Cp[k] = pk1;
+	len[k] = pk2 - pk1;
+	elen[k] = -2;               /* k is now an element */
+
+	/* --- Compute |Le \ Lk| for the elements e adjacent to Lk ---------- */
+	mark = amd_wclear(mark, lemax, w, n);
+	for (pk = pk1; pk < pk2; ++pk) {
+	    i = Ci[pk];
+	    if ( (eln = elen[i]) <= 0 ) continue;
+	    nvi = -nv[i];
+	    wnvi = mark - nvi;
+	    for (p = Cp[i]; p <= Cp[i] + eln - 1; ++p) {
+		e = Ci[p];
+		if ( w[e] >= mark ) w[e] -= nvi;
+		else if ( w[e] != 0 ) w[e] = degree[e] + wnvi;
+	    }
+	}
+
+	/* --- Update the approximate degrees of the variables in Lk -------- */
+	for (pk = pk1; pk < pk2; ++pk) {
+	    i = Ci[pk];
+	    p1 = Cp[i];
+	    p2 = p1 + elen[i] - 1;
+	    pn = p1;
+	    for (h = 0, d = 0, p = p1; p <= p2; ++p) {
+		e = Ci[p];
+		if ( w[e] != 0 ) {
+		    dext = w[e] - mark;     /* |Le \ Lk| */
+		    if ( dext > 0 ) {
+			d += dext;
+			Ci[pn++] = e;
+			h += e;
+		    } else {                /* Le is a subset of Lk: absorb */
+			Cp[e] = FLIP(k);
+			w[e] = 0;
+		    }
+		}
+	    }
+	    elen[i] = pn - p1 + 1;          /* element k is added below */
+	    p3 = pn;
+	    p4 = p1 + len[i];
+	    for (p = p2 + 1; p < p4; ++p) {
+		j = Ci[p];
+		if ( (nvj = nv[j]) <= 0 ) continue;  /* dead, or in Lk */
+		d += nvj;
+		Ci[pn++] = j;
+		h += j;
+	    }
+	    if ( d == 0 ) {
+		/* Mass elimination: i is adjacent only to element k */
+		Cp[i] = FLIP(k);
+		nvi = -nv[i];
+		dk -= nvi;
+		nvk += nvi;
+		nel += nvi;
+		nv[i] = 0;
+		elen[i] = EMPTY;
+	    } else {
+		degree[i] = SUPERLU_MIN(degree[i], d);
+		Ci[pn] = Ci[p3];            /* move the first variable to end */
+		Ci[p3] = Ci[p1];            /* move the first element to end */
+		Ci[p1] = k;                 /* k is the first element */
+		len[i] = pn - p1 + 1;
+		h %= (unsigned long) n;
+		next[i] = hhead[h];         /* put i in hash bucket h */
+		hhead[h] = i;
+		last[i] = (int_t) h;
+	    }
+	}
+	degree[k] = dk;
+	lemax = SUPERLU_MAX(lemax, dk);
+	mark = amd_wclear(mark + lemax, lemax, w, n);
+
+	/* --- Merge indistinguishable variables in Lk ---------------------- */
+	for (pk = pk1; pk < pk2; ++pk) {
+	    i = Ci[pk];
+	    if ( nv[i] >= 0 ) continue;     /* i is dead */
+	    h = (unsigned long) last[i];
+	    i = hhead[h];
+	    hhead[h] = EMPTY;
+	    for ( ; i != EMPTY && next[i] != EMPTY; i = next[i], ++mark) {
+		ln = len[i];
+		eln = elen[i];
+		for (p = Cp[i] + 1; p <= Cp[i] + ln - 1; ++p) w[Ci[p]] = mark;
+		jlast = i;
+		for (j = next[i]; j != EMPTY; ) {
+		    ok = ( len[j] == ln ) && ( elen[j] == eln );
+		    for (p = Cp[j] + 1; ok && p <= Cp[j] + ln - 1; ++p)
+			if ( w[Ci[p]] != mark ) ok = 0;
+		    if ( ok ) {             /* j is absorbed into i */
+			Cp[j] = FLIP(i);
+			nv[i] += nv[j];
+			nv[j] = 0;
+			elen[j] = EMPTY;
+			j = next[j];
+			next[jlast] = j;
+		    } else {
+			jlast = j;
+			j = next[j];
+		    }
+		}
+	    }
+	}
+
+	/* --- Finalize element k, and put Lk back in the degree lists ------ */
+	for (p = pk1, pk = pk1; pk < pk2; ++pk) {
+	    i = Ci[pk];
+	    if ( (nvi = -nv[i]) <= 0 ) continue;
+	    nv[i] = nvi;
+	    d = degree[i] + dk - nvi;
+	    d = SUPERLU_MIN(d, n - nel - nvi);
+	    if ( head[d] != EMPTY ) last[head[d]] = i;
+	    next[i] = head[d];
+	    last[i] = EMPTY;
+	    head[d] = i;
+	    mindeg = SUPERLU_MIN(mindeg, d);
+	    degree[i] = d;
+	    Ci[p++] = i;
+	}
+	nv[k] = nvk;
+	if ( (len[k] = p - pk1) == 0 ) {   /* k is a root of the tree */
+	    Cp[k] = EMPTY;
+	    w[k] = 0;
+	}
+	if ( elenk != 0 ) cnz = p;
+    }
+
+    /* --- Postorder the assembly tree -------------------------------------- */
+    for (i = 0; i < n; ++i) Cp[i] = FLIP(Cp[i]);
+    for (j = 0; j <= n; ++j) head[j] = EMPTY;
+    for (j = n; j >= 0; --j) {      /* merged variables, under their parent */
+	if ( nv[j] > 0 ) continue;
+	next[j] = head[Cp[j]];
+	head[Cp[j]] = j;
+    }
+    for (e = n; e >= 0; --e) {      /* elements, under their parent */
+	if ( nv[e] <= 0 ) continue;
+	if ( Cp[e] != EMPTY ) {
+	    next[e] = head[Cp[e]];
+	    head[Cp[e]] = e;
+	}
+    }
+    /* The postorder of the n+1 nodes goes to Ci[]; node n, the root of
+       the dense variables, is last. */
+    for (k = 0, i = 0; i <= n; ++i)
+	if ( Cp[i] == EMPTY ) k = amd_postorder(i, k, head, next, Ci, w);
+    for (k = 0; k < n; ++k) perm_c[Ci[k]] = k;
+
+    SUPERLU_FREE(Cp);
+    SUPERLU_FREE(Ci);
+    SUPERLU_FREE(W);
+}
@@ -262,6 +262,7 @@ cgsitrf(superlu_options_t *options, SuperMatrix *A, int_t relax, int_t panel_siz
     xa_end   = Astore->colend;
 
     /* Allocate storage common to the factor routines */
+    Glu->work = options->LUWorkspace;
     *info = cLUMemInit(fact, work, lwork, m, n, Astore->nnz, panel_size,
 		       gamma, L, U, Glu, &iwork, &cwork);
     if ( *info ) return;
@@ -525,7 +525,9 @@ printf("dgssvx: Fact=%4d, Trans=%4d, equed=%c\n",
 	 *   permc_spec = MY_PERMC: the ordering already supplied in perm_c[]
 	 */
 	permc_spec = options->ColPerm;
-	if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
+	if ( permc_spec == AUTO && options->Fact == DOFACT )
+            get_perm_c_auto(AA, perm_c, stat);
+	else if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
             get_perm_c(permc_spec, AA, perm_c);
 	utime[COLPERM] = SuperLU_timer_() - t0;
 
@@ -545,6 +547,11 @@ printf("dgssvx: Fact=%4d, Trans=%4d, equed=%c\n",
 	
 	if ( lwork == -1 ) {
 	    mem_usage->total_needed = *info - A->ncol;
+	    Destroy_CompCol_Permuted(&AC);
+	    if ( A->Stype == SLU_NR ) {
+		Destroy_SuperMatrix_Store(AA);
+		SUPERLU_FREE(AA);
+	    }
 	    return;
 	}
     }
@@ -555,6 +562,11 @@ printf("dgssvx: Fact=%4d, Trans=%4d, equed=%c\n",
 	       rank-deficient (*info) columns of A. */
 	    *recip_pivot_growth = cPivotGrowth(*info, AA, perm_c, L, U);
         }
+	if ( nofact ) Destroy_CompCol_Permuted(&AC);
+	if ( A->Stype == SLU_NR ) {
+	    Destroy_SuperMatrix_Store(AA);
+	    SUPERLU_FREE(AA);
+	}
 	return;
     }
 
@@ -192,6 +192,7 @@ cLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
           GlobalLU_t *Glu, int_t **iwork, complex **dwork)
 {
     int_t      info, iword, dword;
+    int_t      top1, used;  /* stack marks before lusup, ..., usub */
     SCformat *Lstore;
     NCformat *Ustore;
     int_t      *xsup, *supno;
@@ -217,6 +218,7 @@ cLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 	nzlmax = SUPERLU_MAX(1, fill_ratio/4.) * annz;
 
 	if ( lwork == -1 ) {
+	    SUPERLU_FREE (Glu->expanders);
 	    return ( GluIntArray(n) * iword + TempSpace(m, panel_size)
 		    + (nzlmax+nzumax)*iword + (nzlumax+nzumax)*dword + n );
         } else {
@@ -244,6 +246,8 @@ cLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 	    xusub  = (int_t *)cuser_malloc((n+1) * iword, HEAD, Glu);
 	}
 
+	top1 = Glu->stack.top1;
+	used = Glu->stack.used;
 	lusup = (complex *) cexpand( &nzlumax, LUSUP, 0, 0, Glu );
 	ucol  = (complex *) cexpand( &nzumax, UCOL, 0, 0, Glu );
 	lsub  = (int_t *)    cexpand( &nzlmax, LSUB, 0, 0, Glu );
@@ -256,8 +260,10 @@ cLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 		SUPERLU_FREE(lsub);
 		SUPERLU_FREE(usub);
 	    } else {
-		cuser_free((nzlumax+nzumax)*dword+(nzlmax+nzumax)*iword,
-                            HEAD, Glu);
+		/* Some of the four may not have been allocated, and the
+		   alignment padding is not in their sizes */
+		Glu->stack.top1 = top1;
+		Glu->stack.used = used;
 	    }
 	    nzlumax /= 2;
 	    nzumax /= 2;
@@ -291,6 +297,7 @@ cLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 	nzlumax  = Glu->nzlumax;
 
 	if ( lwork == -1 ) {
+	    SUPERLU_FREE (Glu->expanders);
 	    return ( GluIntArray(n) * iword + TempSpace(m, panel_size)
 		    + (nzlmax+nzumax)*iword + (nzlumax+nzumax)*dword + n );
         } else if ( lwork == 0 ) {
@@ -348,6 +355,21 @@ cLUWorkInit(int_t m, int_t n, int_t panel_size, int_t**iworkptr,
     dsize = (m * panel_size +
 	     NUM_TEMPV(m,panel_size,maxsuper,rowblk)) * sizeof(complex);
 
+    if ( Glu->MemModel == SYSTEM && Glu->work ) {
+	/* Reuse the arrays kept by the caller. Of iwork[], only segrep,
+	   parent, xplore and xprune are not reset by SetIWork() or the
+	   factor routines. */
+	if ( (extra = LUWorkspaceReserve(Glu->work, isize, dsize)) ) {
+	    fprintf(stderr, "cLUWorkInit: malloc fails for LUWorkspace\n");
+	    return (extra + n);
+	}
+	*iworkptr = Glu->work->iwork;
+	*dworkptr = (complex *) Glu->work->dwork;
+	ifill (*iworkptr, 3 * m, 0);
+	ifill (*iworkptr + (2 * panel_size + 3) * m, n, 0);
+	return 0;
+    }
+
     if ( Glu->MemModel == SYSTEM )
 	*iworkptr = (int_t *) intCalloc(isize/sizeof(int_t));
     else
@@ -403,8 +425,10 @@ cSetRWork(int_t m, int_t panel_size, complex *dworkptr,
 void cLUWorkFree(int_t *iwork, complex *dwork, GlobalLU_t *Glu)
 {
     if ( Glu->MemModel == SYSTEM ) {
-	SUPERLU_FREE (iwork);
-	SUPERLU_FREE (dwork);
+	if ( !Glu->work ) { /* else kept in the caller's LUWorkspace_t */
+	    SUPERLU_FREE (iwork);
+	    SUPERLU_FREE (dwork);
+	}
     } else {
 	Glu->stack.used -= (Glu->stack.size - Glu->stack.top2);
 	Glu->stack.top2 = Glu->stack.size;
@@ -491,7 +515,8 @@ void
 *cexpand (
 	 int_t *prev_len,   /* length used from previous call */
 	 MemType type,    /* which part of the memory to expand */
-	 int_t len_to_copy, /* size of the memory to be copied to new store */
+	 int_t len_to_copy, /* unused: realloc() and the stack shift
+			       carry the whole array to the new store */
 	 int_t keep_prev,   /* = 1: use prev_len;
 			     = 0: compute new_len to expand */
 	 GlobalLU_t *Glu  /* modified - global LU data structures */
@@ -503,6 +528,7 @@ void
     int_t      new_len, tries, lword, extra, bytes_to_copy;
     ExpHeader *expanders = Glu->expanders; /* Array of 4 types of memory */
 
+    (void) len_to_copy;
     alpha = EXPAND;
 
     if ( Glu->num_expansions == 0 || keep_prev ) {
@@ -516,9 +542,17 @@ void
     else lword = sizeof(complex);
 
     if ( Glu->MemModel == SYSTEM ) {
-	new_mem = (void *) SUPERLU_MALLOC((size_t)new_len * lword);
-	if ( Glu->num_expansions != 0 ) {
+	if ( Glu->num_expansions == 0 ) {
+	    new_mem = (void *) SUPERLU_MALLOC((size_t)new_len * lword);
+	} else {
+	    /* Grow the block in place rather than allocate-copy-free:
+	       realloc() extends it, or for large (mmap'ed) blocks remaps
+	       its pages, so the factored part is not copied and the old
+	       and new arrays need not coexist. On failure the old block
+	       is left intact and a smaller growth factor is tried. */
 	    tries = 0;
+	    new_mem = (void *) SUPERLU_REALLOC(expanders[type].mem,
+					       (size_t)new_len * lword);
 	    if ( keep_prev ) {
 		if ( !new_mem ) return (NULL);
 	    } else {
@@ -526,15 +560,10 @@ void
 		    if ( ++tries > 10 ) return (NULL);
 		    alpha = Reduce(alpha);
 		    new_len = alpha * *prev_len;
-		    new_mem = (void *) SUPERLU_MALLOC((size_t)new_len * lword);
+		    new_mem = (void *) SUPERLU_REALLOC(expanders[type].mem,
+						       (size_t)new_len * lword);
 		}
 	    }
-	    if ( type == LSUB || type == USUB ) {
-		copy_mem_int(len_to_copy, expanders[type].mem, new_mem);
-	    } else {
-		copy_mem_complex(len_to_copy, expanders[type].mem, new_mem);
-	    }
-	    SUPERLU_FREE (expanders[type].mem);
 	}
 	expanders[type].mem = (void *) new_mem;
 
@@ -567,21 +596,23 @@ void
 		}
 	    }
 
+	    /* The stack holds lusup, ucol, lsub, usub in this order, which
+	       is decreasing MemType: the array after type is type - 1. */
 	    if ( type != USUB ) {
-		new_mem = (void*)((char*)expanders[type + 1].mem + extra);
+		new_mem = (void*)((char*)expanders[type - 1].mem + extra);
 		bytes_to_copy = (char*)Glu->stack.array + Glu->stack.top1
-		    - (char*)expanders[type + 1].mem;
-		user_bcopy(expanders[type+1].mem, new_mem, bytes_to_copy);
+		    - (char*)expanders[type - 1].mem;
+		user_bcopy(expanders[type-1].mem, new_mem, bytes_to_copy);
 
-		if ( type < USUB ) {
+		if ( type > USUB ) {
 		    Glu->usub = expanders[USUB].mem =
 			(void*)((char*)expanders[USUB].mem + extra);
 		}
-		if ( type < LSUB ) {
+		if ( type > LSUB ) {
 		    Glu->lsub = expanders[LSUB].mem =
 			(void*)((char*)expanders[LSUB].mem + extra);
 		}
-		if ( type < UCOL ) {
+		if ( type > UCOL ) {
 		    Glu->ucol = expanders[UCOL].mem =
 			(void*)((char*)expanders[UCOL].mem + extra);
 		}
@@ -37,6 +37,123 @@ at the top-level directory.
 #define T2_SUPER
 
 
+/*! \brief Amalgamates column jcol into the supernode of jcol-1.
+ *
+ * <pre>
+ * Called when L[*,jcol] does not have the structure of L[*,jcol-1] minus
+ * its pivot row, so jcol would start a new supernode. Let S be the rows
+ * of L[*,jcol-1] not yet pivoted, E the rows of L[*,jcol] not in S, and
+ * D the rows of S not in L[*,jcol]. The supernode fsupc:jcol-1 is padded
+ * with explicit zeros in rows E, and L[*,jcol] in rows D, so that jcol
+ * can join it. This is done when the zeros added are at most
+ * relax percent of the entries the supernode grows by:
+ *     |E|*(jcol-fsupc) + |D| <= relax/100 * (new size - old size),
+ * so at most relax percent of a supernode formed this way are explicit
+ * zeros, and the wider blocks make dpanel_bmod/dcolumn_bmod run at BLAS-3
+ * speed. The row subscripts of the first column of the supernode and
+ * L\U[*,fsupc:jcol-1] are moved to make room for the new rows.
+ *
+ * On entry, marker2[i] = jcol for the rows i of L[*,jcol] in
+ * lsub[xlsub[jcol]:*nextl-1], and marker2[i] = jcol-1 for those of
+ * L[*,jcol-1] only. *merged is set to 1 if jcol was merged, else 0.
+ *
+ * Return value: 0 on success, or as dLUMemXpand().
+ * </pre>
+ */
+static int_t
+dcolumn_amalg(const int_t jcol, const int_t fsupc, const int_t relax,
+	      const int_t *perm_r, int_t *marker2, int_t *xprune,
+	      int_t *nextl, int_t *merged, GlobalLU_t *Glu)
+{
+    int_t  *lsub = Glu->lsub, *xlsub = Glu->xlsub, *xlusup = Glu->xlusup;
+    double *lusup;
+    int_t  jcolm1 = jcol - 1, nsupc = jcol - fsupc, flag = EMPTY - 1;
+    int_t  jptr = xlsub[jcol], jm1ptr = xlsub[jcolm1];
+    int_t  nsupr, nnew, nmiss, nextra, nzlmax, nzlumax, i, k, c, isub;
+    int_t  ito, ifrom, lfrom, lto, mem_error, bad = 0;
+
+    *merged = 0;
+    nsupr = xlsub[fsupc+1] - xlsub[fsupc];
+
+    /* Rows of S in L[*,jcol] are flagged; count those of D. A row of
+       L[*,jcol-1] marked otherwise means it is not from dcolumn_dfs (a
+       relaxed supernode); leave those alone. */
+    nmiss = 0;
+    for (isub = jm1ptr; isub < jptr; ++isub) {
+	i = lsub[isub];
+	if ( perm_r[i] != EMPTY ) continue;
+	if ( marker2[i] == jcol ) marker2[i] = flag;
+	else if ( marker2[i] == jcolm1 ) ++nmiss;
+	else bad = 1;
+    }
+    nextra = 0;
+    for (isub = jptr; isub < *nextl; ++isub)
+	if ( marker2[lsub[isub]] == jcol ) ++nextra;
+
+    nnew = (nsupc + 1) * (nsupr + nextra) - nsupc * nsupr;
+    if ( bad || 100 * (nextra * nsupc + nmiss) > relax * nnew ) {
+	for (isub = jptr; isub < *nextl; ++isub)
+	    marker2[lsub[isub]] = jcol;
+	return 0;
+    }
+
+    /* Make room for the subscripts and values. */
+    nzlmax = Glu->nzlmax;
+    while ( *nextl + nextra + nmiss >= nzlmax ) {
+	mem_error = dLUMemXpand(jcol, *nextl, LSUB, &nzlmax, Glu);
+	if ( mem_error ) return (mem_error);
+    }
+    nzlumax = Glu->nzlumax;
+    while ( xlusup[fsupc] + (nsupc + 1) * (nsupr + nextra) > nzlumax ) {
+	mem_error = dLUMemXpand(jcol, xlusup[jcol], LUSUP, &nzlumax, Glu);
+	if ( mem_error ) return (mem_error);
+    }
+    lsub = Glu->lsub;
+    lusup = (double *) Glu->lusup;
+
+    if ( nextra > 0 ) {
+	/* Add E to the subscripts of the first column, after moving those
+	   of the later columns up. */
+	lfrom = xlsub[fsupc+1];
+	for (ifrom = *nextl - 1; ifrom >= lfrom; --ifrom)
+	    lsub[ifrom + nextra] = lsub[ifrom];
+	*nextl += nextra;
+	for (c = fsupc + 1; c <= jcol; ++c) xlsub[c] += nextra;
+	for (c = fsupc; c < jcol; ++c) xprune[c] += nextra;
+	ito = lfrom;
+	for (isub = xlsub[jcol]; isub < *nextl; ++isub) {
+	    i = lsub[isub];
+	    if ( marker2[i] == jcol ) lsub[ito++] = i;
+	}
+
+	/* Widen L\U[*,fsupc:jcol-1] to nsupr+nextra rows, last column
+	   first, with zeros in the new rows. */
+	for (c = jcol - 1; c >= fsupc; --c) {
+	    lfrom = xlusup[fsupc] + (c - fsupc) * nsupr;
+	    lto = xlusup[fsupc] + (c - fsupc) * (nsupr + nextra);
+	    for (k = nextra - 1; k >= 0; --k) lusup[lto + nsupr + k] = 0.0;
+	    for (k = nsupr - 1; k >= 0; --k) lusup[lto + k] = lusup[lfrom + k];
+	    xlusup[c] = lto;
+	}
+	xlusup[jcol] = xlusup[fsupc] + nsupc * (nsupr + nextra);
+    }
+
+    /* Add D to L[*,jcol]. */
+    for (isub = xlsub[jcolm1]; isub < xlsub[jcol]; ++isub) {
+	i = lsub[isub];
+	if ( perm_r[i] == EMPTY && marker2[i] == jcolm1 ) {
+	    lsub[(*nextl)++] = i;
+	    marker2[i] = jcol;
+	}
+    }
+
+    for (isub = xlsub[jcol]; isub < *nextl; ++isub)
+	marker2[lsub[isub]] = jcol;
+    *merged = 1;
+    return 0;
+}
+
+
 /*! \brief
  *
  * <pre>
@@ -101,7 +218,7 @@ dcolumn_dfs(
     int_t     mem_error;
     int_t     *xsup, *supno, *lsub, *xlsub;
     int_t     nzlmax;
-    int_t     maxsuper;
+    int_t     maxsuper, relax, merged;
     
     xsup    = Glu->xsup;
     supno   = Glu->supno;
@@ -110,6 +227,7 @@ dcolumn_dfs(
     nzlmax  = Glu->nzlmax;
 
     maxsuper = sp_ienv(3);
+    relax   = Glu->amalg;
     jcolp1  = jcol + 1;
     jcolm1  = jcol - 1;
     nsuper  = supno[jcol];
@@ -245,6 +363,14 @@ dcolumn_dfs(
 	/* Make sure the number of columns in a supernode doesn't
 	   exceed threshold. */
 	if ( jcol - fsupc >= maxsuper ) jsuper = EMPTY;
+	else if ( jsuper == EMPTY && relax > 0 ) {
+	    /* Amalgamate if the explicit zeros stay within the budget. */
+	    mem_error = dcolumn_amalg(jcol, fsupc, relax, perm_r, marker2,
+				      xprune, &nextl, &merged, Glu);
+	    if ( mem_error ) return (mem_error);
+	    lsub = Glu->lsub;
+	    if ( merged ) jsuper = nsuper;
+	}
 
 	/* If jcol starts a new supernode, reclaim storage space in
 	 * lsub from the previous supernode. Note we only store
@@ -0,0 +1,499 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dgsbtf.c
+ * \brief Factors A in block upper triangular form, and solves with it
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include "slu_ddefs.h"
+
+/*! \brief Finds the strongly connected components of the graph of the
+ *  n-by-n pattern (colptr, rowind), with an edge j -> rowind[k] for each
+ *  entry k of column j, by Tarjan's algorithm.
+ *
+ * <pre>
+ * On exit, order[] lists the vertices component by component, and
+ * component b is order[r[b]:r[b+1]-1]. A component is listed after all
+ * the components it has edges to. Returns the number of components.
+ *
+ * iwork[] has size 5*n.
+ * </pre>
+ */
+static int_t
+btf_scc(int_t n, int_t *colptr, int_t *rowind, int_t *order, int_t *r,
+	int_t *iwork)
+{
+    int_t *num = iwork, *low = iwork + n, *stack = iwork + 2*n;
+    int_t *next = iwork + 3*n;  /* next entry to visit in each column */
+    int_t *path = iwork + 4*n;  /* the depth-first path */
+    int_t root, j, i, k, top = 0, depth, cnt = 0, nb = 0, nord = 0;
+
+    for (j = 0; j < n; ++j) num[j] = EMPTY;
+
+    for (root = 0; root < n; ++root) {
+	if ( num[root] != EMPTY ) continue;
+	depth = 0;
+	path[0] = root;
+	num[root] = low[root] = cnt++;
+	stack[top++] = root;
+	next[root] = colptr[root];
+	while ( depth >= 0 ) {
+	    j = path[depth];
+	    for (k = next[j]; k < colptr[j+1]; ++k) {
+		i = rowind[k];
+		if ( num[i] == EMPTY ) break;
+		if ( low[i] < low[j] ) low[j] = low[i];
+	    }
+	    next[j] = k + 1;
+	    if ( k < colptr[j+1] ) {            /* descend to i */
+		i = rowind[k];
+		path[++depth] = i;
+		num[i] = low[i] = cnt++;
+		stack[top++] = i;
+		next[i] = colptr[i];
+		continue;
+	    }
+	    if ( low[j] == num[j] ) {           /* j is a root: pop */
+		r[nb++] = nord;
+		do {
+		    i = stack[--top];
+		    low[i] = n;                 /* done: links to i are ignored */
+		    order[nord++] = i;
+		} while ( i != j );
+	    }
+	    if ( --depth >= 0 && low[j] < low[path[depth]] )
+		low[path[depth]] = low[j];
+	}
+    }
+    r[nb] = n;
+    return nb;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DGSBTF permutes A to block upper triangular form (the Dulmage-Mendelsohn
+ * decomposition of a structurally nonsingular matrix),
+ *
+ *     Pr*A*Pc' = B = [ B11 B12 ... B1k ]
+ *                    [     B22 ... B2k ]
+ *                    [         ...     ]
+ *                    [             Bkk ]
+ *
+ * and factors the diagonal blocks only, each as dgssv does. Reducible
+ * matrices, e.g. from circuits and chemical processes, then have no fill
+ * outside the diagonal blocks. DGSBTRS solves with the factors, treating
+ * the off-diagonal blocks by block back substitution.
+ *
+ *   1. The rows are permuted so that the diagonal is zero-free, by the
+ *      maximum matching of dhwpm(), which also makes it heavy.
+ *   2. The strongly connected components of the graph of the row-permuted
+ *      matrix are its diagonal blocks (Tarjan's algorithm), and they are
+ *      ordered so that B is block upper triangular. Rows and columns keep
+ *      their matching, so the diagonal of each block is zero-free.
+ *   3. Blocks of order 1 are their own pivot. Larger blocks are ordered by
+ *      options->ColPerm and factored by dgstrf().
+ *
+ * If A is structurally singular, it is factored as a single block.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_options_t*
+ *         As for DGSSV, and applied to each diagonal block. options->Fact
+ *         must be DOFACT. ColPerm = MY_PERMC is not supported; COLAMD is
+ *         used instead.
+ *
+ * A       (input) SuperMatrix*
+ *         Matrix A, of dimension (A->nrow, A->ncol), square. The type of
+ *         A can be: Stype = SLU_NC or SLU_NR; Dtype = SLU_D; Mtype = SLU_GE.
+ *         If A is stored row-wise, the above is applied to transpose(A),
+ *         and DGSBTRS takes this into account.
+ *
+ * btf     (output) dBTF_t*
+ *         The permutations, B, and the factors of the diagonal blocks.
+ *         Free them with dDestroy_BTF(), also when info != 0.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         Record the statistics on runtime and floating-point operation
+ *         count, summed over the blocks. See slu_util.h for the definition
+ *         of 'SuperLUStat_t'.
+ *
+ * info    (output) int*
+ *         = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ *         > 0: if info = i, B(i,i) is exactly zero in the factorization
+ *              of its block: the blocks after it are not factored, and
+ *              DGSBTRS must not be called.
+ *         > A->ncol: number of bytes allocated when memory allocation
+ *              failure occurred, plus A->ncol.
+ * </pre>
+ */
+void
+dgsbtf(superlu_options_t *options, SuperMatrix *A, dBTF_t *btf,
+       SuperLUStat_t *stat, int_t *info)
+{
+    SuperMatrix *AA = NULL; /* A in SLU_NC format */
+    SuperMatrix Ab, AC;
+    NCformat *Astore;
+    GlobalLU_t Glu;
+    int_t  n, nnz, nb, b, fst, bsize, i, j, k, kb, bnz;
+    int_t  *colptr, *rowind, *match, *order, *iwork;
+    int_t  *bcolptr, *browind, *b_colptr, *b_rowind, *etree;
+    double *nzval, *bnzval, *b_nzval;
+    int_t  panel_size, relax, permc_spec;
+    double t, *utime = stat->utime;
+    flops_t ops = 0;
+
+    /* Test the input parameters ... */
+    *info = 0;
+    btf->nblocks = 0;
+    btf->perm_r = NULL;
+    if ( options->Fact != DOFACT ) *info = -1;
+    else if ( A->nrow != A->ncol || A->nrow < 0 ||
+	      (A->Stype != SLU_NC && A->Stype != SLU_NR) ||
+	      A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	*info = -2;
+    if ( *info != 0 ) {
+	i = -(*info);
+	input_error("dgsbtf", (int*)&i);
+	return;
+    }
+
+    /* Convert A to SLU_NC format when necessary. */
+    if ( A->Stype == SLU_NR ) {
+	NRformat *Astore = A->Store;
+	AA = (SuperMatrix *) SUPERLU_MALLOC( sizeof(SuperMatrix) );
+	dCreate_CompCol_Matrix(AA, A->ncol, A->nrow, Astore->nnz,
+			       Astore->nzval, Astore->colind, Astore->rowptr,
+			       SLU_NC, A->Dtype, A->Mtype);
+	btf->trans = TRANS;
+    } else {
+	AA = A;
+	btf->trans = NOTRANS;
+    }
+    Astore = AA->Store;
+    n = AA->ncol;
+    nnz = Astore->nnz;
+    colptr = Astore->colptr;
+    rowind = Astore->rowind;
+    nzval = Astore->nzval;
+
+    t = SuperLU_timer_();
+    btf->n = n;
+    if ( !(btf->perm_r = intMalloc(2 * n + 1)) )
+	ABORT("SUPERLU_MALLOC fails for btf->perm_r[]");
+    btf->perm_c = btf->perm_r + n;
+    if ( !(iwork = intMalloc(7 * SUPERLU_MAX(n, 1) + 1)) )
+	ABORT("SUPERLU_MALLOC fails for iwork[]");
+    match = iwork + 5 * n;
+    order = match + n;   /* n+1: also the block boundaries below */
+
+    /* 1. Zero-free diagonal: row i is matched to column match[i]. */
+    if ( dhwpm(options->nthreads, n, nnz, colptr, rowind, nzval, match) ) {
+	for (i = 0; i < n; ++i) {
+	    btf->perm_r[i] = btf->perm_c[i] = i;
+	}
+	nb = (n > 0);
+	if ( !(btf->r = intMalloc(2)) )
+	    ABORT("SUPERLU_MALLOC fails for btf->r[]");
+	btf->r[0] = 0;
+	btf->r[nb] = n;
+    } else {
+	/* 2. Strongly connected components of the matched graph. */
+	if ( !(b_rowind = intMalloc(SUPERLU_MAX(nnz, 1))) )
+	    ABORT("SUPERLU_MALLOC fails for b_rowind[]");
+	for (k = 0; k < nnz; ++k) b_rowind[k] = match[rowind[k]];
+	if ( !(btf->r = intMalloc(n + 1)) )
+	    ABORT("SUPERLU_MALLOC fails for btf->r[]");
+	nb = btf_scc(n, colptr, b_rowind, order, btf->r, iwork);
+	SUPERLU_FREE(b_rowind);
+	for (k = 0; k < n; ++k) btf->perm_c[order[k]] = k;
+	for (i = 0; i < n; ++i) btf->perm_r[i] = btf->perm_c[match[i]];
+    }
+    btf->nblocks = nb;
+
+    /* B = Pr*A*Pc' in SLU_NC format. */
+    if ( !(bcolptr = intMalloc(n + 1)) )
+	ABORT("SUPERLU_MALLOC fails for bcolptr[]");
+    if ( !(browind = intMalloc(SUPERLU_MAX(nnz, 1))) )
+	ABORT("SUPERLU_MALLOC fails for browind[]");
+    if ( !(bnzval = doubleMalloc(SUPERLU_MAX(nnz, 1))) )
+	ABORT("SUPERLU_MALLOC fails for bnzval[]");
+    for (j = 0; j < n; ++j) order[btf->perm_c[j]] = j;
+    bcolptr[0] = 0;
+    for (kb = 0; kb < n; ++kb) {
+	j = order[kb];
+	bnz = bcolptr[kb];
+	for (k = colptr[j]; k < colptr[j+1]; ++k, ++bnz) {
+	    browind[bnz] = btf->perm_r[rowind[k]];
+	    bnzval[bnz] = nzval[k];
+	}
+	bcolptr[kb + 1] = bnz;
+    }
+    dCreate_CompCol_Matrix(&btf->B, n, n, nnz, bnzval, browind, bcolptr,
+			   SLU_NC, SLU_D, SLU_GE);
+    SUPERLU_FREE(iwork);
+    if ( A->Stype == SLU_NR ) {
+	Destroy_SuperMatrix_Store(AA);
+	SUPERLU_FREE(AA);
+    }
+
+    btf->L = (SuperMatrix *) SUPERLU_MALLOC( 2 * SUPERLU_MAX(nb, 1) *
+					     sizeof(SuperMatrix) );
+    if ( !btf->L ) ABORT("SUPERLU_MALLOC fails for btf->L[]");
+    btf->U = btf->L + nb;
+    btf->bperm_r = (int_t **) SUPERLU_MALLOC( 2 * SUPERLU_MAX(nb, 1) *
+					      sizeof(int_t *) );
+    if ( !btf->bperm_r ) ABORT("SUPERLU_MALLOC fails for btf->bperm_r[]");
+    btf->bperm_c = btf->bperm_r + nb;
+    if ( !(btf->diag = doubleMalloc(SUPERLU_MAX(nb, 1))) )
+	ABORT("SUPERLU_MALLOC fails for btf->diag[]");
+    for (b = 0; b < nb; ++b) {
+	btf->L[b].Store = btf->U[b].Store = NULL;
+	btf->bperm_r[b] = NULL;
+    }
+    utime[COLPERM] = SuperLU_timer_() - t;
+    utime[ETREE] = utime[FACT] = 0.;
+
+    /* 3. Factor the diagonal blocks. */
+    panel_size = sp_ienv(1);
+    relax = sp_ienv(2);
+    permc_spec = options->ColPerm == MY_PERMC ? COLAMD : options->ColPerm;
+    for (b = 0; b < nb && *info == 0; ++b) {
+	fst = btf->r[b];
+	bsize = btf->r[b+1] - fst;
+	if ( bsize == 1 ) {
+	    btf->diag[b] = 0.;
+	    for (k = bcolptr[fst]; k < bcolptr[fst+1]; ++k)
+		if ( browind[k] == fst ) btf->diag[b] += bnzval[k];
+	    if ( btf->diag[b] == 0. ) *info = fst + 1;
+	    continue;
+	}
+
+	/* Copy out the block; its entries are the rows >= fst. */
+	t = SuperLU_timer_();
+	bnz = 0;
+	for (j = fst; j < fst + bsize; ++j)
+	    for (k = bcolptr[j]; k < bcolptr[j+1]; ++k)
+		if ( browind[k] >= fst ) ++bnz;
+	b_colptr = intMalloc(bsize + 1);
+	b_rowind = intMalloc(SUPERLU_MAX(bnz, 1));
+	b_nzval = doubleMalloc(SUPERLU_MAX(bnz, 1));
+	if ( !b_colptr || !b_rowind || !b_nzval )
+	    ABORT("SUPERLU_MALLOC fails for the diagonal block");
+	bnz = 0;
+	for (j = 0; j < bsize; ++j) {
+	    b_colptr[j] = bnz;
+	    for (k = bcolptr[fst+j]; k < bcolptr[fst+j+1]; ++k)
+		if ( browind[k] >= fst ) {
+		    b_rowind[bnz] = browind[k] - fst;
+		    b_nzval[bnz++] = bnzval[k];
+		}
+	}
+	b_colptr[bsize] = bnz;
+	dCreate_CompCol_Matrix(&Ab, bsize, bsize, bnz, b_nzval, b_rowind,
+			       b_colptr, SLU_NC, SLU_D, SLU_GE);
+
+	if ( !(btf->bperm_r[b] = intMalloc(2 * bsize)) )
+	    ABORT("SUPERLU_MALLOC fails for btf->bperm_r[]");
+	btf->bperm_c[b] = btf->bperm_r[b] + bsize;
+	if ( permc_spec == AUTO )
+	    get_perm_c_auto(&Ab, btf->bperm_c[b], stat);
+	else
+	    get_perm_c(permc_spec, &Ab, btf->bperm_c[b]);
+	utime[COLPERM] += SuperLU_timer_() - t;
+
+	t = SuperLU_timer_();
+	etree = intMalloc(bsize);
+	sp_preorder(options, &Ab, btf->bperm_c[b], etree, &AC);
+	utime[ETREE] += SuperLU_timer_() - t;
+
+	t = SuperLU_timer_();
+	stat->ops[FACT] = 0;
+	dgstrf(options, &AC, relax, panel_size, etree, NULL, 0,
+	       btf->bperm_c[b], btf->bperm_r[b], &btf->L[b], &btf->U[b],
+	       &Glu, stat, info);
+	ops += stat->ops[FACT];
+	utime[FACT] += SuperLU_timer_() - t;
+	if ( *info > 0 && *info <= bsize ) *info += fst;
+	else if ( *info > bsize ) *info += n - bsize;
+
+	SUPERLU_FREE(etree);
+	Destroy_CompCol_Permuted(&AC);
+	Destroy_CompCol_Matrix(&Ab);
+    }
+    stat->ops[FACT] = ops;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DGSBTRS solves A*X=B or A'*X=B with the block triangular form and the
+ * factors from DGSBTF. With B = Pr*A*Pc', the diagonal blocks are solved
+ * with DGSTRS from the last one to the first (A*X=B), or from the first
+ * one to the last (A'*X=B), and the right-hand sides of the others are
+ * updated with the columns of the off-diagonal blocks in between.
+ *
+ * Arguments
+ * =========
+ *
+ * trans   (input) trans_t
+ *          Specifies the form of the system of equations:
+ *          = NOTRANS: A * X = B  (No transpose)
+ *          = TRANS:   A'* X = B  (Transpose)
+ *          = CONJ:    A**H * X = B  (Conjugate transpose)
+ *
+ * btf     (input) dBTF_t*
+ *         The factors from DGSBTF, which returned info = 0.
+ *
+ * B       (input/output) SuperMatrix*
+ *         B has types: Stype = SLU_DN, Dtype = SLU_D, Mtype = SLU_GE.
+ *         On entry, the right hand side matrix.
+ *         On exit, the solution matrix if info = 0;
+ *
+ * stat    (output) SuperLUStat_t*
+ *         Record the statistics on runtime and floating-point operation
+ *         count. See util.h for the definition of 'SuperLUStat_t'.
+ *
+ * info    (output) int*
+ * 	   = 0: successful exit
+ *	   < 0: if info = -i, the i-th argument had an illegal value
+ * </pre>
+ */
+void
+dgsbtrs(trans_t trans, dBTF_t *btf, SuperMatrix *B, SuperLUStat_t *stat,
+	int_t *info)
+{
+    DNformat *Bstore = B->Store;
+    NCformat *Store = btf->B.Store;
+    SuperMatrix Bb;
+    double   *Bmat = Bstore->nzval, *work, *x, *rhs, *bnzval;
+    int_t    *bcolptr, *browind, *out_perm, *in_perm;
+    int_t    n = btf->n, ldb = Bstore->lda, nrhs = B->ncol;
+    int_t    b, fst, bsize, i, j, k, kr, iinfo, noff = 0;
+    trans_t  btrans;
+    flops_t  ops = 0;
+
+    *info = 0;
+    if ( trans != NOTRANS && trans != TRANS && trans != CONJ ) *info = -1;
+    else if ( ldb < SUPERLU_MAX(0, n) || B->nrow != n ||
+	      B->Stype != SLU_DN || B->Dtype != SLU_D || B->Mtype != SLU_GE )
+	*info = -3;
+    if ( *info ) {
+	i = -(*info);
+	input_error("dgsbtrs", (int*)&i);
+	return;
+    }
+    if ( n == 0 || nrhs == 0 ) return;
+
+    /* Solve with B or B', as the factors are of A or of transpose(A). */
+    btrans = (trans == NOTRANS) == (btf->trans == NOTRANS) ? NOTRANS : TRANS;
+    bcolptr = Store->colptr;
+    browind = Store->rowind;
+    bnzval = Store->nzval;
+
+    /* B*y = Pr*b, x = Pc'*y; or B'*y = Pc*b, x = Pr'*y. */
+    in_perm = btrans == NOTRANS ? btf->perm_r : btf->perm_c;
+    out_perm = btrans == NOTRANS ? btf->perm_c : btf->perm_r;
+    if ( !(work = doubleMalloc((size_t) n * nrhs)) )
+	ABORT("SUPERLU_MALLOC fails for work[]");
+    for (kr = 0; kr < nrhs; ++kr) {
+	x = &work[(size_t) kr * n];
+	rhs = &Bmat[(size_t) kr * ldb];
+	for (i = 0; i < n; ++i) x[in_perm[i]] = rhs[i];
+    }
+
+    for (k = 0; k < btf->nblocks; ++k) {
+	b = btrans == NOTRANS ? btf->nblocks - 1 - k : k;
+	fst = btf->r[b];
+	bsize = btf->r[b+1] - fst;
+
+	if ( btrans == TRANS ) {
+	    /* y_b -= B(1:fst-1, b)' * y(1:fst-1) */
+	    for (j = fst; j < fst + bsize; ++j)
+		for (i = bcolptr[j]; i < bcolptr[j+1]; ++i)
+		    if ( browind[i] < fst ) {
+			for (kr = 0; kr < nrhs; ++kr) {
+			    x = &work[(size_t) kr * n];
+			    x[j] -= bnzval[i] * x[browind[i]];
+			}
+			++noff;
+		    }
+	}
+
+	if ( bsize == 1 ) {
+	    for (kr = 0; kr < nrhs; ++kr) work[(size_t) kr * n + fst] /= btf->diag[b];
+	    ops += nrhs;
+	} else {
+	    dCreate_Dense_Matrix(&Bb, bsize, nrhs, &work[fst], n, SLU_DN,
+				 SLU_D, SLU_GE);
+	    dgstrs(btrans, &btf->L[b], &btf->U[b], btf->bperm_c[b],
+		   btf->bperm_r[b], &Bb, stat, &iinfo);
+	    ops += stat->ops[SOLVE];
+	    Destroy_SuperMatrix_Store(&Bb);
+	}
+
+	if ( btrans == NOTRANS ) {
+	    /* y(1:fst-1) -= B(1:fst-1, b) * y_b */
+	    for (j = fst; j < fst + bsize; ++j)
+		for (i = bcolptr[j]; i < bcolptr[j+1]; ++i)
+		    if ( browind[i] < fst ) {
+			for (kr = 0; kr < nrhs; ++kr) {
+			    x = &work[(size_t) kr * n];
+			    x[browind[i]] -= bnzval[i] * x[j];
+			}
+			++noff;
+		    }
+	}
+    }
+    ops += 2 * (flops_t) nrhs * noff;
+
+    for (kr = 0; kr < nrhs; ++kr) {
+	x = &work[(size_t) kr * n];
+	rhs = &Bmat[(size_t) kr * ldb];
+	for (j = 0; j < n; ++j) rhs[j] = x[out_perm[j]];
+    }
+    SUPERLU_FREE(work);
+    stat->ops[SOLVE] = ops;
+}
+
+/*! \brief Frees the storage allocated by DGSBTF. */
+void
+dDestroy_BTF(dBTF_t *btf)
+{
+    int_t b;
+
+    if ( !btf->perm_r ) return;
+    for (b = 0; b < btf->nblocks; ++b) {
+	if ( btf->L[b].Store ) Destroy_SuperNode_Matrix(&btf->L[b]);
+	if ( btf->U[b].Store ) Destroy_CompCol_Matrix(&btf->U[b]);
+	if ( btf->bperm_r[b] ) SUPERLU_FREE(btf->bperm_r[b]);
+    }
+    SUPERLU_FREE(btf->L);
+    SUPERLU_FREE(btf->bperm_r);
+    SUPERLU_FREE(btf->diag);
+    SUPERLU_FREE(btf->r);
+    SUPERLU_FREE(btf->perm_r);
+    Destroy_CompCol_Matrix(&btf->B);
+    btf->nblocks = 0;
+    btf->perm_r = NULL;
+}
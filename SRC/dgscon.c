@@ -43,6 +43,10 @@ at the top-level directory.
  *   condition number is computed as   
  *      RCOND = 1 / ( norm(A) * norm(inv(A)) ).   
  *
+ *   norm(inv(A)) is estimated by DLACONB with t = sp_ienv(8) vectors at
+ *   a time, so that each step of the estimator is one DGSTRS solve with
+ *   t right-hand sides.
+ *
  *   See supermatrix.h for the definition of 'SuperMatrix' structure.
  * 
  *   Arguments   
@@ -87,16 +91,15 @@ dgscon(char *norm, SuperMatrix *L, SuperMatrix *U,
 
 
     /* Local variables */
-    int_t    kase, kase1, onenrm, i;
+    int      kase, kase1, t;
+    int_t    onenrm, i, n, iinfo;
     double ainvnm;
     double *work;
-    int_t    *iwork;
-    int_t    isave[3];
-    extern int drscl_(int *, double *, double *, int *);
-
-    extern int_t dlacon2_(int_t *, double *, double *, int_t *, double *, int_t *, int_t []);
+    int      *iwork;
+    int      isave[4];
+    int_t    *ident;
+    SuperMatrix X;
 
-    
     /* Test the input parameters. */
     *info = 0;
     onenrm = *(unsigned char *)norm == '1' || strncmp(norm, "O", 1)==0;
@@ -120,39 +123,35 @@ dgscon(char *norm, SuperMatrix *L, SuperMatrix *U,
 	return;
     }
 
-    work = doubleCalloc( 3*L->nrow );
-    iwork = intMalloc( L->nrow );
-
+    /* Estimate the norm of inv(A) with t vectors at a time, each
+       iteration being one multiple right-hand side solve. */
+    n = L->nrow;
+    t = SUPERLU_MAX(1, SUPERLU_MIN(sp_ienv(8), n));
+    work = doubleMalloc( n * (2*t + 1) );
+    iwork = (int *) SUPERLU_MALLOC( (n + t) * sizeof(int) );
+    ident = intMalloc( n );
 
-    if ( !work || !iwork )
+    if ( !work || !iwork || !ident )
 	ABORT("Malloc fails for work arrays in dgscon.");
+    for (i = 0; i < n; ++i) ident[i] = i;
+    dCreate_Dense_Matrix(&X, n, t, work, n, SLU_DN, SLU_D, SLU_GE);
     
-    /* Estimate the norm of inv(A). */
     ainvnm = 0.;
     if ( onenrm ) kase1 = 1;
     else kase1 = 2;
     kase = 0;
 
     do {
-	dlacon2_(&L->nrow, &work[L->nrow], &work[0], &iwork[0], &ainvnm, &kase, isave);
+	dlaconb(n, t, work, &work[n*t], iwork, &ainvnm, &kase, isave);
 
 	if (kase == 0) break;
 
 	if (kase == kase1) {
-	    /* Multiply by inv(L). */
-	    sp_dtrsv("L", "No trans", "Unit", L, U, &work[0], stat, (int*)info);
-
-	    /* Multiply by inv(U). */
-	    sp_dtrsv("U", "No trans", "Non-unit", L, U, &work[0], stat, (int*)info);
-	    
+	    /* Multiply by inv(U)*inv(L). */
+	    dgstrs(NOTRANS, L, U, ident, ident, &X, stat, &iinfo);
 	} else {
-
-	    /* Multiply by inv(U'). */
-	    sp_dtrsv("U", "Transpose", "Non-unit", L, U, &work[0], stat, (int*)info);
-
-	    /* Multiply by inv(L'). */
-	    sp_dtrsv("L", "Transpose", "Unit", L, U, &work[0], stat, (int*)info);
-	    
+	    /* Multiply by inv(L')*inv(U'). */
+	    dgstrs(TRANS, L, U, ident, ident, &X, stat, &iinfo);
 	}
 
     } while ( kase != 0 );
@@ -160,8 +159,10 @@ dgscon(char *norm, SuperMatrix *L, SuperMatrix *U,
     /* Compute the estimate of the reciprocal condition number. */
     if (ainvnm != 0.) *rcond = (1. / ainvnm) / anorm;
 
+    Destroy_SuperMatrix_Store(&X);
     SUPERLU_FREE (work);
     SUPERLU_FREE (iwork);
+    SUPERLU_FREE (ident);
     return;
 
 } /* dgscon */
@@ -51,6 +51,8 @@ at the top-level directory.
  *	1.2. Permute columns of A, forming A*Pc, where Pc is a permutation
  *	     matrix that usually preserves sparsity.
  *	     For more details of this step, see sp_preorder.c.
+ *	     If options->PermCache = YES, Pc and the column elimination
+ *	     tree are taken from perm_cache.c when A's pattern was seen before.
  *
  *	1.3. If options->Fact != FACTORED, the LU decomposition is used to
  *	     factor the matrix A (after equilibration if options->Equil = YES)
@@ -83,6 +85,13 @@ at the top-level directory.
  *		entries of modulus 1 on the diagonal and off-diagonal entries
  *		of modulus at most 1. If MC64 fails, dgsequ() is used to
  *		equilibrate the system.
+ *		If options->RowPerm = LargeDiag_HWPM, the row permutation is
+ *		an approximate heavy-weight matching from dhwpm(), which is
+ *		faster than MC64 and uses options->nthreads threads. It gives
+ *		no scaling; dgsequ() is used if options->Equil = YES.
+ *		If options->PermCache = YES and options->Fact = SamePattern,
+ *		the permutation and the scalings of the last factorization of
+ *		a matrix with the same pattern are reused.
  *              ( Default: LargeDiag_MC64 )
  *	     2) options->ILU_DropTol = tau is the threshold for dropping.
  *		For L, it is used directly (for the whole row in a supernode);
@@ -162,6 +171,8 @@ at the top-level directory.
  *	     forming transpose(A)*Pc, where Pc is a permutation matrix that
  *	     usually preserves sparsity.
  *	     For more details of this step, see sp_preorder.c.
+ *	     If options->PermCache = YES, Pc and the column elimination
+ *	     tree are taken from perm_cache.c when A's pattern was seen before.
  *
  *	2.3. If options->Fact != FACTORED, the LU decomposition is used to
  *	     factor the transpose(A) (after equilibration if
@@ -233,6 +244,9 @@ at the top-level directory.
  *            and A is scaled as above, but no permutation is involved.
  *            On exit, A is restored to the orginal row numbering, so
  *            Dr*A*Dc is returned.
+ *         If options->RowPerm = LargeDiag_HWPM, A is scaled by dgsequ() as
+ *            above, and permuted by HWPM; on exit it is also restored to
+ *            the original row numbering.
  *
  * perm_c  (input/output) int*
  *	   If A->Stype = SLU_NC, Column permutation vector of size A->ncol,
@@ -250,7 +264,7 @@ at the top-level directory.
  * perm_r  (input/output) int*
  *	   If A->Stype = SLU_NC, row permutation vector of size A->nrow, 
  *	   which defines the permutation matrix Pr, and is determined
- *	   by MC64 first then followed by partial pivoting.
+ *	   by MC64 or HWPM first then followed by partial pivoting.
  *         perm_r[i] = j means row i of A is in position j in Pr*A.
  *
  *	   If A->Stype = SLU_NR, permutation vector of size A->ncol, which
@@ -415,15 +429,19 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
     SuperMatrix *AA;/* A in SLU_NC format used by the factorization routine.*/
     SuperMatrix AC; /* Matrix postmultiplied by Pc */
     int_t       colequ, equil, nofact, notran, rowequ, permc_spec, mc64;
+    int_t       ldperm;  /* rows permuted by MC64 or HWPM */
+    int_t       rpcached = 0; /* perm[], R[], C[] from the pattern cache */
     trans_t   trant;
     char      norm[1];
     int_t       i, j, info1;
     double    amax, anorm, bignum, smlnum, colcnd, rowcnd, rcmax, rcmin;
     int_t       relax, panel_size;
+    int_t       cached;  /* perm_c[] and etree[] from the pattern cache */
+    unsigned long long phash = 0; /* hash of the pattern of AA */
     double    t0;      /* temporary time */
     double    *utime;
 
-    int_t *perm = NULL; /* permutation returned from MC64 */
+    int_t *perm = NULL; /* permutation returned from MC64 or HWPM */
 
     /* External functions */
     extern double dlangs(char *, SuperMatrix *);
@@ -442,6 +460,7 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
     equil = (options->Equil == YES);
     notran = (options->Trans == NOTRANS);
     mc64 = (options->RowPerm == LargeDiag_MC64);
+    ldperm = mc64 || (options->RowPerm == LargeDiag_HWPM);
     if ( nofact ) {
 	*(unsigned char *)equed = 'N';
 	rowequ = FALSE;
@@ -545,19 +564,39 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
 	int_t *rowind = Astore->rowind;
 	double *nzval = (double *)Astore->nzval;
 
-	if ( mc64 ) {
-	    t0 = SuperLU_timer_();
+	t0 = SuperLU_timer_();
+	if ( ldperm ) {
 	    if ((perm = intMalloc(n)) == NULL)
 		ABORT("SUPERLU_MALLOC fails for perm[]");
 
-	    info1 = dldperm(5, n, nnz, colptr, rowind, nzval, perm, R, C);
-
-	    if (info1 != 0) { /* MC64 fails, call dgsequ() later */
-		mc64 = 0;
-		SUPERLU_FREE(perm);
-		perm = NULL;
+	    /* Reuse the matching and the scalings of the last factorization
+	       with this pattern. */
+	    rpcached = options->PermCache == YES &&
+		       options->Fact == SamePattern &&
+		       rowperm_cache_lookup(options, AA, perm, R, C, equed);
+	    if ( rpcached ) {
+		rowequ = strncmp(equed, "R", 1)==0 || strncmp(equed, "B", 1)==0;
+		colequ = strncmp(equed, "C", 1)==0 || strncmp(equed, "B", 1)==0;
+		if ( rowequ || colequ ) {
+		    for (j = 0; j < n; j++) {
+			for (i = colptr[j]; i < colptr[j + 1]; i++) {
+			    if ( rowequ ) nzval[i] *= R[rowind[i]];
+			    if ( colequ ) nzval[i] *= C[j];
+			}
+		    }
+		}
 	    } else {
-	        if ( equil ) {
+		if ( mc64 )
+		    info1 = dldperm(5, n, nnz, colptr, rowind, nzval, perm, R, C);
+		else
+		    info1 = dhwpm(options->nthreads, n, nnz, colptr, rowind,
+				  nzval, perm);
+
+		if (info1 != 0) { /* No matching, call dgsequ() later */
+		    ldperm = mc64 = 0;
+		    SUPERLU_FREE(perm);
+		    perm = NULL;
+		} else if ( mc64 && equil ) {
 	            rowequ = colequ = 1;
 		    for (i = 0; i < n; i++) {
 		        R[i] = exp(R[i]);
@@ -570,21 +609,12 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
 		        }
 		    }
 	            *equed = 'B';
-                }
-
-                /* permute the matrix */
-		for (j = 0; j < n; j++) {
-		    for (i = colptr[j]; i < colptr[j + 1]; i++) {
-			/*nzval[i] *= R[rowind[i]] * C[j];*/
-			rowind[i] = perm[rowind[i]];
-		    }
 		}
 	    }
-	    utime[EQUIL] = SuperLU_timer_() - t0;
 	}
 
-	if ( mc64==0 && equil ) { /* Only perform equilibration, no row perm */
-	    t0 = SuperLU_timer_();
+	if ( mc64==0 && rpcached==0 && equil ) {
+	    /* Equilibration by dgsequ(), before any row perm from HWPM */
 	    /* Compute row and column scalings to equilibrate the matrix A. */
 	    dgsequ(AA, R, C, &rowcnd, &colcnd, &amax, &info1);
 
@@ -594,8 +624,20 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
 		rowequ = strncmp(equed, "R", 1)==0 || strncmp(equed, "B", 1)==0;
 		colequ = strncmp(equed, "C", 1)==0 || strncmp(equed, "B", 1)==0;
 	    }
-	    utime[EQUIL] = SuperLU_timer_() - t0;
 	}
+
+	if ( ldperm ) {
+	    if ( !rpcached && options->PermCache == YES )
+		rowperm_cache_store(options, AA, perm, R, C, *equed);
+
+	    /* permute the matrix */
+	    for (j = 0; j < n; j++) {
+		for (i = colptr[j]; i < colptr[j + 1]; i++) {
+		    rowind[i] = perm[rowind[i]];
+		}
+	    }
+	}
+	utime[EQUIL] = SuperLU_timer_() - t0;
     }
 
 
@@ -611,12 +653,30 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
 	 *   permc_spec = MY_PERMC: the ordering already supplied in perm_c[]
 	 */
 	permc_spec = options->ColPerm;
-	if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
-	    get_perm_c(permc_spec, AA, perm_c);
+	cached = 0;
+	if ( permc_spec != MY_PERMC && options->Fact == DOFACT ) {
+	    if ( options->PermCache == YES )
+		cached = perm_cache_lookup(options, AA, &phash, perm_c, etree);
+	    if ( !cached && permc_spec == AUTO )
+		get_perm_c_auto(AA, perm_c, stat);
+	    else if ( !cached )
+		get_perm_c(permc_spec, AA, perm_c);
+	}
 	utime[COLPERM] = SuperLU_timer_() - t0;
 
 	t0 = SuperLU_timer_();
-	sp_preorder(options, AA, perm_c, etree, &AC);
+	if ( cached ) {
+	    /* perm_c[] and etree[] are already postordered; only form A*Pc,
+	       as for a SamePattern factorization. */
+	    superlu_options_t options_pc = *options;
+	    options_pc.Fact = SamePattern;
+	    sp_preorder(&options_pc, AA, perm_c, etree, &AC);
+	} else {
+	    sp_preorder(options, AA, perm_c, etree, &AC);
+	    if ( permc_spec != MY_PERMC && options->Fact == DOFACT &&
+		 options->PermCache == YES )
+		perm_cache_store(options, AA, phash, perm_c, etree);
+	}
 	utime[ETREE] = SuperLU_timer_() - t0;
 
 	/* Compute the LU factorization of A*Pc. */
@@ -630,7 +690,7 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
 	    return;
 	}
 
-	if ( mc64 ) { /* Fold MC64's perm[] into perm_r[]. */
+	if ( ldperm ) { /* Fold the matching perm[] into perm_r[]. */
 	    NCformat *Astore = AA->Store;
 	    int_t nnz = Astore->nnz, *rowind = Astore->rowind;
 	    int_t *perm_tmp, *iperm;
@@ -646,7 +706,7 @@ dgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
 	    /* Restore A's original row indices. */
 	    for (i = 0; i < nnz; ++i) rowind[i] = iperm[rowind[i]];
 
-	    SUPERLU_FREE(perm); /* MC64 permutation */
+	    SUPERLU_FREE(perm); /* MC64 or HWPM permutation */
 	    SUPERLU_FREE(perm_tmp);
 	}
     }
@@ -261,6 +261,9 @@ dgsitrf(superlu_options_t *options, SuperMatrix *A, int_t relax, int_t panel_siz
     xa_end   = Astore->colend;
 
     /* Allocate storage common to the factor routines */
+    Glu->work = options->LUWorkspace;
+    Glu->budget = (lwork == 0) ? options->MemBudget : 0.;
+    Glu->ooc = NULL;
     *info = dLUMemInit(fact, work, lwork, m, n, Astore->nnz, panel_size,
 		       gamma, L, U, Glu, &iwork, &dwork);
     if ( *info ) return;
@@ -0,0 +1,360 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dgspipe.c
+ * \brief Solves a stream of independent systems in a three-stage pipeline
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include "slu_ddefs.h"
+
+/*! \brief One system of dgspipe() between its stages */
+typedef struct {
+    dPipeJob_t  *job;
+    SuperMatrix *AA;      /* A in SLU_NC format */
+    SuperMatrix AC, L, U;
+    GlobalLU_t  Glu;
+    trans_t     trant;    /* the system to solve with AA */
+    int_t       *perm_c, *perm_r, *etree;
+    double      *R, *C;
+    double      anorm;
+} dpipe_slot_t;
+
+/*! \brief Checks the job, equilibrates A, orders its columns and forms
+ *  A*Pc, as dgssvx does.
+ */
+static void
+dpipe_prepare(superlu_options_t *options, dPipeJob_t *job, dpipe_slot_t *s,
+	      SuperLUStat_t *stat)
+{
+    SuperMatrix *A = job->A, *B = job->B, *X = job->X;
+    double  *utime = stat->utime;
+    double  rowcnd, colcnd, amax, t0;
+    int_t   n, cached, info1;
+    unsigned long long phash = 0;
+    char    norm[1];
+    extern double dlangs(char *, SuperMatrix *);
+
+    s->job = job;
+    s->AA = NULL;
+    s->perm_c = NULL;
+    job->info = 0;
+    job->equed = 'N';
+    job->rcond = job->rpg = 0.;
+    if ( A->nrow != A->ncol || A->nrow < 0 ||
+	 (A->Stype != SLU_NC && A->Stype != SLU_NR) ||
+	 A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	job->info = -2;
+    else if ( B->ncol < 0 || (B->ncol > 0 &&
+	      (((DNformat *) B->Store)->lda < A->nrow ||
+	       B->Stype != SLU_DN || B->Dtype != SLU_D || B->Mtype != SLU_GE)) )
+	job->info = -13;
+    else if ( X->ncol < 0 || (X->ncol > 0 &&
+	      (((DNformat *) X->Store)->lda < A->nrow ||
+	       (B->ncol != 0 && B->ncol != X->ncol) ||
+	       X->Stype != SLU_DN || X->Dtype != SLU_D || X->Mtype != SLU_GE)) )
+	job->info = -14;
+    if ( job->info ) return;
+    n = A->ncol;
+
+    if ( A->Stype == SLU_NR ) {
+	NRformat *Astore = A->Store;
+	s->AA = (SuperMatrix *) SUPERLU_MALLOC( sizeof(SuperMatrix) );
+	if ( !s->AA ) ABORT("SUPERLU_MALLOC fails for AA");
+	dCreate_CompCol_Matrix(s->AA, A->ncol, A->nrow, Astore->nnz,
+			       Astore->nzval, Astore->colind, Astore->rowptr,
+			       SLU_NC, A->Dtype, A->Mtype);
+	s->trant = (options->Trans == NOTRANS) ? TRANS : NOTRANS;
+    } else {
+	s->AA = A;
+	s->trant = options->Trans;
+    }
+
+    if ( !(s->perm_c = intMalloc(n)) || !(s->perm_r = intMalloc(n)) ||
+	 !(s->etree = intMalloc(n)) )
+	ABORT("Malloc fails for perm_c[], perm_r[] or etree[].");
+    if ( !(s->R = doubleMalloc(n)) || !(s->C = doubleMalloc(n)) )
+	ABORT("Malloc fails for R[] or C[].");
+
+    if ( options->Equil == YES ) {
+	t0 = SuperLU_timer_();
+	dgsequ(s->AA, s->R, s->C, &rowcnd, &colcnd, &amax, &info1);
+	if ( info1 == 0 )
+	    dlaqgs(s->AA, s->R, s->C, rowcnd, colcnd, amax, &job->equed);
+	utime[EQUIL] += SuperLU_timer_() - t0;
+    }
+
+    t0 = SuperLU_timer_();
+    cached = 0;
+    if ( options->PermCache == YES )
+	cached = perm_cache_lookup(options, s->AA, &phash, s->perm_c, s->etree);
+    if ( !cached && options->Presolve == YES )
+	get_perm_c_presolve(options->ColPerm, s->AA, s->perm_c, stat);
+    else if ( !cached && options->ColPerm == AUTO )
+	get_perm_c_auto(s->AA, s->perm_c, stat);
+    else if ( !cached )
+	get_perm_c(options->ColPerm, s->AA, s->perm_c);
+    utime[COLPERM] += SuperLU_timer_() - t0;
+
+    t0 = SuperLU_timer_();
+    if ( cached ) {
+	superlu_options_t options_pc = *options;
+	options_pc.Fact = SamePattern;
+	sp_preorder(&options_pc, s->AA, s->perm_c, s->etree, &s->AC);
+    } else {
+	sp_preorder(options, s->AA, s->perm_c, s->etree, &s->AC);
+	if ( options->PermCache == YES )
+	    perm_cache_store(options, s->AA, phash, s->perm_c, s->etree);
+    }
+    utime[ETREE] += SuperLU_timer_() - t0;
+
+    if ( options->ConditionNumber == YES ) {
+	*(unsigned char *)norm = (s->trant == NOTRANS) ? '1' : 'I';
+	s->anorm = dlangs(norm, s->AA);
+    }
+}
+
+/*! \brief Factors A*Pc, as dgssvx does. */
+static void
+dpipe_factor(superlu_options_t *options, dpipe_slot_t *s, SuperLUStat_t *stat)
+{
+    dPipeJob_t *job = s->job;
+    int_t  n = job->A->ncol;
+    double t0;
+
+    if ( job->info ) return;
+    t0 = SuperLU_timer_();
+    dgstrf(options, &s->AC, sp_ienv(2), sp_ienv(1), s->etree, NULL, 0,
+	   s->perm_c, s->perm_r, &s->L, &s->U, &s->Glu, stat, &job->info);
+    stat->utime[FACT] += SuperLU_timer_() - t0;
+
+    if ( job->info > 0 && job->info <= n )
+	job->rpg = dPivotGrowth(job->info, s->AA, s->perm_c, &s->L, &s->U);
+    else if ( job->info == 0 && options->PivotGrowth == YES )
+	job->rpg = dPivotGrowth(n, s->AA, s->perm_c, &s->L, &s->U);
+}
+
+/*! \brief Solves with the factors, as dgssvx does, and frees everything
+ *  the job used, also when it failed.
+ */
+static void
+dpipe_solve(superlu_options_t *options, dpipe_slot_t *s, SuperLUStat_t *stat)
+{
+    dPipeJob_t *job = s->job;
+    SuperMatrix *A = job->A, *B = job->B, *X = job->X;
+    double  *Bmat, *Xmat, *R = s->R, *C = s->C, *utime = stat->utime;
+    double  t0;
+    int_t   i, j, n, nrhs, ldb, ldx, notran, rowequ, colequ, info1;
+    char    norm[1];
+
+    if ( !s->perm_c ) return;   /* rejected by dpipe_prepare() */
+    n = A->ncol;
+    if ( job->info == 0 ) {
+	notran = (s->trant == NOTRANS);
+	rowequ = (job->equed == 'R' || job->equed == 'B');
+	colequ = (job->equed == 'C' || job->equed == 'B');
+	nrhs = B->ncol;
+	Bmat = ((DNformat *) B->Store)->nzval;
+	ldb  = ((DNformat *) B->Store)->lda;
+	Xmat = ((DNformat *) X->Store)->nzval;
+	ldx  = ((DNformat *) X->Store)->lda;
+
+	if ( options->ConditionNumber == YES ) {
+	    t0 = SuperLU_timer_();
+	    *(unsigned char *)norm = notran ? '1' : 'I';
+	    dgscon(norm, &s->L, &s->U, s->anorm, &job->rcond, stat, &info1);
+	    utime[RCOND] += SuperLU_timer_() - t0;
+	}
+
+	if ( nrhs > 0 ) {
+	    if ( notran ? rowequ : colequ )
+		for (j = 0; j < nrhs; ++j)
+		    for (i = 0; i < n; ++i)
+			Bmat[i + j*ldb] *= notran ? R[i] : C[i];
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < n; ++i)
+		    Xmat[i + j*ldx] = Bmat[i + j*ldb];
+
+	    t0 = SuperLU_timer_();
+	    dpgstrs(options, s->trant, &s->L, &s->U, s->perm_c, s->perm_r,
+		    X, stat, &info1);
+	    utime[SOLVE] += SuperLU_timer_() - t0;
+
+	    t0 = SuperLU_timer_();
+	    if ( options->IterRefine != NOREFINE )
+		dgsrfs(s->trant, s->AA, &s->L, &s->U, s->perm_c, s->perm_r,
+		       &job->equed, R, C, B, X, job->ferr, job->berr,
+		       stat, &info1);
+	    else
+		for (j = 0; j < nrhs; ++j) job->ferr[j] = job->berr[j] = 1.0;
+	    utime[REFINE] += SuperLU_timer_() - t0;
+
+	    if ( notran ? colequ : rowequ )
+		for (j = 0; j < nrhs; ++j)
+		    for (i = 0; i < n; ++i)
+			Xmat[i + j*ldx] *= notran ? C[i] : R[i];
+	}
+
+	if ( options->ConditionNumber == YES && job->rcond < dmach("E") )
+	    job->info = n + 1;
+    }
+
+    if ( job->info >= 0 && job->info <= n + 1 ) {
+	Destroy_SuperNode_Matrix(&s->L);
+	Destroy_CompCol_Matrix(&s->U);
+    }
+    Destroy_CompCol_Permuted(&s->AC);
+    if ( A->Stype == SLU_NR ) {
+	Destroy_SuperMatrix_Store(s->AA);
+	SUPERLU_FREE(s->AA);
+    }
+    SUPERLU_FREE(s->perm_c);
+    SUPERLU_FREE(s->perm_r);
+    SUPERLU_FREE(s->etree);
+    SUPERLU_FREE(s->R);
+    SUPERLU_FREE(s->C);
+}
+
+/*! \brief Adds the counts of one stage to stat. */
+static void
+dpipe_stat_add(SuperLUStat_t *stat, SuperLUStat_t *s)
+{
+    int_t i, w = SUPERLU_MAX(sp_ienv(1), sp_ienv(2));
+
+    for (i = 0; i < NPHASES; ++i) {
+	stat->utime[i] += s->utime[i];
+	stat->ops[i] += s->ops[i];
+    }
+    for (i = 0; i <= w; ++i) stat->panel_histo[i] += s->panel_histo[i];
+    stat->TinyPivots += s->TinyPivots;
+    stat->RefineSteps += s->RefineSteps;
+    stat->expansions += s->expansions;
+    stat->OOCWrite += s->OOCWrite;
+    stat->OOCRead += s->OOCRead;
+    if ( s->ColPermChosen != AUTO ) {
+	stat->ColPermChosen = s->ColPermChosen;
+	for (i = 0; i < AUTO; ++i) {
+	    stat->ColPermNnz[i] = s->ColPermNnz[i];
+	    stat->ColPermOps[i] = s->ColPermOps[i];
+	}
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DGSPIPE solves a stream of independent systems A*X=B or A'*X=B, each as
+ * DGSSVX would with options->Fact = DOFACT, in a pipeline of three stages:
+ *
+ *   1. equilibration, column ordering and etree (sp_preorder) of job k+1,
+ *   2. the LU factorization of job k,
+ *   3. condition estimate, solve and refinement of job k-1.
+ *
+ * The stages run concurrently, one OpenMP thread each, and all three
+ * finish before the pipeline moves on by a job. The throughput is then
+ * that of the slowest stage, rather than of the sum of the stages, and at
+ * most three jobs hold their permutations, A*Pc and factors at a time.
+ * Each job's storage is freed when its solve completes. Without OpenMP
+ * the stages run one after another.
+ *
+ * A stage that calls dgstrf() or dpgstrs() with options->nthreads > 1
+ * opens a nested parallel region, which has one thread unless nested
+ * parallelism is enabled.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_options_t*
+ *         As for DGSSVX, and applied to every job. options->Fact must be
+ *         DOFACT, and ColPerm = MY_PERMC is not supported. With
+ *         options->PermCache = YES, the jobs with the same pattern share
+ *         their column ordering.
+ *
+ * njobs   (input) int_t
+ *         The number of jobs.
+ *
+ * jobs    (input/output) dPipeJob_t*, dimension njobs
+ *         The systems, solved in this order. For each one, A, B and X are
+ *         as for DGSSVX: A is overwritten by its equilibrated form when
+ *         equed != 'N', and so is B. ferr and berr have B->ncol entries.
+ *         On exit, equed, rcond (if options->ConditionNumber = YES),
+ *         rpg (if options->PivotGrowth = YES, or info is in 1..n) and info
+ *         are set as by DGSSVX for the job; info is -2, -13 or -14 if A, B
+ *         or X is not valid.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         Record the statistics on runtime and floating-point operation
+ *         count, summed over the jobs. The times of the stages add up to
+ *         more than the elapsed time, as they overlap.
+ *
+ * info    (output) int*
+ *         = 0: successful exit; see jobs[k].info for each job
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ * </pre>
+ */
+void
+dgspipe(superlu_options_t *options, int_t njobs, dPipeJob_t *jobs,
+	SuperLUStat_t *stat, int_t *info)
+{
+    dpipe_slot_t  slot[3];
+    SuperLUStat_t sstat[3];
+    int_t  k, i;
+
+    *info = 0;
+    if ( options->Fact != DOFACT || options->ColPerm == MY_PERMC ||
+	 (options->Trans != NOTRANS && options->Trans != TRANS &&
+	  options->Trans != CONJ) )
+	*info = -1;
+    else if ( njobs < 0 ) *info = -2;
+    if ( *info != 0 ) {
+	i = -(*info);
+	input_error("dgspipe", (int *)&i);
+	return;
+    }
+
+    for (i = 0; i < 3; ++i) StatInit(&sstat[i]);
+
+    /* At step k, job k is prepared, job k-1 factored and job k-2 solved,
+       each in slot (job mod 3). */
+    for (k = 0; k < njobs + 2; ++k) {
+#ifdef _OPENMP
+#pragma omp parallel sections num_threads(3)
+#endif
+	{
+#ifdef _OPENMP
+#pragma omp section
+#endif
+	    if ( k < njobs )
+		dpipe_prepare(options, &jobs[k], &slot[k % 3], &sstat[0]);
+#ifdef _OPENMP
+#pragma omp section
+#endif
+	    if ( k >= 1 && k - 1 < njobs )
+		dpipe_factor(options, &slot[(k - 1) % 3], &sstat[1]);
+#ifdef _OPENMP
+#pragma omp section
+#endif
+	    if ( k >= 2 )
+		dpipe_solve(options, &slot[(k - 2) % 3], &sstat[2]);
+	}
+    }
+
+    for (i = 0; i < 3; ++i) {
+	dpipe_stat_add(stat, &sstat[i]);
+	StatFree(&sstat[i]);
+    }
+}
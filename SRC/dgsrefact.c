@@ -0,0 +1,239 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dgsrefact.c
+ * \brief Numeric-only refactorization on a fixed structure of L and U
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "slu_ddefs.h"
+
+static int _compare_(const void *a, const void *b)
+{
+    int_t x = *(int_t *)a, y = *(int_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DGSREFACT recomputes the numerical values of the LU factorization
+ *     Pr * A = L * U
+ * computed by a previous call to dgstrf() for a matrix with the same
+ * sparsity pattern, keeping the row permutation, the supernode partition
+ * and the row subscripts of L and U. No depth-first search, pruning or
+ * memory expansion is done; each column is computed by a left-looking
+ * sparse triangular solve over the U-segments stored for it.
+ *
+ * The pivot of column j is kept in row j of Pr*A, provided that
+ *     abs(U(j,j)) >= options->DiagPivotThresh * max_(i>=j) abs(A_ij),
+ * with the same test as dpivotL() uses for a user-specified pivot.
+ * Otherwise the routine stops, and the caller must factorize A again
+ * with dgstrf() to obtain a new structure.
+ *
+ * The row subscripts of each column of U are sorted in increasing order
+ * on the first call; the factors remain valid for the solve routines.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_options_t*
+ *         Only DiagPivotThresh is used.
+ *
+ * A       (input) SuperMatrix*
+ *         Original matrix A, permuted by columns, of dimension
+ *         (A->nrow, A->ncol). The type of A can be:
+ *         Stype = SLU_NCP; Dtype = SLU_D; Mtype = SLU_GE.
+ *
+ * perm_r  (input) int*, dimension (A->nrow)
+ *         Row permutation vector of the previous factorization.
+ *
+ * L       (input/output) SuperMatrix*
+ * U       (input/output) SuperMatrix*
+ *         The factors L and U of the previous factorization, as returned
+ *         by dgstrf(). On exit, their numerical values are those of the
+ *         factorization of A if the return value is 0.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         Record the statistics on floating-point operation count.
+ *
+ * Return value
+ * ============
+ *         = 0: successful exit
+ *         > 0: if j, the pivot of column j-1 failed the threshold test,
+ *              or is zero. The values of L and U are not valid.
+ * </pre>
+ */
+int_t
+dgsrefact(superlu_options_t *options, SuperMatrix *A, int_t *perm_r,
+	  SuperMatrix *L, SuperMatrix *U, SuperLUStat_t *stat)
+{
+#ifdef USE_VENDOR_BLAS
+    int_t      incx = 1, incy = 1;
+    double     alpha = 1.0, beta = 0.0;
+#endif
+    NCPformat *Astore = A->Store;
+    SCformat  *Lstore = L->Store;
+    NCformat  *Ustore = U->Store;
+    double    *a = Astore->nzval;
+    int_t     *asub = Astore->rowind;
+    int_t     *xa_begin = Astore->colbeg, *xa_end = Astore->colend;
+    int_t     *xsup = Lstore->sup_to_col, *supno = Lstore->col_to_sup;
+    int_t     *lsub = Lstore->rowind, *xlsub = Lstore->rowind_colptr;
+    double    *lusup = Lstore->nzval;
+    int_t     *xlusup = Lstore->nzval_colptr;
+    int_t     *usub = Ustore->rowind, *xusub = Ustore->colptr;
+    double    *ucol = Ustore->nzval;
+    double    u = options->DiagPivotThresh;
+    flops_t   *ops = stat->ops;
+    double    *dense, *tempv, *tempv1;
+    double    pivmax, rtemp, temp;
+    int_t     m = A->nrow, n = U->ncol;
+    int_t     jcol, fsupc, nsupc, nsupr, nrow, segsze, lptr, luptr;
+    int_t     ksupno, kfnz, krep, i, k, kend, info = 0;
+
+    if ( !(dense = doubleCalloc(m)) ) ABORT("Malloc fails for dense[].");
+    if ( !(tempv = doubleCalloc(m)) ) ABORT("Malloc fails for tempv[].");
+
+    for (jcol = 0; jcol < n; ++jcol) {
+
+	/* The U-segments must be visited in topological order; increasing
+	   row subscripts of Pr*A give one. */
+	for (k = xusub[jcol] + 1; k < xusub[jcol+1]; ++k)
+	    if ( usub[k] < usub[k-1] ) {
+		qsort(&usub[xusub[jcol]], xusub[jcol+1] - xusub[jcol],
+		      sizeof(int_t), _compare_);
+		break;
+	    }
+
+	/* Scatter A(:,jcol) into SPA dense[*], indexed as Pr*A */
+	for (k = xa_begin[jcol]; k < xa_end[jcol]; ++k)
+	    dense[perm_r[asub[k]]] = a[k];
+
+	/*
+	 * For each supernodal segment kfnz:krep of U(:,jcol)
+	 */
+	for (k = xusub[jcol]; k < xusub[jcol+1]; k = kend) {
+	    kfnz   = usub[k];
+	    ksupno = supno[kfnz];
+	    for (kend = k + 1; kend < xusub[jcol+1] &&
+		     supno[usub[kend]] == ksupno; ++kend) ;
+	    krep   = usub[kend-1];
+
+	    fsupc  = xsup[ksupno];
+	    lptr   = xlsub[fsupc];
+	    nsupr  = xlsub[fsupc+1] - lptr;
+	    nsupc  = krep - fsupc + 1;
+	    segsze = krep - kfnz + 1;
+	    nrow   = nsupr - nsupc;
+
+	    ops[TRSV] += segsze * (segsze - 1);
+	    ops[GEMV] += 2 * nrow * segsze;
+
+	    /* Dense triangular solve, then block update below the segment */
+	    luptr = xlusup[kfnz] + (kfnz - fsupc);
+	    for (i = 0; i < segsze; ++i) tempv[i] = dense[kfnz + i];
+	    tempv1 = &tempv[segsze];
+#ifdef USE_VENDOR_BLAS
+	    dtrsv_( "L", "N", "U", (int*)&segsze, &lusup[luptr],
+		    (int*)&nsupr, tempv, (int*)&incx );
+	    dgemv_( "N", (int*)&nrow, (int*)&segsze, &alpha,
+		    &lusup[luptr+segsze], (int*)&nsupr, tempv, (int*)&incx,
+		    &beta, tempv1, (int*)&incy );
+#else
+	    dlsolve ( nsupr, segsze, &lusup[luptr], tempv );
+	    dmatvec ( nsupr, nrow, segsze, &lusup[luptr+segsze], tempv, tempv1 );
+#endif
+
+	    for (i = 0; i < segsze; ++i) {
+		dense[kfnz + i] = tempv[i];
+		tempv[i] = 0.0;
+	    }
+	    for (i = 0; i < nrow; ++i) {
+		dense[lsub[lptr + nsupc + i]] -= tempv1[i];
+		tempv1[i] = 0.0;
+	    }
+	}
+
+	/* Gather U(:,jcol) */
+	for (k = xusub[jcol]; k < xusub[jcol+1]; ++k) {
+	    ucol[k] = dense[usub[k]];
+	    dense[usub[k]] = 0.0;
+	}
+
+	/*
+	 * Process the supernodal portion of L\U[*,jcol]
+	 */
+	fsupc = xsup[supno[jcol]];
+	lptr  = xlsub[fsupc];
+	nsupr = xlsub[fsupc+1] - lptr;
+	nsupc = jcol - fsupc;	/* excluding jcol */
+	nrow  = nsupr - nsupc;
+	luptr = xlusup[jcol];
+
+	for (i = 0; i < nsupr; ++i) {
+	    lusup[luptr + i] = dense[lsub[lptr + i]];
+	    dense[lsub[lptr + i]] = 0.0;
+	}
+
+	if ( nsupc > 0 ) {
+	    ops[TRSV] += nsupc * (nsupc - 1);
+	    ops[GEMV] += 2 * nrow * nsupc;
+#ifdef USE_VENDOR_BLAS
+	    alpha = -1.0; beta = 1.0;
+	    dtrsv_( "L", "N", "U", (int*)&nsupc, &lusup[xlusup[fsupc]],
+		    (int*)&nsupr, &lusup[luptr], (int*)&incx );
+	    dgemv_( "N", (int*)&nrow, (int*)&nsupc, &alpha,
+		    &lusup[xlusup[fsupc] + nsupc], (int*)&nsupr,
+		    &lusup[luptr], (int*)&incx, &beta, &lusup[luptr + nsupc],
+		    (int*)&incy );
+	    alpha = 1.0; beta = 0.0;
+#else
+	    dlsolve ( nsupr, nsupc, &lusup[xlusup[fsupc]], &lusup[luptr] );
+	    dmatvec ( nsupr, nrow, nsupc, &lusup[xlusup[fsupc] + nsupc],
+		      &lusup[luptr], tempv );
+	    for (i = 0; i < nrow; ++i) {
+		lusup[luptr + nsupc + i] -= tempv[i];
+		tempv[i] = 0.0;
+	    }
+#endif
+	}
+
+	/* Test the pivot in row jcol, and do the cdiv operation */
+	pivmax = 0.0;
+	for (i = nsupc; i < nsupr; ++i) {
+	    rtemp = fabs(lusup[luptr + i]);
+	    if ( rtemp > pivmax ) pivmax = rtemp;
+	}
+	rtemp = fabs(lusup[luptr + nsupc]);
+	if ( rtemp == 0.0 || rtemp < u * pivmax ) {
+	    info = jcol + 1;
+	    break;
+	}
+
+	ops[FACT] += nsupr - nsupc;
+	temp = 1.0 / lusup[luptr + nsupc];
+	for (i = nsupc + 1; i < nsupr; ++i) lusup[luptr + i] *= temp;
+    }
+
+    SUPERLU_FREE (dense);
+    SUPERLU_FREE (tempv);
+    return info;
+}
@@ -29,6 +29,92 @@ at the top-level directory.
 #include <math.h>
 #include "slu_ddefs.h"
 
+/*! \brief Residuals of the active columns of a panel of right-hand sides.
+ *
+ * <pre>
+ * For each slot j in act[0:nact-1], computes
+ *     Res(:,j) = B(:,j) - op(A)*X(:,j)  and
+ *     Wabs(:,j) = abs(op(A))*abs(X(:,j)) + abs(B(:,j)),
+ * where Res and Wabs have leading dimension A->nrow. A is read once for
+ * all the columns.
+ * </pre>
+ */
+static void
+dgsrfs_resid(int_t notran, SuperMatrix *A, int_t nact, int_t *act,
+	     double *Bmat, int_t ldb, double *Xmat, int_t ldx,
+	     double *Res, double *Wabs)
+{
+    NCformat *Astore = A->Store;
+    double   *Aval = Astore->nzval;
+    int_t    n = A->nrow, i, k, p, irow;
+    size_t   j;  /* a panel may have more than INT_MAX entries */
+    double   a, xk, s, t;
+
+    for (p = 0; p < nact; ++p) {
+	j = act[p];
+	for (i = 0; i < n; ++i) {
+	    Res[i + j*n] = Bmat[i + j*ldb];
+	    Wabs[i + j*n] = fabs( Bmat[i + j*ldb] );
+	}
+    }
+
+    if ( notran ) {
+	for (k = 0; k < A->ncol; ++k) {
+	    for (i = Astore->colptr[k]; i < Astore->colptr[k+1]; ++i) {
+		irow = Astore->rowind[i];
+		a = Aval[i];
+		for (p = 0; p < nact; ++p) {
+		    j = act[p];
+		    xk = Xmat[k + j*ldx];
+		    Res[irow + j*n] -= a * xk;
+		    Wabs[irow + j*n] += fabs(a) * fabs(xk);
+		}
+	    }
+	}
+    } else {  /* trans = TRANS or CONJ */
+	for (p = 0; p < nact; ++p) {
+	    j = act[p];
+	    for (k = 0; k < A->ncol; ++k) {
+		s = 0.;
+		t = 0.;
+		for (i = Astore->colptr[k]; i < Astore->colptr[k+1]; ++i) {
+		    xk = Xmat[Astore->rowind[i] + j*ldx];
+		    s += Aval[i] * xk;
+		    t += fabs(Aval[i]) * fabs(xk);
+		}
+		Res[k + j*n] -= s;
+		Wabs[k + j*n] += t;
+	    }
+	}
+    }
+}
+
+/*! \brief Solve op(A)*Y = V(:,act) in place with one call to DGSTRS.
+ *
+ * <pre>
+ * The columns V(:,act[0:nact-1]) are gathered into tmp, solved together,
+ * and scattered back. V and tmp have leading dimension L->nrow.
+ * </pre>
+ */
+static void
+dgsrfs_solve(trans_t trans, SuperMatrix *L, SuperMatrix *U, int_t *perm_c,
+	     int_t *perm_r, int_t nact, int_t *act, double *V, double *tmp,
+	     SuperLUStat_t *stat, int_t *info)
+{
+    SuperMatrix Y;
+    int_t       n = L->nrow, i, p;
+    size_t      ld = n;
+
+    if ( nact == 0 ) return;
+    for (p = 0; p < nact; ++p)
+	for (i = 0; i < n; ++i) tmp[i + p*ld] = V[i + act[p]*ld];
+    dCreate_Dense_Matrix(&Y, n, nact, tmp, n, SLU_DN, SLU_D, SLU_GE);
+    dgstrs (trans, L, U, perm_c, perm_r, &Y, stat, info);
+    Destroy_SuperMatrix_Store(&Y);
+    for (p = 0; p < nact; ++p)
+	for (i = 0; i < n; ++i) V[i + act[p]*ld] = tmp[i + p*ld];
+}
+
 /*! \brief
  *
  * <pre>
@@ -135,6 +221,8 @@ at the top-level directory.
  *
  *    ITMAX is the maximum number of steps of iterative refinement.   
  *
+ *    NBRHS is the number of right-hand sides that are refined together.
+ *
  * </pre>
  */
 void
@@ -146,41 +234,36 @@ dgsrfs(trans_t trans, SuperMatrix *A, SuperMatrix *L, SuperMatrix *U,
 
 
 #define ITMAX 5
+#define NBRHS 64   /* number of right-hand sides refined together */
     
     /* Table of constant values */
     int_t    ione = 1;
-    double ndone = -1.;
     double done = 1.;
     
     /* Local variables */
     NCformat *Astore;
-    double   *Aval;
-    SuperMatrix Bjcol;
-    DNformat *Bstore, *Xstore, *Bjcol_store;
+    DNformat *Bstore, *Xstore;
     double   *Bmat, *Xmat, *Bptr, *Xptr;
-    int_t      kase;
     double   safe1, safe2;
-    int_t      i, j, k, irow, nz, count, notran, rowequ, colequ;
-    int_t      ldb, ldx, nrhs;
-    double   s, xk, lstres, eps, safmin;
-    char     transc[1];
+    int_t      i, j, k, p, j0, jb, nz, count, notran, rowequ, colequ;
+    int_t      ldb, ldx, nrhs, n, nact, nkeep, n1, n2, c, t;
+    size_t     ldw;       /* leading dimension of work and rwork */
+    double   s, eps, safmin;
     trans_t  transt;
-    double   *work;
-    double   *rwork;
-    int_t      *iwork;
-    int_t      isave[3];
-
-    extern int dlacon2_(int *, double *, double *, int *, double *, int *, int []);
+    double   *work;     /* residuals, then the DLACON2 iterates */
+    double   *rwork;    /* abs(op(A))*abs(X) + abs(B), then the weights */
+    double   *vwork;    /* DLACONB workspace */
+    double   *tmp;      /* right-hand sides passed to dgstrs */
+    double   *lstres;
+    int_t      *iwork, *act, *act1, *act2;
+    int      *isgn, *kase, *isave;
 #ifdef _CRAY
-    extern int SCOPY(int *, double *, int *, double *, int *);
     extern int SSAXPY(int *, double *, double *, int *, double *, int *);
 #else
-    extern int dcopy_(int *, double *, int *, double *, int *);
     extern int daxpy_(int *, double *, double *, int *, double *, int *);
 #endif
 
     Astore = A->Store;
-    Aval   = Astore->nzval;
     Bstore = B->Store;
     Xstore = X->Store;
     Bmat   = Bstore->nzval;
@@ -226,23 +309,29 @@ dgsrfs(trans_t trans, SuperMatrix *A, SuperMatrix *L, SuperMatrix *U,
     rowequ = strncmp(equed, "R", 1)==0 || strncmp(equed, "B", 1)==0;
     colequ = strncmp(equed, "C", 1)==0 || strncmp(equed, "B", 1)==0;
     
-    /* Allocate working space */
-    work = doubleMalloc(2*A->nrow);
-    rwork = (double *) SUPERLU_MALLOC( A->nrow * sizeof(double) );
-    iwork = intMalloc(2*A->nrow);
-    if ( !work || !rwork || !iwork ) 
+    /* Allocate working space for a panel of at most NBRHS columns, with
+       t estimator vectors per column */
+    n = A->nrow;
+    t = SUPERLU_MAX(1, SUPERLU_MIN(sp_ienv(9), n));
+    jb = SUPERLU_MIN(nrhs, NBRHS);
+    ldw = n;
+    work = (double *) SUPERLU_MALLOC( ldw * jb * t * sizeof(double) );
+    rwork = (double *) SUPERLU_MALLOC( ldw * jb * sizeof(double) );
+    vwork = (double *) SUPERLU_MALLOC( ldw * jb * (t + 1) * sizeof(double) );
+    tmp = (double *) SUPERLU_MALLOC( ldw * jb * t * sizeof(double) );
+    lstres = doubleMalloc(jb);
+    iwork = intMalloc(n + jb + 2 * jb * t);
+    isgn = (int *) SUPERLU_MALLOC( (ldw + t) * jb * sizeof(int) );
+    kase = (int *) SUPERLU_MALLOC( 5 * jb * sizeof(int) );
+    if ( !work || !rwork || !vwork || !tmp || !lstres || !iwork ||
+	 !isgn || !kase ) 
         ABORT("Malloc fails for work/rwork/iwork.");
+    act = &iwork[n];
+    act1 = &act[jb];
+    act2 = &act1[jb * t];
+    isave = &kase[jb];
     
-    if ( notran ) {
-	*(unsigned char *)transc = 'N';
-        transt = TRANS;
-    } else if ( trans == TRANS ) {
-	*(unsigned char *)transc = 'T';
-	transt = NOTRANS;
-    } else if ( trans == CONJ ) {
-	*(unsigned char *)transc = 'C';
-	transt = NOTRANS;
-    }    
+    transt = notran ? TRANS : NOTRANS;
 
     /* NZ = maximum number of nonzero elements in each row of A, plus 1 */
     nz     = A->ncol + 1;
@@ -265,36 +354,30 @@ dgsrfs(trans_t trans, SuperMatrix *A, SuperMatrix *L, SuperMatrix *U,
 	    iwork[k] = Astore->colptr[k+1] - Astore->colptr[k];
     }	
 
-    /* Copy one column of RHS B into Bjcol. */
-    Bjcol.Stype = B->Stype;
-    Bjcol.Dtype = B->Dtype;
-    Bjcol.Mtype = B->Mtype;
-    Bjcol.nrow  = B->nrow;
-    Bjcol.ncol  = 1;
-    Bjcol.Store = (void *) SUPERLU_MALLOC( sizeof(DNformat) );
-    if ( !Bjcol.Store ) ABORT("SUPERLU_MALLOC fails for Bjcol.Store");
-    Bjcol_store = Bjcol.Store;
-    Bjcol_store->lda = ldb;
-    Bjcol_store->nzval = work; /* address aliasing */
-	
-    /* Do for each right hand side ... */
-    for (j = 0; j < nrhs; ++j) {
-	count = 0;
-	lstres = 3.;
-	Bptr = &Bmat[j*ldb];
-	Xptr = &Xmat[j*ldx];
-
-	while (1) { /* Loop until stopping criterion is satisfied. */
+    stat->RefineSteps = 0;
+
+    /* Do for each panel of right hand sides ... The columns of a panel
+       are refined together: every sweep computes the residuals of the
+       active columns in one pass over A, and solves for all their
+       corrections with one call to dgstrs. A column leaves the active
+       set once it meets the stopping criterion. */
+    for (j0 = 0; j0 < nrhs; j0 += NBRHS) {
+	jb = SUPERLU_MIN(NBRHS, nrhs - j0);
+	Bptr = &Bmat[(size_t) j0*ldb];
+	Xptr = &Xmat[(size_t) j0*ldx];
+
+	nact = jb;
+	for (j = 0; j < jb; ++j) {
+	    act[j] = j;
+	    lstres[j] = 3.;
+	}
+
+	for (count = 0; nact > 0; ++count) {
 
 	    /* Compute residual R = B - op(A) * X,   
 	       where op(A) = A, A**T, or A**H, depending on TRANS. */
-	    
-#ifdef _CRAY
-	    SCOPY(&A->nrow, Bptr, &ione, work, &ione);
-#else
-	    dcopy_((int*)&A->nrow, Bptr, (int*)&ione, work, (int*)&ione);
-#endif
-	    sp_dgemv(transc, ndone, A, Xptr, ione, done, work, ione);
+	    dgsrfs_resid(notran, A, nact, act, Bptr, ldb, Xptr, ldx,
+			 work, rwork);
 
 	    /* Compute componentwise relative backward error from formula 
 	       max(i) ( abs(R(i)) / ( abs(op(A))*abs(X) + abs(B) )(i) )   
@@ -302,66 +385,53 @@ dgsrfs(trans_t trans, SuperMatrix *A, SuperMatrix *L, SuperMatrix *U,
 	       or vector Z.  If the i-th component of the denominator is less
 	       than SAFE2, then SAFE1 is added to the i-th component of the   
 	       numerator before dividing. */
-
-	    for (i = 0; i < A->nrow; ++i) rwork[i] = fabs( Bptr[i] );
-	    
-	    /* Compute abs(op(A))*abs(X) + abs(B). */
-	    if ( notran ) {
-		for (k = 0; k < A->ncol; ++k) {
-		    xk = fabs( Xptr[k] );
-		    for (i = Astore->colptr[k]; i < Astore->colptr[k+1]; ++i)
-			rwork[Astore->rowind[i]] += fabs(Aval[i]) * xk;
-		}
-	    } else {  /* trans = TRANS or CONJ */
-		for (k = 0; k < A->ncol; ++k) {
-		    s = 0.;
-		    for (i = Astore->colptr[k]; i < Astore->colptr[k+1]; ++i) {
-			irow = Astore->rowind[i];
-			s += fabs(Aval[i]) * fabs(Xptr[irow]);
+	    nkeep = 0;
+	    for (p = 0; p < nact; ++p) {
+		j = act[p];
+		s = 0.;
+		for (i = 0; i < n; ++i) {
+		    if (rwork[i + j*ldw] > safe2) {
+			s = SUPERLU_MAX( s, fabs(work[i + j*ldw]) / rwork[i + j*ldw] );
+		    } else if ( rwork[i + j*ldw] != 0.0 ) {
+			/* Adding SAFE1 to the numerator guards against
+			   spuriously zero residuals (underflow). */
+			s = SUPERLU_MAX( s, (safe1 + fabs(work[i + j*ldw]))
+					 / rwork[i + j*ldw] );
 		    }
-		    rwork[k] += s;
+		    /* If rwork[i] is exactly 0.0, then we know the true 
+		       residual also must be exactly 0.0. */
+		}
+		berr[j0 + j] = s;
+
+		/* Test stopping criterion. Continue iterating if   
+		   1) The residual BERR(J) is larger than machine epsilon, and   
+		   2) BERR(J) decreased by at least a factor of 2 during the   
+		      last iteration, and   
+		   3) At most ITMAX iterations tried. */
+		if ( s > eps && s * 2. <= lstres[j] && count < ITMAX ) {
+		    lstres[j] = s;
+		    act[nkeep++] = j;
 		}
 	    }
-	    s = 0.;
-	    for (i = 0; i < A->nrow; ++i) {
-		if (rwork[i] > safe2) {
-		    s = SUPERLU_MAX( s, fabs(work[i]) / rwork[i] );
-		} else if ( rwork[i] != 0.0 ) {
-                    /* Adding SAFE1 to the numerator guards against
-                       spuriously zero residuals (underflow). */
-		    s = SUPERLU_MAX( s, (safe1 + fabs(work[i])) / rwork[i] );
-                }
-                /* If rwork[i] is exactly 0.0, then we know the true 
-                   residual also must be exactly 0.0. */
-	    }
-	    berr[j] = s;
-
-	    /* Test stopping criterion. Continue iterating if   
-	       1) The residual BERR(J) is larger than machine epsilon, and   
-	       2) BERR(J) decreased by at least a factor of 2 during the   
-	          last iteration, and   
-	       3) At most ITMAX iterations tried. */
-
-	    if (berr[j] > eps && berr[j] * 2. <= lstres && count < ITMAX) {
-		/* Update solution and try again. */
-		dgstrs (trans, L, U, perm_c, perm_r, &Bjcol, stat, info);
-		
+	    nact = nkeep;
+	    if ( nact == 0 ) break;
+
+	    /* Update the solutions of the active columns and try again. */
+	    dgsrfs_solve(trans, L, U, perm_c, perm_r, nact, act, work, tmp,
+			 stat, info);
+	    for (p = 0; p < nact; ++p) {
+		j = act[p];
 #ifdef _CRAY
-		SAXPY(&A->nrow, &done, work, &ione,
-		       &Xmat[j*ldx], &ione);
+		SAXPY(&A->nrow, &done, &work[j*ldw], &ione,
+		       &Xptr[(size_t) j*ldx], &ione);
 #else
-		daxpy_((int*)&A->nrow, &done, work, (int*)&ione,
-		       &Xmat[j*ldx], (int*)&ione);
+		daxpy_((int*)&A->nrow, &done, &work[j*ldw], (int*)&ione,
+		       &Xptr[(size_t) j*ldx], (int*)&ione);
 #endif
-		lstres = berr[j];
-		++count;
-	    } else {
-		break;
 	    }
-        
-	} /* end while */
+	}
 
-	stat->RefineSteps = count;
+	stat->RefineSteps = SUPERLU_MAX(stat->RefineSteps, count);
 
 	/* Bound error from formula:
 	   norm(X - XTRUE) / norm(X) .le. FERR = norm( abs(inv(op(A)))*   
@@ -378,90 +448,102 @@ dgsrfs(trans_t trans, SuperMatrix *A, SuperMatrix *L, SuperMatrix *U,
           is incremented by SAFE1 if the i-th component of   
           abs(op(A))*abs(X) + abs(B) is less than SAFE2.   
 
-          Use DLACON2 to estimate the infinity-norm of the matrix   
+          Use DLACONB to estimate the infinity-norm of the matrix   
              inv(op(A)) * diag(W),   
-          where W = abs(R) + NZ*EPS*( abs(op(A))*abs(X)+abs(B) ))) */
-	
-	for (i = 0; i < A->nrow; ++i) rwork[i] = fabs( Bptr[i] );
-	
-	/* Compute abs(op(A))*abs(X) + abs(B). */
-	if ( notran ) {
-	    for (k = 0; k < A->ncol; ++k) {
-		xk = fabs( Xptr[k] );
-		for (i = Astore->colptr[k]; i < Astore->colptr[k+1]; ++i)
-		    rwork[Astore->rowind[i]] += fabs(Aval[i]) * xk;
-	    }
-	} else {  /* trans == TRANS or CONJ */
-	    for (k = 0; k < A->ncol; ++k) {
-		s = 0.;
-		for (i = Astore->colptr[k]; i < Astore->colptr[k+1]; ++i) {
-		    irow = Astore->rowind[i];
-		    xk = fabs( Xptr[irow] );
-		    s += fabs(Aval[i]) * xk;
+          where W = abs(R) + NZ*EPS*( abs(op(A))*abs(X)+abs(B) ))),
+	  with t = sp_ienv(9) vectors per column. The estimators of the
+	  columns of the panel run in step, so that each round needs at
+	  most one solve with op(A) and one with op(A)**T. Vector c of
+	  column j is work(:,j*t+c). */
+
+	for (j = 0; j < jb; ++j) {
+	    for (i = 0; i < n; ++i)
+		if (rwork[i + j*ldw] > safe2)
+		    rwork[i + j*ldw] = fabs(work[i + j*ldw])
+			+ (iwork[i]+1)*eps*rwork[i + j*ldw];
+		else
+		    rwork[i + j*ldw] = fabs(work[i + j*ldw])
+			+ (iwork[i]+1)*eps*rwork[i + j*ldw] + safe1;
+	    act[j] = j;
+	    kase[j] = 0;
+	}
+	nact = jb;
+
+	while ( nact > 0 ) {
+	    nkeep = n1 = n2 = 0;
+	    for (p = 0; p < nact; ++p) {
+		j = act[p];
+		dlaconb((int) n, (int) t, &work[j*ldw*t], &vwork[j*ldw*(t+1)],
+			&isgn[j*(ldw+t)], &ferr[j0 + j], &kase[j], &isave[4*j]);
+		if (kase[j] == 0) continue;
+		act[nkeep++] = j;
+		for (c = 0; c < t; ++c) {
+		    if (kase[j] == 1) act1[n1++] = j*t + c;
+		    else act2[n2++] = j*t + c;
 		}
-		rwork[k] += s;
 	    }
-	}
-	
-	for (i = 0; i < A->nrow; ++i)
-	    if (rwork[i] > safe2)
-		rwork[i] = fabs(work[i]) + (iwork[i]+1)*eps*rwork[i];
-	    else
-		rwork[i] = fabs(work[i])+(iwork[i]+1)*eps*rwork[i]+safe1;
-
-	kase = 0;
-
-	do {
-	    dlacon2_((int*)&A->nrow, &work[A->nrow], work,
-		    (int*)&iwork[A->nrow], &ferr[j], (int*)&kase, (int*)isave);
-	    if (kase == 0) break;
-
-	    if (kase == 1) {
-		/* Multiply by diag(W)*inv(op(A)**T)*(diag(C) or diag(R)). */
+	    nact = nkeep;
+
+	    /* Multiply by diag(W)*inv(op(A)**T)*(diag(C) or diag(R)). */
+	    for (p = 0; p < n1; ++p) {
+		k = act1[p];
 		if ( notran && colequ )
-		    for (i = 0; i < A->ncol; ++i) work[i] *= C[i];
+		    for (i = 0; i < A->ncol; ++i) work[i + k*ldw] *= C[i];
 		else if ( !notran && rowequ )
-		    for (i = 0; i < A->nrow; ++i) work[i] *= R[i];
-		
-		dgstrs (transt, L, U, perm_c, perm_r, &Bjcol, stat, info);
-		
-		for (i = 0; i < A->nrow; ++i) work[i] *= rwork[i];
-	    } else {
-		/* Multiply by (diag(C) or diag(R))*inv(op(A))*diag(W). */
-		for (i = 0; i < A->nrow; ++i) work[i] *= rwork[i];
-		
-		dgstrs (trans, L, U, perm_c, perm_r, &Bjcol, stat, info);
-		
+		    for (i = 0; i < A->nrow; ++i) work[i + k*ldw] *= R[i];
+	    }
+	    dgsrfs_solve(transt, L, U, perm_c, perm_r, n1, act1, work, tmp,
+			 stat, info);
+	    for (p = 0; p < n1; ++p) {
+		k = act1[p];
+		j = k / t;
+		for (i = 0; i < A->nrow; ++i) work[i + k*ldw] *= rwork[i + j*ldw];
+	    }
+
+	    /* Multiply by (diag(C) or diag(R))*inv(op(A))*diag(W). */
+	    for (p = 0; p < n2; ++p) {
+		k = act2[p];
+		j = k / t;
+		for (i = 0; i < A->nrow; ++i) work[i + k*ldw] *= rwork[i + j*ldw];
+	    }
+	    dgsrfs_solve(trans, L, U, perm_c, perm_r, n2, act2, work, tmp,
+			 stat, info);
+	    for (p = 0; p < n2; ++p) {
+		k = act2[p];
 		if ( notran && colequ )
-		    for (i = 0; i < A->ncol; ++i) work[i] *= C[i];
+		    for (i = 0; i < A->ncol; ++i) work[i + k*ldw] *= C[i];
 		else if ( !notran && rowequ )
-		    for (i = 0; i < A->ncol; ++i) work[i] *= R[i];  
+		    for (i = 0; i < A->ncol; ++i) work[i + k*ldw] *= R[i];  
 	    }
-	    
-	} while ( kase != 0 );
-
+	}
 
 	/* Normalize error. */
-	lstres = 0.;
- 	if ( notran && colequ ) {
-	    for (i = 0; i < A->nrow; ++i)
-	    	lstres = SUPERLU_MAX( lstres, C[i] * fabs( Xptr[i]) );
-  	} else if ( !notran && rowequ ) {
-	    for (i = 0; i < A->nrow; ++i)
-	    	lstres = SUPERLU_MAX( lstres, R[i] * fabs( Xptr[i]) );
-	} else {
-	    for (i = 0; i < A->nrow; ++i)
-	    	lstres = SUPERLU_MAX( lstres, fabs( Xptr[i]) );
+	for (j = 0; j < jb; ++j) {
+	    s = 0.;
+	    if ( notran && colequ ) {
+		for (i = 0; i < A->nrow; ++i)
+		    s = SUPERLU_MAX( s, C[i] * fabs( Xptr[i + (size_t) j*ldx]) );
+	    } else if ( !notran && rowequ ) {
+		for (i = 0; i < A->nrow; ++i)
+		    s = SUPERLU_MAX( s, R[i] * fabs( Xptr[i + (size_t) j*ldx]) );
+	    } else {
+		for (i = 0; i < A->nrow; ++i)
+		    s = SUPERLU_MAX( s, fabs( Xptr[i + (size_t) j*ldx]) );
+	    }
+	    if ( s != 0. )
+		ferr[j0 + j] /= s;
 	}
-	if ( lstres != 0. )
-	    ferr[j] /= lstres;
 
-    } /* for each RHS j ... */
-    
+    } /* for each panel of RHS ... */
+
     SUPERLU_FREE(work);
     SUPERLU_FREE(rwork);
+    SUPERLU_FREE(vwork);
+    SUPERLU_FREE(tmp);
+    SUPERLU_FREE(lstres);
     SUPERLU_FREE(iwork);
-    SUPERLU_FREE(Bjcol.Store);
+    SUPERLU_FREE(isgn);
+    SUPERLU_FREE(kase);
 
     return;
 
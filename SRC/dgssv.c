@@ -195,12 +195,18 @@ dgssv(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
      * Get column permutation vector perm_c[], according to permc_spec:
      *   permc_spec = NATURAL:  natural ordering 
      *   permc_spec = MMD_AT_PLUS_A: minimum degree on structure of A'+A
+     *   permc_spec = AMD_ATA: approximate minimum degree on structure of A'*A
+     *   permc_spec = AMD_AT_PLUS_A: approximate minimum degree on structure of A'+A
      *   permc_spec = MMD_ATA:  minimum degree on structure of A'*A
      *   permc_spec = COLAMD:   approximate minimum degree column ordering
+     *   permc_spec = METIS_AT_PLUS_A: nested dissection on structure of A'+A
      *   permc_spec = MY_PERMC: the ordering already supplied in perm_c[]
+     *   permc_spec = AUTO: the best predicted of several orderings
      */
     permc_spec = options->ColPerm;
-    if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
+    if ( permc_spec == AUTO && options->Fact == DOFACT )
+      get_perm_c_auto(AA, perm_c, stat);
+    else if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
       get_perm_c(permc_spec, AA, perm_c);
     utime[COLPERM] = SuperLU_timer_() - t;
 
@@ -224,7 +230,7 @@ dgssv(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
     t = SuperLU_timer_();
     if ( *info == 0 ) {
         /* Solve the system A*X=B, overwriting B with X. */
-        dgstrs (trans, L, U, perm_c, perm_r, B, stat, info);
+        dpgstrs (options, trans, L, U, perm_c, perm_r, B, stat, info);
     }
     utime[SOLVE] = SuperLU_timer_() - t;
 
@@ -50,6 +50,11 @@ at the top-level directory.
  *      1.2. Permute columns of A, forming A*Pc, where Pc is a permutation
  *           matrix that usually preserves sparsity.
  *           For more details of this step, see sp_preorder.c.
+ *           If options->PermCache = YES, Pc and the column elimination
+ *           tree are taken from perm_cache.c when A's pattern was seen before.
+ *           If options->Presolve = YES, only the core of A left by taking
+ *           out singletons and dense rows and columns is ordered so; see
+ *           get_perm_c_presolve().
  *
  *      1.3. If options->Fact != FACTORED, the LU decomposition is used to
  *           factor the matrix A (after equilibration if options->Equil = YES)
@@ -97,6 +102,11 @@ at the top-level directory.
  *           forming transpose(A)*Pc, where Pc is a permutation matrix that 
  *           usually preserves sparsity.
  *           For more details of this step, see sp_preorder.c.
+ *           If options->PermCache = YES, Pc and the column elimination
+ *           tree are taken from perm_cache.c when A's pattern was seen before.
+ *           If options->Presolve = YES, only the core of A left by taking
+ *           out singletons and dense rows and columns is ordered so; see
+ *           get_perm_c_presolve().
  *
  *      2.3. If options->Fact != FACTORED, the LU decomposition is used to
  *           factor the transpose(A) (after equilibration if 
@@ -248,9 +258,11 @@ at the top-level directory.
  *         = 0:  allocate space internally by system malloc;
  *         > 0:  use user-supplied work array of length lwork in bytes,
  *               returns error if space runs out.
- *         = -1: the routine guesses the amount of space needed without
+ *         = -1: the routine estimates the amount of space needed without
  *               performing the factorization, and returns it in
- *               mem_usage->total_needed; no other side effects.
+ *               mem_usage->total_needed; no other side effects. For
+ *               square A this is a bound from a symbolic factorization
+ *               under the chosen column ordering; see dgstrf().
  *
  *         See argument 'mem_usage' for memory usage statistics.
  *
@@ -374,6 +386,8 @@ dgssvx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
     int_t       i, j, info1;
     double    amax, anorm, bignum, smlnum, colcnd, rowcnd, rcmax, rcmin;
     int_t       relax, panel_size;
+    int_t       cached;  /* perm_c[] and etree[] from the pattern cache */
+    unsigned long long phash = 0; /* hash of the pattern of AA */
     double    t0;      /* temporary time */
     double    *utime;
 
@@ -520,17 +534,41 @@ printf("dgssvx: Fact=%4d, Trans=%4d, equed=%c\n",
 	 * Gnet column permutation vector perm_c[], according to permc_spec:
 	 *   permc_spec = NATURAL:  natural ordering 
 	 *   permc_spec = MMD_AT_PLUS_A: minimum degree on structure of A'+A
+	 *   permc_spec = AMD_ATA: approximate minimum degree on structure of A'*A
+	 *   permc_spec = AMD_AT_PLUS_A: approximate minimum degree on structure of A'+A
 	 *   permc_spec = MMD_ATA:  minimum degree on structure of A'*A
 	 *   permc_spec = COLAMD:   approximate minimum degree column ordering
+	 *   permc_spec = METIS_AT_PLUS_A: nested dissection on structure of A'+A
 	 *   permc_spec = MY_PERMC: the ordering already supplied in perm_c[]
+	 *   permc_spec = AUTO: the best predicted of several orderings
 	 */
 	permc_spec = options->ColPerm;
-	if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
-            get_perm_c(permc_spec, AA, perm_c);
+	cached = 0;
+	if ( permc_spec != MY_PERMC && options->Fact == DOFACT ) {
+	    if ( options->PermCache == YES )
+		cached = perm_cache_lookup(options, AA, &phash, perm_c, etree);
+	    if ( !cached && options->Presolve == YES )
+		get_perm_c_presolve(permc_spec, AA, perm_c, stat);
+	    else if ( !cached && permc_spec == AUTO )
+		get_perm_c_auto(AA, perm_c, stat);
+	    else if ( !cached )
+		get_perm_c(permc_spec, AA, perm_c);
+	}
 	utime[COLPERM] = SuperLU_timer_() - t0;
 
 	t0 = SuperLU_timer_();
-	sp_preorder(options, AA, perm_c, etree, &AC);
+	if ( cached ) {
+	    /* perm_c[] and etree[] are already postordered; only form A*Pc,
+	       as for a SamePattern factorization. */
+	    superlu_options_t options_pc = *options;
+	    options_pc.Fact = SamePattern;
+	    sp_preorder(&options_pc, AA, perm_c, etree, &AC);
+	} else {
+	    sp_preorder(options, AA, perm_c, etree, &AC);
+	    if ( permc_spec != MY_PERMC && options->Fact == DOFACT &&
+		 options->PermCache == YES )
+		perm_cache_store(options, AA, phash, perm_c, etree);
+	}
 	utime[ETREE] = SuperLU_timer_() - t0;
     
 /*	printf("Factor PA = LU ... relax %d\tw %d\tmaxsuper %d\trowblk %d\n", 
@@ -545,6 +583,11 @@ printf("dgssvx: Fact=%4d, Trans=%4d, equed=%c\n",
 	
 	if ( lwork == -1 ) {
 	    mem_usage->total_needed = *info - A->ncol;
+	    Destroy_CompCol_Permuted(&AC);
+	    if ( A->Stype == SLU_NR ) {
+		Destroy_SuperMatrix_Store(AA);
+		SUPERLU_FREE(AA);
+	    }
 	    return;
 	}
     }
@@ -555,6 +598,11 @@ printf("dgssvx: Fact=%4d, Trans=%4d, equed=%c\n",
 	       rank-deficient (*info) columns of A. */
 	    *recip_pivot_growth = dPivotGrowth(*info, AA, perm_c, L, U);
         }
+	if ( nofact ) Destroy_CompCol_Permuted(&AC);
+	if ( A->Stype == SLU_NR ) {
+	    Destroy_SuperMatrix_Store(AA);
+	    SUPERLU_FREE(AA);
+	}
 	return;
     }
 
@@ -598,7 +646,7 @@ printf("dgssvx: Fact=%4d, Trans=%4d, equed=%c\n",
 	        Xmat[i + j*ldx] = Bmat[i + j*ldb];
     
         t0 = SuperLU_timer_();
-        dgstrs (trant, L, U, perm_c, perm_r, X, stat, &info1);
+        dpgstrs (options, trant, L, U, perm_c, perm_r, X, stat, &info1);
         utime[SOLVE] = SuperLU_timer_() - t0;
     
         /* Use iterative refinement to improve the computed solution and compute
@@ -84,12 +84,18 @@ at the top-level directory.
  *
  * lwork   (input) int
  *         Specifies the size of work array in bytes.
- *         = 0:  allocate space internally by system malloc;
+ *         = 0:  allocate space internally by system malloc; with
+ *               options->OutOfCore = YES and square A, the values of
+ *               L and U are kept in a scratch file (see ooc.c);
  *         > 0:  use user-supplied work array of length lwork in bytes,
  *               returns error if space runs out.
- *         = -1: the routine guesses the amount of space needed without
+ *         = -1: the routine estimates the amount of space needed without
  *               performing the factorization, and returns it in
- *               *info; no other side effects.
+ *               *info; no other side effects. For square A, the L\U
+ *               storage is sized by a symbolic factorization
+ *               (sp_symbfact_size()), so the estimate is an upper bound
+ *               for any row pivoting; otherwise it is a guess from
+ *               sp_ienv(6).
  *
  * perm_c   (input) int*, dimension (A->ncol)
  *	    Column permutation vector, which defines the 
@@ -128,6 +134,9 @@ at the top-level directory.
  *		scaling factors R and C, both row and column permutation
  *		vectors perm_r and perm_c, and the L & U data structures
  *		set up from the previous factorization.
+ *              If in addition options->Refactor == YES, the structure of
+ *              L and U is kept and only their values are recomputed by
+ *              dgsrefact(), unless a pivot fails the threshold test.
  *          Otherwise, it is an output.
  *
  * stat     (output) SuperLUStat_t*
@@ -208,37 +217,18 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
     int_t       *iperm_r = NULL; /* inverse of perm_r; used when 
                                   options->Fact == SamePattern_SameRowPerm */
     int_t       *iperm_c; /* inverse of perm_c */
-    int_t       *iwork;
-    double    *dwork;
-    int_t	      *segrep, *repfnz, *parent, *xplore;
-    int_t	      *panel_lsub; /* dense[]/panel_lsub[] pair forms a w-wide SPA */
-    int_t	      *xprune;
-    int_t	      *marker;
-    double    *dense, *tempv;
+    dLUWork_t wk;       /* kernel working arrays */
     int_t       *relax_end;
-    double    *a;
-    int_t       *asub;
-    int_t       *xa_begin, *xa_end;
-    int_t       *xsup, *supno;
-    int_t       *xlsub, *xlusup, *xusub;
-    int_t       nzlumax;
     double fill_ratio = sp_ienv(6);  /* estimated fill ratio */
 
     /* Local scalars */
     fact_t    fact = options->Fact;
-    double    diag_pivot_thresh = options->DiagPivotThresh;
-    int_t       pivrow;   /* pivotal row number in the original matrix A */
-    int_t       nseg1;	/* no of segments in U-column above panel row jcol */
-    int_t       nseg;	/* no of segments in each U-column */
-    register int_t jcol;	
-    register int_t kcol;	/* end column of a relaxed snode */
-    register int_t icol;
-    register int_t i, k, jj, new_next, iinfo;
-    int_t       m, n, min_mn, jsupno, fsupc, nextlu, nextu;
-    int_t       w_def;	/* upper bound on panel width */
+    register int_t i, k;
+    int_t       iinfo;
+    int_t       m, n, min_mn;
     int_t       usepr, iperm_r_allocated = 0;
     int_t       nnzL, nnzU;
-    int_t       *panel_histo = stat->panel_histo;
+    int_t       nzlmax, nzumax, nzlumax;
     flops_t   *ops = stat->ops;
 
     iinfo    = 0;
@@ -246,25 +236,69 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
     n        = A->ncol;
     min_mn   = SUPERLU_MIN(m, n);
     Astore   = A->Store;
-    a        = Astore->nzval;
-    asub     = Astore->rowind;
-    xa_begin = Astore->colbeg;
-    xa_end   = Astore->colend;
-
-    /* Allocate storage common to the factor routines */
-    *info = dLUMemInit(fact, work, lwork, m, n, Astore->nnz,
-                       panel_size, fill_ratio, L, U, Glu, &iwork, &dwork);
-    if ( *info ) return;
-    
-    xsup    = Glu->xsup;
-    supno   = Glu->supno;
-    xlsub   = Glu->xlsub;
-    xlusup  = Glu->xlusup;
-    xusub   = Glu->xusub;
+
+    if ( fact == SamePattern_SameRowPerm && options->Refactor == YES
+	 && lwork != -1 ) {
+	/* Recompute the values on the structure of the previous
+	   factorization; if a pivot is rejected, factor from scratch. */
+	if ( dgsrefact(options, A, perm_r, L, U, stat) == 0 ) {
+	    ops[FACT] += ops[TRSV] + ops[GEMV];
+	    stat->expansions = 0;
+	    *info = 0;
+	    return;
+	}
+    }
+
+    /* Identify relaxed snodes */
+    relax_end = (int_t *) intMalloc(n);
+    /* used as workspace here; relax_snode() reads descendants[n] */
+    iperm_c = (int_t *) intMalloc(n+1);
+    if ( options->SymmetricMode == YES ) {
+        heap_relax_snode(n, etree, relax, iperm_c, relax_end); 
+    } else {
+        relax_snode(n, etree, relax, iperm_c, relax_end); 
+    }
+
+    /* Allocate storage common to the factor routines. The symbolic
+       sizes are also used for lwork = -1, so that it returns a bound
+       and a work[] of that size needs no expansions with SymbolicFact,
+       and for a memory budget, to project the need. The explicit zeros
+       of supernode amalgamation are not in the bound. */
+    Glu->work = options->LUWorkspace;
+    Glu->budget = (lwork == 0) ? options->MemBudget : 0.;
+    Glu->amalg = (options->SymbolicFact == YES) ? 0 : sp_ienv(10);
+    if ( (options->SymbolicFact == YES || lwork == -1 || Glu->budget > 0.)
+	 && fact != SamePattern_SameRowPerm && m == n ) {
+	sp_symbfact_size(n, Astore->colbeg, Astore->colend, Astore->rowind,
+			 etree, relax_end, sp_ienv(3), &nzlmax, &nzumax,
+			 &nzlumax);
+    } else {
+	nzumax = nzlumax = fill_ratio * Astore->nnz;
+	nzlmax = SUPERLU_MAX(1, fill_ratio/4.) * Astore->nnz;
+    }
+    if ( Glu->budget > 0. && fact != SamePattern_SameRowPerm ) {
+	/* Narrower panels need less work space */
+	while ( panel_size > 1 && Glu->budget <
+		dLUStackSize(m, n, panel_size, nzlmax, nzumax, nzlumax) )
+	    panel_size /= 2;
+    }
+    Glu->ooc = NULL;
+    if ( options->OutOfCore == YES && lwork == 0 && m == n )
+	Glu->ooc = ooc_init(A, etree, sizeof(double));
+    *info = dLUMemInitSize(fact, work, lwork, m, n, Astore->nnz,
+			   panel_size, nzlmax, nzumax, nzlumax, L, U, Glu,
+			   &wk.iwork, &wk.dwork);
+    if ( *info ) {
+	ooc_finish(Glu->ooc, NULL, stat);
+	Glu->ooc = NULL;
+	SUPERLU_FREE (relax_end);
+	SUPERLU_FREE (iperm_c);
+	return;
+    }
     
-    SetIWork(m, n, panel_size, iwork, &segrep, &parent, &xplore,
-	     &repfnz, &panel_lsub, &xprune, &marker);
-    dSetRWork(m, panel_size, dwork, &dense, &tempv);
+    SetIWork(m, n, panel_size, wk.iwork, &wk.segrep, &wk.parent, &wk.xplore,
+	     &wk.repfnz, &wk.panel_lsub, &wk.xprune, &wk.marker);
+    dSetRWork(m, panel_size, wk.dwork, &wk.dense, &wk.tempv);
     
     usepr = (fact == SamePattern_SameRowPerm);
     if ( usepr ) {
@@ -273,21 +307,133 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 	for (k = 0; k < m; ++k) iperm_r[perm_r[k]] = k;
 	iperm_r_allocated = 1;
     }
-    iperm_c = (int_t *) intMalloc(n);
     for (k = 0; k < n; ++k) iperm_c[perm_c[k]] = k;
+    
+    ifill (perm_r, m, EMPTY);
+    ifill (wk.marker, m * NO_MARKER, EMPTY);
+    Glu->supno[0] = -1;
+    Glu->xsup[0]  = Glu->xlsub[0] = Glu->xusub[0] = Glu->xlusup[0] = 0;
+
+    /*
+     * Independent subtrees of the etree may be factored by several
+     * threads; the remaining columns are done by dgstrf_cols() below.
+     * The subtrees have private L\U storage outside a memory budget
+     * and outside the out-of-core file.
+     */
+    if ( options->nthreads > 1 && Glu->MemModel == SYSTEM && m >= n
+	 && Glu->budget == 0. && !Glu->ooc )
+	*info = dpgstrf(options, A, panel_size, relax_end, etree, perm_r,
+			iperm_r, iperm_c, &usepr, &wk, Glu, stat, &iinfo);
+    else
+	*info = dgstrf_cols(options, A, 0, min_mn, panel_size, relax_end,
+			    perm_r, iperm_r, iperm_c, &usepr, &wk, Glu,
+			    stat, &iinfo);
+    if ( *info ) {
+	ooc_finish(Glu->ooc, NULL, stat);
+	Glu->ooc = NULL;
+	return;
+    }
 
-    /* Identify relaxed snodes */
-    relax_end = (int_t *) intMalloc(n);
-    if ( options->SymmetricMode == YES ) {
-        heap_relax_snode(n, etree, relax, marker, relax_end); 
+    *info = iinfo;
+    
+    if ( m > n ) {
+	k = 0;
+        for (i = 0; i < m; ++i) 
+            if ( perm_r[i] == EMPTY ) {
+    		perm_r[i] = n + k;
+		++k;
+	    }
+    }
+
+    countnz(min_mn, wk.xprune, &nnzL, &nnzU, Glu);
+    fixupL(min_mn, perm_r, Glu);
+    ooc_finish(Glu->ooc, Glu, stat); /* Write out the rest of L\U */
+    Glu->ooc = NULL;
+
+    dLUWorkFree(wk.iwork, wk.dwork, Glu); /* Free work space and compress storage */
+
+    if ( fact == SamePattern_SameRowPerm ) {
+        /* L and U structures may have changed due to possibly different
+	   pivoting, even though the storage is available.
+	   There could also be memory expansions, so the array locations
+           may have changed, */
+        ((SCformat *)L->Store)->nnz = nnzL;
+	((SCformat *)L->Store)->nsuper = Glu->supno[n];
+	((SCformat *)L->Store)->nzval = (double *) Glu->lusup;
+	((SCformat *)L->Store)->nzval_colptr = Glu->xlusup;
+	((SCformat *)L->Store)->rowind = Glu->lsub;
+	((SCformat *)L->Store)->rowind_colptr = Glu->xlsub;
+	((NCformat *)U->Store)->nnz = nnzU;
+	((NCformat *)U->Store)->nzval = (double *) Glu->ucol;
+	((NCformat *)U->Store)->rowind = Glu->usub;
+	((NCformat *)U->Store)->colptr = Glu->xusub;
     } else {
-        relax_snode(n, etree, relax, marker, relax_end); 
+        dCreate_SuperNode_Matrix(L, A->nrow, min_mn, nnzL, 
+	      (double *) Glu->lusup, Glu->xlusup, 
+              Glu->lsub, Glu->xlsub, Glu->supno, Glu->xsup,
+              SLU_SC, SLU_D, SLU_TRLU);
+    	dCreate_CompCol_Matrix(U, min_mn, min_mn, nnzU, 
+	      (double *) Glu->ucol, Glu->usub, Glu->xusub,
+              SLU_NC, SLU_D, SLU_TRU);
     }
     
-    ifill (perm_r, m, EMPTY);
-    ifill (marker, m * NO_MARKER, EMPTY);
-    supno[0] = -1;
-    xsup[0]  = xlsub[0] = xusub[0] = xlusup[0] = 0;
+    ops[FACT] += ops[TRSV] + ops[GEMV];	
+    stat->expansions = --(Glu->num_expansions);
+    
+    if ( iperm_r_allocated ) SUPERLU_FREE (iperm_r);
+    SUPERLU_FREE (iperm_c);
+    SUPERLU_FREE (relax_end);
+
+}
+
+
+/*! \brief Factor the columns jstart, ..., jend-1 of A.
+ *
+ * <pre>
+ * The columns are processed one "panel" at a time, as in dgstrf(). On
+ * entry, columns 0, ..., jstart-1 that are needed to update the range
+ * have been factored into Glu, and supno[jstart], xsup, xlsub[jstart],
+ * xlusup[jstart] and xusub[jstart] point past them. Panels are cut at
+ * jend, so a relaxed supernode must not straddle it.
+ *
+ * The index of the first zero pivot encountered is recorded in *iinfo
+ * if *iinfo is still 0. The return value is nonzero only on a memory
+ * allocation failure, as for the info argument of dgstrf().
+ * </pre>
+ */
+int_t
+dgstrf_cols(superlu_options_t *options, SuperMatrix *A,
+	    int_t jstart, int_t jend, int_t panel_size, int_t *relax_end,
+	    int_t *perm_r, int_t *iperm_r, int_t *iperm_c, int_t *usepr,
+	    dLUWork_t *wk, GlobalLU_t *Glu, SuperLUStat_t *stat, int_t *iinfo)
+{
+    NCPformat *Astore = A->Store;
+    double    *a = Astore->nzval;
+    int_t       *asub = Astore->rowind;
+    int_t       *xa_begin = Astore->colbeg;
+    int_t       *xa_end = Astore->colend;
+    int_t	      *segrep = wk->segrep, *repfnz = wk->repfnz;
+    int_t	      *parent = wk->parent, *xplore = wk->xplore;
+    int_t	      *panel_lsub = wk->panel_lsub; /* dense[]/panel_lsub[] pair forms a w-wide SPA */
+    int_t	      *xprune = wk->xprune;
+    int_t	      *marker = wk->marker;
+    double    *dense = wk->dense, *tempv = wk->tempv;
+    int_t       *xsup = Glu->xsup, *supno = Glu->supno;
+    int_t       *xlsub = Glu->xlsub, *xlusup = Glu->xlusup, *xusub = Glu->xusub;
+    int_t       nzlumax;
+    double    diag_pivot_thresh = options->DiagPivotThresh;
+    int_t       pivrow;   /* pivotal row number in the original matrix A */
+    int_t       nseg1;	/* no of segments in U-column above panel row jcol */
+    int_t       nseg;	/* no of segments in each U-column */
+    register int_t jcol;	
+    register int_t kcol;	/* end column of a relaxed snode */
+    register int_t icol;
+    register int_t k, jj, new_next, info;
+    int_t       m, jsupno, fsupc, nextlu, nextu;
+    int_t       w_def;	/* upper bound on panel width */
+    int_t       *panel_histo = stat->panel_histo;
+
+    m        = A->nrow;
     w_def    = panel_size;
 
     /* 
@@ -295,7 +441,7 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
      *	   (a) a relaxed supernode at the bottom of the etree, or
      *	   (b) panel_size contiguous columns, defined by the user
      */
-    for (jcol = 0; jcol < min_mn; ) {
+    for (jcol = jstart; jcol < jend; ) {
 
 	if ( relax_end[jcol] != EMPTY ) { /* start of a relaxed snode */
    	    kcol = relax_end[jcol];	  /* end of the relaxed snode */
@@ -305,9 +451,9 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 	     * Factorize the relaxed supernode(jcol:kcol) 
 	     * -------------------------------------- */
 	    /* Determine the union of the row structure of the snode */
-	    if ( (*info = dsnode_dfs(jcol, kcol, asub, xa_begin, xa_end,
+	    if ( (info = dsnode_dfs(jcol, kcol, asub, xa_begin, xa_end,
 				    xprune, marker, Glu)) != 0 )
-		return;
+		return info;
 
             nextu    = xusub[jcol];
 	    nextlu   = xlusup[jcol];
@@ -316,8 +462,8 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 	    new_next = nextlu + (xlsub[fsupc+1]-xlsub[fsupc])*(kcol-jcol+1);
 	    nzlumax = Glu->nzlumax;
 	    while ( new_next > nzlumax ) {
-		if ( (*info = dLUMemXpand(jcol, nextlu, LUSUP, &nzlumax, Glu)) )
-		    return;
+		if ( (info = dLUMemXpand(jcol, nextlu, LUSUP, &nzlumax, Glu)) )
+		    return info;
 	    }
     
 	    for (icol = jcol; icol<= kcol; icol++) {
@@ -330,9 +476,9 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 	       	/* Numeric update within the snode */
 	        dsnode_bmod(icol, jsupno, fsupc, dense, tempv, Glu, stat);
 
-		if ( (*info = dpivotL(icol, diag_pivot_thresh, &usepr, perm_r,
-				      iperm_r, iperm_c, &pivrow, Glu, stat)) )
-		    if ( iinfo == 0 ) iinfo = *info;
+		if ( (info = dpivotL(icol, diag_pivot_thresh, usepr, perm_r,
+				     iperm_r, iperm_c, &pivrow, Glu, stat)) )
+		    if ( *iinfo == 0 ) *iinfo = info;
 		
 #ifdef DEBUG
 		dprint_lu_col("[1]: ", icol, pivrow, xprune, Glu);
@@ -348,12 +494,12 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 	     * relaxed snode.
 	     */
 	    panel_size = w_def;
-	    for (k = jcol + 1; k < SUPERLU_MIN(jcol+panel_size, min_mn); k++) 
+	    for (k = jcol + 1; k < SUPERLU_MIN(jcol+panel_size, jend); k++) 
 		if ( relax_end[k] != EMPTY ) {
 		    panel_size = k - jcol;
 		    break;
 		}
-	    if ( k == min_mn ) panel_size = min_mn - jcol;
+	    if ( k == jend ) panel_size = jend - jcol;
 	    panel_histo[panel_size]++;
 
 	    /* symbolic factor on a panel of columns */
@@ -371,23 +517,23 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 
 		nseg = nseg1;	/* Begin after all the panel segments */
 
-	    	if ((*info = dcolumn_dfs(m, jj, perm_r, &nseg, &panel_lsub[k],
+	    	if ((info = dcolumn_dfs(m, jj, perm_r, &nseg, &panel_lsub[k],
 					segrep, &repfnz[k], xprune, marker,
-					parent, xplore, Glu)) != 0) return;
+					parent, xplore, Glu)) != 0) return info;
 
 	      	/* Numeric updates */
-	    	if ((*info = dcolumn_bmod(jj, (nseg - nseg1), &dense[k],
+	    	if ((info = dcolumn_bmod(jj, (nseg - nseg1), &dense[k],
 					 tempv, &segrep[nseg1], &repfnz[k],
-					 jcol, Glu, stat)) != 0) return;
+					 jcol, Glu, stat)) != 0) return info;
 		
 	        /* Copy the U-segments to ucol[*] */
-		if ((*info = dcopy_to_ucol(jj, nseg, segrep, &repfnz[k],
+		if ((info = dcopy_to_ucol(jj, nseg, segrep, &repfnz[k],
 					  perm_r, &dense[k], Glu)) != 0)
-		    return;
+		    return info;
 
-	    	if ( (*info = dpivotL(jj, diag_pivot_thresh, &usepr, perm_r,
-				      iperm_r, iperm_c, &pivrow, Glu, stat)) )
-		    if ( iinfo == 0 ) iinfo = *info;
+	    	if ( (info = dpivotL(jj, diag_pivot_thresh, usepr, perm_r,
+				     iperm_r, iperm_c, &pivrow, Glu, stat)) )
+		    if ( *iinfo == 0 ) *iinfo = info;
 
 		/* Prune columns (0:jj-1) using column jj */
 	    	dpruneL(jj, perm_r, pivrow, nseg, segrep,
@@ -406,54 +552,10 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 
 	} /* else */
 
-    } /* for */
-
-    *info = iinfo;
-    
-    if ( m > n ) {
-	k = 0;
-        for (i = 0; i < m; ++i) 
-            if ( perm_r[i] == EMPTY ) {
-    		perm_r[i] = n + k;
-		++k;
-	    }
-    }
+	/* Write out the parts of L\U that the rest does not use */
+	if ( Glu->ooc ) ooc_retire(Glu->ooc, jcol, Glu, stat);
 
-    countnz(min_mn, xprune, &nnzL, &nnzU, Glu);
-    fixupL(min_mn, perm_r, Glu);
-
-    dLUWorkFree(iwork, dwork, Glu); /* Free work space and compress storage */
-
-    if ( fact == SamePattern_SameRowPerm ) {
-        /* L and U structures may have changed due to possibly different
-	   pivoting, even though the storage is available.
-	   There could also be memory expansions, so the array locations
-           may have changed, */
-        ((SCformat *)L->Store)->nnz = nnzL;
-	((SCformat *)L->Store)->nsuper = Glu->supno[n];
-	((SCformat *)L->Store)->nzval = (double *) Glu->lusup;
-	((SCformat *)L->Store)->nzval_colptr = Glu->xlusup;
-	((SCformat *)L->Store)->rowind = Glu->lsub;
-	((SCformat *)L->Store)->rowind_colptr = Glu->xlsub;
-	((NCformat *)U->Store)->nnz = nnzU;
-	((NCformat *)U->Store)->nzval = (double *) Glu->ucol;
-	((NCformat *)U->Store)->rowind = Glu->usub;
-	((NCformat *)U->Store)->colptr = Glu->xusub;
-    } else {
-        dCreate_SuperNode_Matrix(L, A->nrow, min_mn, nnzL, 
-	      (double *) Glu->lusup, Glu->xlusup, 
-              Glu->lsub, Glu->xlsub, Glu->supno, Glu->xsup,
-              SLU_SC, SLU_D, SLU_TRLU);
-    	dCreate_CompCol_Matrix(U, min_mn, min_mn, nnzU, 
-	      (double *) Glu->ucol, Glu->usub, Glu->xusub,
-              SLU_NC, SLU_D, SLU_TRU);
-    }
-    
-    ops[FACT] += ops[TRSV] + ops[GEMV];	
-    stat->expansions = --(Glu->num_expansions);
-    
-    if ( iperm_r_allocated ) SUPERLU_FREE (iperm_r);
-    SUPERLU_FREE (iperm_c);
-    SUPERLU_FREE (relax_end);
+    } /* for */
 
+    return 0;
 }
@@ -33,6 +33,10 @@ at the top-level directory.
 
 #include "slu_ddefs.h"
 
+/* Byte offsets of column j in the values of L and U, for ooc_stream() */
+#define LBYTES(j)  ( (size_t) L_NZ_START(j) * sizeof(double) )
+#define UBYTES(j)  ( (size_t) U_NZ_START(j) * sizeof(double) )
+
 
 /*! \brief
  *
@@ -99,10 +103,9 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
     _fcd ftcs1, ftcs2, ftcs3, ftcs4;
 #endif
     int_t      incx = 1, incy = 1;
-#ifdef USE_VENDOR_BLAS
-    double   alpha = 1.0, beta = 1.0;
+    double   alpha = 1.0, beta = 1.0, mone = -1.0;
+    double   temp;
     double   *work_col;
-#endif
     DNformat *Bstore;
     double   *Bmat;
     SCformat *Lstore;
@@ -112,6 +115,7 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
     int_t      i, j, k, iptr, jcol, n, ldb, nrhs;
     double   *work, *rhs_work, *soln;
     flops_t  solve_ops;
+    ooc_stream_t Ls, Us;  /* read ahead of out-of-core factors */
     void dprint_soln();
 
     /* Test input parameters ... */
@@ -157,12 +161,14 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 	}
 	
 	/* Forward solve PLy=Pb. */
+	ooc_stream_init(&Ls, Lval, LBYTES(n), 0);
 	for (k = 0; k <= Lstore->nsuper; k++) {
 	    fsupc = L_FST_SUPC(k);
 	    istart = L_SUB_START(fsupc);
 	    nsupr = L_SUB_START(fsupc+1) - istart;
 	    nsupc = L_FST_SUPC(k+1) - fsupc;
 	    nrow = nsupr - nsupc;
+	    ooc_stream(&Ls, LBYTES(fsupc), stat);
 
 	    solve_ops += nsupc * (nsupc - 1) * nrhs;
 	    solve_ops += 2 * nrow * nsupc * nrhs;
@@ -179,7 +185,6 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 		}
 	    } else {
 	    	luptr = L_NZ_START(fsupc);
-#ifdef USE_VENDOR_BLAS
 #ifdef _CRAY
 		ftcs1 = _cptofcd("L", strlen("L"));
 		ftcs2 = _cptofcd("N", strlen("N"));
@@ -209,22 +214,6 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 			iptr++;
 		    }
 		}
-#else		
-		for (j = 0; j < nrhs; j++) {
-		    rhs_work = &Bmat[(size_t)j * (size_t)ldb];
-		    dlsolve (nsupr, nsupc, &Lval[luptr], &rhs_work[fsupc]);
-		    dmatvec (nsupr, nrow, nsupc, &Lval[luptr+nsupc],
-			    &rhs_work[fsupc], &work[0] );
-
-		    iptr = istart + nsupc;
-		    for (i = 0; i < nrow; i++) {
-			irow = L_SUB(iptr);
-			rhs_work[irow] -= work[i];
-			work[i] = 0.0;
-			iptr++;
-		    }
-		}
-#endif		    
 	    } /* else ... */
 	} /* for L-solve */
 
@@ -236,12 +225,16 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 	/*
 	 * Back solve Ux=y.
 	 */
+	ooc_stream_init(&Ls, Lval, LBYTES(n), 1);
+	ooc_stream_init(&Us, Uval, UBYTES(n), 1);
 	for (k = Lstore->nsuper; k >= 0; k--) {
 	    fsupc = L_FST_SUPC(k);
 	    istart = L_SUB_START(fsupc);
 	    nsupr = L_SUB_START(fsupc+1) - istart;
 	    nsupc = L_FST_SUPC(k+1) - fsupc;
 	    luptr = L_NZ_START(fsupc);
+	    ooc_stream(&Ls, LBYTES(fsupc), stat);
+	    ooc_stream(&Us, UBYTES(fsupc), stat);
 
 	    solve_ops += nsupc * (nsupc + 1) * nrhs;
 
@@ -252,7 +245,6 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 		    rhs_work += ldb;
 		}
 	    } else {
-#ifdef USE_VENDOR_BLAS
 #ifdef _CRAY
 		ftcs1 = _cptofcd("L", strlen("L"));
 		ftcs2 = _cptofcd("U", strlen("U"));
@@ -263,10 +255,6 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 		dtrsm_("L", "U", "N", "N", (int*)&nsupc, (int*)&nrhs, &alpha,
 		       &Lval[luptr], (int*)&nsupr, &Bmat[fsupc], (int*)&ldb);
 #endif
-#else		
-		for (j = 0; j < nrhs; j++)
-		    dusolve ( nsupr, nsupc, &Lval[luptr], &Bmat[(size_t)fsupc + (size_t)j * (size_t)ldb] );
-#endif		
 	    }
 
 	    for (j = 0; j < nrhs; ++j) {
@@ -304,16 +292,117 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 	    for (k = 0; k < n; k++) rhs_work[k] = soln[k];
 	}
 
-	stat->ops[SOLVE] = 0;
-	for (k = 0; k < nrhs; ++k) {
-	    
-	    /* Multiply by inv(U'). */
-	    sp_dtrsv("U", "T", "N", L, U, &Bmat[(size_t)k * (size_t)ldb], stat, (int*)info);
-	    
-	    /* Multiply by inv(L'). */
-	    sp_dtrsv("L", "T", "U", L, U, &Bmat[(size_t)k * (size_t)ldb], stat, (int*)info);
-	    
-	}
+	/*
+	 * Forward solve U'y=b, one supernode at a time for all columns
+	 * of B. The rows of U above the diagonal block are applied as
+	 * dot products with the solved part of y.
+	 */
+	ooc_stream_init(&Ls, Lval, LBYTES(n), 0);
+	ooc_stream_init(&Us, Uval, UBYTES(n), 0);
+	for (k = 0; k <= Lstore->nsuper; k++) {
+	    fsupc = L_FST_SUPC(k);
+	    istart = L_SUB_START(fsupc);
+	    nsupr = L_SUB_START(fsupc+1) - istart;
+	    nsupc = L_FST_SUPC(k+1) - fsupc;
+	    luptr = L_NZ_START(fsupc);
+	    ooc_stream(&Ls, LBYTES(fsupc), stat);
+	    ooc_stream(&Us, UBYTES(fsupc), stat);
+
+	    solve_ops += nsupc * (nsupc + 1) * nrhs;
+
+	    for (j = 0; j < nrhs; ++j) {
+		rhs_work = &Bmat[(size_t)j * (size_t)ldb];
+		for (jcol = fsupc; jcol < fsupc + nsupc; jcol++) {
+		    solve_ops += 2*(U_NZ_START(jcol+1) - U_NZ_START(jcol));
+		    temp = 0.0;
+		    for (i = U_NZ_START(jcol); i < U_NZ_START(jcol+1); i++ )
+			temp += rhs_work[U_SUB(i)] * Uval[i];
+		    rhs_work[jcol] -= temp;
+		}
+	    }
+
+	    if ( nsupc == 1 ) {
+		rhs_work = &Bmat[0];
+		for (j = 0; j < nrhs; j++) {
+		    rhs_work[fsupc] /= Lval[luptr];
+		    rhs_work += ldb;
+		}
+	    } else {
+#ifdef _CRAY
+		ftcs1 = _cptofcd("L", strlen("L"));
+		ftcs2 = _cptofcd("U", strlen("U"));
+		ftcs3 = _cptofcd("T", strlen("T"));
+		ftcs4 = _cptofcd("N", strlen("N"));
+		STRSM( ftcs1, ftcs2, ftcs3, ftcs4, &nsupc, &nrhs, &alpha,
+		       &Lval[luptr], &nsupr, &Bmat[fsupc], &ldb);
+#else
+		dtrsm_("L", "U", "T", "N", (int*)&nsupc, (int*)&nrhs, &alpha,
+		       &Lval[luptr], (int*)&nsupr, &Bmat[fsupc], (int*)&ldb);
+#endif
+	    }
+	} /* for U'-solve */
+
+	/*
+	 * Back solve L'x=y. The solved rows below the diagonal block are
+	 * gathered into work[] and applied with one GEMM per supernode.
+	 */
+	ooc_stream_init(&Ls, Lval, LBYTES(n), 1);
+	for (k = Lstore->nsuper; k >= 0; k--) {
+	    fsupc = L_FST_SUPC(k);
+	    istart = L_SUB_START(fsupc);
+	    nsupr = L_SUB_START(fsupc+1) - istart;
+	    nsupc = L_FST_SUPC(k+1) - fsupc;
+	    nrow = nsupr - nsupc;
+	    luptr = L_NZ_START(fsupc);
+	    ooc_stream(&Ls, LBYTES(fsupc), stat);
+
+	    solve_ops += nsupc * (nsupc - 1) * nrhs;
+	    solve_ops += 2 * nrow * nsupc * nrhs;
+
+	    if ( nsupc == 1 ) {
+		for (j = 0; j < nrhs; j++) {
+		    rhs_work = &Bmat[(size_t)j * (size_t)ldb];
+		    temp = 0.0;
+		    for (iptr = istart+1, i = luptr+1;
+			 iptr < L_SUB_START(fsupc+1); iptr++, i++)
+			temp += rhs_work[L_SUB(iptr)] * Lval[i];
+		    rhs_work[fsupc] -= temp;
+		}
+	    } else {
+		if ( nrow > 0 ) {
+		    for (j = 0; j < nrhs; j++) {
+			rhs_work = &Bmat[(size_t)j * (size_t)ldb];
+			work_col = &work[(size_t)j * (size_t)n];
+			iptr = istart + nsupc;
+			for (i = 0; i < nrow; i++, iptr++)
+			    work_col[i] = rhs_work[L_SUB(iptr)]; /* Gather */
+		    }
+#ifdef _CRAY
+		    ftcs1 = _cptofcd("T", strlen("T"));
+		    ftcs2 = _cptofcd("N", strlen("N"));
+		    SGEMM( ftcs1, ftcs2, &nsupc, &nrhs, &nrow, &mone,
+			   &Lval[luptr+nsupc], &nsupr, &work[0], &n,
+			   &alpha, &Bmat[fsupc], &ldb );
+#else
+		    dgemm_( "T", "N", (int*)&nsupc, (int*)&nrhs, (int*)&nrow,
+			    &mone, &Lval[luptr+nsupc], (int*)&nsupr,
+			    &work[0], (int*)&n, &alpha, &Bmat[fsupc],
+			    (int*)&ldb );
+#endif
+		}
+#ifdef _CRAY
+		ftcs1 = _cptofcd("L", strlen("L"));
+		ftcs2 = _cptofcd("T", strlen("T"));
+		ftcs3 = _cptofcd("U", strlen("U"));
+		STRSM( ftcs1, ftcs1, ftcs2, ftcs3, &nsupc, &nrhs, &alpha,
+		       &Lval[luptr], &nsupr, &Bmat[fsupc], &ldb);
+#else
+		dtrsm_("L", "L", "T", "U", (int*)&nsupc, (int*)&nrhs, &alpha,
+		       &Lval[luptr], (int*)&nsupr, &Bmat[fsupc], (int*)&ldb);
+#endif
+	    }
+	} /* for L'-solve */
+
 	/* Compute the final solution X := Pr'*X (=inv(Pr)*X) */
 	for (i = 0; i < nrhs; i++) {
 	    rhs_work = &Bmat[(size_t)i * (size_t)ldb];
@@ -321,6 +410,7 @@ dgstrs (trans_t trans, SuperMatrix *L, SuperMatrix *U,
 	    for (k = 0; k < n; k++) rhs_work[k] = soln[k];
 	}
 
+        stat->ops[SOLVE] = solve_ops;
     }
 
     SUPERLU_FREE(work);
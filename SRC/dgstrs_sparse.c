@@ -0,0 +1,361 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dgstrs_sparse.c
+ * \brief Solves a system with a sparse right-hand side using LU factorization
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "slu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   DSP_REACH finds the supernodes reachable from a set of seed supernodes
+ *   in the supernodal graph of L (upper = 0) or U (upper = 1), by the same
+ *   nonrecursive depth-first search as DCOLUMN_DFS.
+ *
+ *   In the graph of L, supernode k has an edge to the supernode of every
+ *   row subscript below its diagonal block; in the graph of U, to the
+ *   supernode of every row subscript of U(:,fsupc:lsupc). A supernode can
+ *   only be solved after all the supernodes with an edge to it.
+ *
+ * Return value
+ * ============
+ *   top: the supernodes newly reached are prepended to topo[top0:nsuper],
+ *   so that topo[top:nsuper] is in topological order. They are marked in
+ *   marker[], which must be zero for all the unreached supernodes.
+ *
+ *   parent: supernode --> supernode that it was reached from
+ *   xplore: supernode --> next edge to explore
+ * </pre>
+ */
+static int_t
+dsp_reach(int upper, SCformat *Lstore, NCformat *Ustore, int_t nseed,
+	  int_t *seed, int_t *marker, int_t *parent, int_t *xplore,
+	  int_t *topo, int_t top0)
+{
+    int_t  *supno = Lstore->col_to_sup;
+    int_t  *adj = upper ? Ustore->rowind : Lstore->rowind;
+    int_t  top = top0;
+    int_t  i, k, kchild, fsupc, xdfs, maxdfs;
+
+#define SUP_EDGE_START(s) ( fsupc = L_FST_SUPC(s), upper ? U_NZ_START(fsupc) \
+	: L_SUB_START(fsupc) + L_FST_SUPC((s)+1) - fsupc )
+#define SUP_EDGE_END(s) ( upper ? U_NZ_START(L_FST_SUPC((s)+1)) \
+	: L_SUB_START(L_FST_SUPC(s)+1) )
+
+    for (i = 0; i < nseed; ++i) {
+	k = seed[i];
+	if ( marker[k] ) continue;
+
+	/* Start a dfs at supernode k */
+	marker[k] = 1;
+	parent[k] = EMPTY;
+	xplore[k] = SUP_EDGE_START(k);
+
+	while ( k != EMPTY ) {
+	    maxdfs = SUP_EDGE_END(k);
+	    for (xdfs = xplore[k]; xdfs < maxdfs; ++xdfs) {
+		kchild = supno[adj[xdfs]];
+		if ( !marker[kchild] ) break;
+	    }
+
+	    if ( xdfs < maxdfs ) {
+		/* Go down to an unvisited child */
+		xplore[k] = xdfs + 1;
+		marker[kchild] = 1;
+		parent[kchild] = k;
+		xplore[kchild] = SUP_EDGE_START(kchild);
+		k = kchild;
+	    } else {
+		/* All children explored: place k and go back up */
+		topo[--top] = k;
+		k = parent[k];
+	    }
+	}
+    }
+
+#undef SUP_EDGE_START
+#undef SUP_EDGE_END
+
+    return top;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DGSTRS_SPARSE_INIT sets up the work arrays of DGSTRS_SPARSE for the
+ * factors L and the column permutation perm_c from DGSTRF. This is the
+ * O(n) part of the solve; the same ws can then be passed to any number of
+ * calls to DGSTRS_SPARSE with these factors, and is released by
+ * DGSTRS_SPARSE_FREE.
+ * </pre>
+ */
+void
+dgstrs_sparse_init(SuperMatrix *L, int_t *perm_c, dSpSolve_t *ws)
+{
+    SCformat *Lstore = L->Store;
+    int_t    n = L->nrow, nsuper = Lstore->nsuper, k;
+
+    ws->n       = n;
+    ws->nsuper  = nsuper;
+    ws->iperm_c = intMalloc(n);
+    ws->z       = doubleCalloc(n);
+    ws->work    = doubleMalloc(n);
+    ws->marker  = intCalloc(nsuper + 1);
+    ws->parent  = intMalloc(nsuper + 1);
+    ws->xplore  = intMalloc(nsuper + 1);
+    ws->topoL   = intMalloc(nsuper + 1);
+    ws->topoU   = intMalloc(nsuper + 1);
+    if ( !ws->iperm_c || !ws->z || !ws->work || !ws->marker ||
+	 !ws->parent || !ws->xplore || !ws->topoL || !ws->topoU )
+	ABORT("Malloc fails for dgstrs_sparse work arrays.");
+
+    for (k = 0; k < n; ++k) ws->iperm_c[perm_c[k]] = k;
+}
+
+/*! \brief Release the work arrays set up by dgstrs_sparse_init(). */
+void
+dgstrs_sparse_free(dSpSolve_t *ws)
+{
+    SUPERLU_FREE(ws->iperm_c);
+    SUPERLU_FREE(ws->z);
+    SUPERLU_FREE(ws->work);
+    SUPERLU_FREE(ws->marker);
+    SUPERLU_FREE(ws->parent);
+    SUPERLU_FREE(ws->xplore);
+    SUPERLU_FREE(ws->topoL);
+    SUPERLU_FREE(ws->topoU);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DGSTRS_SPARSE solves a system of linear equations A*x=b with a sparse
+ * right-hand side b, using the LU factorization computed by DGSTRF.
+ *
+ * The nonzeros of b determine the supernodes of L that the forward solve
+ * reaches, and those determine the supernodes of U that the back solve
+ * reaches (Gilbert and Peierls). Only these supernodes are visited, so the
+ * cost is proportional to nzb plus the part of L and U that contributes
+ * to x. The work arrays, including the inverse of perm_c, come from
+ * DGSTRS_SPARSE_INIT and are left ready for the next call.
+ *
+ * Arguments
+ * =========
+ *
+ * L, U, perm_r
+ *         The factors and row permutation from DGSTRF, as for DGSTRS.
+ *
+ * ws      (input/output) dSpSolve_t*
+ *         The work arrays set up by dgstrs_sparse_init() for L and the
+ *         column permutation perm_c from DGSTRF.
+ *
+ * nzb     (input) int_t
+ *         The number of nonzeros of b.
+ *
+ * bind    (input) int_t*, dimension (nzb)
+ *         The row indices of the nonzeros of b. Repeated indices are
+ *         summed.
+ *
+ * bval    (input) double*, dimension (nzb)
+ *         The values of the nonzeros of b.
+ *
+ * x       (output) double*, dimension (L->nrow)
+ *         The solution. Must be zero on entry; only the entries listed
+ *         in xind[] are written.
+ *
+ * nzx     (output) int_t*
+ *         The number of entries of x that were written.
+ *
+ * xind    (output) int_t*, dimension (L->nrow)
+ *         If not NULL, the indices of the entries of x that were written,
+ *         which contain all the nonzeros of x.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         Record the floating-point operation count in ops[SOLVE].
+ *
+ * info    (output) int_t*
+ * 	   = 0: successful exit
+ *	   < 0: if info = -i, the i-th argument had an illegal value
+ * </pre>
+ */
+void
+dgstrs_sparse(SuperMatrix *L, SuperMatrix *U, int_t *perm_r, dSpSolve_t *ws,
+	      int_t nzb, int_t *bind, double *bval, double *x, int_t *nzx,
+	      int_t *xind, SuperLUStat_t *stat, int_t *info)
+{
+    SCformat *Lstore;
+    NCformat *Ustore;
+    double   *Lval, *Uval;
+    double   *z, *work;
+    double   alpha = 1.0, beta = 0.0, ukj;
+    int_t    *supno, *iperm_c, *marker, *parent, *xplore;
+    int_t    *topoL, *topoU;
+    int_t    incx = 1, n, nsuper, topL, topU, s;
+    int_t    fsupc, istart, nsupr, nsupc, nrow, luptr, irow, jcol;
+    int_t    i, k, p, iptr;
+    flops_t  solve_ops;
+
+    /* Test input parameters ... */
+    *info = 0;
+    if ( L->nrow != L->ncol || L->nrow < 0 ||
+	 L->Stype != SLU_SC || L->Dtype != SLU_D || L->Mtype != SLU_TRLU )
+	*info = -1;
+    else if ( U->nrow != U->ncol || U->nrow < 0 ||
+	      U->Stype != SLU_NC || U->Dtype != SLU_D || U->Mtype != SLU_TRU )
+	*info = -2;
+    else if ( ws->n != L->nrow ||
+	      ws->nsuper != ((SCformat *) L->Store)->nsuper ) *info = -4;
+    else if ( nzb < 0 ) *info = -5;
+    else {
+	for (i = 0; i < nzb; ++i)
+	    if ( bind[i] < 0 || bind[i] >= L->nrow ) {
+		*info = -6;
+		break;
+	    }
+    }
+    if ( *info ) {
+	i = -(*info);
+	input_error("dgstrs_sparse", (int*)&i);
+	return;
+    }
+
+    *nzx = 0;
+    n = L->nrow;
+    if ( n == 0 || nzb == 0 ) return;
+
+    Lstore = L->Store;
+    Lval   = Lstore->nzval;
+    Ustore = U->Store;
+    Uval   = Ustore->nzval;
+    supno  = Lstore->col_to_sup;
+    nsuper = Lstore->nsuper;
+
+    /* z[] and marker[] are zero between calls. */
+    z       = ws->z;
+    work    = ws->work;
+    iperm_c = ws->iperm_c;
+    marker  = ws->marker;
+    parent  = ws->parent;
+    xplore  = ws->xplore;
+    topoL   = ws->topoL;
+    topoU   = ws->topoU;
+
+    /* Scatter Pr*b into z[], and start the dfs from its supernodes. */
+    topL = nsuper + 1;
+    for (i = 0; i < nzb; ++i) {
+	irow = perm_r[bind[i]];
+	z[irow] += bval[i];
+	s = supno[irow];
+	topL = dsp_reach(0, Lstore, Ustore, 1, &s, marker, parent, xplore,
+			 topoL, topL);
+    }
+
+    solve_ops = 0;
+
+    /* Forward solve PLy=Pb over the reached supernodes. */
+    for (p = topL; p <= nsuper; ++p) {
+	k = topoL[p];
+	fsupc = L_FST_SUPC(k);
+	istart = L_SUB_START(fsupc);
+	nsupr = L_SUB_START(fsupc+1) - istart;
+	nsupc = L_FST_SUPC(k+1) - fsupc;
+	nrow = nsupr - nsupc;
+	luptr = L_NZ_START(fsupc);
+
+	solve_ops += nsupc * (nsupc - 1);
+	solve_ops += 2 * nrow * nsupc;
+
+	if ( nsupc == 1 ) {
+	    ukj = z[fsupc];
+	    for (iptr = istart + 1; iptr < istart + nsupr; iptr++) {
+		irow = L_SUB(iptr);
+		++luptr;
+		z[irow] -= ukj * Lval[luptr];
+	    }
+	} else {
+	    dtrsv_("L", "N", "U", (int*)&nsupc, &Lval[luptr], (int*)&nsupr,
+		   &z[fsupc], (int*)&incx);
+	    if ( nrow > 0 ) {
+		dgemv_("N", (int*)&nrow, (int*)&nsupc, &alpha,
+		       &Lval[luptr+nsupc], (int*)&nsupr, &z[fsupc],
+		       (int*)&incx, &beta, work, (int*)&incx);
+		for (i = 0, iptr = istart + nsupc; i < nrow; i++, iptr++) {
+		    irow = L_SUB(iptr);
+		    z[irow] -= work[i]; /* Scatter */
+		}
+	    }
+	}
+    }
+
+    /* The back solve starts from every supernode of y. */
+    for (p = topL; p <= nsuper; ++p) marker[topoL[p]] = 0;
+    topU = dsp_reach(1, Lstore, Ustore, nsuper + 1 - topL, &topoL[topL],
+		     marker, parent, xplore, topoU, nsuper + 1);
+
+    /* Back solve Ux=y over the reached supernodes. */
+    for (p = topU; p <= nsuper; ++p) {
+	k = topoU[p];
+	fsupc = L_FST_SUPC(k);
+	nsupr = L_SUB_START(fsupc+1) - L_SUB_START(fsupc);
+	nsupc = L_FST_SUPC(k+1) - fsupc;
+	luptr = L_NZ_START(fsupc);
+
+	solve_ops += nsupc * (nsupc + 1);
+
+	if ( nsupc == 1 ) {
+	    z[fsupc] /= Lval[luptr];
+	} else {
+	    dtrsv_("U", "N", "N", (int*)&nsupc, &Lval[luptr], (int*)&nsupr,
+		   &z[fsupc], (int*)&incx);
+	}
+
+	for (jcol = fsupc; jcol < fsupc + nsupc; jcol++) {
+	    solve_ops += 2*(U_NZ_START(jcol+1) - U_NZ_START(jcol));
+	    ukj = z[jcol];
+	    for (i = U_NZ_START(jcol); i < U_NZ_START(jcol+1); i++) {
+		irow = U_SUB(i);
+		z[irow] -= ukj * Uval[i];
+	    }
+	}
+    }
+
+    /* Compute the final solution x := Pc*x on the reached columns, and
+       leave z[] and marker[] zero for the next call. Every entry of z[]
+       that was touched lies in a supernode reached by the back solve. */
+    for (p = topU; p <= nsuper; ++p) {
+	k = topoU[p];
+	marker[k] = 0;
+	for (jcol = L_FST_SUPC(k); jcol < L_FST_SUPC(k+1); jcol++) {
+	    i = iperm_c[jcol];
+	    x[i] = z[jcol];
+	    z[jcol] = 0.0;
+	    if ( xind ) xind[*nzx] = i;
+	    ++(*nzx);
+	}
+    }
+
+    stat->ops[SOLVE] = solve_ops;
+}
@@ -0,0 +1,367 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dhwpm.c
+ * \brief Finds a row permutation with large entries on the diagonal by an
+ *  approximate heavy-weight perfect matching
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include <math.h>
+#include "slu_ddefs.h"
+
+/* Weight of an explicit zero: usable to complete the matching only. */
+#define HWPM_ZERO     (-1.0e30)
+/* The parallel rounds stop when a round matches fewer than this fraction
+   of the columns that are still unmatched; a serial sweep does the rest. */
+#define HWPM_MINFRAC  0.01
+/* Number of sweeps improving the matching by exchanges along 4-cycles. */
+#define HWPM_SWEEPS   2
+
+/* Is edge (wa, ka) heavier than edge (wb, kb)? Ties are broken by the
+   position in rowind[], so both ends of an edge order the edges alike. */
+#define HWPM_HEAVIER(wa, ka, wb, kb) ( (wa) > (wb) || ((wa) == (wb) && (ka) > (kb)) )
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ *   DHWPM finds a row permutation so that the matrix has large entries on
+ *   the diagonal, as DLDPERM does with JOB = 5, but by an approximation
+ *   that is partly multithreaded. Phases 1 and 3 below take time about
+ *   linear in nnz; phase 2 takes O(n*nnz) time in the worst case, as
+ *   MC21 does, but usually has few columns left to match.
+ *   The weight of a_ij is log|a_ij| - log max_k |a_kj|, and the matching
+ *   is built in three phases:
+ *
+ *   1. A locally dominant matching: in each round, every unmatched column
+ *      and every unmatched row points to its heaviest unmatched neighbour,
+ *      and the pairs that point to each other are matched. The rounds are
+ *      run in parallel over the columns and over the rows. The heaviest
+ *      remaining edge is matched in every round; when a round matches few
+ *      columns, the remaining columns are matched greedily in one serial
+ *      sweep. For nonnegative weights such a matching weighs at least
+ *      half as much as the heaviest one, but the weights here are
+ *      nonpositive, so no such bound holds; phase 3 improves it.
+ *   2. The matching is made perfect by augmenting paths from the columns
+ *      that are still unmatched, as HSL MC21 does. Explicit zeros are only
+ *      used in this phase.
+ *   3. Pairs of matched edges (i1,j1), (i2,j2) are replaced by (i2,j1),
+ *      (i1,j2) when these are heavier together.
+ *
+ *   Unlike DLDPERM, no scaling factors are computed.
+ *
+ * Arguments
+ * =========
+ *
+ * nthreads (input) int_t
+ *        The number of threads used in phase 1.
+ *
+ * n      (input) int_t
+ *        The order of the matrix.
+ *
+ * nnz    (input) int_t
+ *        The number of nonzeros in the matrix.
+ *
+ * colptr (input) int_t*, of size n+1
+ *        The pointers to the beginning of each column in ROWIND.
+ *
+ * rowind (input) int_t*, of size nnz
+ *        The row indices of the nonzeros.
+ *
+ * nzval  (input) double*, of size nnz
+ *        The nonzero values of the matrix.
+ *
+ * perm   (output) int_t*, of size n
+ *        The permutation vector. perm[i] = j means row i in the
+ *        original matrix is in row j of the permuted matrix.
+ *
+ * Return value
+ * ============
+ *
+ *   = 0: success.
+ *   = 1: the matrix is structurally singular; perm[] is not defined.
+ * </pre>
+ */
+int
+dhwpm(int_t nthreads, int_t n, int_t nnz, int_t colptr[], int_t rowind[],
+      double nzval[], int_t *perm)
+{
+    int_t  i, i1, i2, j, j1, j2, k, t, jj, sweep;
+    int_t  nact, nmatched, top, found;
+    int_t  *rowptr, *colind, *tpos, *mcol, *mrow, *cand, *rcand, *active;
+    int_t  *mark, *stack, *next, *look;
+    double *w, *mw, *wv, wbest, gain, gbest;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC("Enter dhwpm()");
+#endif
+#ifndef _OPENMP
+    nthreads = 1;
+#endif
+    if ( nthreads < 1 ) nthreads = 1;
+
+    if ( !(w = doubleMalloc(SUPERLU_MAX(nnz, 1))) )
+	ABORT("SUPERLU_MALLOC fails for w[]");
+    if ( !(mw = doubleMalloc(2 * SUPERLU_MAX(n, 1))) )
+	ABORT("SUPERLU_MALLOC fails for mw[]");
+    wv = mw + n;
+    if ( !(rowptr = intMalloc(n + 1)) )
+	ABORT("SUPERLU_MALLOC fails for rowptr[]");
+    if ( !(colind = intMalloc(2 * SUPERLU_MAX(nnz, 1))) )
+	ABORT("SUPERLU_MALLOC fails for colind[]");
+    tpos = colind + nnz;
+    if ( !(mcol = intMalloc(10 * SUPERLU_MAX(n, 1))) )
+	ABORT("SUPERLU_MALLOC fails for mcol[]");
+    mrow = mcol + n;
+    cand = mrow + n;
+    rcand = cand + n;
+    active = rcand + n;
+    mark = active + n;
+    stack = mark + n;
+    next = stack + n;
+    look = next + n;
+
+    /* Column-scaled weights log|a_ij| - log max_k |a_kj| <= 0. */
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static) private(k, wbest)
+#endif
+    for (j = 0; j < n; ++j) {
+	wbest = 0.0;
+	for (k = colptr[j]; k < colptr[j+1]; ++k)
+	    wbest = SUPERLU_MAX(wbest, fabs(nzval[k]));
+	for (k = colptr[j]; k < colptr[j+1]; ++k)
+	    w[k] = nzval[k] != 0.0 ? log(fabs(nzval[k]) / wbest) : HWPM_ZERO;
+    }
+
+    /* Row-wise structure; tpos[t] is the position in rowind[] of the
+       entry colind[t]. */
+    for (i = 0; i <= n; ++i) rowptr[i] = 0;
+    for (k = 0; k < nnz; ++k) ++rowptr[rowind[k] + 1];
+    for (i = 0; i < n; ++i) rowptr[i+1] += rowptr[i];
+    for (i = 0; i < n; ++i) mark[i] = rowptr[i];
+    for (j = 0; j < n; ++j)
+	for (k = colptr[j]; k < colptr[j+1]; ++k) {
+	    t = mark[rowind[k]]++;
+	    colind[t] = j;
+	    tpos[t] = k;
+	}
+
+    for (j = 0; j < n; ++j) {
+	mcol[j] = mrow[j] = EMPTY;
+	active[j] = j;
+    }
+    nact = n;
+
+    /* Phase 1: locally dominant matching. */
+    while ( nact > 0 ) {
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads) private(i, j, jj, k, t, wbest)
+#endif
+	{
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+	for (jj = 0; jj < nact; ++jj) {
+	    j = active[jj];
+	    cand[j] = EMPTY;
+	    t = EMPTY;
+	    wbest = 0.0;
+	    for (k = colptr[j]; k < colptr[j+1]; ++k) {
+		if ( w[k] == HWPM_ZERO || mrow[rowind[k]] != EMPTY ) continue;
+		if ( t == EMPTY || HWPM_HEAVIER(w[k], k, wbest, t) ) {
+		    t = k;
+		    wbest = w[k];
+		}
+	    }
+	    if ( t != EMPTY ) cand[j] = rowind[t];
+	}
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+	for (i = 0; i < n; ++i) {
+	    int_t kbest = EMPTY;
+	    rcand[i] = EMPTY;
+	    if ( mrow[i] != EMPTY ) continue;
+	    wbest = 0.0;
+	    for (t = rowptr[i]; t < rowptr[i+1]; ++t) {
+		k = tpos[t];
+		if ( w[k] == HWPM_ZERO || mcol[colind[t]] != EMPTY ) continue;
+		if ( kbest == EMPTY || HWPM_HEAVIER(w[k], k, wbest, kbest) ) {
+		    kbest = k;
+		    wbest = w[k];
+		    rcand[i] = colind[t];
+		}
+	    }
+	}
+	}
+
+	/* Match the pairs that point to each other. Each row is in at most
+	   one pair, so the writes do not conflict. */
+	nmatched = 0;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static) private(i, j) reduction(+:nmatched)
+#endif
+	for (jj = 0; jj < nact; ++jj) {
+	    j = active[jj];
+	    i = cand[j];
+	    if ( i != EMPTY && rcand[i] == j ) {
+		mcol[j] = i;
+		mrow[i] = j;
+		++nmatched;
+	    }
+	}
+
+	/* Keep the columns that may still be matched. */
+	t = 0;
+	for (jj = 0; jj < nact; ++jj) {
+	    j = active[jj];
+	    if ( mcol[j] == EMPTY && cand[j] != EMPTY ) active[t++] = j;
+	}
+	nact = t;
+	if ( nmatched < HWPM_MINFRAC * nact ) break;
+    }
+
+    /* Serial greedy sweep over the columns left by the rounds. */
+    for (jj = 0; jj < nact; ++jj) {
+	j = active[jj];
+	t = EMPTY;
+	wbest = 0.0;
+	for (k = colptr[j]; k < colptr[j+1]; ++k) {
+	    if ( w[k] == HWPM_ZERO || mrow[rowind[k]] != EMPTY ) continue;
+	    if ( t == EMPTY || w[k] > wbest ) {
+		t = k;
+		wbest = w[k];
+	    }
+	}
+	if ( t != EMPTY ) {
+	    mcol[j] = rowind[t];
+	    mrow[rowind[t]] = j;
+	}
+    }
+
+    /* Phase 2: augmenting paths by depth-first search with lookahead.
+       stack[] holds the columns on the path, next[j] the position in
+       column j to resume at, and look[j] the lookahead position. */
+    for (j = 0; j < n; ++j) {
+	mark[j] = EMPTY;
+	look[j] = colptr[j];
+    }
+    for (j1 = 0; j1 < n; ++j1) {
+	if ( mcol[j1] != EMPTY ) continue;
+	top = 0;
+	stack[0] = j1;
+	next[j1] = colptr[j1];
+	mark[j1] = j1;
+	found = EMPTY;
+	while ( top >= 0 && found == EMPTY ) {
+	    j = stack[top];
+	    /* Cheap assignment: an unmatched row in column j. */
+	    for (k = look[j]; k < colptr[j+1]; ++k)
+		if ( mrow[rowind[k]] == EMPTY ) break;
+	    look[j] = k + 1;
+	    if ( k < colptr[j+1] ) {
+		found = rowind[k];
+		break;
+	    }
+	    /* Otherwise extend the path through a matched row. */
+	    j2 = EMPTY;
+	    for (k = next[j]; k < colptr[j+1]; ++k) {
+		j2 = mrow[rowind[k]];
+		if ( mark[j2] != j1 ) break;
+	    }
+	    next[j] = k + 1;
+	    if ( k < colptr[j+1] ) {
+		mark[j2] = j1;
+		next[j2] = colptr[j2];
+		stack[++top] = j2;
+	    } else {
+		--top;
+	    }
+	}
+	if ( found == EMPTY ) break;
+	/* Flip the path. */
+	for (i = found; top >= 0; --top) {
+	    j = stack[top];
+	    i2 = mcol[j];
+	    mcol[j] = i;
+	    mrow[i] = j;
+	    i = i2;
+	}
+    }
+    if ( j1 < n ) {
+	SUPERLU_FREE(w);
+	SUPERLU_FREE(mw);
+	SUPERLU_FREE(rowptr);
+	SUPERLU_FREE(colind);
+	SUPERLU_FREE(mcol);
+	return 1;
+    }
+
+    /* Phase 3: exchanges along 4-cycles i1-j1-i2-j2. The columns of row
+       i1 are marked with the weights of their entries in wv[]. */
+    for (j = 0; j < n; ++j) {
+	mark[j] = EMPTY;
+	for (k = colptr[j]; k < colptr[j+1]; ++k)
+	    if ( rowind[k] == mcol[j] ) mw[j] = w[k];
+    }
+    for (sweep = 0; sweep < HWPM_SWEEPS; ++sweep) {
+	nmatched = 0;
+	for (j1 = 0; j1 < n; ++j1) {
+	    i1 = mcol[j1];
+	    for (t = rowptr[i1]; t < rowptr[i1+1]; ++t) {
+		mark[colind[t]] = sweep * n + j1;
+		wv[colind[t]] = w[tpos[t]];
+	    }
+	    gbest = 0.0;
+	    found = EMPTY;
+	    for (k = colptr[j1]; k < colptr[j1+1]; ++k) {
+		j2 = mrow[rowind[k]];
+		if ( j2 == j1 || mark[j2] != sweep * n + j1 ) continue;
+		gain = w[k] + wv[j2] - mw[j1] - mw[j2];
+		if ( gain > gbest ) {
+		    gbest = gain;
+		    found = k;
+		}
+	    }
+	    if ( found != EMPTY ) {
+		i2 = rowind[found];
+		j2 = mrow[i2];
+		mw[j2] = wv[j2];
+		mw[j1] = w[found];
+		mcol[j1] = i2;
+		mrow[i2] = j1;
+		mcol[j2] = i1;
+		mrow[i1] = j2;
+		++nmatched;
+	    }
+	}
+	if ( nmatched == 0 ) break;
+    }
+
+    for (i = 0; i < n; ++i) perm[i] = mrow[i];
+
+    SUPERLU_FREE(w);
+    SUPERLU_FREE(mw);
+    SUPERLU_FREE(rowptr);
+    SUPERLU_FREE(colind);
+    SUPERLU_FREE(mcol);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC("Exit dhwpm()");
+#endif
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dlaconb.c
+ * \brief Estimates the 1-norm with a block of vectors
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include <math.h>
+#include "slu_ddefs.h"
+
+#define ITMAX 5
+
+/*! \brief Next pseudo-random sign, from the state in *seed. */
+static double
+dlaconb_sign(int *seed)
+{
+    *seed = (int) (((unsigned) *seed * 1103515245u + 12345u) & 0x7fffffff);
+    return (*seed & 0x10000) ? 1.0 : -1.0;
+}
+
+/*! \brief Whether column j of S (n by t) is parallel to one of the
+ *  columns 0:ncol-1 of S2. All entries are +1 or -1.
+ */
+static int
+dlaconb_parallel(int n, double *S, int j, double *S2, int ncol)
+{
+    int    i, k;
+    double dot;
+
+    for (k = 0; k < ncol; ++k) {
+	dot = 0.;
+	for (i = 0; i < n; ++i) dot += S[i + j*n] * S2[i + k*n];
+	if ( fabs(dot) == (double) n ) return 1;
+    }
+    return 0;
+}
+
+/*! \brief
+ *
+ * <pre>
+ *   Purpose
+ *   =======
+ *
+ *   DLACONB estimates the 1-norm of a square matrix A, using a block of
+ *   t vectors at a time (Higham and Tisseur). Reverse communication is
+ *   used for evaluating the products with A and A', so that each
+ *   intermediate return asks for one product with an n by t matrix.
+ *   Larger t gives a more reliable estimate in fewer iterations; t = 2
+ *   is usually enough. For t = 1 this is essentially the algorithm of
+ *   DLACON2, without its final test vector; for t > 1 that vector is
+ *   one of the starting vectors.
+ *
+ *   Arguments
+ *   =========
+ *
+ *   N      (input) int
+ *          The order of the matrix.  N >= 1.
+ *
+ *   T      (input) int
+ *          The number of vectors, 1 <= T <= N.
+ *
+ *   X      (input/output) double array, dimension (N*T)
+ *          On an intermediate return, the N by T matrix X should be
+ *          overwritten by
+ *                A * X,   if KASE=1,
+ *                A' * X,  if KASE=2,
+ *          and DLACONB must be re-called with all the other parameters
+ *          unchanged.
+ *
+ *   WORK   (workspace) double array, dimension (N*(T+1))
+ *
+ *   IWORK  (workspace) int array, dimension (N+T)
+ *
+ *   EST    (input/output) double
+ *          An estimate (a lower bound) for norm(A).
+ *
+ *   KASE   (input/output) int
+ *          On the initial call to DLACONB, KASE should be 0.
+ *          On an intermediate return, KASE will be 1 or 2, indicating
+ *          whether X should be overwritten by A * X  or A' * X.
+ *          On the final return from DLACONB, KASE will again be 0.
+ *
+ *   ISAVE  (input/output) int array, dimension (4)
+ *          ISAVE is used to save variables between calls to DLACONB.
+ *
+ *   Further Details
+ *   ===============
+ *
+ *   Reference: N.J. Higham and F. Tisseur, "A block algorithm for matrix
+ *   1-norm estimation, with an application to 1-norm pseudospectra",
+ *   SIAM J. Matrix Anal. Appl., vol. 21, no. 4, pp. 1185-1201, 2000.
+ * </pre>
+ */
+int
+dlaconb(int n, int t, double *x, double *work, int *iwork, double *est,
+	int *kase, int isave[4])
+{
+    double *S_old = work;           /* sign matrix of the last iteration */
+    double *h = &work[n*t];         /* row norms of A'*S */
+    int    *hist = iwork;           /* unit vectors used so far */
+    int    *ind = &iwork[n];        /* unit vectors in X */
+    double s, colnrm, estnew, hmax;
+    int    i, j, k, jbest, ntry, nind, imax;
+
+    /* isave[0] = jump, isave[1] = iter, isave[2] = ind_best,
+       isave[3] = random seed */
+
+    if ( *kase == 0 ) {
+	/* X = [ones, random +-1 columns not parallel to the earlier
+	   ones] / n. Column 1 is replaced by the alternating vector
+	   that DLACON2 tries last, scaled to unit 1-norm. */
+	isave[3] = 2015;
+	for (i = 0; i < n; ++i) {
+	    x[i] = 1.;
+	    hist[i] = 0;
+	}
+	for (j = 1; j < t; ++j) {
+	    for (ntry = 0; ntry < 10; ++ntry) {
+		for (i = 0; i < n; ++i) x[i + j*n] = dlaconb_sign(&isave[3]);
+		if ( !dlaconb_parallel(n, x, j, x, j) ) break;
+	    }
+	}
+	for (i = 0; i < t*n; ++i) x[i] /= (double) n;
+	if ( t > 1 && n > 1 ) {
+	    s = 0.;
+	    for (i = 0; i < n; ++i) {
+		x[i + n] = (i % 2 ? -1. : 1.) * ((double) i / (double) (n-1) + 1.);
+		s += fabs(x[i + n]);
+	    }
+	    for (i = 0; i < n; ++i) x[i + n] /= s;
+	}
+	for (j = 0; j < t; ++j) ind[j] = -1;
+	*est = 0.;
+	isave[1] = 1;
+	isave[2] = -1;
+	isave[0] = 1;
+	*kase = 1;
+	return 0;
+    }
+
+    if ( isave[0] == 1 ) {
+	/* X has been overwritten by A*X. */
+	estnew = 0.;
+	jbest = 0;
+	for (j = 0; j < t; ++j) {
+	    colnrm = 0.;
+	    for (i = 0; i < n; ++i) colnrm += fabs(x[i + j*n]);
+	    if ( colnrm > estnew ) {
+		estnew = colnrm;
+		jbest = j;
+	    }
+	}
+	if ( isave[1] >= 2 && estnew <= *est ) goto done;
+	if ( estnew > *est || isave[1] == 2 ) isave[2] = ind[jbest];
+	*est = estnew;
+	if ( isave[1] > ITMAX || n == 1 ) goto done;
+
+	/* S = sign(A*X). Stop if every column of S is parallel to a
+	   column of the last S. */
+	for (j = 0; j < t*n; ++j) x[j] = x[j] >= 0. ? 1. : -1.;
+	if ( isave[1] >= 2 ) {
+	    for (j = 0; j < t; ++j)
+		if ( !dlaconb_parallel(n, x, j, S_old, t) ) break;
+	    if ( j == t ) goto done;
+	}
+	if ( t > 1 ) {
+	    /* Resample the columns that repeat earlier ones. */
+	    for (j = 0; j < t; ++j) {
+		for (ntry = 0; ntry < 10; ++ntry) {
+		    if ( !dlaconb_parallel(n, x, j, x, j) &&
+			 (isave[1] == 1 || !dlaconb_parallel(n, x, j, S_old, t)) )
+			break;
+		    for (i = 0; i < n; ++i)
+			x[i + j*n] = dlaconb_sign(&isave[3]);
+		}
+	    }
+	}
+	for (j = 0; j < t*n; ++j) S_old[j] = x[j];
+	isave[0] = 2;
+	*kase = 2;
+	return 0;
+    }
+
+    /* X has been overwritten by A'*S. */
+    hmax = 0.;
+    for (i = 0; i < n; ++i) {
+	s = 0.;
+	for (j = 0; j < t; ++j) s = SUPERLU_MAX(s, fabs(x[i + j*n]));
+	h[i] = s;
+	hmax = SUPERLU_MAX(hmax, s);
+    }
+    if ( isave[1] >= 2 && isave[2] >= 0 && hmax == h[isave[2]] ) goto done;
+
+    /* The t largest entries of h pick the next unit vectors; stop if
+       they have all been used before. Otherwise take the largest ones
+       that have not been used. */
+    for (k = 0; k < 2; ++k) {
+	nind = 0;
+	for (j = 0; j < t; ++j) {
+	    imax = -1;
+	    for (i = 0; i < n; ++i) {
+		if ( h[i] < 0. || (k == 1 && hist[i]) ) continue;
+		if ( imax < 0 || h[i] > h[imax] ) imax = i;
+	    }
+	    if ( imax < 0 ) break;
+	    ind[nind++] = imax;
+	    h[imax] = -1. - h[imax];      /* exclude it for now */
+	}
+	for (j = 0; j < nind; ++j) h[ind[j]] = -1. - h[ind[j]];
+	if ( k == 0 ) {
+	    for (j = 0; j < nind; ++j)
+		if ( !hist[ind[j]] ) break;
+	    if ( j == nind ) goto done;
+	}
+    }
+    if ( nind == 0 ) goto done;
+
+    for (j = 0; j < t; ++j) {
+	if ( j >= nind ) ind[j] = ind[0];
+	for (i = 0; i < n; ++i) x[i + j*n] = 0.;
+	x[ind[j] + j*n] = 1.;
+	hist[ind[j]] = 1;
+    }
+    ++isave[1];
+    isave[0] = 1;
+    *kase = 1;
+    return 0;
+
+done:
+    *kase = 0;
+    return 0;
+
+} /* dlaconb */
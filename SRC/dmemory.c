@@ -39,8 +39,6 @@ extern void    user_bcopy      (char *, char *, int_t);
 #define StackFull(x)         ( x + Glu->stack.used >= Glu->stack.size )
 #define NotDoubleAlign(addr) ( (intptr_t)addr & 7 )
 #define DoubleAlign(addr)    ( ((intptr_t)addr + 7) & ~7L )
-#define TempSpace(m, w)      ( (2*w + 4 + NO_MARKER) * m * sizeof(int_t) + \
-			      (w + 1) * m * sizeof(double) )
 #define Reduce(alpha)        ((alpha + 1) / 2)  /* i.e. (alpha-1)/2 + 1 */
 
 
@@ -176,6 +174,42 @@ int_t ilu_dQuerySpace(SuperMatrix *L, SuperMatrix *U, mem_usage_t *mem_usage)
 } /* ilu_dQuerySpace */
 
 
+/*! \brief Sizes in bytes of iwork[] and dwork[] allocated by dLUWorkInit().
+ */
+static void
+dLUWorkSize(int_t m, int_t n, int_t panel_size, int_t *isize, int_t *dsize)
+{
+    int_t maxsuper = SUPERLU_MAX( sp_ienv(3), sp_ienv(7) ),
+          rowblk   = sp_ienv(4);
+
+    *isize = ( (2 * panel_size + 3 + NO_MARKER ) * m + n ) * sizeof(int_t);
+    *dsize = (m * panel_size +
+	      NUM_TEMPV(m,panel_size,maxsuper,rowblk)) * sizeof(double);
+}
+
+/*! \brief Bytes of work[] used by dLUMemInitSize() and dLUWorkInit().
+ *
+ * <pre>
+ * The L\U arrays of the given lengths, the column-indexed arrays, the
+ * work arrays of the factor routines and the alignment padding of lusup,
+ * ucol and dwork. This is what lwork = -1 returns, less n, and what a
+ * memory budget is checked against. It is summed in double, as it may
+ * not fit in an int_t.
+ * </pre>
+ */
+double
+dLUStackSize(int_t m, int_t n, int_t panel_size, int_t nzlmax, int_t nzumax,
+	     int_t nzlumax)
+{
+    int_t isize, dsize;
+
+    dLUWorkSize(m, n, panel_size, &isize, &dsize);
+    return ( (double) GluIntArray(n) * sizeof(int_t) + isize + dsize
+	     + ((double) nzlmax + nzumax) * sizeof(int_t)
+	     + ((double) nzlumax + nzumax) * sizeof(double)
+	     + 4 * sizeof(double) );
+}
+
 /*! \brief Allocate storage for the data structures common to all factor routines.
  *
  * <pre>
@@ -190,8 +224,36 @@ int_t
 dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 	  int_t panel_size, double fill_ratio, SuperMatrix *L, SuperMatrix *U,
           GlobalLU_t *Glu, int_t **iwork, double **dwork)
+{
+    /* Guess for L\U factors */
+    int_t nzumax = fill_ratio * annz;
+    int_t nzlmax = SUPERLU_MAX(1, fill_ratio/4.) * annz;
+
+    return dLUMemInitSize(fact, work, lwork, m, n, annz, panel_size,
+			  nzlmax, nzumax, nzumax, L, U, Glu, iwork, dwork);
+}
+
+/*! \brief Allocate storage for the data structures common to all factor routines.
+ *
+ * <pre>
+ * As dLUMemInit(), with the initial sizes of lsub[], ucol[]/usub[] and
+ * lusup[] given by nzlmax, nzumax and nzlumax, e.g. from a symbolic
+ * factorization (see sp_symbfact_size()). They are not used if
+ * fact = SamePattern_SameRowPerm.
+ *
+ * With system malloc and a memory budget Glu->budget > 0, the sizes are
+ * cut to fit the budget, and on return Glu->budget is the part of it
+ * left for lusup, ucol, lsub and usub, which dexpand() keeps to.
+ * </pre>
+ */
+int_t
+dLUMemInitSize(fact_t fact, void *work, int_t lwork, int_t m, int_t n,
+	       int_t annz, int_t panel_size, int_t nzlmax, int_t nzumax,
+	       int_t nzlumax, SuperMatrix *L, SuperMatrix *U,
+	       GlobalLU_t *Glu, int_t **iwork, double **dwork)
 {
     int_t      info, iword, dword;
+    int_t      top1, used;  /* stack marks before lusup, ..., usub */
     SCformat *Lstore;
     NCformat *Ustore;
     int_t      *xsup, *supno;
@@ -200,7 +262,6 @@ dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
     int_t      *xlusup;
     double   *ucol;
     int_t      *usub, *xusub;
-    int_t      nzlmax, nzumax, nzlumax;
 
     iword     = sizeof(int_t);
     dword     = sizeof(double);
@@ -212,20 +273,38 @@ dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
     if ( !Glu->expanders ) ABORT("SUPERLU_MALLOC fails for expanders");
 
     if ( fact != SamePattern_SameRowPerm ) {
-	/* Guess for L\U factors */
-	nzumax = nzlumax = fill_ratio * annz;
-	nzlmax = SUPERLU_MAX(1, fill_ratio/4.) * annz;
-
 	if ( lwork == -1 ) {
-	    return ( GluIntArray(n) * iword + TempSpace(m, panel_size)
-		    + (nzlmax+nzumax)*iword + (nzlumax+nzumax)*dword + n );
+	    SUPERLU_FREE (Glu->expanders);
+	    return ( (int_t) dLUStackSize(m, n, panel_size, nzlmax, nzumax,
+					  nzlumax) + n );
         } else {
 	    dSetupSpace(work, lwork, Glu);
 	}
 
+	if ( Glu->MemModel == SYSTEM && Glu->budget > 0. ) {
+	    double room, need;
+	    room = Glu->budget - dLUStackSize(m, n, panel_size, 0, 0, 0);
+	    need = (double) nzlmax * iword + (double) nzumax * (iword + dword)
+		+ (double) nzlumax * dword;
+	    if ( need > room ) {
+		if ( 0.5 * room < need * annz / nzlumax ) {
+		    /* Not even A fits */
+		    SUPERLU_FREE (Glu->expanders);
+		    Glu->expanders = NULL;
+		    return ( (int_t) dLUStackSize(m, n, panel_size, nzlmax,
+						  nzumax, nzlumax) + n );
+		}
+		/* Start with half, and let the arrays that need it grow */
+		nzlmax  *= 0.5 * room / need;
+		nzumax  *= 0.5 * room / need;
+		nzlumax *= 0.5 * room / need;
+	    }
+	    Glu->budget = room;
+	}
+
 #if ( PRNTlevel >= 1 )
-	printf("dLUMemInit() called: fill_ratio %.0f, nzlmax %lld, nzumax %lld\n",
-	       fill_ratio, nzlmax, nzumax);
+	printf("dLUMemInit() called: nzlmax %lld, nzumax %lld, nzlumax %lld\n",
+	       nzlmax, nzumax, nzlumax);
 	fflush(stdout);
 #endif
 
@@ -244,6 +323,8 @@ dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 	    xusub  = (int_t *)duser_malloc((n+1) * iword, HEAD, Glu);
 	}
 
+	top1 = Glu->stack.top1;
+	used = Glu->stack.used;
 	lusup = (double *) dexpand( &nzlumax, LUSUP, 0, 0, Glu );
 	ucol  = (double *) dexpand( &nzumax, UCOL, 0, 0, Glu );
 	lsub  = (int_t *)    dexpand( &nzlmax, LSUB, 0, 0, Glu );
@@ -256,8 +337,10 @@ dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 		SUPERLU_FREE(lsub);
 		SUPERLU_FREE(usub);
 	    } else {
-		duser_free((nzlumax+nzumax)*dword+(nzlmax+nzumax)*iword,
-                            HEAD, Glu);
+		/* Some of the four may not have been allocated, and the
+		   alignment padding is not in their sizes */
+		Glu->stack.top1 = top1;
+		Glu->stack.used = used;
 	    }
 	    nzlumax /= 2;
 	    nzumax /= 2;
@@ -291,8 +374,9 @@ dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 	nzlumax  = Glu->nzlumax;
 
 	if ( lwork == -1 ) {
-	    return ( GluIntArray(n) * iword + TempSpace(m, panel_size)
-		    + (nzlmax+nzumax)*iword + (nzlumax+nzumax)*dword + n );
+	    SUPERLU_FREE (Glu->expanders);
+	    return ( (int_t) dLUStackSize(m, n, panel_size, nzlmax, nzumax,
+					  nzlumax) + n );
         } else if ( lwork == 0 ) {
 	    Glu->MemModel = SYSTEM;
 	} else {
@@ -309,6 +393,8 @@ dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 	Glu->expanders[LUSUP].size        = nzlumax;
 	Glu->expanders[USUB].size         = nzumax;
 	Glu->expanders[UCOL].size         = nzumax;
+	if ( Glu->MemModel == SYSTEM && Glu->budget > 0. )
+	    Glu->budget -= dLUStackSize(m, n, panel_size, 0, 0, 0);
     }
 
     Glu->xsup    = xsup;
@@ -333,6 +419,66 @@ dLUMemInit(fact_t fact, void *work, int_t lwork, int_t m, int_t n, int_t annz,
 
 } /* dLUMemInit */
 
+/*! \brief Allocate the L\U storage for one subtree in threaded dgstrf.
+ *
+ * <pre>
+ * Only the four expandable arrays lusup, ucol, lsub and usub are
+ * allocated, sized from annz, the number of nonzeros of A in the
+ * subtree. The column-indexed arrays xsup, supno, xlsub, xlusup and
+ * xusub are supplied by the caller. Storage is always system malloc'd.
+ * Return value:
+ *     0 on success; otherwise the amount of space requested when memory
+ *     allocation failure occurred, plus n.
+ * </pre>
+ */
+int_t
+dLUSubtreeMemInit(int_t n, int_t annz, double fill_ratio, GlobalLU_t *Glu)
+{
+    int_t  nzlmax, nzumax, nzlumax;
+
+    Glu->n = n;
+    Glu->MemModel = SYSTEM;
+    Glu->budget = 0.;
+    Glu->ooc = NULL;
+    Glu->num_expansions = 0;
+    Glu->expanders = (ExpHeader *) SUPERLU_MALLOC( NO_MEMTYPE *
+                                                     sizeof(ExpHeader) );
+    if ( !Glu->expanders ) ABORT("SUPERLU_MALLOC fails for expanders");
+
+    annz = SUPERLU_MAX(annz, 1);
+    nzumax = nzlumax = fill_ratio * annz;
+    nzlmax = SUPERLU_MAX(1, fill_ratio/4.) * annz;
+
+    Glu->lusup = dexpand( &nzlumax, LUSUP, 0, 0, Glu );
+    Glu->ucol  = dexpand( &nzumax, UCOL, 0, 0, Glu );
+    Glu->lsub  = (int_t *) dexpand( &nzlmax, LSUB, 0, 0, Glu );
+    Glu->usub  = (int_t *) dexpand( &nzumax, USUB, 0, 1, Glu );
+    if ( !Glu->lusup || !Glu->ucol || !Glu->lsub || !Glu->usub ) {
+	dLUSubtreeMemFree(Glu);
+	return (dmemory_usage(nzlmax, nzumax, nzlumax, n) + n);
+    }
+
+    Glu->nzlmax  = nzlmax;
+    Glu->nzumax  = nzumax;
+    Glu->nzlumax = nzlumax;
+    ++Glu->num_expansions;
+    return 0;
+}
+
+/*! \brief Free the storage allocated by dLUSubtreeMemInit().
+ */
+void dLUSubtreeMemFree(GlobalLU_t *Glu)
+{
+    if ( Glu->lusup ) SUPERLU_FREE (Glu->lusup);
+    if ( Glu->ucol )  SUPERLU_FREE (Glu->ucol);
+    if ( Glu->lsub )  SUPERLU_FREE (Glu->lsub);
+    if ( Glu->usub )  SUPERLU_FREE (Glu->usub);
+    if ( Glu->expanders ) SUPERLU_FREE (Glu->expanders);
+    Glu->lusup = Glu->ucol = NULL;
+    Glu->lsub = Glu->usub = NULL;
+    Glu->expanders = NULL;
+}
+
 /*! \brief Allocate known working storage. Returns 0 if success, otherwise
    returns the number of bytes allocated so far when failure occurred. */
 int_t
@@ -341,12 +487,23 @@ dLUWorkInit(int_t m, int_t n, int_t panel_size, int_t **iworkptr,
 {
     int_t    isize, dsize, extra;
     double *old_ptr;
-    int_t    maxsuper = SUPERLU_MAX( sp_ienv(3), sp_ienv(7) ),
-           rowblk   = sp_ienv(4);
 
-    isize = ( (2 * panel_size + 3 + NO_MARKER ) * m + n ) * sizeof(int_t);
-    dsize = (m * panel_size +
-	     NUM_TEMPV(m,panel_size,maxsuper,rowblk)) * sizeof(double);
+    dLUWorkSize(m, n, panel_size, &isize, &dsize);
+
+    if ( Glu->MemModel == SYSTEM && Glu->work ) {
+	/* Reuse the arrays kept by the caller. Of iwork[], only segrep,
+	   parent, xplore and xprune are not reset by SetIWork() or the
+	   factor routines. */
+	if ( (extra = LUWorkspaceReserve(Glu->work, isize, dsize)) ) {
+	    fprintf(stderr, "dLUWorkInit: malloc fails for LUWorkspace\n");
+	    return (extra + n);
+	}
+	*iworkptr = Glu->work->iwork;
+	*dworkptr = (double *) Glu->work->dwork;
+	ifill (*iworkptr, 3 * m, 0);
+	ifill (*iworkptr + (2 * panel_size + 3) * m, n, 0);
+	return 0;
+    }
 
     if ( Glu->MemModel == SYSTEM )
 	*iworkptr = (int_t *) intCalloc(isize/sizeof(int_t));
@@ -403,8 +560,10 @@ dSetRWork(int_t m, int_t panel_size, double *dworkptr,
 void dLUWorkFree(int_t *iwork, double *dwork, GlobalLU_t *Glu)
 {
     if ( Glu->MemModel == SYSTEM ) {
-	SUPERLU_FREE (iwork);
-	SUPERLU_FREE (dwork);
+	if ( !Glu->work ) { /* else kept in the caller's LUWorkspace_t */
+	    SUPERLU_FREE (iwork);
+	    SUPERLU_FREE (dwork);
+	}
     } else {
 	Glu->stack.used -= (Glu->stack.size - Glu->stack.top2);
 	Glu->stack.top2 = Glu->stack.size;
@@ -491,7 +650,8 @@ void
 *dexpand (
 	 int_t *prev_len,   /* length used from previous call */
 	 MemType type,    /* which part of the memory to expand */
-	 int_t len_to_copy, /* size of the memory to be copied to new store */
+	 int_t len_to_copy, /* unused: realloc() and the stack shift
+			       carry the whole array to the new store */
 	 int_t keep_prev,   /* = 1: use prev_len;
 			     = 0: compute new_len to expand */
 	 GlobalLU_t *Glu  /* modified - global LU data structures */
@@ -500,9 +660,10 @@ void
     float    EXPAND = 1.5;
     float    alpha;
     void     *new_mem, *old_mem;
-    int_t      new_len, tries, lword, extra, bytes_to_copy;
+    int_t      new_len, maxlen, tries, lword, extra, bytes_to_copy;
     ExpHeader *expanders = Glu->expanders; /* Array of 4 types of memory */
 
+    (void) len_to_copy;
     alpha = EXPAND;
 
     if ( Glu->num_expansions == 0 || keep_prev ) {
@@ -516,25 +677,49 @@ void
     else lword = sizeof(double);
 
     if ( Glu->MemModel == SYSTEM ) {
-	new_mem = (void *) SUPERLU_MALLOC((size_t)new_len * lword);
-	if ( Glu->num_expansions != 0 ) {
+	if ( Glu->num_expansions == 0 ) {
+	    /* Out-of-core values go to a scratch file if one can be had */
+	    new_mem = NULL;
+	    if ( Glu->ooc && (type == LUSUP || type == UCOL) )
+		new_mem = ooc_malloc((size_t)new_len * lword);
+	    if ( !new_mem )
+		new_mem = (void *) SUPERLU_MALLOC((size_t)new_len * lword);
+	} else {
+	    maxlen = new_len;
+	    if ( Glu->budget > 0. && !keep_prev ) {
+		/* Take at most half of what the budget has left, so that
+		   the other arrays can still grow; UCOL pays for USUB too */
+		double room = Glu->budget - (double) Glu->nzlmax * sizeof(int_t)
+		    - (double) Glu->nzumax * (sizeof(int_t) + sizeof(double))
+		    - (double) Glu->nzlumax * sizeof(double);
+		double cost = (type == UCOL)
+		    ? (double) (sizeof(int_t) + sizeof(double)) : (double) lword;
+		room = SUPERLU_MAX(room / 2, SUPERLU_MIN(room, 65536.)) / cost;
+		if ( room < 1. ) return (NULL);
+		if ( (double) maxlen - *prev_len > room )
+		    maxlen = *prev_len + (int_t) room;
+		if ( maxlen <= *prev_len ) return (NULL);
+		new_len = maxlen;
+	    }
+	    /* Grow the block in place rather than allocate-copy-free:
+	       realloc() extends it, or for large (mmap'ed) blocks remaps
+	       its pages, so the factored part is not copied and the old
+	       and new arrays need not coexist. On failure the old block
+	       is left intact and a smaller growth factor is tried. */
 	    tries = 0;
+	    new_mem = (void *) SUPERLU_REALLOC(expanders[type].mem,
+					       (size_t)new_len * lword);
 	    if ( keep_prev ) {
 		if ( !new_mem ) return (NULL);
 	    } else {
 		while ( !new_mem ) {
 		    if ( ++tries > 10 ) return (NULL);
 		    alpha = Reduce(alpha);
-		    new_len = alpha * *prev_len;
-		    new_mem = (void *) SUPERLU_MALLOC((size_t)new_len * lword);
+		    new_len = SUPERLU_MIN(alpha * *prev_len, maxlen);
+		    new_mem = (void *) SUPERLU_REALLOC(expanders[type].mem,
+						       (size_t)new_len * lword);
 		}
 	    }
-	    if ( type == LSUB || type == USUB ) {
-		copy_mem_int(len_to_copy, expanders[type].mem, new_mem);
-	    } else {
-		copy_mem_double(len_to_copy, expanders[type].mem, new_mem);
-	    }
-	    SUPERLU_FREE (expanders[type].mem);
 	}
 	expanders[type].mem = (void *) new_mem;
 
@@ -567,21 +752,23 @@ void
 		}
 	    }
 
+	    /* The stack holds lusup, ucol, lsub, usub in this order, which
+	       is decreasing MemType: the array after type is type - 1. */
 	    if ( type != USUB ) {
-		new_mem = (void*)((char*)expanders[type + 1].mem + extra);
+		new_mem = (void*)((char*)expanders[type - 1].mem + extra);
 		bytes_to_copy = (char*)Glu->stack.array + Glu->stack.top1
-		    - (char*)expanders[type + 1].mem;
-		user_bcopy(expanders[type+1].mem, new_mem, bytes_to_copy);
+		    - (char*)expanders[type - 1].mem;
+		user_bcopy(expanders[type-1].mem, new_mem, bytes_to_copy);
 
-		if ( type < USUB ) {
+		if ( type > USUB ) {
 		    Glu->usub = expanders[USUB].mem =
 			(void*)((char*)expanders[USUB].mem + extra);
 		}
-		if ( type < LSUB ) {
+		if ( type > LSUB ) {
 		    Glu->lsub = expanders[LSUB].mem =
 			(void*)((char*)expanders[LSUB].mem + extra);
 		}
-		if ( type < UCOL ) {
+		if ( type > UCOL ) {
 		    Glu->ucol = expanders[UCOL].mem =
 			(void*)((char*)expanders[UCOL].mem + extra);
 		}
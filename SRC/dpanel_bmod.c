@@ -73,12 +73,12 @@ dpanel_bmod (
 {
 
 
-#ifdef USE_VENDOR_BLAS
 #ifdef _CRAY
     _fcd ftcs1 = _cptofcd("L", strlen("L")),
          ftcs2 = _cptofcd("N", strlen("N")),
          ftcs3 = _cptofcd("U", strlen("U"));
 #endif
+#ifdef USE_VENDOR_BLAS
     int_t          incx = 1, incy = 1;
     double       alpha, beta;
 #endif
@@ -104,9 +104,10 @@ dpanel_bmod (
     double       *TriTmp, *MatvecTmp; /* used in 2-D update */
     double      zero = 0.0;
     double      one = 1.0;
-    register int_t ldaTmp;
+    int_t          ldaTmp;
     register int_t r_ind, r_hi;
     int_t  maxsuper, rowblk, colblk;
+    int_t  ncol, kfnz_min;         /* used in 2-D update */
     flops_t  *ops = stat->ops;
     
     xsup    = Glu->xsup;
@@ -145,11 +146,14 @@ dpanel_bmod (
 	
 	if ( nsupc >= colblk && nrow > rowblk ) { /* 2-D block update */
 
-	    TriTmp = tempv;
-	
-	    /* Sequence through each column in panel -- triangular solves */
+	    /* The U-segments of the panel columns are gathered into the
+	     * columns of TriTmp[*], padded with zeros in front up to the
+	     * longest segment, so that the triangular solves and the block
+	     * update are done by one dtrsm and one dgemm per block row.
+	     */
+	    kfnz_min = krep + 1;
 	    for (jj = jcol; jj < jcol + w; jj++,
-		 repfnz_col += m, dense_col += m, TriTmp += ldaTmp ) {
+		 repfnz_col += m, dense_col += m) {
 
 		kfnz = repfnz_col[krep];
 		if ( kfnz == EMPTY ) continue;	/* Skip any zero segment */
@@ -201,93 +205,87 @@ dpanel_bmod (
 			}
 		    }
 
-		} else  {	/* segsze >= 4 */
-		    
-		    /* Copy U[*,j] segment from dense[*] to TriTmp[*], which
-		       holds the result of triangular solves.    */
-		    no_zeros = kfnz - fsupc;
-		    isub = lptr + no_zeros;
-		    for (i = 0; i < segsze; ++i) {
-			irow = lsub[isub];
-			TriTmp[i] = dense_col[irow]; /* Gather */
-			++isub;
-		    }
-		    
-		    /* start effective triangle */
-		    luptr += nsupr * no_zeros + no_zeros;
+		} else if ( kfnz < kfnz_min ) { /* segsze >= 4 */
+		    kfnz_min = kfnz;
+		}
+	    
+	    }  /* for jj ... end unrolled cases */
+
+	    if ( kfnz_min > krep ) continue; /* No segment of size >= 4 */
+	    segsze = krep - kfnz_min + 1;
+	    no_zeros = kfnz_min - fsupc;
+
+	    /* Gather the U-segments from dense[*] into TriTmp[*] */
+	    ncol = 0;
+	    repfnz_col = repfnz;
+	    dense_col = dense;
+	    TriTmp = tempv;
+	    for (jj = jcol; jj < jcol + w; jj++,
+		 repfnz_col += m, dense_col += m) {
+		kfnz = repfnz_col[krep];
+		if ( kfnz == EMPTY || krep - kfnz < 3 ) continue;
+
+		isub = lptr + no_zeros;
+		for (i = 0; i < kfnz - kfnz_min; ++i, ++isub) TriTmp[i] = zero;
+		for (; i < segsze; ++i, ++isub) {
+		    irow = lsub[isub];
+		    TriTmp[i] = dense_col[irow]; /* Gather */
+		}
+		TriTmp += ldaTmp;
+		++ncol;
+	    }
+
+	    /* start effective triangle */
+	    luptr = xlusup[fsupc] + nsupr * no_zeros + no_zeros;
 
-#ifdef USE_VENDOR_BLAS
 #ifdef _CRAY
-		    STRSV( ftcs1, ftcs2, ftcs3, &segsze, &lusup[luptr], 
-			   &nsupr, TriTmp, &incx );
+	    STRSM( ftcs1, ftcs1, ftcs2, ftcs3, &segsze, &ncol, &one,
+		   &lusup[luptr], &nsupr, tempv, &ldaTmp );
 #else
-		    dtrsv_( "L", "N", "U", (int*)&segsze, &lusup[luptr], 
-			   (int*)&nsupr, TriTmp, (int*)&incx );
-#endif
-#else		
-		    dlsolve ( nsupr, segsze, &lusup[luptr], TriTmp );
+	    dtrsm_( "L", "L", "N", "U", (int*)&segsze, (int*)&ncol, &one,
+		    &lusup[luptr], (int*)&nsupr, tempv, (int*)&ldaTmp );
 #endif
-		    
-
-		} /* else ... */
-	    
-	    }  /* for jj ... end tri-solves */
 
 	    /* Block row updates; push all the way into dense[*] block */
+	    MatvecTmp = &tempv[maxsuper];
 	    for ( r_ind = 0; r_ind < nrow; r_ind += rowblk ) {
 		
 		r_hi = SUPERLU_MIN(nrow, r_ind + rowblk);
 		block_nrow = SUPERLU_MIN(rowblk, r_hi - r_ind);
-		luptr = xlusup[fsupc] + nsupc + r_ind;
+		luptr1 = xlusup[fsupc] + nsupc + r_ind + nsupr * no_zeros;
 		isub1 = lptr + nsupc + r_ind;
 		
-		repfnz_col = repfnz;
-		TriTmp = tempv;
-		dense_col = dense;
-		
-		/* Sequence through each column in panel -- matrix-vector */
-		for (jj = jcol; jj < jcol + w; jj++,
-		     repfnz_col += m, dense_col += m, TriTmp += ldaTmp) {
-		    
-		    kfnz = repfnz_col[krep];
-		    if ( kfnz == EMPTY ) continue; /* Skip any zero segment */
-		    
-		    segsze = krep - kfnz + 1;
-		    if ( segsze <= 3 ) continue;   /* skip unrolled cases */
-		    
-		    /* Perform a block update, and scatter the result of
-		       matrix-vector to dense[].		 */
-		    no_zeros = kfnz - fsupc;
-		    luptr1 = luptr + nsupr * no_zeros;
-		    MatvecTmp = &TriTmp[maxsuper];
-		    
-#ifdef USE_VENDOR_BLAS
-		    alpha = one; 
-                    beta = zero;
 #ifdef _CRAY
-		    SGEMV(ftcs2, &block_nrow, &segsze, &alpha, &lusup[luptr1], 
-			   &nsupr, TriTmp, &incx, &beta, MatvecTmp, &incy);
-#else
-		    dgemv_("N", (int*)&block_nrow, (int*)&segsze, &alpha, &lusup[luptr1], 
-			   (int*)&nsupr, TriTmp, (int*)&incx, &beta, MatvecTmp, (int*)&incy);
-#endif
+		SGEMM( ftcs2, ftcs2, &block_nrow, &ncol, &segsze, &one,
+		       &lusup[luptr1], &nsupr, tempv, &ldaTmp,
+		       &zero, MatvecTmp, &ldaTmp );
 #else
-		    dmatvec(nsupr, block_nrow, segsze, &lusup[luptr1],
-			   TriTmp, MatvecTmp);
+		dgemm_( "N", "N", (int*)&block_nrow, (int*)&ncol, (int*)&segsze,
+			&one, &lusup[luptr1], (int*)&nsupr, tempv,
+			(int*)&ldaTmp, &zero, MatvecTmp, (int*)&ldaTmp );
 #endif
 		    
-		    /* Scatter MatvecTmp[*] into SPA dense[*] temporarily
-		     * such that MatvecTmp[*] can be re-used for the
-		     * the next blok row update. dense[] will be copied into 
-		     * global store after the whole panel has been finished.
-		     */
+		/* Scatter MatvecTmp[*] into SPA dense[*] temporarily
+		 * such that MatvecTmp[*] can be re-used for the
+		 * the next blok row update. dense[] will be copied into 
+		 * global store after the whole panel has been finished.
+		 */
+		repfnz_col = repfnz;
+		dense_col = dense;
+		TriTmp = MatvecTmp;
+		for (jj = jcol; jj < jcol + w; jj++,
+		     repfnz_col += m, dense_col += m) {
+		    kfnz = repfnz_col[krep];
+		    if ( kfnz == EMPTY || krep - kfnz < 3 ) continue;
+
 		    isub = isub1;
 		    for (i = 0; i < block_nrow; i++) {
 			irow = lsub[isub];
-			dense_col[irow] -= MatvecTmp[i];
-			MatvecTmp[i] = zero;
+			dense_col[irow] -= TriTmp[i];
+			TriTmp[i] = zero;
 			++isub;
 		    }
+		    TriTmp += ldaTmp;
 		    
 		} /* for jj ... */
 		
@@ -299,21 +297,20 @@ dpanel_bmod (
 	    dense_col = dense;
 	    
 	    for (jj = jcol; jj < jcol + w; jj++,
-		 repfnz_col += m, dense_col += m, TriTmp += ldaTmp) {
+		 repfnz_col += m, dense_col += m) {
 		kfnz = repfnz_col[krep];
-		if ( kfnz == EMPTY ) continue; /* Skip any zero segment */
-		
-		segsze = krep - kfnz + 1;
-		if ( segsze <= 3 ) continue; /* skip unrolled cases */
+		if ( kfnz == EMPTY || krep - kfnz < 3 ) continue;
 		
-		no_zeros = kfnz - fsupc;		
 		isub = lptr + no_zeros;
 		for (i = 0; i < segsze; i++) {
-		    irow = lsub[isub];
-		    dense_col[irow] = TriTmp[i];
+		    if ( i >= kfnz - kfnz_min ) {
+			irow = lsub[isub];
+			dense_col[irow] = TriTmp[i];
+		    }
 		    TriTmp[i] = zero;
 		    ++isub;
 		}
+		TriTmp += ldaTmp;
 		
 	    } /* for jj ... */
 	    
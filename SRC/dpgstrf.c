@@ -0,0 +1,354 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dpgstrf.c
+ * \brief Threaded LU factorization over independent etree subtrees
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "slu_ddefs.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*! \brief Factorization state of one subtree of the column etree */
+typedef struct {
+    int_t  fcol, lcol;    /* first and last column of the subtree */
+    int_t  tid;           /* thread that factored it */
+    int_t  nextl;         /* lengths used in the private lsub, */
+    int_t  nextlu;        /*   lusup, */
+    int_t  nextu;         /*   and ucol/usub */
+    int_t  usepr;         /* the input perm_r was kept throughout */
+    int_t  iinfo;         /* first zero pivot, or 0 */
+    int_t  info;          /* memory allocation failure, or 0 */
+    GlobalLU_t Glu;       /* private L\U storage */
+} dsubtree_t;
+
+/* Column-indexed arrays of one thread, n+2 entries each. */
+#define T_XSUP(t)    ( (t) )
+#define T_SUPNO(t)   ( (t) + (n+2) )
+#define T_XLSUB(t)   ( (t) + 2*(n+2) )
+#define T_XLUSUP(t)  ( (t) + 3*(n+2) )
+#define T_XUSUB(t)   ( (t) + 4*(n+2) )
+
+static void
+dfactor_subtree(superlu_options_t *options, SuperMatrix *A, int_t panel_size,
+		int_t *relax_end, int_t *perm_r, int_t *iperm_r,
+		int_t *iperm_c, int_t usepr, dsubtree_t *t, int_t *tcols,
+		dLUWork_t *wk, SuperLUStat_t *stat)
+{
+    NCPformat *Astore = A->Store;
+    GlobalLU_t *Glu = &t->Glu;
+    int_t  n = A->ncol, fcol = t->fcol, lcol = t->lcol, annz = 0, j;
+
+    for (j = fcol; j <= lcol; ++j)
+	annz += Astore->colend[j] - Astore->colbeg[j];
+
+    t->iinfo = 0;
+    t->usepr = usepr;
+    t->info  = dLUSubtreeMemInit(n, annz, sp_ienv(6), Glu);
+    if ( t->info ) return;
+
+    Glu->xsup   = T_XSUP(tcols);
+    Glu->supno  = T_SUPNO(tcols);
+    Glu->xlsub  = T_XLSUB(tcols);
+    Glu->xlusup = T_XLUSUP(tcols);
+    Glu->xusub  = T_XUSUB(tcols);
+
+    /* Supernodes are numbered from 0 within the subtree. */
+    Glu->supno[fcol] = -1;
+    Glu->xsup[0] = fcol;
+    Glu->xlsub[fcol] = Glu->xlusup[fcol] = Glu->xusub[fcol] = 0;
+
+    t->info = dgstrf_cols(options, A, fcol, lcol + 1, panel_size, relax_end,
+			  perm_r, iperm_r, iperm_c, &t->usepr, wk, Glu, stat,
+			  &t->iinfo);
+
+    t->nextl  = Glu->xlsub[lcol + 1];
+    t->nextlu = Glu->xlusup[lcol + 1];
+    t->nextu  = Glu->xusub[lcol + 1];
+}
+
+/*! \brief Append the factors of a subtree to the global L\U storage.
+ *
+ * <pre>
+ * On return Glu and xprune[] are in the same state as if the columns of
+ * the subtree had been factored in place by dgstrf_cols().
+ * </pre>
+ */
+static int_t
+dmerge_subtree(dsubtree_t *t, int_t *tcols, int_t *txprune, int_t *relax_end,
+	       int_t m, int_t n, dLUWork_t *wk, GlobalLU_t *Glu)
+{
+    int_t  *supno_t  = T_SUPNO(tcols), *xlsub_t = T_XLSUB(tcols);
+    int_t  *xlusup_t = T_XLUSUP(tcols), *xusub_t = T_XUSUB(tcols);
+    int_t  *xsup = Glu->xsup, *supno = Glu->supno;
+    int_t  *xlsub = Glu->xlsub, *xlusup = Glu->xlusup, *xusub = Glu->xusub;
+    int_t  fcol = t->fcol, lcol = t->lcol;
+    int_t  nextl, nextlu, nextu, nsuper, maxlen, info, j, k;
+    int_t  *marker2;
+
+    nextl  = xlsub[fcol];
+    nextlu = xlusup[fcol];
+    nextu  = xusub[fcol];
+    nsuper = supno[fcol] + 1;   /* first new supernode */
+
+    /* Make room for the subtree */
+    maxlen = Glu->nzlmax;
+    while ( nextl + t->nextl > maxlen )
+	if ( (info = dLUMemXpand(fcol, nextl, LSUB, &maxlen, Glu)) )
+	    return info;
+    maxlen = Glu->nzlumax;
+    while ( nextlu + t->nextlu > maxlen )
+	if ( (info = dLUMemXpand(fcol, nextlu, LUSUP, &maxlen, Glu)) )
+	    return info;
+    maxlen = Glu->nzumax;
+    while ( nextu + t->nextu > maxlen ) {
+	if ( (info = dLUMemXpand(fcol, nextu, UCOL, &maxlen, Glu)) )
+	    return info;
+	if ( (info = dLUMemXpand(fcol, nextu, USUB, &maxlen, Glu)) )
+	    return info;
+    }
+
+    memcpy(&Glu->lsub[nextl], t->Glu.lsub, t->nextl * sizeof(int_t));
+    memcpy(&((double *) Glu->lusup)[nextlu], t->Glu.lusup,
+	   t->nextlu * sizeof(double));
+    memcpy(&((double *) Glu->ucol)[nextu], t->Glu.ucol,
+	   t->nextu * sizeof(double));
+    memcpy(&Glu->usub[nextu], t->Glu.usub, t->nextu * sizeof(int_t));
+
+    /* Shift the column pointers and renumber the supernodes. The entries
+       of column fcol are not read, since the end pointers of a subtree
+       ending at fcol-1 and later factored by the same thread overwrite
+       them; the subtree starts a new supernode at offset 0. */
+    xlsub[fcol]  = nextl;
+    xlusup[fcol] = nextlu;
+    xusub[fcol]  = nextu;
+    wk->xprune[fcol] = txprune[fcol] + nextl;
+    supno[fcol]  = nsuper;
+    xsup[nsuper] = fcol;
+    for (j = fcol + 1; j <= lcol; ++j) {
+	xlsub[j]  = xlsub_t[j] + nextl;
+	xlusup[j] = xlusup_t[j] + nextlu;
+	xusub[j]  = xusub_t[j] + nextu;
+	wk->xprune[j] = txprune[j] + nextl;
+	supno[j]  = supno_t[j] + nsuper;
+	if ( supno[j] != supno[j-1] ) xsup[supno[j]] = j;
+    }
+    xlsub[lcol+1]  = nextl + t->nextl;
+    xlusup[lcol+1] = nextlu + t->nextlu;
+    xusub[lcol+1]  = nextu + t->nextu;
+    supno[lcol+1]  = supno[lcol];
+    xsup[supno[lcol]+1] = lcol + 1;
+
+    /* dcolumn_dfs() lets column lcol+1 join the supernode of lcol when
+       their row structures nest; it detects this through marker2[],
+       so mark the rows of L(:,lcol) as if lcol was factored here. */
+    if ( relax_end[xsup[supno[lcol]]] != lcol ) {
+	marker2 = &wk->marker[2*m];
+	for (k = xlsub[lcol]; k < xlsub[lcol+1]; ++k)
+	    marker2[Glu->lsub[k]] = lcol;
+    }
+
+    Glu->num_expansions += t->Glu.num_expansions - 1;
+    dLUSubtreeMemFree(&t->Glu);
+    return 0;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DPGSTRF factors the columns of A with options->nthreads threads.
+ *
+ * Disjoint subtrees of the column elimination tree touch disjoint rows
+ * of A, so their columns of L and U, and their pivots, can be computed
+ * independently. The maximal subtrees of at most n/(4*nthreads) columns
+ * are factored as tasks into private storage, each thread taking the
+ * largest remaining task from a shared queue. Each thread has its own
+ * SPA and marker workspace. The remaining columns near the root of the
+ * etree are then factored in order by the calling thread, with the
+ * private factors of each subtree appended to Glu as its first column
+ * is reached. The resulting L and U are those of the serial factorization
+ * up to rounding, in a different storage order.
+ *
+ * The etree must be the postordered column etree of A, as computed by
+ * sp_preorder(). Storage must be system malloc'd. Without OpenMP the
+ * tasks are run one after the other by the calling thread.
+ *
+ * The arguments are as for dgstrf_cols(), with etree the column
+ * elimination tree and wk the working arrays of the calling thread.
+ * </pre>
+ */
+int_t
+dpgstrf(superlu_options_t *options, SuperMatrix *A, int_t panel_size,
+	int_t *relax_end, int_t *etree, int_t *perm_r, int_t *iperm_r,
+	int_t *iperm_c, int_t *usepr, dLUWork_t *wk, GlobalLU_t *Glu,
+	SuperLUStat_t *stat, int_t *iinfo)
+{
+    int_t  m = A->nrow, n = A->ncol;
+    int_t  nthreads = options->nthreads, nworkers;
+    int_t  relax = sp_ienv(2), w;
+    int_t  ntasks, maxsize, minsize;
+    int_t  *tfirst, *tlast, *tstart, *tcols;
+    int_t  jcol, jnext, i, j, k, next, info = 0, tinfo;
+    dsubtree_t    *tasks;
+    dLUWork_t     *twk;
+    SuperLUStat_t *tstat;
+    GlobalLU_t    dummy; /* only its MemModel and work are used */
+
+    /* Choose the subtrees */
+    tfirst  = intMalloc(n);
+    tlast   = intMalloc(n);
+    minsize = SUPERLU_MAX(relax, 1);
+    maxsize = SUPERLU_MAX(relax, n / (4 * nthreads));
+    ntasks  = etree_subtrees(n, etree, minsize, maxsize, tfirst, tlast);
+
+    /* A subtree must start with a relaxed supernode inside it, so that
+       its first column does not depend on the column before. */
+    for (i = k = 0; i < ntasks; ++i) {
+	j = relax_end[tfirst[i]];
+	if ( j != EMPTY && j <= tlast[i] ) {
+	    tfirst[k] = tfirst[i];
+	    tlast[k++] = tlast[i];
+	}
+    }
+    ntasks = k;
+
+    if ( ntasks == 0 ) {
+	SUPERLU_FREE (tfirst);
+	SUPERLU_FREE (tlast);
+	return dgstrf_cols(options, A, 0, n, panel_size, relax_end, perm_r,
+			   iperm_r, iperm_c, usepr, wk, Glu, stat, iinfo);
+    }
+
+#ifdef _OPENMP
+    nworkers = SUPERLU_MIN(nthreads, ntasks);
+#else
+    nworkers = 1;
+#endif
+
+    tasks = (dsubtree_t *) SUPERLU_MALLOC(ntasks * sizeof(dsubtree_t));
+    if ( !tasks ) ABORT("SUPERLU_MALLOC fails for tasks[]");
+    for (k = 0; k < ntasks; ++k) {
+	tasks[k].fcol = tfirst[k];
+	tasks[k].lcol = tlast[k];
+	tasks[k].info = 0;
+	tasks[k].Glu.expanders = NULL;
+	tasks[k].Glu.amalg = Glu->amalg;
+    }
+
+    /* Per-thread workspace */
+    tcols = intCalloc(nworkers * 5 * (n+2));
+    twk   = (dLUWork_t *) SUPERLU_MALLOC(nworkers * sizeof(dLUWork_t));
+    tstat = (SuperLUStat_t *) SUPERLU_MALLOC(nworkers * sizeof(SuperLUStat_t));
+    if ( !twk || !tstat ) ABORT("SUPERLU_MALLOC fails for thread workspace");
+    dummy.MemModel = SYSTEM;
+    dummy.work = NULL;
+    for (i = 0; i < nworkers; ++i) {
+	if ( (info = dLUWorkInit(m, n, panel_size, &twk[i].iwork,
+				 &twk[i].dwork, &dummy)) ) {
+	    nworkers = i;
+	    goto cleanup;
+	}
+	SetIWork(m, n, panel_size, twk[i].iwork, &twk[i].segrep,
+		 &twk[i].parent, &twk[i].xplore, &twk[i].repfnz,
+		 &twk[i].panel_lsub, &twk[i].xprune, &twk[i].marker);
+	dSetRWork(m, panel_size, twk[i].dwork, &twk[i].dense, &twk[i].tempv);
+	ifill (twk[i].marker, m * NO_MARKER, EMPTY);
+	StatInit(&tstat[i]);
+    }
+
+    /* Factor the subtrees, largest first. */
+    next = 0;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nworkers) private(k)
+#endif
+    {
+	int_t tid = 0;
+#ifdef _OPENMP
+	tid = omp_get_thread_num();
+#endif
+	for (;;) {
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+	    k = next++;
+	    if ( k >= ntasks ) break;
+	    tasks[k].tid = tid;
+	    dfactor_subtree(options, A, panel_size, relax_end, perm_r,
+			    iperm_r, iperm_c, *usepr, &tasks[k],
+			    &tcols[tid * 5 * (n+2)], &twk[tid], &tstat[tid]);
+	}
+    }
+
+    /* Accumulate the statistics of the threads. */
+    w = SUPERLU_MAX(sp_ienv(1), relax);
+    for (i = 0; i < nworkers; ++i) {
+	for (j = 0; j < NPHASES; ++j) stat->ops[j] += tstat[i].ops[j];
+	for (j = 0; j <= w; ++j) stat->panel_histo[j] += tstat[i].panel_histo[j];
+	stat->TinyPivots += tstat[i].TinyPivots;
+    }
+
+    tinfo = 0;
+    for (k = 0; k < ntasks; ++k) {
+	if ( tasks[k].info && !info ) info = tasks[k].info;
+	if ( tasks[k].iinfo && (!tinfo || tasks[k].iinfo < tinfo) )
+	    tinfo = tasks[k].iinfo;
+	if ( !tasks[k].usepr ) *usepr = 0;
+    }
+
+    /* Factor the top of the etree, merging the subtrees in order. */
+    if ( !info ) {
+	tstart = intMalloc(n);
+	ifill (tstart, n, EMPTY);
+	for (k = 0; k < ntasks; ++k) tstart[tasks[k].fcol] = k;
+
+	for (jcol = 0; jcol < n && !info; jcol = jnext) {
+	    if ( (k = tstart[jcol]) != EMPTY ) {
+		i = tasks[k].tid;
+		info = dmerge_subtree(&tasks[k], &tcols[i * 5 * (n+2)],
+				      twk[i].xprune, relax_end, m, n, wk, Glu);
+		jnext = tasks[k].lcol + 1;
+	    } else {
+		for (jnext = jcol + 1; jnext < n && tstart[jnext] == EMPTY;
+		     ++jnext) ;
+		info = dgstrf_cols(options, A, jcol, jnext, panel_size,
+				   relax_end, perm_r, iperm_r, iperm_c, usepr,
+				   wk, Glu, stat, iinfo);
+	    }
+	}
+	SUPERLU_FREE (tstart);
+    }
+    if ( tinfo && (*iinfo == 0 || tinfo < *iinfo) ) *iinfo = tinfo;
+
+cleanup:
+    for (i = 0; i < nworkers; ++i) {
+	SUPERLU_FREE (twk[i].iwork);
+	SUPERLU_FREE (twk[i].dwork);
+	StatFree(&tstat[i]);
+    }
+    for (k = 0; k < ntasks; ++k)
+	if ( tasks[k].Glu.expanders ) dLUSubtreeMemFree(&tasks[k].Glu);
+    SUPERLU_FREE (tasks);
+    SUPERLU_FREE (tcols);
+    SUPERLU_FREE (twk);
+    SUPERLU_FREE (tstat);
+    SUPERLU_FREE (tfirst);
+    SUPERLU_FREE (tlast);
+    return info;
+}
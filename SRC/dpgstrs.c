@@ -0,0 +1,429 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dpgstrs.c
+ * \brief Threaded triangular solves with the L and U factors
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "slu_ddefs.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*! \brief Sort the supernodes 0..nsuper by level.
+ *
+ * <pre>
+ * On return, the supernodes of level l are order[levptr[l]:levptr[l+1]-1],
+ * in the order in which they were listed in sup[]. Returns the number
+ * of levels.
+ * </pre>
+ */
+static int_t
+dsort_levels(int_t nsuper, int_t *lev, int_t *sup, int_t *levptr,
+	     int_t *order)
+{
+    int_t k, l, nlevels = 0;
+
+    for (k = 0; k <= nsuper; ++k) nlevels = SUPERLU_MAX(nlevels, lev[k] + 1);
+    for (l = 0; l <= nlevels; ++l) levptr[l] = 0;
+    for (k = 0; k <= nsuper; ++k) ++levptr[lev[k] + 1];
+    for (l = 0; l < nlevels; ++l) levptr[l + 1] += levptr[l];
+    for (k = 0; k <= nsuper; ++k) order[levptr[lev[sup[k]]]++] = sup[k];
+    for (l = nlevels; l > 0; --l) levptr[l] = levptr[l - 1];
+    levptr[0] = 0;
+    return nlevels;
+}
+
+/*! \brief Forward solve with supernode k for nrhs columns of B.
+ *
+ * <pre>
+ * The updates of the rows below the supernode are subtracted from X,
+ * which is either B or an accumulator private to the calling thread.
+ * </pre>
+ */
+static void
+dlsolve_super(int_t k, SCformat *Lstore, int_t nrhs, double *Bmat,
+	      int_t ldb, double *X, double *work, int_t ldw)
+{
+    double  *Lval = Lstore->nzval;
+    double  alpha = 1.0, beta = 0.0;
+    double  *rhs_work, *work_col, ukj;
+    int_t   fsupc, istart, nsupr, nsupc, nrow, luptr, irow, iptr, i, j;
+
+    fsupc  = L_FST_SUPC(k);
+    istart = L_SUB_START(fsupc);
+    nsupr  = L_SUB_START(fsupc+1) - istart;
+    nsupc  = L_FST_SUPC(k+1) - fsupc;
+    nrow   = nsupr - nsupc;
+    luptr  = L_NZ_START(fsupc);
+
+    if ( nsupc == 1 ) {
+	for (j = 0; j < nrhs; j++) {
+	    rhs_work = &X[(size_t)j * (size_t)ldb];
+	    ukj = Bmat[(size_t)fsupc + (size_t)j * (size_t)ldb];
+	    for (iptr = istart + 1, i = luptr + 1; iptr < istart + nsupr;
+		 iptr++, i++) {
+		irow = L_SUB(iptr);
+		rhs_work[irow] -= ukj * Lval[i];
+	    }
+	}
+	return;
+    }
+
+    dtrsm_("L", "L", "N", "U", (int*)&nsupc, (int*)&nrhs, &alpha,
+	   &Lval[luptr], (int*)&nsupr, &Bmat[fsupc], (int*)&ldb);
+    if ( nrow == 0 ) return;
+    dgemm_("N", "N", (int*)&nrow, (int*)&nrhs, (int*)&nsupc, &alpha,
+	   &Lval[luptr+nsupc], (int*)&nsupr, &Bmat[fsupc], (int*)&ldb,
+	   &beta, work, (int*)&ldw);
+
+    for (j = 0; j < nrhs; j++) {
+	rhs_work = &X[(size_t)j * (size_t)ldb];
+	work_col = &work[(size_t)j * (size_t)ldw];
+	for (i = 0, iptr = istart + nsupc; i < nrow; i++, iptr++) {
+	    irow = L_SUB(iptr);
+	    rhs_work[irow] -= work_col[i];
+	}
+    }
+}
+
+/*! \brief Add the accumulated updates of rows fsupc:fsupc+nsupc-1 to B.
+ *
+ * <pre>
+ * acc[] holds nthreads accumulators of size ldb*nrhs; the rows that are
+ * gathered are reset to zero.
+ * </pre>
+ */
+static void
+dgather_acc(int_t fsupc, int_t nsupc, int_t nrhs, double *Bmat, int_t ldb,
+	    double *acc, int_t nthreads, size_t accsize)
+{
+    double *a, *b;
+    int_t  t, i, j;
+
+    for (t = 0; t < nthreads; ++t) {
+	for (j = 0; j < nrhs; ++j) {
+	    a = &acc[t * accsize + (size_t)fsupc + (size_t)j * (size_t)ldb];
+	    b = &Bmat[(size_t)fsupc + (size_t)j * (size_t)ldb];
+	    for (i = 0; i < nsupc; ++i) {
+		b[i] += a[i];
+		a[i] = 0.0;
+	    }
+	}
+    }
+}
+
+/*! \brief Back solve with supernode k for nrhs columns of B.
+ *
+ * <pre>
+ * The updates of the rows above the supernode are subtracted from X,
+ * as in dlsolve_super().
+ * </pre>
+ */
+static void
+dusolve_super(int_t k, SCformat *Lstore, NCformat *Ustore, int_t nrhs,
+	      double *Bmat, int_t ldb, double *X)
+{
+    double  *Lval = Lstore->nzval, *Uval = Ustore->nzval;
+    double  alpha = 1.0;
+    double  *rhs_work, xj;
+    int_t   fsupc, nsupr, nsupc, luptr, irow, jcol, i, j;
+
+    fsupc = L_FST_SUPC(k);
+    nsupr = L_SUB_START(fsupc+1) - L_SUB_START(fsupc);
+    nsupc = L_FST_SUPC(k+1) - fsupc;
+    luptr = L_NZ_START(fsupc);
+
+    if ( nsupc == 1 ) {
+	for (j = 0; j < nrhs; j++)
+	    Bmat[(size_t)fsupc + (size_t)j * (size_t)ldb] /= Lval[luptr];
+    } else {
+	dtrsm_("L", "U", "N", "N", (int*)&nsupc, (int*)&nrhs, &alpha,
+	       &Lval[luptr], (int*)&nsupr, &Bmat[fsupc], (int*)&ldb);
+    }
+
+    for (j = 0; j < nrhs; ++j) {
+	rhs_work = &X[(size_t)j * (size_t)ldb];
+	for (jcol = fsupc; jcol < fsupc + nsupc; jcol++) {
+	    xj = Bmat[(size_t)jcol + (size_t)j * (size_t)ldb];
+	    for (i = U_NZ_START(jcol); i < U_NZ_START(jcol+1); i++ ) {
+		irow = U_SUB(i);
+		rhs_work[irow] -= xj * Uval[i];
+	    }
+	}
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DPGSTRS solves a system of linear equations A*X=B or A'*X=B with the
+ * LU factorization computed by DGSTRF, using options->nthreads threads.
+ * It gives the same result as DGSTRS, up to rounding.
+ *
+ * By default the supernodes are sorted into level sets: supernode k of
+ * the forward (backward) solve has a level one higher than every
+ * supernode whose L (U) columns update its rows. The supernodes of a
+ * level are solved concurrently, for all right-hand sides at once. Their
+ * updates are summed in an accumulator of the size of B per thread, which
+ * is added to B when the updated rows are solved. When a level has fewer
+ * supernodes than threads, the right-hand sides are also divided among
+ * the threads. The transposed systems are solved by DGSTRS.
+ *
+ * If options->SplitRHS = YES and B has more than one column, the columns
+ * of B are divided among the threads instead, and each block is solved
+ * by DGSTRS. This needs no synchronization, and is the faster mode for
+ * many right-hand sides.
+ *
+ * Without OpenMP, or if options->nthreads <= 1, DGSTRS is called.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_options_t*
+ *         Only nthreads and SplitRHS are used.
+ *
+ * The other arguments are as for DGSTRS.
+ * </pre>
+ */
+void
+dpgstrs (superlu_options_t *options, trans_t trans, SuperMatrix *L,
+	 SuperMatrix *U, int_t *perm_c, int_t *perm_r, SuperMatrix *B,
+	 SuperLUStat_t *stat, int_t *info)
+{
+    DNformat *Bstore;
+    SCformat *Lstore;
+    NCformat *Ustore;
+    double   *Bmat, *acc, *work, *soln;
+    int_t    *supno, *lev, *sup, *levL, *ordL, *levU, *ordU;
+    int_t    nlevL, nlevU, nthreads, nsuper, n, ldb, ldw, nrhs;
+    int_t    fsupc, istart, nsupr, nsupc, iptr, jcol, i, k, s;
+    size_t   accsize;
+    flops_t  solve_ops;
+
+    /* Test input parameters ... */
+    *info = 0;
+    Bstore = B->Store;
+    ldb = Bstore->lda;
+    nrhs = B->ncol;
+    if ( trans != NOTRANS && trans != TRANS && trans != CONJ ) *info = -2;
+    else if ( L->nrow != L->ncol || L->nrow < 0 ||
+	      L->Stype != SLU_SC || L->Dtype != SLU_D || L->Mtype != SLU_TRLU )
+	*info = -3;
+    else if ( U->nrow != U->ncol || U->nrow < 0 ||
+	      U->Stype != SLU_NC || U->Dtype != SLU_D || U->Mtype != SLU_TRU )
+	*info = -4;
+    else if ( ldb < SUPERLU_MAX(0, L->nrow) ||
+	      B->Stype != SLU_DN || B->Dtype != SLU_D || B->Mtype != SLU_GE )
+	*info = -7;
+    if ( *info ) {
+	i = -(*info);
+	input_error("dpgstrs", (int*)&i);
+	return;
+    }
+
+    nthreads = options->nthreads;
+#ifndef _OPENMP
+    nthreads = 1;
+#endif
+    n = L->nrow;
+    if ( nthreads <= 1 || n == 0 || nrhs == 0 ||
+	 (trans != NOTRANS && (options->SplitRHS == NO || nrhs == 1)) ) {
+	dgstrs(trans, L, U, perm_c, perm_r, B, stat, info);
+	return;
+    }
+
+    Bmat = Bstore->nzval;
+
+    if ( options->SplitRHS == YES && nrhs > 1 ) {
+	int_t nparts = SUPERLU_MIN(nthreads, nrhs), p;
+
+	solve_ops = 0;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nparts) schedule(static) reduction(+:solve_ops)
+#endif
+	for (p = 0; p < nparts; ++p) {
+	    SuperMatrix   Bp;
+	    SuperLUStat_t statp;
+	    flops_t       ops[NPHASES];
+	    int_t         j0 = p * nrhs / nparts, j1 = (p + 1) * nrhs / nparts;
+	    int_t         iinfo, j;
+
+	    for (j = 0; j < NPHASES; ++j) ops[j] = 0;
+	    statp.ops = ops;
+	    dCreate_Dense_Matrix(&Bp, n, j1 - j0, &Bmat[(size_t)j0 * ldb],
+				 ldb, SLU_DN, SLU_D, SLU_GE);
+	    dgstrs(trans, L, U, perm_c, perm_r, &Bp, &statp, &iinfo);
+	    Destroy_SuperMatrix_Store(&Bp);
+	    solve_ops += ops[SOLVE];
+	}
+	stat->ops[SOLVE] = solve_ops;
+	return;
+    }
+
+    Lstore = L->Store;
+    Ustore = U->Store;
+    supno  = Lstore->col_to_sup;
+    nsuper = Lstore->nsuper;
+
+    lev  = intMalloc(nsuper + 1);
+    sup  = intMalloc(nsuper + 1);
+    levL = intMalloc(nsuper + 2);
+    ordL = intMalloc(nsuper + 1);
+    levU = intMalloc(nsuper + 2);
+    ordU = intMalloc(nsuper + 1);
+
+    /* Levels of the forward solve: the rows of L(:,k) below the diagonal
+       block are in supernodes that must wait for k. */
+    solve_ops = 0;
+    ldw = 1;
+    ifill (lev, nsuper + 1, 0);
+    for (k = 0; k <= nsuper; k++) {
+	fsupc  = L_FST_SUPC(k);
+	istart = L_SUB_START(fsupc);
+	nsupr  = L_SUB_START(fsupc+1) - istart;
+	nsupc  = L_FST_SUPC(k+1) - fsupc;
+	solve_ops += nsupc * (nsupc - 1) * nrhs;
+	solve_ops += 2 * (nsupr - nsupc) * nsupc * nrhs;
+	ldw = SUPERLU_MAX(ldw, nsupr - nsupc);
+	for (iptr = istart + nsupc; iptr < istart + nsupr; iptr++) {
+	    s = supno[L_SUB(iptr)];
+	    if ( lev[s] <= lev[k] ) lev[s] = lev[k] + 1;
+	}
+	sup[k] = k;
+    }
+    nlevL = dsort_levels(nsuper, lev, sup, levL, ordL);
+
+    /* Levels of the back solve: the rows of U(:,fsupc:lsupc) are in
+       supernodes that must wait for k. */
+    ifill (lev, nsuper + 1, 0);
+    for (k = nsuper; k >= 0; k--) {
+	fsupc = L_FST_SUPC(k);
+	nsupc = L_FST_SUPC(k+1) - fsupc;
+	solve_ops += nsupc * (nsupc + 1) * nrhs;
+	for (jcol = fsupc; jcol < fsupc + nsupc; jcol++) {
+	    solve_ops += 2 * (U_NZ_START(jcol+1) - U_NZ_START(jcol)) * nrhs;
+	    for (i = U_NZ_START(jcol); i < U_NZ_START(jcol+1); i++) {
+		s = supno[U_SUB(i)];
+		if ( lev[s] <= lev[k] ) lev[s] = lev[k] + 1;
+	    }
+	}
+	sup[nsuper - k] = k;
+    }
+    nlevU = dsort_levels(nsuper, lev, sup, levU, ordU);
+
+    /* Updates from supernodes that share a level go to accumulators
+       private to each thread, and are added to B just before the rows
+       they update are solved. */
+    accsize = (size_t) ldb * nrhs;
+    acc = doubleCalloc((size_t) nthreads * accsize);
+    if ( !acc ) ABORT("Malloc fails for acc[].");
+    work = doubleMalloc((size_t) nthreads * ldw * nrhs);
+    if ( !work ) ABORT("Malloc fails for local work[].");
+    soln = doubleMalloc((size_t) nthreads * n);
+    if ( !soln ) ABORT("Malloc fails for local soln[].");
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+	int_t  tid = 0, l, q, cnt, nchunks, ks, fst, j, j0, j1, kk;
+	double *wk, *sol, *myacc, *rhs_work, *Bj;
+
+#ifdef _OPENMP
+	tid = omp_get_thread_num();
+#endif
+	wk    = &work[(size_t) tid * ldw * nrhs];
+	sol   = &soln[(size_t) tid * n];
+	myacc = &acc[tid * accsize];
+
+	/* Permute right hand sides to form Pr*B */
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+	for (j = 0; j < nrhs; j++) {
+	    rhs_work = &Bmat[(size_t)j * (size_t)ldb];
+	    for (kk = 0; kk < n; kk++) sol[perm_r[kk]] = rhs_work[kk];
+	    for (kk = 0; kk < n; kk++) rhs_work[kk] = sol[kk];
+	}
+
+	/* Forward solve PLy=Pb, one level at a time. A supernode solve
+	   is split by columns of B if the level is too narrow. */
+	for (l = 0; l < nlevL; ++l) {
+	    cnt = levL[l+1] - levL[l];
+	    nchunks = SUPERLU_MIN(nrhs, (nthreads + cnt - 1) / cnt);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+	    for (q = 0; q < cnt * nchunks; ++q) {
+		ks = ordL[levL[l] + q / nchunks];
+		fst = L_FST_SUPC(ks);
+		j0 = (q % nchunks) * nrhs / nchunks;
+		j1 = (q % nchunks + 1) * nrhs / nchunks;
+		Bj = &Bmat[(size_t)j0 * ldb];
+		dgather_acc(fst, L_FST_SUPC(ks+1) - fst, j1 - j0, Bj, ldb,
+			    &acc[(size_t)j0 * ldb], nthreads, accsize);
+		dlsolve_super(ks, Lstore, j1 - j0, Bj, ldb,
+			      cnt > 1 ? &myacc[(size_t)j0 * ldb] : Bj, wk, ldw);
+	    }
+	}
+
+	/* Back solve Ux=y. */
+	for (l = 0; l < nlevU; ++l) {
+	    cnt = levU[l+1] - levU[l];
+	    nchunks = SUPERLU_MIN(nrhs, (nthreads + cnt - 1) / cnt);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+	    for (q = 0; q < cnt * nchunks; ++q) {
+		ks = ordU[levU[l] + q / nchunks];
+		fst = L_FST_SUPC(ks);
+		j0 = (q % nchunks) * nrhs / nchunks;
+		j1 = (q % nchunks + 1) * nrhs / nchunks;
+		Bj = &Bmat[(size_t)j0 * ldb];
+		dgather_acc(fst, L_FST_SUPC(ks+1) - fst, j1 - j0, Bj, ldb,
+			    &acc[(size_t)j0 * ldb], nthreads, accsize);
+		dusolve_super(ks, Lstore, Ustore, j1 - j0, Bj, ldb,
+			      cnt > 1 ? &myacc[(size_t)j0 * ldb] : Bj);
+	    }
+	}
+
+	/* Compute the final solution X := Pc*X. */
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+	for (j = 0; j < nrhs; j++) {
+	    rhs_work = &Bmat[(size_t)j * (size_t)ldb];
+	    for (kk = 0; kk < n; kk++) sol[kk] = rhs_work[perm_c[kk]];
+	    for (kk = 0; kk < n; kk++) rhs_work[kk] = sol[kk];
+	}
+    }
+
+    stat->ops[SOLVE] = solve_ops;
+
+    SUPERLU_FREE(lev);
+    SUPERLU_FREE(sup);
+    SUPERLU_FREE(levL);
+    SUPERLU_FREE(ordL);
+    SUPERLU_FREE(levU);
+    SUPERLU_FREE(ordU);
+    SUPERLU_FREE(acc);
+    SUPERLU_FREE(work);
+    SUPERLU_FREE(soln);
+}
@@ -0,0 +1,347 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file dsgssv.c
+ * \brief Solves A*X=B with a single precision LU factorization and
+ *  double precision iterative refinement
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include <math.h>
+#include "slu_sdefs.h"
+#include "slu_ddefs.h"
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define ITERMAX 30
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * DSGSSV solves the system of linear equations A*X=B, where A and B are
+ * double precision, using a single precision LU factorization of A from
+ * SGSTRF and iterative refinement in double precision (as LAPACK DSGESV).
+ * The factors take half the memory of those from DGSTRF, and when A is
+ * not too ill-conditioned the solution has the same accuracy as from a
+ * double precision factorization.
+ *
+ * It performs the following steps:
+ *
+ *   1. Round A to single precision, and factor it as Pr*A*Pc=L*U as in
+ *      DGSSV, in single precision.
+ *
+ *   2. Solve A*X=B with the single precision factors, and refine: each
+ *      step computes R = B - A*X in double precision, solves A*D=R with
+ *      the single precision factors and updates X = X + D. A column has
+ *      converged when
+ *          norm(R, inf) < norm(X, inf) * norm(A, inf) * eps * sqrt(n),
+ *      where eps is the double precision machine epsilon.
+ *
+ *   3. If A cannot be rounded to single precision, the single precision
+ *      U is exactly singular, or the refinement stagnates or does not
+ *      converge within ITERMAX steps, the single precision factors are
+ *      discarded, and A*X=B is solved with DGSTRF and DGSTRS instead.
+ *
+ *   If A is stored row-wise (A->Stype = SLU_NR), the above is applied to
+ *   transpose(A), as in DGSSV.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_options_t*
+ *         As for DGSSV. options->Fact must be DOFACT.
+ *
+ * A       (input) SuperMatrix*
+ *         Matrix A in A*X=B, of dimension (A->nrow, A->ncol). The type of
+ *         A can be: Stype = SLU_NC or SLU_NR; Dtype = SLU_D; Mtype = SLU_GE.
+ *
+ * perm_c  (input/output) int*
+ *         As for DGSSV.
+ *
+ * perm_r  (output) int*
+ *         As for DGSSV.
+ *
+ * L       (output) SuperMatrix*
+ *         The factor L, as for DGSSV. L->Dtype = SLU_S if the single
+ *         precision factors were used (iter >= 0), and SLU_D otherwise.
+ *
+ * U       (output) SuperMatrix*
+ *         The factor U, as for DGSSV, in the same precision as L.
+ *
+ * B       (input) SuperMatrix*
+ *         The right hand side matrix. B has types: Stype = SLU_DN,
+ *         Dtype = SLU_D, Mtype = SLU_GE. B is not modified.
+ *
+ * X       (output) SuperMatrix*
+ *         The solution matrix if info = 0. X has the same types and
+ *         number of columns as B.
+ *
+ * iter    (output) int_t*
+ *         >= 0: the number of refinement steps; the single precision
+ *               factors were used.
+ *         <  0: the double precision factorization was used, because
+ *               -2: A has an entry that overflows in single precision;
+ *               -3: SGSTRF failed (U(i,i) is exactly zero or memory
+ *                   allocation failed);
+ *               -(ITERMAX+1): the refinement stagnated or did not
+ *                   converge.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         Record the statistics on runtime and floating-point operation
+ *         count. stat->RefineSteps is set to the number of refinement
+ *         steps.
+ *
+ * info    (output) int*
+ *	   = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ *         > 0: as for DGSSV, from DGSTRF.
+ * </pre>
+ */
+
+void
+dsgssv(superlu_options_t *options, SuperMatrix *A, int_t *perm_c,
+       int_t *perm_r, SuperMatrix *L, SuperMatrix *U, SuperMatrix *B,
+       SuperMatrix *X, int_t *iter, SuperLUStat_t *stat, int_t *info)
+{
+    DNformat *Bstore, *Xstore;
+    NCformat *Astore;
+    SuperMatrix *AA;/* A in SLU_NC format used by the factorization routine.*/
+    SuperMatrix AS; /* AA rounded to single precision */
+    SuperMatrix AC; /* Matrix postmultiplied by Pc */
+    SuperMatrix SR; /* right-hand sides in single precision */
+    GlobalLU_t Glu; /* Not needed on return. */
+    float    *snzval, *sr;
+    double   *Bmat, *Xmat, *R;
+    double   anorm, eps, cte, sfmax, xnrm, rnrm, ratio, ratio_old;
+    int_t    lwork = 0, *etree, panel_size, relax, permc_spec;
+    int_t    i, j, n, nrhs, ldb, ldx, nnz, it, done;
+    trans_t  trans = NOTRANS;
+    char     *rtrans;
+    double   *utime;
+    double   t;	/* Temporary time */
+#if defined(__SSE__)
+    unsigned int csr = _mm_getcsr();
+#endif
+    extern double dlangs(char *, SuperMatrix *);
+
+    /* Test the input parameters ... */
+    *info = 0;
+    Bstore = B->Store;
+    Xstore = X->Store;
+    if ( options->Fact != DOFACT ) *info = -1;
+    else if ( A->nrow != A->ncol || A->nrow < 0 ||
+	 (A->Stype != SLU_NC && A->Stype != SLU_NR) ||
+	 A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	*info = -2;
+    else if ( B->ncol < 0 || Bstore->lda < SUPERLU_MAX(0, A->nrow) ||
+	B->Stype != SLU_DN || B->Dtype != SLU_D || B->Mtype != SLU_GE )
+	*info = -7;
+    else if ( X->ncol != B->ncol || Xstore->lda < SUPERLU_MAX(0, A->nrow) ||
+	X->Stype != SLU_DN || X->Dtype != SLU_D || X->Mtype != SLU_GE )
+	*info = -8;
+    if ( *info != 0 ) {
+	i = -(*info);
+	input_error("dsgssv", (int*)&i);
+	return;
+    }
+
+    utime = stat->utime;
+    n = A->nrow;
+    nrhs = B->ncol;
+    Bmat = Bstore->nzval;
+    ldb = Bstore->lda;
+    Xmat = Xstore->nzval;
+    ldx = Xstore->lda;
+    *iter = 0;
+
+    /* Convert A to SLU_NC format when necessary. */
+    if ( A->Stype == SLU_NR ) {
+	NRformat *Arstore = A->Store;
+	AA = (SuperMatrix *) SUPERLU_MALLOC( sizeof(SuperMatrix) );
+	dCreate_CompCol_Matrix(AA, A->ncol, A->nrow, Arstore->nnz,
+			       Arstore->nzval, Arstore->colind, Arstore->rowptr,
+			       SLU_NC, A->Dtype, A->Mtype);
+	trans = TRANS;
+    } else {
+        AA = A;
+    }
+    /* The residual is B - op(AA)*X, with op(AA) = A. */
+    rtrans = ( trans == NOTRANS ) ? "N" : "T";
+    Astore = AA->Store;
+    nnz = Astore->nnz;
+
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < n; ++i) Xmat[i + j*ldx] = Bmat[i + j*ldb];
+
+    t = SuperLU_timer_();
+    permc_spec = options->ColPerm;
+    if ( permc_spec == AUTO && options->Fact == DOFACT )
+      get_perm_c_auto(AA, perm_c, stat);
+    else if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
+      get_perm_c(permc_spec, AA, perm_c);
+    utime[COLPERM] = SuperLU_timer_() - t;
+
+    etree = intMalloc(n);
+    panel_size = sp_ienv(1);
+    relax = sp_ienv(2);
+
+    /* Round A to single precision, unless an entry would overflow. */
+    sfmax = smach("Overflow");
+    for (i = 0; i < nnz; ++i)
+	if ( fabs(((double *) Astore->nzval)[i]) > sfmax ) {
+	    *iter = -2;
+	    break;
+	}
+
+#if defined(__SSE__)
+    /* Fill entries that decay below the single precision underflow
+       threshold would be computed as subnormals, which is many times
+       slower; flush them to zero, and let the refinement absorb it. */
+    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+#endif
+
+    if ( *iter == 0 ) {
+	if ( !(snzval = floatMalloc(nnz)) )
+	    ABORT("Malloc fails for snzval[].");
+	for (i = 0; i < nnz; ++i)
+	    snzval[i] = (float) ((double *) Astore->nzval)[i];
+	sCreate_CompCol_Matrix(&AS, AA->nrow, AA->ncol, nnz, snzval,
+			       Astore->rowind, Astore->colptr,
+			       SLU_NC, SLU_S, SLU_GE);
+
+	t = SuperLU_timer_();
+	sp_preorder(options, &AS, perm_c, etree, &AC);
+	utime[ETREE] = SuperLU_timer_() - t;
+
+	t = SuperLU_timer_();
+	sgstrf(options, &AC, relax, panel_size, etree,
+	       NULL, lwork, perm_c, perm_r, L, U, &Glu, stat, info);
+	utime[FACT] = SuperLU_timer_() - t;
+
+	Destroy_CompCol_Permuted(&AC);
+	Destroy_SuperMatrix_Store(&AS);
+	SUPERLU_FREE(snzval);
+
+	if ( *info != 0 ) {
+	    if ( *info <= n ) {
+		Destroy_SuperNode_Matrix(L);
+		Destroy_CompCol_Matrix(U);
+	    }
+	    *info = 0;
+	    *iter = -3;
+	}
+    }
+
+    if ( *iter == 0 ) {
+	t = SuperLU_timer_();
+	if ( !(sr = floatMalloc(n * nrhs)) )
+	    ABORT("Malloc fails for sr[].");
+	if ( !(R = doubleMalloc(n * nrhs)) )
+	    ABORT("Malloc fails for R[].");
+	sCreate_Dense_Matrix(&SR, n, nrhs, sr, n, SLU_DN, SLU_S, SLU_GE);
+
+	/* Solve with the single precision factors. */
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < n; ++i) sr[i + j*n] = (float) Bmat[i + j*ldb];
+	sgstrs(trans, L, U, perm_c, perm_r, &SR, stat, info);
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < n; ++i) Xmat[i + j*ldx] = sr[i + j*n];
+
+	anorm = dlangs(trans == NOTRANS ? "I" : "1", AA);
+	eps = dmach("Epsilon");
+	cte = anorm * eps * sqrt((double) n);
+	ratio_old = 0.;
+
+	for (it = 0; ; ++it) {
+	    /* R = B - A*X; see whether every column has converged. */
+	    done = 1;
+	    ratio = 0.;
+	    for (j = 0; j < nrhs; ++j) {
+		for (i = 0; i < n; ++i) R[i + j*n] = Bmat[i + j*ldb];
+		sp_dgemv(rtrans, -1.0, AA, &Xmat[j*ldx], 1, 1.0, &R[j*n], 1);
+		xnrm = rnrm = 0.;
+		for (i = 0; i < n; ++i) {
+		    xnrm = SUPERLU_MAX(xnrm, fabs(Xmat[i + j*ldx]));
+		    rnrm = SUPERLU_MAX(rnrm, fabs(R[i + j*n]));
+		}
+		if ( rnrm > xnrm * cte ) done = 0;
+		ratio = SUPERLU_MAX(ratio, xnrm > 0. ? rnrm / xnrm : rnrm);
+	    }
+	    if ( done ) break;
+
+	    /* Stop when the residual no longer halves. */
+	    if ( it == ITERMAX || (it > 0 && 2. * ratio > ratio_old) ) {
+		*iter = -(ITERMAX + 1);
+		break;
+	    }
+	    ratio_old = ratio;
+
+	    /* Solve A*D = R in single precision, and X = X + D. */
+	    for (i = 0; i < n * nrhs; ++i) sr[i] = (float) R[i];
+	    sgstrs(trans, L, U, perm_c, perm_r, &SR, stat, info);
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < n; ++i) Xmat[i + j*ldx] += sr[i + j*n];
+	}
+	if ( *iter == 0 ) *iter = it;
+
+	Destroy_SuperMatrix_Store(&SR);
+	SUPERLU_FREE(sr);
+	SUPERLU_FREE(R);
+	utime[REFINE] = SuperLU_timer_() - t;
+
+	if ( *iter < 0 ) {
+	    Destroy_SuperNode_Matrix(L);
+	    Destroy_CompCol_Matrix(U);
+	}
+    }
+
+#if defined(__SSE__)
+    _mm_setcsr(csr);
+#endif
+
+    if ( *iter < 0 ) {
+	/* Fall back to the double precision factorization. The ordering
+	   in perm_c[] is kept. */
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < n; ++i) Xmat[i + j*ldx] = Bmat[i + j*ldb];
+
+	t = SuperLU_timer_();
+	sp_preorder(options, AA, perm_c, etree, &AC);
+	utime[ETREE] += SuperLU_timer_() - t;
+
+	t = SuperLU_timer_();
+	dgstrf(options, &AC, relax, panel_size, etree,
+	       NULL, lwork, perm_c, perm_r, L, U, &Glu, stat, info);
+	utime[FACT] += SuperLU_timer_() - t;
+
+	t = SuperLU_timer_();
+	if ( *info == 0 )
+	    dpgstrs(options, trans, L, U, perm_c, perm_r, X, stat, info);
+	utime[SOLVE] = SuperLU_timer_() - t;
+
+	Destroy_CompCol_Permuted(&AC);
+    }
+    stat->RefineSteps = SUPERLU_MAX(*iter, 0);
+
+    SUPERLU_FREE (etree);
+    if ( A->Stype == SLU_NR ) {
+	Destroy_SuperMatrix_Store(AA);
+	SUPERLU_FREE(AA);
+    }
+
+}
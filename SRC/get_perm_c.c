@@ -18,11 +18,14 @@ at the top-level directory.
  * August 1, 2008
  * </pre>
  */
+#include <math.h>
 #include "slu_ddefs.h"
 #include "colamd.h"
 
 extern int  genmmd_(int *, int *, int *, int *, int *, int *, int *, 
 		    int *, int *, int *, int *, int *);
+extern void get_nd(int_t, int_t *, int_t *, int_t *);
+extern void get_amd(int_t, int_t, int_t *, int_t *, int_t *);
 
 void
 get_colamd(
@@ -57,6 +60,15 @@ get_colamd(
     SUPERLU_FREE(A);
     SUPERLU_FREE(p);
 }
+/*! \brief Rows of an m-by-n matrix with more entries than this are dense
+ *  for the orderings on A'*A (the default of COLAMD).
+ */
+static int_t
+ata_dense(int_t n)
+{
+    return (int_t) SUPERLU_MAX(16., 10. * sqrt((double) n));
+}
+
 /*! \brief
  *
  * <pre>
@@ -72,10 +84,11 @@ get_colamd(
  * The complexity of this algorithm is: SUM_{i=1,m} r(i)^2,
  * i.e., the sum of the square of the row counts.
  *
- * Questions
- * =========
- *     o  Do I need to withhold the *dense* rows?
- *     o  How do I know the number of nonzeros in A'*A?
+ * The dense rows, those with more than ata_dense(n) entries, are left
+ * out, as in COLAMD; a single one would make A'*A dense. The storage
+ * and the time are then at most nz * ata_dense(n). The columns whose
+ * rows are all dense are isolated in the result; get_perm_c() orders
+ * them last.
  * </pre>
  */
 void
@@ -92,7 +105,7 @@ getata(
        )
 {
     register int_t i, j, k, col, num_nz, ti, trow;
-    int_t *marker, *b_colptr, *b_rowind;
+    int_t *marker, *b_colptr, *b_rowind, dense;
     int_t *t_colptr, *t_rowind; /* a column oriented form of T = A' */
 
     if ( !(marker = (int_t*) SUPERLU_MALLOC((SUPERLU_MAX(m,n)+1)*sizeof(int_t))) )
@@ -103,12 +116,16 @@ getata(
 	ABORT("SUPERLU_MALLOC fails for t_rowind[]");
 
     
-    /* Get counts of each column of T, and set up column pointers */
+    /* Get counts of each column of T, and set up column pointers.
+       The dense rows of A are left out of T. */
+    dense = ata_dense(n);
     for (i = 0; i < m; ++i) marker[i] = 0;
     for (j = 0; j < n; ++j) {
 	for (i = colptr[j]; i < colptr[j+1]; ++i)
 	    ++marker[rowind[i]];
     }
+    for (i = 0; i < m; ++i)
+	if ( marker[i] > dense ) marker[i] = 0;
     t_colptr[0] = 0;
     for (i = 0; i < m; ++i) {
 	t_colptr[i+1] = t_colptr[i] + marker[i];
@@ -119,8 +136,10 @@ getata(
     for (j = 0; j < n; ++j)
 	for (i = colptr[j]; i < colptr[j+1]; ++i) {
 	    col = rowind[i];
-	    t_rowind[marker[col]] = j;
-	    ++marker[col];
+	    if ( marker[col] < t_colptr[col+1] ) {
+		t_rowind[marker[col]] = j;
+		++marker[col];
+	    }
 	}
 
     
@@ -201,6 +220,47 @@ getata(
 }
 
 
+/*! \brief Moves the columns of A whose rows are all dense (see getata())
+ *  to the end of the ordering perm_c[], in their natural order.
+ *
+ * <pre>
+ * Such columns are isolated in A'*A without the dense rows, and would be
+ * ordered first; as in COLAMD, they are deferred to the end instead, with
+ * the dense rows.
+ * </pre>
+ */
+static void
+ata_defer_dense(int_t m, int_t n, int_t *colptr, int_t *rowind,
+		int_t *perm_c)
+{
+    int_t *cnt, *invp, i, j, k, p, dense, ndefer = 0;
+
+    dense = ata_dense(n);
+    cnt = intCalloc(SUPERLU_MAX(m, n) + 1);
+    invp = intMalloc(n + 1);
+    for (p = 0; p < colptr[n]; ++p) ++cnt[rowind[p]];
+    for (j = 0; j < n; ++j) {
+	invp[j] = (colptr[j] < colptr[j+1]);   /* deferred, unless ... */
+	for (p = colptr[j]; p < colptr[j+1]; ++p)
+	    if ( cnt[rowind[p]] <= dense ) {
+		invp[j] = 0;                    /* ... a row is sparse */
+		break;
+	    }
+	ndefer += invp[j];
+    }
+    if ( ndefer ) {
+	for (j = 0; j < n; ++j) cnt[j] = invp[j];   /* cnt[j]: deferred */
+	for (j = 0; j < n; ++j) invp[perm_c[j]] = j;
+	k = 0;
+	for (i = 0; i < n; ++i)
+	    if ( !cnt[invp[i]] ) perm_c[invp[i]] = k++;
+	for (j = 0; j < n; ++j)
+	    if ( cnt[j] ) perm_c[j] = k++;
+    }
+    SUPERLU_FREE(cnt);
+    SUPERLU_FREE(invp);
+}
+
 /*! \brief
  *
  * <pre>
@@ -347,7 +407,9 @@ at_plus_a(
  *
  * GET_PERM_C obtains a permutation matrix Pc, by applying the multiple
  * minimum degree ordering code by Joseph Liu to matrix A'*A or A+A'.
- * or using approximate minimum degree column ordering by Davis et. al.
+ * or using approximate minimum degree column ordering by Davis et. al.,
+ * or nested dissection on A+A', or approximate minimum degree (AMD)
+ * on A'*A or A+A'.
  * The LU factorization of A*Pc tends to have less fill than the LU 
  * factorization of A.
  *
@@ -359,7 +421,16 @@ at_plus_a(
  *         = 1: minimum degree on the structure of A^T * A
  *         = 2: minimum degree on the structure of A^T + A
  *         = 3: approximate minimum degree for unsymmetric matrices
+ *         = 4: nested dissection on the structure of A^T + A
+ *         = 8: approximate minimum degree on the structure of A^T * A
+ *         = 9: approximate minimum degree on the structure of A^T + A
+ *         = 10: the best of several of the above (see GET_PERM_C_AUTO)
  *         If ispec == 0, the natural ordering (i.e., Pc = I) is returned.
+ *         For 1 and 8, the rows of A with more than max(16, 10*sqrt(n))
+ *         entries are left out of A^T * A (see GETATA), and the columns
+ *         with only such rows are ordered last. On matrices with dense
+ *         rows, these orderings therefore differ from those of earlier
+ *         versions, which formed A^T * A from all the rows.
  * 
  * A       (input) SuperMatrix*
  *         Matrix A in A*X=B, of dimension (A->nrow, A->ncol). The number
@@ -394,6 +465,7 @@ get_perm_c(int_t ispec, SuperMatrix *A, int_t *perm_c)
 #endif
 	return;
     case (MMD_ATA): /* Minimum degree ordering on A'*A */
+    case (AMD_ATA):
 	getata(m, n, Astore->nnz, Astore->colptr, Astore->rowind,
 		     &bnz, &b_colptr, &b_rowind);
 #if ( PRNTlevel>=1 )
@@ -403,6 +475,7 @@ get_perm_c(int_t ispec, SuperMatrix *A, int_t *perm_c)
 	/*printf("Form A'*A time = %8.3f\n", t);*/
 	break;
     case (MMD_AT_PLUS_A): /* Minimum degree ordering on A'+A */
+    case (AMD_AT_PLUS_A):
 	if ( m != n ) ABORT("Matrix is not square");
 	at_plus_a(n, Astore->nnz, Astore->colptr, Astore->rowind,
 		  &bnz, &b_colptr, &b_rowind);
@@ -418,11 +491,29 @@ get_perm_c(int_t ispec, SuperMatrix *A, int_t *perm_c)
 	printf(".. Use approximate minimum degree column ordering.\n");
 #endif
 	return; 
+    case (METIS_AT_PLUS_A): /* Nested dissection ordering on A'+A */
+	if ( m != n ) ABORT("Matrix is not square");
+	at_plus_a(n, Astore->nnz, Astore->colptr, Astore->rowind,
+		  &bnz, &b_colptr, &b_rowind);
+#if ( PRNTlevel>=1 )
+	printf("Use nested dissection ordering on A'+A.\n");
+#endif
+	get_nd(n, b_colptr, b_rowind, perm_c);
+	SUPERLU_FREE(b_colptr);
+	if ( bnz ) SUPERLU_FREE(b_rowind);
+	return;
+    case (AUTO): /* Cheapest predicted of several orderings */
+	get_perm_c_auto(A, perm_c, NULL);
+	return;
     default:
 	ABORT("Invalid ISPEC");
     }
 
-    if ( bnz != 0 ) {
+    if ( bnz != 0 && (ispec == AMD_ATA || ispec == AMD_AT_PLUS_A) ) {
+	get_amd(n, bnz, b_colptr, b_rowind, perm_c);
+	SUPERLU_FREE(b_rowind);
+
+    } else if ( bnz != 0 ) {
 	t = SuperLU_timer_();
 
 	/* Initialize and allocate storage for GENMMD. */
@@ -464,5 +555,512 @@ get_perm_c(int_t ispec, SuperMatrix *A, int_t *perm_c)
 	for (i = 0; i < n; ++i) perm_c[i] = i;
     }
 
+    if ( ispec == MMD_ATA || ispec == AMD_ATA )
+	ata_defer_dense(m, n, Astore->colptr, Astore->rowind, perm_c);
+
     SUPERLU_FREE(b_colptr);
 }
+
+/*! \brief Predicts nnz(L+U) and the factorization flops for A*Pc.
+ *
+ * <pre>
+ * A is m-by-n, with its pattern in colptr[] and rowind[]. The columns of
+ * A*Pc are postordered by their column etree, and the relaxed supernodes
+ * are found, as by sp_preorder() and dgstrf(). Let E be the me-by-n
+ * matrix in e_colptr[] and e_rowind[] (or A if e_colptr = NULL), with a
+ * row added for each relaxed supernode j..l, whose entries are columns
+ * j..l and, if e_colptr != NULL, the columns i for the rows i of
+ * A(:,j..l). These rows make the supernodes dense, as they are stored,
+ * and pass on the explicit zeros to the later columns. The column counts
+ * c(j) of the Cholesky factor of (E*Pc)'*(E*Pc) are computed without
+ * numeric work (sp_colcnt_ata()), and L(:,j) and U(j,:) are taken to
+ * have c(j) entries each:
+ *     nnz(L+U) = sum (2*c(j) - 1),
+ *     flops    = sum ((c(j) - 1) + 2*(c(j) - 1)^2).
+ * </pre>
+ */
+static void
+colperm_predict(int_t m, int_t n, int_t *colptr, int_t *rowind,
+		int_t me, int_t *e_colptr, int_t *e_rowind, int_t *perm_c,
+		double *nnz, flops_t *ops)
+{
+    int_t *colbeg, *colend, *etree, *post, *iwork, *colcnt, *relax_end;
+    int_t *q, *marker, *xrow, *xcol, *ccolptr, *crowind, *cbeg, *cend, *cnext;
+    int_t i, j, k, l, p, nx, nrow, xm;
+    double c;
+
+    if ( !e_colptr ) {
+	me = m;
+	e_colptr = colptr;
+	e_rowind = rowind;
+    }
+    colbeg = intMalloc(SUPERLU_MAX(n, 1));
+    colend = intMalloc(SUPERLU_MAX(n, 1));
+    etree  = intMalloc(SUPERLU_MAX(n, 1));
+    iwork  = intMalloc(SUPERLU_MAX(m, n) + 1);
+    colcnt = intMalloc(SUPERLU_MAX(n, 1));
+    relax_end = intMalloc(SUPERLU_MAX(n, 1));
+    q      = intMalloc(SUPERLU_MAX(n, 1));
+    marker = intMalloc(SUPERLU_MAX(m, n) + 1);
+    if ( !colbeg || !colend || !etree || !iwork || !colcnt || !relax_end
+	 || !q || !marker )
+	ABORT("SUPERLU_MALLOC fails in colperm_predict()");
+    for (i = 0; i < n; ++i) {
+	colbeg[perm_c[i]] = colptr[i];
+	colend[perm_c[i]] = colptr[i+1];
+    }
+
+    /* Column etree of A*Pc, postordered as in sp_preorder(). */
+    sp_coletree(colbeg, colend, rowind, m, n, etree);
+    post = TreePostorder(n, etree);
+    for (i = 0; i < n; ++i) iwork[post[i]] = post[etree[i]];
+    for (i = 0; i < n; ++i) etree[i] = iwork[i];
+    for (i = 0; i < n; ++i) iwork[post[i]] = colbeg[i];
+    for (i = 0; i < n; ++i) colbeg[i] = iwork[i];
+    for (i = 0; i < n; ++i) iwork[post[i]] = colend[i];
+    for (i = 0; i < n; ++i) colend[i] = iwork[i];
+    for (i = 0; i < n; ++i) q[i] = post[perm_c[i]];  /* final position */
+
+    /* Relaxed supernodes, as in dgstrf(); one row of E for each. */
+    relax_snode(n, etree, sp_ienv(2), iwork, relax_end);
+    nx = colptr[n] + n;
+    xrow = intMalloc(SUPERLU_MAX(nx, 1));
+    xcol = intMalloc(SUPERLU_MAX(nx, 1));
+    if ( !xrow || !xcol ) ABORT("SUPERLU_MALLOC fails in colperm_predict()");
+    for (i = 0; i < n; ++i) marker[i] = EMPTY;
+    nx = 0;
+    nrow = me;
+    for (j = 0; j < n; ) {
+	if ( relax_end[j] == EMPTY ) {
+	    ++j;
+	    continue;
+	}
+	l = relax_end[j];
+	for (k = j; k <= l; ++k) {
+	    marker[k] = nrow;
+	    xrow[nx] = nrow;
+	    xcol[nx++] = k;
+	}
+	if ( e_colptr != colptr )
+	    for (k = j; k <= l; ++k)
+		for (p = colbeg[k]; p < colend[k]; ++p) {
+		    i = q[rowind[p]];
+		    if ( marker[i] != nrow ) {
+			marker[i] = nrow;
+			xrow[nx] = nrow;
+			xcol[nx++] = i;
+		    }
+		}
+	++nrow;
+	j = l + 1;
+    }
+    xm = nrow;
+
+    /* E*Pc with the extra rows, in the final column order. */
+    ccolptr = intCalloc(n + 1);
+    for (i = 0; i < n; ++i) ccolptr[q[i] + 1] = e_colptr[i+1] - e_colptr[i];
+    for (p = 0; p < nx; ++p) ++ccolptr[xcol[p] + 1];
+    for (j = 0; j < n; ++j) ccolptr[j+1] += ccolptr[j];
+    crowind = intMalloc(SUPERLU_MAX(ccolptr[n], 1));
+    cnext = intMalloc(SUPERLU_MAX(n, 1));
+    if ( !crowind || !cnext ) ABORT("SUPERLU_MALLOC fails in colperm_predict()");
+    for (j = 0; j < n; ++j) cnext[j] = ccolptr[j];
+    for (i = 0; i < n; ++i)
+	for (p = e_colptr[i]; p < e_colptr[i+1]; ++p)
+	    crowind[cnext[q[i]]++] = e_rowind[p];
+    for (p = 0; p < nx; ++p) crowind[cnext[xcol[p]]++] = xrow[p];
+    SUPERLU_FREE(xrow);
+    SUPERLU_FREE(xcol);
+
+    /* Counts of the Cholesky factor, computed in a postorder of its own
+       etree, which leaves them unchanged. */
+    cbeg = colbeg;
+    cend = colend;
+    for (j = 0; j < n; ++j) {
+	cbeg[j] = ccolptr[j];
+	cend[j] = ccolptr[j+1];
+    }
+    sp_coletree(cbeg, cend, crowind, xm, n, etree);
+    SUPERLU_FREE(post);
+    post = TreePostorder(n, etree);
+    for (i = 0; i < n; ++i) iwork[post[i]] = post[etree[i]];
+    for (i = 0; i < n; ++i) etree[i] = iwork[i];
+    for (i = 0; i < n; ++i) iwork[post[i]] = cbeg[i];
+    for (i = 0; i < n; ++i) cbeg[i] = iwork[i];
+    for (i = 0; i < n; ++i) iwork[post[i]] = cend[i];
+    for (i = 0; i < n; ++i) cend[i] = iwork[i];
+    sp_colcnt_ata(xm, n, cbeg, cend, crowind, etree, colcnt);
+
+    *nnz = 0.;
+    *ops = 0.;
+    for (i = 0; i < n; ++i) {
+	c = colcnt[i] - 1;
+	*nnz += 2. * c + 1.;
+	*ops += c + 2. * c * c;
+    }
+
+    SUPERLU_FREE(colbeg);
+    SUPERLU_FREE(colend);
+    SUPERLU_FREE(etree);
+    SUPERLU_FREE(post);
+    SUPERLU_FREE(iwork);
+    SUPERLU_FREE(colcnt);
+    SUPERLU_FREE(relax_end);
+    SUPERLU_FREE(q);
+    SUPERLU_FREE(marker);
+    SUPERLU_FREE(ccolptr);
+    SUPERLU_FREE(crowind);
+    SUPERLU_FREE(cnext);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GET_PERM_C_AUTO chooses the column ordering for ColPerm = AUTO. Each of
+ * NATURAL, MMD_ATA, COLAMD and, for square A, MMD_AT_PLUS_A and
+ * METIS_AT_PLUS_A is computed, the nonzeros and flops of the LU
+ * factorization of A*Pc are predicted symbolically, and the ordering with
+ * the fewest predicted flops (then nonzeros) is returned in perm_c[].
+ *
+ * For square A with a zero-free diagonal, the pivots are assumed to stay
+ * on the diagonal, and the predictions are made from the structure of
+ * the Cholesky factor of Pc'*(A'+A)*Pc, which contains that of L+U
+ * without pivoting. Otherwise they are made from the Cholesky factor of
+ * (A*Pc)'*(A*Pc), which contains the structures of L and U for any row
+ * pivoting (George and Ng). Either way the relaxed supernodes are
+ * accounted for, as they are stored dense. The cost is that of computing
+ * every candidate ordering, plus a few passes over the pattern of A or
+ * A'+A per candidate.
+ *
+ * Arguments
+ * =========
+ *
+ * A       (input) SuperMatrix*
+ *         As for GET_PERM_C.
+ *
+ * perm_c  (output) int_t*
+ *         As for GET_PERM_C.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         If not NULL, stat->ColPermChosen is set to the chosen ordering,
+ *         and stat->ColPermNnz[k] and stat->ColPermOps[k] to the predicted
+ *         nnz(L+U) and flops for ordering k, or to -1 if k was not tried.
+ *         (StatInit() sets stat->ColPermChosen = AUTO, which remains if no
+ *         choice was made.)
+ * </pre>
+ */
+void
+get_perm_c_auto(SuperMatrix *A, int_t *perm_c, SuperLUStat_t *stat)
+{
+    static const colperm_t cand[] = {NATURAL, MMD_ATA, COLAMD,
+				     MMD_AT_PLUS_A, METIS_AT_PLUS_A};
+    NCformat *Astore = A->Store;
+    int_t    m = A->nrow, n = A->ncol, ncand, k, i, j, p, e;
+    int_t    *colptr = Astore->colptr, *rowind = Astore->rowind;
+    int_t    *perm, *marker, bnz, *b_colptr, *b_rowind;
+    int_t    *e_colptr = NULL, *e_rowind = NULL, ne = m, ndiag;
+    double   nnz, best_nnz = 0.;
+    flops_t  ops, best_ops = 0.;
+    colperm_t best = NATURAL;
+
+    if ( stat ) {
+	for (k = 0; k < AUTO; ++k) stat->ColPermNnz[k] = stat->ColPermOps[k] = -1.;
+    }
+    ncand = (m == n) ? 5 : 3;
+
+    /* For square A with a zero-free diagonal, predict with the matrix E
+       whose rows are the unit rows and the edges {i,j} of A'+A, so that
+       E'*E has the pattern of A'+A plus the diagonal. */
+    ndiag = 0;
+    if ( m == n )
+	for (j = 0; j < n; ++j)
+	    for (p = colptr[j]; p < colptr[j+1]; ++p)
+		if ( rowind[p] == j ) ++ndiag;
+    if ( m == n && n > 0 && ndiag >= n ) {
+	at_plus_a(n, Astore->nnz, colptr, rowind, &bnz, &b_colptr, &b_rowind);
+	ne = n + bnz / 2;
+	e_colptr = intMalloc(n + 1);
+	e_rowind = intMalloc(n + bnz + 1);
+	marker = intMalloc(n);
+	if ( !e_colptr || !e_rowind || !marker )
+	    ABORT("SUPERLU_MALLOC fails in get_perm_c_auto()");
+	for (j = 0; j <= n; ++j) e_colptr[j] = b_colptr[j] + j;
+	for (j = 0; j < n; ++j) {
+	    marker[j] = e_colptr[j];
+	    e_rowind[marker[j]++] = j;
+	}
+	e = n;
+	for (j = 0; j < n; ++j)
+	    for (p = b_colptr[j]; p < b_colptr[j+1]; ++p) {
+		i = b_rowind[p];
+		if ( i > j ) {
+		    e_rowind[marker[j]++] = e;
+		    e_rowind[marker[i]++] = e;
+		    ++e;
+		}
+	    }
+	SUPERLU_FREE(b_colptr);
+	if ( bnz ) SUPERLU_FREE(b_rowind);
+	SUPERLU_FREE(marker);
+    }
+
+    perm = intMalloc(SUPERLU_MAX(n, 1));
+    for (k = 0; k < ncand; ++k) {
+	get_perm_c(cand[k], A, perm);
+	colperm_predict(m, n, colptr, rowind, ne, e_colptr, e_rowind, perm,
+			&nnz, &ops);
+	if ( stat ) {
+	    stat->ColPermNnz[cand[k]] = nnz;
+	    stat->ColPermOps[cand[k]] = ops;
+	}
+	if ( k == 0 || ops < best_ops || (ops == best_ops && nnz < best_nnz) ) {
+	    best = cand[k];
+	    best_ops = ops;
+	    best_nnz = nnz;
+	    for (i = 0; i < n; ++i) perm_c[i] = perm[i];
+	}
+#if ( PRNTlevel>=1 )
+	printf(".. ColPerm %d: predicted nnz(L+U) %e, flops %e\n",
+	       cand[k], nnz, ops);
+#endif
+    }
+    if ( stat ) stat->ColPermChosen = best;
+
+    SUPERLU_FREE(perm);
+    if ( e_colptr ) {
+	SUPERLU_FREE(e_colptr);
+	SUPERLU_FREE(e_rowind);
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GET_PERM_C_PRESOLVE computes the column ordering of ispec (as for
+ * GET_PERM_C, or AUTO as GET_PERM_C_AUTO) on the core of A only, and
+ * orders the rest of A around it so that it causes no fill:
+ *
+ *   1. Column singletons, those with one entry in the rows not yet taken
+ *      out, are ordered first, repeatedly. The entry is their pivot, and
+ *      its row is taken out.
+ *   2. Row singletons, those with one entry in the columns not yet taken
+ *      out, repeatedly. Their columns are ordered next, and the row of
+ *      the entry is their pivot: U(i,:) is then that entry alone, and
+ *      the update from the column causes no fill in the core.
+ *   3. Of the rows and columns left, those with more than
+ *      max(16, 10*sqrt(n)) entries are dense. The dense columns are
+ *      ordered after the core, and the dense rows are left out of the
+ *      pattern that is ordered.
+ *
+ * For the orderings on A'+A (MMD_AT_PLUS_A, AMD_AT_PLUS_A,
+ * METIS_AT_PLUS_A and AUTO), which assume the pivots to be on the
+ * diagonal, row and column j are taken out together: a singleton is then
+ * one whose entry is diagonal, and j is dense if row or column j is. The
+ * core is a principal submatrix of A.
+ *
+ * Only perm_c[] is computed: perm_r[] is not seeded with the pivots
+ * above, and dgstrf() still chooses them by partial pivoting (or the
+ * diagonal, see DiagPivotThresh). A column singleton has no other entry
+ * left when it is factored, so its pivot is the one above. A row
+ * singleton's column may have other entries below it, and when one of
+ * them is pivoted on instead, that column fills like any other. The
+ * factors and perm_r[] are those of an ordinary factorization with this
+ * perm_c[]. When ispec is NATURAL or MY_PERMC, perm_c[] is left as
+ * GET_PERM_C leaves it.
+ *
+ * Arguments
+ * =========
+ *
+ * ispec   (input) int_t
+ *         As for GET_PERM_C, or AUTO.
+ *
+ * A       (input) SuperMatrix*
+ *         As for GET_PERM_C.
+ *
+ * perm_c  (output) int_t*
+ *         As for GET_PERM_C.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         Passed to GET_PERM_C_AUTO when ispec = AUTO. May be NULL.
+ * </pre>
+ */
+void
+get_perm_c_presolve(int_t ispec, SuperMatrix *A, int_t *perm_c,
+		    SuperLUStat_t *stat)
+{
+    NCformat *Astore = A->Store, Cstore;
+    SuperMatrix C;
+    int_t  m = A->nrow, n = A->ncol, nnz = Astore->nnz;
+    int_t  *colptr = Astore->colptr, *rowind = Astore->rowind;
+    int_t  *rowptr, *colind, *colcnt, *rowcnt, *queue, *cmap, *rmap;
+    int_t  *c_colptr, *c_rowind, *c_perm;
+    int_t  i, j, k, p, head, tail, sym, front, ncore, mcore, cnz;
+    int_t  dense_c, dense_r;
+
+    if ( ispec == NATURAL || ispec == MY_PERMC ) {
+	get_perm_c(ispec, A, perm_c);
+	return;
+    }
+    sym = (m == n) && (ispec == MMD_AT_PLUS_A || ispec == AMD_AT_PLUS_A ||
+		       ispec == METIS_AT_PLUS_A || ispec == AUTO);
+
+    /* Row-wise pattern, and the counts of entries in the rows and columns
+       not taken out: rowcnt[i] = EMPTY once row i is out, and
+       colcnt[j] = EMPTY once column j is. */
+    rowptr = intMalloc(m + 1);
+    colind = intMalloc(SUPERLU_MAX(nnz, 1));
+    colcnt = intMalloc(n);
+    rowcnt = intMalloc(m);
+    queue = intMalloc(SUPERLU_MAX(m, n));
+    cmap = intMalloc(n);
+    rmap = intMalloc(m);
+    if ( !rowptr || !colind || !colcnt || !rowcnt || !queue || !cmap || !rmap )
+	ABORT("SUPERLU_MALLOC fails in get_perm_c_presolve()");
+    for (i = 0; i <= m; ++i) rowptr[i] = 0;
+    for (p = 0; p < nnz; ++p) ++rowptr[rowind[p] + 1];
+    for (i = 0; i < m; ++i) {
+	rowptr[i+1] += rowptr[i];
+	rowcnt[i] = rowptr[i+1] - rowptr[i];
+    }
+    for (i = 0; i < m; ++i) rmap[i] = rowptr[i];
+    for (j = 0; j < n; ++j) {
+	colcnt[j] = colptr[j+1] - colptr[j];
+	for (p = colptr[j]; p < colptr[j+1]; ++p)
+	    colind[rmap[rowind[p]]++] = j;
+    }
+
+#define PRESOLVE_CSINGLE(j) ( colcnt[j] == 1 && (!sym || rowcnt[j] != EMPTY) )
+#define PRESOLVE_RSINGLE(i) ( rowcnt[i] == 1 && (!sym || colcnt[i] != EMPTY) )
+
+    /* 1. Column singletons, ordered first. */
+    front = 0;
+    tail = 0;
+    for (j = 0; j < n; ++j)
+	if ( PRESOLVE_CSINGLE(j) ) queue[tail++] = j;
+    for (head = 0; head < tail; ++head) {
+	j = queue[head];
+	if ( colcnt[j] != 1 ) continue;
+	for (p = colptr[j]; rowcnt[rowind[p]] == EMPTY; ++p) ;
+	i = rowind[p];
+	if ( sym && i != j ) continue;  /* not diagonal: stays in the core */
+	perm_c[j] = front++;
+	colcnt[j] = EMPTY;
+	for (p = colptr[j]; p < colptr[j+1]; ++p)
+	    if ( rowcnt[rowind[p]] != EMPTY ) --rowcnt[rowind[p]];
+	rowcnt[i] = EMPTY;
+	for (p = rowptr[i]; p < rowptr[i+1]; ++p) {
+	    k = colind[p];
+	    if ( colcnt[k] == EMPTY ) continue;
+	    if ( --colcnt[k] == 1 && PRESOLVE_CSINGLE(k) ) queue[tail++] = k;
+	}
+    }
+
+    /* 2. Row singletons; their columns follow the column singletons. */
+    tail = 0;
+    for (i = 0; i < m; ++i)
+	if ( PRESOLVE_RSINGLE(i) ) queue[tail++] = i;
+    for (head = 0; head < tail; ++head) {
+	i = queue[head];
+	if ( rowcnt[i] != 1 ) continue;
+	for (p = rowptr[i]; colcnt[colind[p]] == EMPTY; ++p) ;
+	j = colind[p];
+	if ( sym && i != j ) continue;
+	perm_c[j] = front++;
+	rowcnt[i] = EMPTY;
+	for (p = colptr[j]; p < colptr[j+1]; ++p) {
+	    k = rowind[p];
+	    if ( rowcnt[k] == EMPTY ) continue;
+	    if ( --rowcnt[k] == 1 && PRESOLVE_RSINGLE(k) ) queue[tail++] = k;
+	}
+	for (p = rowptr[i]; p < rowptr[i+1]; ++p)
+	    if ( colcnt[colind[p]] != EMPTY ) --colcnt[colind[p]];
+	colcnt[j] = EMPTY;
+    }
+#undef PRESOLVE_CSINGLE
+#undef PRESOLVE_RSINGLE
+
+    /* 3. Dense rows and columns of the rest. cmap[] and rmap[] number the
+       columns and rows of the core, or are EMPTY. */
+    dense_c = ata_dense(m);
+    dense_r = ata_dense(n);
+    ncore = mcore = 0;
+    for (j = 0; j < n; ++j) {
+	cmap[j] = EMPTY;
+	if ( colcnt[j] == EMPTY ) continue;
+	if ( colcnt[j] > dense_c || (sym && rowcnt[j] > dense_r) )
+	    colcnt[j] = EMPTY - 1;      /* dense: ordered after the core */
+	else
+	    cmap[j] = ncore++;
+    }
+    for (i = 0; i < m; ++i) {
+	rmap[i] = EMPTY;
+	if ( sym ) rmap[i] = cmap[i];
+	else if ( rowcnt[i] != EMPTY && rowcnt[i] <= dense_r ) rmap[i] = mcore++;
+    }
+    if ( sym ) mcore = ncore;
+
+    /* The core, ordered by ispec. */
+    c_colptr = intMalloc(ncore + 1);
+    c_perm = intMalloc(SUPERLU_MAX(ncore, 1));
+    if ( !c_colptr || !c_perm ) ABORT("SUPERLU_MALLOC fails for the core");
+    cnz = 0;
+    for (j = 0; j < n; ++j)
+	if ( cmap[j] != EMPTY )
+	    for (p = colptr[j]; p < colptr[j+1]; ++p)
+		if ( rmap[rowind[p]] != EMPTY ) ++cnz;
+    c_rowind = intMalloc(SUPERLU_MAX(cnz, 1));
+    if ( !c_rowind ) ABORT("SUPERLU_MALLOC fails for the core");
+    cnz = 0;
+    for (j = 0; j < n; ++j) {
+	if ( cmap[j] == EMPTY ) continue;
+	c_colptr[cmap[j]] = cnz;
+	for (p = colptr[j]; p < colptr[j+1]; ++p)
+	    if ( rmap[rowind[p]] != EMPTY ) c_rowind[cnz++] = rmap[rowind[p]];
+    }
+    c_colptr[ncore] = cnz;
+    if ( ncore > 0 ) {
+	/* Only the pattern of the core is ordered; no values, so that this
+	   file needs no precision-specific routine. */
+	C.Stype = SLU_NC;
+	C.Dtype = SLU_D;
+	C.Mtype = SLU_GE;
+	C.nrow = mcore;
+	C.ncol = ncore;
+	C.Store = &Cstore;
+	Cstore.nnz = cnz;
+	Cstore.nzval = NULL;
+	Cstore.rowind = c_rowind;
+	Cstore.colptr = c_colptr;
+	if ( ispec == AUTO ) get_perm_c_auto(&C, c_perm, stat);
+	else get_perm_c(ispec, &C, c_perm);
+    }
+
+#if ( PRNTlevel>=1 )
+    printf(".. get_perm_c_presolve(): %d singletons, %d dense, core %d x %d\n",
+	   (int) front, (int) (n - front - ncore), (int) mcore, (int) ncore);
+#endif
+
+    /* Core columns after the singletons, then the dense columns. */
+    for (j = 0; j < n; ++j)
+	if ( cmap[j] != EMPTY ) perm_c[j] = front + c_perm[cmap[j]];
+    front += ncore;
+    for (j = 0; j < n; ++j)
+	if ( colcnt[j] == EMPTY - 1 ) perm_c[j] = front++;
+
+    SUPERLU_FREE(c_colptr);
+    SUPERLU_FREE(c_rowind);
+    SUPERLU_FREE(c_perm);
+    SUPERLU_FREE(rowptr);
+    SUPERLU_FREE(colind);
+    SUPERLU_FREE(colcnt);
+    SUPERLU_FREE(rowcnt);
+    SUPERLU_FREE(queue);
+    SUPERLU_FREE(cmap);
+    SUPERLU_FREE(rmap);
+}
@@ -31,12 +31,12 @@ int_t superlu_malloc_total = 0;
 #define DWORD  (sizeof(double)) /* Be sure it's no smaller than double. */
 /* size_t is usually defined as 'unsigned long' */
 
-void *superlu_malloc(int_t size)
+void *superlu_malloc(size_t size)
 {
     char* buf = (char *) malloc(size + DWORD);
     if ( !buf ) {
 	printf("superlu_malloc fails: malloc_total %.0f MB, size %lld\n",
-	       superlu_malloc_total*1e-6, size);
+	       superlu_malloc_total*1e-6, (long long) size);
 	ABORT("superlu_malloc: out of memory");
     }
 
@@ -49,6 +49,27 @@ void *superlu_malloc(int_t size)
     return (void *) (buf + DWORD);
 }
 
+/*! \brief Resize a block from superlu_malloc(); on failure return NULL
+ * and leave the old block intact.
+ */
+void *superlu_realloc(void *addr, size_t size)
+{
+    char *p = ((char *) addr) - DWORD;
+    char *buf;
+    size_t n;
+
+    if ( ooc_owns(addr) ) return (ooc_realloc(addr, size));
+    n = ((size_t *) p)[0];
+    if ( !n )
+	ABORT("superlu_realloc: tried to resize a freed pointer");
+    buf = (char *) realloc(p, size + DWORD);
+    if ( !buf ) return (NULL);
+
+    ((size_t *) buf)[0] = size;
+    superlu_malloc_total += (int_t) size - (int_t) n;
+    return (void *) (buf + DWORD);
+}
+
 void superlu_free(void *addr)
 {
     char *p = ((char *) addr) - DWORD;
@@ -59,6 +80,11 @@ void superlu_free(void *addr)
     if ( !p )
 	ABORT("superlu_free: tried to free NULL+DWORD pointer");
 
+    if ( ooc_owns(addr) ) {
+	ooc_free(addr);
+	return;
+    }
+
     { 
 	int_t n = ((size_t *) p)[0];
 	
@@ -82,21 +108,71 @@ void superlu_free(void *addr)
 
 #else   /* production mode */
 
-void *superlu_malloc(int_t size)
+void *superlu_malloc(size_t size)
 {
     void *buf;
     buf = (void *) malloc(size);
     return (buf);
 }
 
+void *superlu_realloc(void *addr, size_t size)
+{
+    if ( ooc_owns(addr) ) return (ooc_realloc(addr, size));
+    return (realloc(addr, size));
+}
+
 void superlu_free(void *addr)
 {
-    free (addr);
+    if ( ooc_owns(addr) ) ooc_free(addr);
+    else free (addr);
 }
 
 #endif
 
 
+/*! \brief Initialize an empty workspace for options->LUWorkspace.
+ */
+void LUWorkspaceInit(LUWorkspace_t *ws)
+{
+    ws->iwork = NULL;
+    ws->dwork = NULL;
+    ws->isize = ws->dsize = 0;
+}
+
+/*! \brief Free the arrays held by a workspace, leaving it empty.
+ */
+void LUWorkspaceFree(LUWorkspace_t *ws)
+{
+    if ( ws->iwork ) SUPERLU_FREE (ws->iwork);
+    if ( ws->dwork ) SUPERLU_FREE (ws->dwork);
+    LUWorkspaceInit(ws);
+}
+
+/*! \brief Make the arrays of a workspace at least isize and dsize bytes.
+ *
+ * <pre>
+ * An array is reallocated only when it is too small; its contents are
+ * not kept. Returns 0, or the number of bytes requested when malloc
+ * fails.
+ * </pre>
+ */
+int_t LUWorkspaceReserve(LUWorkspace_t *ws, int_t isize, int_t dsize)
+{
+    if ( ws->isize < isize ) {
+	if ( ws->iwork ) SUPERLU_FREE (ws->iwork);
+	ws->iwork = (int_t *) SUPERLU_MALLOC(isize);
+	ws->isize = ws->iwork ? isize : 0;
+	if ( !ws->iwork ) return (isize);
+    }
+    if ( ws->dsize < dsize ) {
+	if ( ws->dwork ) SUPERLU_FREE (ws->dwork);
+	ws->dwork = SUPERLU_MALLOC(dsize);
+	ws->dsize = ws->dwork ? dsize : 0;
+	if ( !ws->dwork ) return (isize + dsize);
+    }
+    return 0;
+}
+
 /*! \brief Set up pointers for integer working arrays.
  */
 void
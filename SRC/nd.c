@@ -0,0 +1,762 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file nd.c
+ * \brief Nested dissection ordering of a symmetric graph
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include "slu_ddefs.h"
+
+extern int  genmmd_(int *, int *, int *, int *, int *, int *, int *,
+		    int *, int *, int *, int *, int *);
+
+#define ND_LEAF      200  /* subgraphs this small are ordered by MMD */
+#define ND_COARSEST  100  /* stop coarsening at this many vertices */
+#define ND_NTRIES    4    /* number of initial bisections tried */
+#define ND_NPASS     8    /* maximum number of refinement passes */
+#define ND_UBFACTOR  10   /* each side may hold 50+ND_UBFACTOR/2 percent */
+
+/*! \brief A graph with weighted vertices and edges, in adjacency list form. */
+typedef struct {
+    int_t nv;
+    int_t *xadj;    /* size nv+1 */
+    int_t *adj;     /* size xadj[nv] */
+    int_t *vwgt;    /* size nv */
+    int_t *ewgt;    /* size xadj[nv] */
+} nd_graph_t;
+
+static int_t
+nd_rand(unsigned int *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (int_t) ((*seed >> 8) & 0x7fffff);
+}
+
+/*! \brief Random permutation of 0:n-1 in perm[]. */
+static void
+nd_randperm(int_t n, int_t *perm, unsigned int *seed)
+{
+    int_t i, j, t;
+
+    for (i = 0; i < n; ++i) perm[i] = i;
+    for (i = n - 1; i > 0; --i) {
+	j = nd_rand(seed) % (i + 1);
+	t = perm[i]; perm[i] = perm[j]; perm[j] = t;
+    }
+}
+
+static void
+nd_graph_free(nd_graph_t *g)
+{
+    SUPERLU_FREE(g->xadj);
+    SUPERLU_FREE(g->adj);
+    SUPERLU_FREE(g->vwgt);
+    SUPERLU_FREE(g->ewgt);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Coarsens g by heavy-edge matching: the vertices are visited in order,
+ * and each unmatched vertex is matched with the unmatched neighbor joined
+ * by the heaviest edge. (Visiting them in random order, as METIS does,
+ * gives about the same separators but is much slower on large graphs.) Every matched pair (or unmatched vertex)
+ * becomes one vertex of cg; cmap[] maps the vertices of g to those of cg.
+ * </pre>
+ */
+static void
+nd_coarsen(nd_graph_t *g, nd_graph_t *cg, int_t *cmap)
+{
+    int_t nv = g->nv, *xadj = g->xadj, *adj = g->adj, *ewgt = g->ewgt;
+    int_t *match, *htab;
+    int_t j, k, v, u, x, maxw, cnv, cnz, c, cu;
+
+    match = intMalloc(nv);
+    if ( !match ) ABORT("Malloc fails for match[].");
+
+    for (v = 0; v < nv; ++v) match[v] = EMPTY;
+    for (v = 0; v < nv; ++v) {
+	if ( match[v] != EMPTY ) continue;
+	u = v;
+	maxw = -1;
+	for (j = xadj[v]; j < xadj[v+1]; ++j) {
+	    k = adj[j];
+	    if ( match[k] == EMPTY && k != v && ewgt[j] > maxw ) {
+		u = k;
+		maxw = ewgt[j];
+	    }
+	}
+	match[v] = u;
+	match[u] = v;
+    }
+
+    /* Number the coarse vertices in the order of the fine ones, which
+       keeps the locality of the input ordering. */
+    cnv = 0;
+    for (v = 0; v < nv; ++v)
+	if ( match[v] >= v ) cmap[v] = cmap[match[v]] = cnv++;
+
+    cg->nv = cnv;
+    cg->xadj = intMalloc(cnv + 1);
+    cg->adj  = intMalloc(SUPERLU_MAX(xadj[nv], 1));
+    cg->vwgt = intMalloc(cnv);
+    cg->ewgt = intMalloc(SUPERLU_MAX(xadj[nv], 1));
+    htab = intMalloc(cnv);
+    if ( !cg->xadj || !cg->adj || !cg->vwgt || !cg->ewgt || !htab )
+	ABORT("Malloc fails for the coarse graph.");
+
+    /* Merge the adjacency lists of each pair; htab[] locates the
+       coarse neighbors already in the list of the current vertex. */
+    for (c = 0; c < cnv; ++c) htab[c] = EMPTY;
+    cnz = 0;
+    c = 0;
+    for (v = 0; v < nv; ++v) {
+	u = match[v];
+	if ( u < v ) continue;          /* visit each pair once */
+	cg->xadj[c] = cnz;
+	cg->vwgt[c] = g->vwgt[v] + (u != v ? g->vwgt[u] : 0);
+	for (k = 0, x = v; k < 2; ++k, x = u) {
+	    if ( k == 1 && u == v ) break;
+	    for (j = xadj[x]; j < xadj[x+1]; ++j) {
+		cu = cmap[adj[j]];
+		if ( cu == c ) continue;
+		if ( htab[cu] == EMPTY ) {
+		    htab[cu] = cnz;
+		    cg->adj[cnz] = cu;
+		    cg->ewgt[cnz++] = ewgt[j];
+		} else {
+		    cg->ewgt[htab[cu]] += ewgt[j];
+		}
+	    }
+	}
+	for (j = cg->xadj[c]; j < cnz; ++j) htab[cg->adj[j]] = EMPTY;
+	++c;
+    }
+    cg->xadj[cnv] = cnz;
+
+    SUPERLU_FREE(match);
+    SUPERLU_FREE(htab);
+}
+
+/*! \brief Weight of the edges cut by the bisection part[]. */
+static int_t
+nd_cut(nd_graph_t *g, int_t *part)
+{
+    int_t v, j, cut = 0;
+
+    for (v = 0; v < g->nv; ++v)
+	for (j = g->xadj[v]; j < g->xadj[v+1]; ++j)
+	    if ( part[g->adj[j]] != part[v] ) cut += g->ewgt[j];
+    return cut / 2;
+}
+
+/*! \brief Binary max-heap of vertices keyed by key[], with hpos[v] the
+ *  position of v in the heap or EMPTY.
+ */
+static void
+nd_heap_up(int_t *h, int_t *hpos, int_t *key, int_t i)
+{
+    int_t p, v = h[i];
+
+    while ( i > 0 && key[h[p = (i - 1) / 2]] < key[v] ) {
+	h[i] = h[p];
+	hpos[h[i]] = i;
+	i = p;
+    }
+    h[i] = v;
+    hpos[v] = i;
+}
+
+static void
+nd_heap_down(int_t *h, int_t *hpos, int_t *key, int_t hn, int_t i)
+{
+    int_t c, v = h[i];
+
+    while ( (c = 2 * i + 1) < hn ) {
+	if ( c + 1 < hn && key[h[c+1]] > key[h[c]] ) ++c;
+	if ( key[h[c]] <= key[v] ) break;
+	h[i] = h[c];
+	hpos[h[i]] = i;
+	i = c;
+    }
+    h[i] = v;
+    hpos[v] = i;
+}
+
+static void
+nd_heap_remove(int_t *h, int_t *hpos, int_t *key, int_t *hn, int_t v)
+{
+    int_t i = hpos[v];
+
+    hpos[v] = EMPTY;
+    if ( i != --(*hn) ) {
+	h[i] = h[*hn];
+	hpos[h[i]] = i;
+	nd_heap_up(h, hpos, key, i);
+	nd_heap_down(h, hpos, key, *hn, hpos[h[i]]);
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Refines the bisection part[] of g by Fiduccia-Mattheyses passes. Each
+ * pass moves boundary vertices to the other side one at a time, the one
+ * with the largest decrease of the edge cut (gain) first, even when the
+ * gain is negative; a vertex moves at most once per pass. The pass stops
+ * after a number of moves without improvement, and the moves after the
+ * best cut that satisfies the balance bound are undone.
+ * </pre>
+ */
+static void
+nd_refine(nd_graph_t *g, int_t *part)
+{
+    int_t nv = g->nv, *xadj = g->xadj, *adj = g->adj, *ewgt = g->ewgt;
+    int_t *vwgt = g->vwgt;
+    int_t *id, *ed, *gain, *hpos, *locked, *moves, *h[2], hn[2];
+    int_t w[2], total, maxw, limit, pass, nmoves, best, cut, bestcut;
+    int_t bal, bestbal, ok, bestok, from, to, s, i, j, v, u;
+
+    id     = intMalloc(nv);
+    ed     = intMalloc(nv);
+    gain   = intMalloc(nv);
+    hpos   = intMalloc(nv);
+    locked = intMalloc(nv);
+    moves  = intMalloc(nv);
+    h[0]   = intMalloc(nv);
+    h[1]   = intMalloc(nv);
+    if ( !id || !ed || !gain || !hpos || !locked || !moves || !h[0] || !h[1] )
+	ABORT("Malloc fails for nd_refine work arrays.");
+
+    w[0] = w[1] = 0;
+    for (v = 0; v < nv; ++v) w[part[v]] += vwgt[v];
+    total = w[0] + w[1];
+    maxw = total / 2 + (total * ND_UBFACTOR) / 200;
+    limit = SUPERLU_MIN(SUPERLU_MAX(nv / 100, 25), 150);
+
+    for (pass = 0; pass < ND_NPASS; ++pass) {
+	cut = 0;
+	hn[0] = hn[1] = 0;
+	for (v = 0; v < nv; ++v) {
+	    id[v] = ed[v] = 0;
+	    for (j = xadj[v]; j < xadj[v+1]; ++j) {
+		if ( part[adj[j]] == part[v] ) id[v] += ewgt[j];
+		else ed[v] += ewgt[j];
+	    }
+	    cut += ed[v];
+	    gain[v] = ed[v] - id[v];
+	    locked[v] = 0;
+	    hpos[v] = EMPTY;
+	    if ( ed[v] > 0 ) {
+		s = part[v];
+		h[s][hn[s]++] = v;
+		nd_heap_up(h[s], hpos, gain, hn[s] - 1);
+	    }
+	}
+	cut /= 2;
+	bestcut = cut;
+	bestbal = SUPERLU_MAX(w[0] - w[1], w[1] - w[0]);
+	bestok = ( w[0] <= maxw && w[1] <= maxw );
+	best = nmoves = 0;
+
+	while ( nmoves - best <= limit ) {
+	    /* Move from the side that is too heavy, or else the move with
+	       the larger gain that keeps the balance. */
+	    from = EMPTY;
+	    for (s = 0; s < 2; ++s) {
+		if ( hn[s] == 0 ) continue;
+		v = h[s][0];
+		if ( w[s] == vwgt[v] ) continue;
+		if ( w[s] > maxw ) {
+		    from = s;
+		    break;
+		}
+		if ( w[1-s] + vwgt[v] > maxw ) continue;
+		if ( from == EMPTY || gain[v] > gain[h[from][0]] ) from = s;
+	    }
+	    if ( from == EMPTY ) break;
+	    to = 1 - from;
+
+	    v = h[from][0];
+	    nd_heap_remove(h[from], hpos, gain, &hn[from], v);
+	    part[v] = to;
+	    w[from] -= vwgt[v];
+	    w[to] += vwgt[v];
+	    cut -= gain[v];
+	    locked[v] = 1;
+	    u = id[v]; id[v] = ed[v]; ed[v] = u;
+	    gain[v] = -gain[v];
+	    moves[nmoves++] = v;
+
+	    for (j = xadj[v]; j < xadj[v+1]; ++j) {
+		u = adj[j];
+		if ( part[u] == to ) {
+		    id[u] += ewgt[j];
+		    ed[u] -= ewgt[j];
+		} else {
+		    id[u] -= ewgt[j];
+		    ed[u] += ewgt[j];
+		}
+		if ( locked[u] ) continue;
+		gain[u] = ed[u] - id[u];
+		s = part[u];
+		if ( ed[u] > 0 ) {
+		    if ( hpos[u] == EMPTY ) {
+			h[s][hn[s]++] = u;
+			nd_heap_up(h[s], hpos, gain, hn[s] - 1);
+		    } else {
+			nd_heap_up(h[s], hpos, gain, hpos[u]);
+			nd_heap_down(h[s], hpos, gain, hn[s], hpos[u]);
+		    }
+		} else if ( hpos[u] != EMPTY ) {
+		    nd_heap_remove(h[s], hpos, gain, &hn[s], u);
+		}
+	    }
+
+	    bal = SUPERLU_MAX(w[0] - w[1], w[1] - w[0]);
+	    ok = ( w[0] <= maxw && w[1] <= maxw );
+	    if ( (ok && (!bestok || cut < bestcut ||
+			 (cut == bestcut && bal < bestbal))) ||
+		 (!ok && !bestok && bal < bestbal) ) {
+		best = nmoves;
+		bestcut = cut;
+		bestbal = bal;
+		bestok = ok;
+	    }
+	}
+
+	/* Undo the moves after the best one. */
+	for (i = nmoves - 1; i >= best; --i) {
+	    v = moves[i];
+	    w[part[v]] -= vwgt[v];
+	    part[v] = 1 - part[v];
+	    w[part[v]] += vwgt[v];
+	}
+	if ( best == 0 ) break;
+    }
+
+    SUPERLU_FREE(id);
+    SUPERLU_FREE(ed);
+    SUPERLU_FREE(gain);
+    SUPERLU_FREE(hpos);
+    SUPERLU_FREE(locked);
+    SUPERLU_FREE(moves);
+    SUPERLU_FREE(h[0]);
+    SUPERLU_FREE(h[1]);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Initial bisection of a small graph by graph growing: a breadth-first
+ * search from a start vertex puts vertices on side 0 until that side
+ * holds half the weight. Several start vertices are tried, and the
+ * refined bisection with the smallest cut is kept.
+ * </pre>
+ */
+static void
+nd_init_part(nd_graph_t *g, int_t *part, unsigned int *seed)
+{
+    int_t nv = g->nv, *xadj = g->xadj, *adj = g->adj, *vwgt = g->vwgt;
+    int_t *best, *queue, *perm;
+    int_t try, total, w0, head, tail, next, j, v, u, cut, bestcut = -1;
+
+    best  = intMalloc(nv);
+    queue = intMalloc(nv);
+    perm  = intMalloc(nv);
+    if ( !best || !queue || !perm ) ABORT("Malloc fails for queue[].");
+
+    total = 0;
+    for (v = 0; v < nv; ++v) total += vwgt[v];
+
+    for (try = 0; try < ND_NTRIES; ++try) {
+	for (v = 0; v < nv; ++v) part[v] = 1;
+	w0 = 0;
+	head = tail = 0;
+	next = 0;
+	nd_randperm(nv, perm, seed);
+	while ( 2 * w0 < total ) {
+	    if ( head == tail ) {
+		/* Start (again) from an unvisited vertex */
+		while ( part[perm[next]] == 0 ) ++next;
+		v = perm[next];
+		part[v] = 0;
+		queue[tail++] = v;
+		w0 += vwgt[v];
+		continue;
+	    }
+	    v = queue[head++];
+	    for (j = xadj[v]; j < xadj[v+1] && 2 * w0 < total; ++j) {
+		u = adj[j];
+		if ( part[u] == 1 ) {
+		    part[u] = 0;
+		    queue[tail++] = u;
+		    w0 += vwgt[u];
+		}
+	    }
+	}
+	if ( w0 == total && tail > 1 )  /* keep both sides nonempty */
+	    part[queue[tail-1]] = 1;
+	nd_refine(g, part);
+	cut = nd_cut(g, part);
+	if ( bestcut < 0 || cut < bestcut ) {
+	    bestcut = cut;
+	    for (v = 0; v < nv; ++v) best[v] = part[v];
+	}
+    }
+    for (v = 0; v < nv; ++v) part[v] = best[v];
+
+    SUPERLU_FREE(best);
+    SUPERLU_FREE(queue);
+    SUPERLU_FREE(perm);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Multilevel bisection of g: coarsen until the graph is small or stops
+ * shrinking, bisect the coarsest graph, and project the bisection back
+ * level by level, refining it on each level. On exit part[v] is 0 or 1.
+ * </pre>
+ */
+static void
+nd_bisect(nd_graph_t *g, int_t *part, unsigned int *seed)
+{
+    nd_graph_t cg;
+    int_t *cmap, *cpart, v;
+
+    if ( g->nv <= ND_COARSEST ) {
+	nd_init_part(g, part, seed);
+	return;
+    }
+
+    cmap = intMalloc(g->nv);
+    if ( !cmap ) ABORT("Malloc fails for cmap[].");
+    nd_coarsen(g, &cg, cmap);
+    if ( 10 * cg.nv > 9 * g->nv ) {
+	nd_graph_free(&cg);
+	SUPERLU_FREE(cmap);
+	nd_init_part(g, part, seed);
+	return;
+    }
+
+    cpart = intMalloc(cg.nv);
+    if ( !cpart ) ABORT("Malloc fails for cpart[].");
+    nd_bisect(&cg, cpart, seed);
+    for (v = 0; v < g->nv; ++v) part[v] = cpart[cmap[v]];
+    SUPERLU_FREE(cpart);
+    nd_graph_free(&cg);
+    SUPERLU_FREE(cmap);
+
+    nd_refine(g, part);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Turns the edge separator given by the bisection part[] into a vertex
+ * separator: the cut edges form a bipartite graph between the boundary
+ * vertices of the two sides, and a minimum vertex cover of it is found
+ * from a maximum matching (Koenig's theorem). The cover is marked
+ * part[v] = 2.
+ * </pre>
+ */
+static void
+nd_vsep(nd_graph_t *g, int_t *part)
+{
+    int_t nv = g->nv, *xadj = g->xadj, *adj = g->adj;
+    int_t *mate, *visit, *iter, *stack, *queue;
+    int_t i, j, v, u, x, y, top, head, tail, found, stamp, prev;
+
+    mate  = intMalloc(nv);
+    visit = intMalloc(nv);
+    iter  = intMalloc(nv);
+    stack = intMalloc(nv);
+    queue = intMalloc(nv);
+    if ( !mate || !visit || !iter || !stack || !queue )
+	ABORT("Malloc fails for mate[].");
+
+    for (v = 0; v < nv; ++v) {
+	mate[v] = EMPTY;
+	visit[v] = 0;
+    }
+
+    /* Maximum matching of the cut edges, from side 0 to side 1. */
+    stamp = 0;
+    for (v = 0; v < nv; ++v) {
+	if ( part[v] != 0 ) continue;
+	for (j = xadj[v]; j < xadj[v+1]; ++j) {
+	    u = adj[j];
+	    if ( part[u] == 1 && mate[u] == EMPTY ) {
+		mate[u] = v;
+		mate[v] = u;
+		break;
+	    }
+	}
+    }
+    for (v = 0; v < nv; ++v) {
+	if ( part[v] != 0 || mate[v] != EMPTY ) continue;
+
+	/* Depth-first search for an augmenting path from v */
+	++stamp;
+	top = 0;
+	stack[top++] = v;
+	visit[v] = stamp;
+	iter[v] = xadj[v];
+	found = EMPTY;
+	while ( top > 0 && found == EMPTY ) {
+	    x = stack[top-1];
+	    while ( iter[x] < xadj[x+1] ) {
+		u = adj[iter[x]++];
+		if ( part[u] != 1 ) continue;
+		if ( mate[u] == EMPTY ) {
+		    found = u;
+		    break;
+		}
+		y = mate[u];
+		if ( visit[y] != stamp ) {
+		    visit[y] = stamp;
+		    iter[y] = xadj[y];
+		    stack[top++] = y;
+		    break;
+		}
+	    }
+	    if ( found == EMPTY && stack[top-1] == x && iter[x] >= xadj[x+1] )
+		--top;
+	}
+	if ( found != EMPTY ) {
+	    u = found;
+	    for (i = top - 1; i >= 0; --i) {
+		x = stack[i];
+		prev = mate[x];
+		mate[x] = u;
+		mate[u] = x;
+		u = prev;
+	    }
+	}
+    }
+
+    /* Z = vertices reachable from the unmatched side-0 boundary vertices
+       by alternating paths. The cover is (side-0 boundary \ Z) plus
+       (side-1 boundary and Z). */
+    ++stamp;
+    head = tail = 0;
+    for (v = 0; v < nv; ++v) {
+	if ( part[v] != 0 || mate[v] != EMPTY ) continue;
+	visit[v] = stamp;
+	queue[tail++] = v;
+    }
+    while ( head < tail ) {
+	x = queue[head++];
+	for (j = xadj[x]; j < xadj[x+1]; ++j) {
+	    u = adj[j];
+	    if ( part[u] != 1 || visit[u] == stamp ) continue;
+	    visit[u] = stamp;
+	    y = mate[u];
+	    if ( y != EMPTY && visit[y] != stamp ) {
+		visit[y] = stamp;
+		queue[tail++] = y;
+	    }
+	}
+    }
+    for (v = 0; v < nv; ++v) {
+	if ( mate[v] == EMPTY ) continue;   /* every cover vertex is matched */
+	if ( (part[v] == 0 && visit[v] != stamp) ||
+	     (part[v] == 1 && visit[v] == stamp) )
+	    queue[v] = 2;
+	else
+	    queue[v] = part[v];
+    }
+    for (v = 0; v < nv; ++v)
+	if ( mate[v] != EMPTY ) part[v] = queue[v];
+
+    SUPERLU_FREE(mate);
+    SUPERLU_FREE(visit);
+    SUPERLU_FREE(iter);
+    SUPERLU_FREE(stack);
+    SUPERLU_FREE(queue);
+}
+
+/*! \brief Orders a subgraph by multiple minimum degree (GENMMD). On exit
+ *  mmdperm[k] is the local vertex placed k-th.
+ */
+static void
+nd_mmd(nd_graph_t *g, int_t *mmdperm)
+{
+    int_t nv = g->nv, nnz = g->xadj[nv];
+    int_t *xadj, *adj, *invp, *dhead, *qsize, *llist, *marker;
+    int_t i, delta = 0, maxint = 2147483647, nofsub;
+
+    if ( nnz == 0 ) {
+	for (i = 0; i < nv; ++i) mmdperm[i] = i;
+	return;
+    }
+
+    xadj   = intMalloc(nv + 1);
+    adj    = intMalloc(nnz);
+    invp   = intMalloc(nv);
+    dhead  = intMalloc(nv);
+    qsize  = intMalloc(nv);
+    llist  = intMalloc(nv);
+    marker = intMalloc(nv);
+    if ( !xadj || !adj || !invp || !dhead || !qsize || !llist || !marker )
+	ABORT("Malloc fails for GENMMD work arrays.");
+
+    /* GENMMD uses 1-based indexing and destroys its adjacency list. */
+    for (i = 0; i <= nv; ++i) xadj[i] = g->xadj[i] + 1;
+    for (i = 0; i < nnz; ++i) adj[i] = g->adj[i] + 1;
+
+    genmmd_((int*)&nv, (int*)xadj, (int*)adj, (int*)invp, (int*)mmdperm,
+	    (int*)&delta, (int*)dhead, (int*)qsize, (int*)llist,
+	    (int*)marker, (int*)&maxint, (int*)&nofsub);
+    for (i = 0; i < nv; ++i) --mmdperm[i];
+
+    SUPERLU_FREE(xadj);
+    SUPERLU_FREE(adj);
+    SUPERLU_FREE(invp);
+    SUPERLU_FREE(dhead);
+    SUPERLU_FREE(qsize);
+    SUPERLU_FREE(llist);
+    SUPERLU_FREE(marker);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GET_ND computes a nested dissection ordering of a symmetric graph,
+ * given as the structure of A'+A without the diagonal by AT_PLUS_A.
+ *
+ * A vertex separator splits the graph into two parts that are not
+ * connected to each other. The parts are ordered first, recursively in
+ * the same way, and the separator last. The separator is found by
+ * multilevel bisection (heavy-edge coarsening, graph growing on the
+ * coarsest graph, and greedy boundary refinement on each level), as in
+ * METIS, followed by a minimum vertex cover of the cut edges. Subgraphs
+ * with at most ND_LEAF vertices, or without a good separator, are
+ * ordered by multiple minimum degree (GENMMD).
+ *
+ * Arguments
+ * =========
+ *
+ * n       (input) int_t
+ *         The number of vertices.
+ *
+ * b_colptr, b_rowind (input) int_t*
+ *         The adjacency lists of the graph, in column oriented format.
+ *
+ * perm_c  (output) int_t*, dimension (n)
+ *         The ordering; perm_c[i] = j means vertex i is in position j.
+ * </pre>
+ */
+void
+get_nd(int_t n, int_t *b_colptr, int_t *b_rowind, int_t *perm_c)
+{
+    nd_graph_t g;
+    int_t *lst, *gmap, *part, *stack, *tmp;
+    int_t top, first, nv, nnz, i, j, k, v, cnt[3], pos[3];
+    unsigned int seed = 7;
+
+    lst   = intMalloc(n);
+    gmap  = intMalloc(n);
+    part  = intMalloc(n);
+    tmp   = intMalloc(n);
+    stack = intMalloc(2 * n + 2);
+    g.xadj = intMalloc(n + 1);
+    g.adj  = intMalloc(SUPERLU_MAX(b_colptr[n], 1));
+    g.vwgt = intMalloc(n);
+    g.ewgt = intMalloc(SUPERLU_MAX(b_colptr[n], 1));
+    if ( !lst || !gmap || !part || !tmp || !stack || !g.xadj || !g.adj ||
+	 !g.vwgt || !g.ewgt )
+	ABORT("Malloc fails for get_nd work arrays.");
+
+    /* lst[first:first+nv-1] holds the vertices of the subgraph that is
+       ordered in positions first:first+nv-1. */
+    for (i = 0; i < n; ++i) {
+	lst[i] = i;
+	gmap[i] = EMPTY;
+    }
+    top = 0;
+    if ( n > 0 ) {
+	stack[top++] = 0;
+	stack[top++] = n;
+    }
+
+    while ( top > 0 ) {
+	nv = stack[--top];
+	first = stack[--top];
+
+	/* Extract the subgraph induced by lst[first:first+nv-1]. */
+	for (i = 0; i < nv; ++i) gmap[lst[first + i]] = i;
+	nnz = 0;
+	for (i = 0; i < nv; ++i) {
+	    v = lst[first + i];
+	    g.xadj[i] = nnz;
+	    g.vwgt[i] = 1;
+	    for (j = b_colptr[v]; j < b_colptr[v+1]; ++j) {
+		k = gmap[b_rowind[j]];
+		if ( k != EMPTY ) {
+		    g.adj[nnz] = k;
+		    g.ewgt[nnz++] = 1;
+		}
+	    }
+	}
+	g.xadj[nv] = nnz;
+	g.nv = nv;
+	for (i = 0; i < nv; ++i) gmap[lst[first + i]] = EMPTY;
+
+	cnt[0] = cnt[1] = cnt[2] = 0;
+	if ( nv > ND_LEAF && nnz > 0 ) {
+	    nd_bisect(&g, part, &seed);
+	    nd_vsep(&g, part);
+	    for (i = 0; i < nv; ++i) ++cnt[part[i]];
+	}
+
+	if ( (cnt[2] == 0 && (cnt[0] == 0 || cnt[1] == 0)) ||
+	     2 * cnt[2] > nv ) {
+	    /* A leaf, or no useful separator: minimum degree. */
+	    nd_mmd(&g, part);
+	    for (i = 0; i < nv; ++i) tmp[i] = lst[first + part[i]];
+	    for (i = 0; i < nv; ++i) lst[first + i] = tmp[i];
+	    continue;
+	}
+
+	/* Side 0, then side 1, then the separator. */
+	pos[0] = 0;
+	pos[1] = cnt[0];
+	pos[2] = cnt[0] + cnt[1];
+	for (i = 0; i < nv; ++i) tmp[pos[part[i]]++] = lst[first + i];
+	for (i = 0; i < nv; ++i) lst[first + i] = tmp[i];
+
+	if ( cnt[1] > 0 ) {
+	    stack[top++] = first + cnt[0];
+	    stack[top++] = cnt[1];
+	}
+	if ( cnt[0] > 0 ) {
+	    stack[top++] = first;
+	    stack[top++] = cnt[0];
+	}
+    }
+
+    for (i = 0; i < n; ++i) perm_c[lst[i]] = i;
+
+    SUPERLU_FREE(lst);
+    SUPERLU_FREE(gmap);
+    SUPERLU_FREE(part);
+    SUPERLU_FREE(tmp);
+    SUPERLU_FREE(stack);
+    nd_graph_free(&g);
+}
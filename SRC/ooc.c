@@ -0,0 +1,592 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file ooc.c
+ * \brief Out-of-core storage of the L\U factors
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ *
+ * With options->OutOfCore = YES, dgstrf allocates the numerical values
+ * of L and U, lusup[] and ucol[], by ooc_malloc(): a shared mapping of an
+ * unlinked scratch file in the directory set by ooc_scratch_dir(), or in
+ * $TMPDIR or /tmp. The file blocks are reserved with posix_fallocate(),
+ * so that running out of disk space is a failed allocation and not a
+ * fault at the first store. The mapping is freed and resized by
+ * superlu_free() and superlu_realloc() like any other block.
+ *
+ * During the factorization, ooc_retire() writes the parts that are not
+ * referenced again to the file, and drops them from memory:
+ *   - ucol[] of a column as soon as it is computed, as the factorization
+ *     never reads U again;
+ *   - lusup[] of a supernode after the last column it updates. By the
+ *     result of George and Ng, the structure of U is contained in that of
+ *     the Cholesky factor R of A'*A, so column k of L updates no column
+ *     after lastuse(k), the largest j with R(k,j) != 0. This is computed
+ *     from the pattern of A and its column elimination tree: for a row r
+ *     of A with first and last nonzero columns f < l, R(k,l) != 0 for the
+ *     columns k on the etree path from f to l.
+ * The row indices lsub[] and usub[] stay in memory. Dropping is advisory:
+ * a page that is touched again is read back from the file, so the bound
+ * affects only the I/O volume and never the results.
+ *
+ * The solve dgstrs() streams the factors back in with ooc_stream(), which
+ * prefetches a window ahead of the supernode being solved and drops the
+ * pages more than a window behind it.
+ *
+ * SuperLUStat_t counts the bytes written, i.e. resident when dropped,
+ * in OOCWrite, and the bytes that were not resident when prefetched in
+ * OOCRead. Outside Linux, ooc_malloc() fails and the factors are kept in
+ * memory.
+ */
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "slu_ddefs.h"
+
+/* Pages are dropped, and prefetched, this many bytes at a time */
+#define OOC_BATCH  ((size_t) 4 << 20)
+
+struct OOCState {
+    int_t   n;
+    int_t   lword;      /* size of an entry of lusup[] and ucol[] */
+    int_t   *lastuse;   /* last column updated by column k */
+    int_t   *head;      /* columns k with lastuse[k] = j, linked by next[] */
+    int_t   *next;
+    int_t   *smax;      /* max lastuse over supernode s; EMPTY while not
+			   known, n once s is dropped */
+    int_t   jdone;      /* columns 0, ..., jdone-1 have been retired */
+    size_t  lfrom, lto; /* pending range of lusup[], in bytes */
+    size_t  udone;      /* ucol[] is dropped below this byte offset */
+};
+
+#if defined(__linux__)
+
+typedef struct {
+    char    *addr;
+    size_t  len;
+    int     fd;
+} ooc_map_t;
+
+/* The table of mappings and the directory name are allocated by malloc()
+   rather than SUPERLU_MALLOC(), since superlu_free() and superlu_realloc()
+   look up the table inside the same critical section. ooc_nmaps is only
+   changed inside it, by atomic updates, so that ooc_owns() can read it
+   atomically outside. */
+static ooc_map_t *ooc_maps = NULL;
+static int ooc_nmaps = 0, ooc_maxmaps = 0;
+static char *ooc_dirname = NULL;
+
+static size_t
+ooc_pagesize(void)
+{
+    static size_t pg = 0;
+    if ( !pg ) pg = (size_t) sysconf(_SC_PAGESIZE);
+    return pg;
+}
+
+/* Index of the mapping at addr in ooc_maps[], or -1. Called inside the
+   critical section. */
+static int
+ooc_find(void *addr)
+{
+    int i;
+    for (i = 0; i < ooc_nmaps; ++i)
+	if ( ooc_maps[i].addr == addr ) return i;
+    return -1;
+}
+
+/* Copies the mapping at addr to *map; returns 0 if there is none. */
+static int
+ooc_lookup(void *addr, ooc_map_t *map)
+{
+    int i;
+
+#pragma omp critical (ooc)
+    {
+    i = ooc_find(addr);
+    if ( i >= 0 ) *map = ooc_maps[i];
+    }
+    return i >= 0;
+}
+
+/* Bytes of the pages in [addr, addr+len) that are in memory (resident
+   = 1) or not (resident = 0). */
+static double
+ooc_resident(char *addr, size_t len, int resident)
+{
+    unsigned char vec[1024];
+    size_t pg = ooc_pagesize(), off, np, i, bytes = 0;
+
+    for (off = 0; off < len; off += np * pg) {
+	np = SUPERLU_MIN(1024, (len - off + pg - 1) / pg);
+	if ( mincore(addr + off, SUPERLU_MIN(np * pg, len - off), vec) )
+	    return 0.;
+	for (i = 0; i < np; ++i)
+	    if ( (vec[i] & 1) == resident ) bytes += pg;
+    }
+    return (double) bytes;
+}
+
+/*! \brief Writes the whole pages in bytes [from, to) of the mapping at
+ *  base to its file, and drops them from memory. The bytes that were in
+ *  memory are added to *written, if not NULL. Returns the end of the
+ *  pages dropped, or from if there are none.
+ */
+static size_t
+ooc_evict(void *base, size_t from, size_t to, double *written)
+{
+    ooc_map_t map = {NULL, 0, -1};
+    size_t pg = ooc_pagesize(), lo, hi;
+
+    if ( !ooc_lookup(base, &map) ) return from;
+    to = SUPERLU_MIN(to, map.len);
+    lo = (from + pg - 1) / pg * pg;
+    hi = (to == map.len) ? to : to / pg * pg;
+    if ( hi <= lo ) return from;
+
+    if ( written ) *written += ooc_resident(map.addr + lo, hi - lo, 1);
+    msync(map.addr + lo, hi - lo, MS_SYNC);
+    madvise(map.addr + lo, hi - lo, MADV_DONTNEED);
+    posix_fadvise(map.fd, lo, hi - lo, POSIX_FADV_DONTNEED);
+    return hi;
+}
+
+/*! \brief Starts reading bytes [from, to) of the mapping at base. */
+static void
+ooc_prefetch(char *base, size_t from, size_t to, SuperLUStat_t *stat)
+{
+    size_t pg = ooc_pagesize();
+
+    from = from / pg * pg;
+    stat->OOCRead += ooc_resident(base + from, to - from, 0);
+    madvise(base + from, to - from, MADV_WILLNEED);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * OOC_SCRATCH_DIR sets the directory of the scratch files of
+ * options->OutOfCore. The files are unlinked as soon as they are
+ * created, and need as much space as the values of L and U.
+ * dir = NULL restores the default, $TMPDIR or /tmp.
+ * </pre>
+ */
+void
+ooc_scratch_dir(char *dir)
+{
+    char *s = NULL;
+
+    if ( dir ) {
+	s = (char *) malloc(strlen(dir) + 1);
+	if ( !s ) ABORT("malloc fails for ooc_dirname");
+	strcpy(s, dir);
+    }
+#pragma omp critical (ooc)
+    {
+    free(ooc_dirname);
+    ooc_dirname = s;
+    }
+}
+
+/*! \brief Allocates size bytes backed by a scratch file; returns NULL if
+ *  the file cannot be created, reserved or mapped.
+ */
+void *
+ooc_malloc(size_t size)
+{
+    char    path[4096];
+    char    *dir;
+    int     fd, ok = 0;
+    size_t  len = SUPERLU_MAX(size, 1);
+    void    *addr;
+    ooc_map_t *maps;
+
+#pragma omp critical (ooc)
+    {
+    dir = ooc_dirname ? ooc_dirname : getenv("TMPDIR");
+    if ( !dir || !*dir ) dir = "/tmp";
+    ok = snprintf(path, sizeof(path), "%s/superlu_ooc_XXXXXX", dir)
+	< (int) sizeof(path);
+    }
+    if ( !ok || (fd = mkstemp(path)) < 0 ) return (NULL);
+    unlink(path);  /* removed when closed, also if the process dies */
+    if ( posix_fallocate(fd, 0, len) ) {
+	close(fd);
+	return (NULL);
+    }
+    addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if ( addr == MAP_FAILED ) {
+	close(fd);
+	return (NULL);
+    }
+    /* The factorization moves forward through the arrays; reading ahead
+       around a fault would only bring back pages that were dropped */
+    madvise(addr, len, MADV_RANDOM);
+
+#pragma omp critical (ooc)
+    {
+    ok = 1;
+    if ( ooc_nmaps == ooc_maxmaps ) {
+	maps = (ooc_map_t *) realloc(ooc_maps, (2 * ooc_maxmaps + 4)
+				     * sizeof(ooc_map_t));
+	if ( maps ) {
+	    ooc_maps = maps;
+	    ooc_maxmaps = 2 * ooc_maxmaps + 4;
+	} else ok = 0;
+    }
+    if ( ok ) {
+	ooc_maps[ooc_nmaps].addr = addr;
+	ooc_maps[ooc_nmaps].len = len;
+	ooc_maps[ooc_nmaps].fd = fd;
+#pragma omp atomic
+	++ooc_nmaps;
+    }
+    }
+    if ( !ok ) {
+	munmap(addr, len);
+	close(fd);
+	return (NULL);
+    }
+    return addr;
+}
+
+/*! \brief Returns 1 if addr was allocated by ooc_malloc(). */
+int
+ooc_owns(void *addr)
+{
+    int i, nmaps;
+
+    /* A block is in the table before ooc_malloc() returns it, so a
+       caller that holds one always finds ooc_nmaps > 0. */
+#pragma omp atomic read
+    nmaps = ooc_nmaps;
+    if ( !nmaps ) return 0;
+#pragma omp critical (ooc)
+    i = ooc_find(addr);
+    return i >= 0;
+}
+
+/*! \brief Frees a block from ooc_malloc(), and its scratch file. */
+void
+ooc_free(void *addr)
+{
+    ooc_map_t map = {NULL, 0, -1};
+    int i;
+
+#pragma omp critical (ooc)
+    {
+    i = ooc_find(addr);
+    if ( i >= 0 ) {
+	map = ooc_maps[i];
+#pragma omp atomic
+	--ooc_nmaps;
+	ooc_maps[i] = ooc_maps[ooc_nmaps];
+    }
+    }
+    if ( i < 0 ) ABORT("ooc_free: not an out-of-core block");
+    munmap(map.addr, map.len);
+    close(map.fd);
+}
+
+/*! \brief Resizes a block from ooc_malloc(); on failure returns NULL and
+ *  leaves the block intact.
+ */
+void *
+ooc_realloc(void *addr, size_t size)
+{
+    ooc_map_t map = {NULL, 0, -1};
+    size_t len = SUPERLU_MAX(size, 1);
+    void   *new_addr;
+    int    i;
+
+    if ( !ooc_lookup(addr, &map) )
+	ABORT("ooc_realloc: not an out-of-core block");
+    if ( len > map.len && posix_fallocate(map.fd, 0, len) ) return (NULL);
+    new_addr = mremap(map.addr, map.len, len, MREMAP_MAYMOVE);
+    if ( new_addr == MAP_FAILED ) return (NULL);
+
+#pragma omp critical (ooc)
+    {
+    i = ooc_find(addr);
+    ooc_maps[i].addr = new_addr;
+    ooc_maps[i].len = len;
+    }
+    return new_addr;
+}
+
+#else  /* not Linux: everything stays in memory */
+
+static size_t
+ooc_evict(void *base, size_t from, size_t to, double *written)
+{
+    return from;
+}
+
+static void
+ooc_prefetch(char *base, size_t from, size_t to, SuperLUStat_t *stat)
+{
+}
+
+void ooc_scratch_dir(char *dir) {}
+void *ooc_malloc(size_t size) { return (NULL); }
+int ooc_owns(void *addr) { return 0; }
+void ooc_free(void *addr) { ABORT("ooc_free: not an out-of-core block"); }
+void *ooc_realloc(void *addr, size_t size)
+{
+    ABORT("ooc_realloc: not an out-of-core block");
+    return (NULL);
+}
+
+#endif
+
+
+/* Root of the set of k in the union-find forest anc[], with path
+   compression. */
+static int_t
+ooc_anc(int_t *anc, int_t k)
+{
+    int_t r = k, t;
+
+    while ( anc[r] != r ) r = anc[r];
+    while ( anc[k] != r ) {
+	t = anc[k];
+	anc[k] = r;
+	k = t;
+    }
+    return r;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * OOC_INIT sets up the retirement of the L\U factors of A, stored in
+ * column-permuted format (Stype = SLU_NCP), for dgstrf() with
+ * options->OutOfCore = YES. etree is the postordered column elimination
+ * tree of A, and lword the size of a numerical value. Returns NULL if
+ * out-of-core storage is not available.
+ *
+ * lastuse(k), the last column that column k can update, is set rows
+ * first in decreasing order of their last column l: the columns on the
+ * etree path from the first column f of the row up to l, that have not
+ * been set by a row with a larger l, get lastuse = l. A union-find over
+ * the columns set so far skips them, so that the time is almost linear
+ * in nnz(A) + n.
+ * </pre>
+ */
+OOCState_t *
+ooc_init(SuperMatrix *A, int_t *etree, int_t lword)
+{
+    NCPformat *Astore = A->Store;
+    int_t   m = A->nrow, n = A->ncol;
+    int_t   *first, *lastc, *rhead, *rnext, *anc;
+    int_t   i, j, k, r;
+    OOCState_t *st;
+
+#if defined(__linux__)
+    st = (OOCState_t *) SUPERLU_MALLOC(sizeof(OOCState_t));
+    if ( !st ) ABORT("SUPERLU_MALLOC fails for OOCState_t");
+    st->n = n;
+    st->lword = lword;
+    st->lastuse = intMalloc(4 * SUPERLU_MAX(n, 1));
+    if ( !st->lastuse ) ABORT("SUPERLU_MALLOC fails for st->lastuse[]");
+    st->head = st->lastuse + n;
+    st->next = st->head + n;
+    st->smax = st->next + n;
+    st->jdone = 0;
+    st->lfrom = st->lto = st->udone = 0;
+
+    first = intMalloc(3 * SUPERLU_MAX(m, 1) + 2 * n + 1);
+    if ( !first ) ABORT("SUPERLU_MALLOC fails for first[]");
+    lastc = first + m;
+    rnext = lastc + m;
+    rhead = rnext + m;
+    anc   = rhead + n;
+
+    ifill(first, m, EMPTY);
+    for (j = 0; j < n; ++j)
+	for (i = Astore->colbeg[j]; i < Astore->colend[j]; ++i) {
+	    r = Astore->rowind[i];
+	    if ( first[r] == EMPTY ) first[r] = j;
+	    lastc[r] = j;
+	}
+
+    /* Rows by their last column */
+    ifill(rhead, n, EMPTY);
+    for (r = 0; r < m; ++r)
+	if ( first[r] != EMPTY && first[r] < lastc[r] ) {
+	    rnext[r] = rhead[lastc[r]];
+	    rhead[lastc[r]] = r;
+	}
+
+    for (k = 0; k <= n; ++k) anc[k] = k;
+    for (k = 0; k < n; ++k) st->lastuse[k] = k;
+    for (j = n - 1; j > 0; --j)
+	for (r = rhead[j]; r != EMPTY; r = rnext[r])
+	    for (k = ooc_anc(anc, first[r]); k < j; k = ooc_anc(anc, k)) {
+		st->lastuse[k] = j;
+		anc[k] = etree[k];
+	    }
+
+    ifill(st->head, n, EMPTY);
+    for (k = 0; k < n; ++k) {
+	st->next[k] = st->head[st->lastuse[k]];
+	st->head[st->lastuse[k]] = k;
+    }
+    ifill(st->smax, n, EMPTY);
+
+    SUPERLU_FREE(first);
+    return st;
+#else
+    return (NULL);
+#endif
+}
+
+/* Adds the supernode s to the pending range of lusup[] if it is closed,
+   i.e. s < nclosed, and no column from jnext on uses it. */
+static void
+ooc_retire_snode(OOCState_t *st, int_t s, int_t nclosed, int_t jnext,
+		 GlobalLU_t *Glu, SuperLUStat_t *stat)
+{
+    int_t  *xsup = Glu->xsup, *xlusup = Glu->xlusup;
+    int_t  k, smax;
+    size_t from, to;
+
+    if ( s >= nclosed || st->smax[s] == st->n ) return;
+    if ( (smax = st->smax[s]) == EMPTY ) {
+	for (k = xsup[s]; k < xsup[s+1]; ++k)
+	    smax = SUPERLU_MAX(smax, st->lastuse[k]);
+	st->smax[s] = smax;
+    }
+    if ( smax >= jnext ) return;
+    st->smax[s] = st->n;
+
+    from = (size_t) xlusup[xsup[s]] * st->lword;
+    to   = (size_t) xlusup[xsup[s+1]] * st->lword;
+    if ( from != st->lto ) {
+	ooc_evict(Glu->lusup, st->lfrom, st->lto, &stat->OOCWrite);
+	st->lfrom = from;
+    }
+    st->lto = to;
+    if ( st->lto - st->lfrom >= OOC_BATCH )
+	st->lfrom = ooc_evict(Glu->lusup, st->lfrom, st->lto,
+			      &stat->OOCWrite);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * OOC_RETIRE is called by dgstrf_cols() when the columns before jnext
+ * are factored. It drops the columns of U computed since the last call,
+ * and the supernodes of L that no column from jnext on updates, a batch
+ * at a time.
+ * </pre>
+ */
+void
+ooc_retire(OOCState_t *st, int_t jnext, GlobalLU_t *Glu,
+	   SuperLUStat_t *stat)
+{
+    int_t  *supno = Glu->supno;
+    int_t  j, k, nclosed;
+    size_t to;
+
+    if ( jnext <= st->jdone ) return;
+
+    /* Only the last supernode can still grow */
+    nclosed = supno[jnext-1] + (jnext == st->n);
+    if ( st->jdone > 0 )
+	ooc_retire_snode(st, supno[st->jdone-1], nclosed, jnext, Glu, stat);
+    for (j = st->jdone; j < jnext; ++j)
+	for (k = st->head[j]; k != EMPTY; k = st->next[k])
+	    ooc_retire_snode(st, supno[k], nclosed, jnext, Glu, stat);
+    st->jdone = jnext;
+
+    to = (size_t) Glu->xusub[jnext] * st->lword;
+    if ( to - st->udone >= OOC_BATCH )
+	st->udone = ooc_evict(Glu->ucol, st->udone, to, &stat->OOCWrite);
+}
+
+/*! \brief Drops what is left of lusup[] and ucol[] from memory, unless
+ *  Glu = NULL, and frees st.
+ */
+void
+ooc_finish(OOCState_t *st, GlobalLU_t *Glu, SuperLUStat_t *stat)
+{
+    if ( !st ) return;
+    if ( Glu ) {
+	ooc_evict(Glu->lusup, 0, (size_t) -1, &stat->OOCWrite);
+	ooc_evict(Glu->ucol, 0, (size_t) -1, &stat->OOCWrite);
+    }
+    SUPERLU_FREE(st->lastuse);
+    SUPERLU_FREE(st);
+}
+
+/*! \brief Sets up s to read the len bytes at base, in increasing
+ *  (down = 0) or decreasing (down = 1) order, if base is out-of-core.
+ */
+void
+ooc_stream_init(ooc_stream_t *s, void *base, size_t len, int down)
+{
+    s->base = ooc_owns(base) ? (char *) base : NULL;
+    s->len = len;
+    s->down = down;
+    s->next = s->done = down ? len : 0;
+}
+
+/*! \brief Moves the stream to byte offset off: prefetches the window
+ *  ahead of it, and drops what is more than a window behind it.
+ */
+void
+ooc_stream(ooc_stream_t *s, size_t off, SuperLUStat_t *stat)
+{
+    size_t a;
+
+    if ( !s->base ) return;
+    if ( !s->down ) {
+	while ( s->next < s->len && off + OOC_BATCH / 2 >= s->next ) {
+	    a = s->next;
+	    s->next = SUPERLU_MIN(s->len, a + OOC_BATCH);
+	    ooc_prefetch(s->base, a, s->next, stat);
+	}
+	if ( off > s->done + 2 * OOC_BATCH ) {
+	    ooc_evict(s->base, s->done, off - OOC_BATCH, NULL);
+	    s->done = off - OOC_BATCH;
+	}
+    } else {
+	while ( s->next > 0 && off < s->next + OOC_BATCH / 2 ) {
+	    a = s->next;
+	    s->next = (a > OOC_BATCH) ? a - OOC_BATCH : 0;
+	    ooc_prefetch(s->base, s->next, a, stat);
+	}
+	if ( off + 2 * OOC_BATCH < s->done ) {
+	    ooc_evict(s->base, off + OOC_BATCH, s->done, NULL);
+	    s->done = off + OOC_BATCH;
+	}
+    }
+}
@@ -0,0 +1,544 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file perm_cache.c
+ * \brief Cache of column orderings and elimination trees, keyed by the
+ *  sparsity pattern
+ *
+ * <pre>
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ *
+ * The drivers xGSSVX and xGSISX consult the cache when options->PermCache
+ * = YES and options->Fact = DOFACT. An entry holds perm_c[] and etree[] as
+ * they are after sp_preorder(), i.e., the fill-reducing ordering composed
+ * with the postorder of the column elimination tree, and the postordered
+ * tree. It is keyed by a 64-bit hash of the pattern (colptr[], rowind[])
+ * of the matrix that is ordered, together with its dimensions, ColPerm,
+ * SymmetricMode and Presolve. Before an entry is reused, its colptr[] and
+ * a second, independent hash of rowind[] must match as well.
+ *
+ * The entries live in memory until perm_cache_clear() is called. After
+ * perm_cache_file() they are also read from, and appended to, a file, so
+ * that they are kept across processes. Each record is appended with one
+ * write() under an exclusive flock(), so that processes sharing the file
+ * do not interleave records, and every record read is checked: perm_c[]
+ * must be a permutation, etree[j] must lie in (j, n], and colptr[] must
+ * be nondecreasing from 0 to nnz. Records that fail are dropped.
+ *
+ * DGSISX also keeps here, when options->PermCache = YES, the row
+ * permutation and the scaling factors computed for options->RowPerm, so
+ * that a later factorization with Fact = SamePattern reuses them. These
+ * are keyed by the pattern and RowPerm, hold the last values stored, and
+ * are kept in memory only.
+ */
+#include <stdio.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+#include "slu_ddefs.h"
+
+typedef unsigned long long perm_cache_key_t;
+
+typedef struct perm_cache_entry {
+    perm_cache_key_t hash, hash2;
+    int_t   m, n, nnz, colperm, symmetric, presolve;
+    int_t   *perm_c;    /* perm_c[] after sp_preorder() */
+    int_t   *etree;     /* postordered column elimination tree */
+    int_t   *colptr;    /* column pointers of the pattern */
+    struct perm_cache_entry *next;
+} perm_cache_entry_t;
+
+/* A record in the file is hash, hash2, the PERM_CACHE_NHEAD fields m, n,
+   nnz, colperm, symmetric and presolve, then perm_c[n], etree[n] and
+   colptr[n+1]. */
+#define PERM_CACHE_NHEAD 6
+#define PERM_CACHE_NINT(n) (PERM_CACHE_NHEAD + 3 * (size_t) (n) + 1)
+static const char perm_cache_magic[8] = "SLUPERM1";
+
+typedef struct rowperm_cache_entry {
+    perm_cache_key_t hash, hash2;
+    int_t   m, n, nnz, rowperm;
+    int_t   *perm;      /* perm[i] = j: row i is moved to row j */
+    int_t   *colptr;    /* column pointers of the pattern */
+    double  *R, *C;     /* scaling factors */
+    char    equed;      /* which of R and C are used, as in dgsisx */
+    struct rowperm_cache_entry *next;
+} rowperm_cache_entry_t;
+
+static perm_cache_entry_t *perm_cache_head = NULL;
+static rowperm_cache_entry_t *rowperm_cache_head = NULL;
+static char *perm_cache_filename = NULL;
+
+/*! \brief Hashes the pattern of the NC matrix A (FNV-1a over the column
+ *  pointers and row indices, with a final avalanche).
+ */
+static perm_cache_key_t
+perm_cache_hash(SuperMatrix *A)
+{
+    NCformat *Astore = A->Store;
+    perm_cache_key_t h = 14695981039346656037ULL;
+    int_t j, n = A->ncol, nnz = Astore->nnz;
+
+    for (j = 0; j <= n; ++j)
+	h = (h ^ (perm_cache_key_t) Astore->colptr[j]) * 1099511628211ULL;
+    for (j = 0; j < nnz; ++j)
+	h = (h ^ (perm_cache_key_t) Astore->rowind[j]) * 1099511628211ULL;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/*! \brief A second hash of the row indices of A, independent of
+ *  perm_cache_hash(): each index is combined with its position and mixed
+ *  by the splitmix64 finalizer.
+ */
+static perm_cache_key_t
+perm_cache_hash2(SuperMatrix *A)
+{
+    NCformat *Astore = A->Store;
+    perm_cache_key_t h = 0x9e3779b97f4a7c15ULL;
+    int_t j, nnz = Astore->nnz;
+
+    for (j = 0; j < nnz; ++j) {
+	h += ((perm_cache_key_t) Astore->rowind[j] << 32)
+	     ^ (perm_cache_key_t) j;
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+    }
+    return h;
+}
+
+/*! \brief Whether an entry with hash2 and colptr[] is for the pattern of
+ *  A, whose hash, dimensions and nnz are already known to match.
+ */
+static int
+perm_cache_same(perm_cache_key_t hash2, int_t *colptr, SuperMatrix *A,
+		perm_cache_key_t A_hash2)
+{
+    NCformat *Astore = A->Store;
+
+    return hash2 == A_hash2 &&
+	!memcmp(colptr, Astore->colptr, (A->ncol + 1) * sizeof(int_t));
+}
+
+static perm_cache_entry_t *
+perm_cache_new(int_t n)
+{
+    perm_cache_entry_t *e;
+
+    e = (perm_cache_entry_t *) SUPERLU_MALLOC(sizeof(perm_cache_entry_t));
+    if ( !e ) ABORT("SUPERLU_MALLOC fails for perm_cache_entry_t");
+    e->perm_c = intMalloc(3 * n + 1);
+    if ( !e->perm_c ) ABORT("SUPERLU_MALLOC fails for perm_cache perm_c[]");
+    e->etree = e->perm_c + n;
+    e->colptr = e->etree + n;
+    e->n = n;
+    return e;
+}
+
+/*! \brief Whether the record rec[] read from the file, of the length
+ *  given by its n, is consistent: see the top of the file. mark[] is
+ *  work space of length n.
+ */
+static int
+perm_cache_valid(int_t *rec, int_t *mark)
+{
+    int_t m = rec[0], n = rec[1], nnz = rec[2], j;
+    int_t *perm_c = &rec[PERM_CACHE_NHEAD], *etree = perm_c + n;
+    int_t *colptr = etree + n;
+
+    if ( m < 0 || nnz < 0 || colptr[0] != 0 || colptr[n] != nnz )
+	return 0;
+    for (j = 0; j < n; ++j) mark[j] = 0;
+    for (j = 0; j < n; ++j) {
+	if ( perm_c[j] < 0 || perm_c[j] >= n || mark[perm_c[j]] ) return 0;
+	mark[perm_c[j]] = 1;
+	if ( etree[j] <= j || etree[j] > n ) return 0;
+	if ( colptr[j] > colptr[j+1] ) return 0;
+    }
+    return 1;
+}
+
+/*! \brief Reads the entries of the cache file, if it exists. Records that
+ *  are inconsistent are dropped; reading stops at a record whose length
+ *  is out of range, such as a truncated last one.
+ */
+static void
+perm_cache_load(FILE *fp)
+{
+    char    magic[8];
+    int     isize;
+    long    start, end;
+    size_t  nint, maxint;
+    int_t   head[PERM_CACHE_NHEAD], *rec = NULL, *mark = NULL, n;
+    perm_cache_key_t hash[2];
+    perm_cache_entry_t *e;
+
+    if ( fread(magic, 1, 8, fp) != 8 || memcmp(magic, perm_cache_magic, 8)
+	 || fread(&isize, sizeof(int), 1, fp) != 1 || isize != sizeof(int_t) )
+	return;
+    start = ftell(fp);
+    if ( start < 0 || fseek(fp, 0L, SEEK_END) || (end = ftell(fp)) < start
+	 || fseek(fp, start, SEEK_SET) )
+	return;
+
+    while ( fread(hash, sizeof(hash), 1, fp) == 1 &&
+	    fread(head, sizeof(int_t), PERM_CACHE_NHEAD, fp)
+	    == PERM_CACHE_NHEAD ) {
+	/* The record must fit in what is left of the file. */
+	n = head[1];
+	maxint = (end - ftell(fp)) / sizeof(int_t) + PERM_CACHE_NHEAD;
+	if ( n < 0 || (size_t) n > maxint || PERM_CACHE_NINT(n) > maxint )
+	    break;
+	nint = PERM_CACHE_NINT(n);
+	rec = (int_t *) SUPERLU_MALLOC(nint * sizeof(int_t));
+	mark = intMalloc(SUPERLU_MAX(n, 1));
+	if ( !rec || !mark ) ABORT("SUPERLU_MALLOC fails for perm_cache_load");
+	memcpy(rec, head, sizeof(head));
+	if ( fread(&rec[PERM_CACHE_NHEAD], sizeof(int_t),
+		   nint - PERM_CACHE_NHEAD, fp) != nint - PERM_CACHE_NHEAD )
+	    break;
+	if ( perm_cache_valid(rec, mark) ) {
+	    e = perm_cache_new(n);
+	    memcpy(e->perm_c, &rec[PERM_CACHE_NHEAD],
+		   (3 * (size_t) n + 1) * sizeof(int_t));
+	    e->hash = hash[0];
+	    e->hash2 = hash[1];
+	    e->m = head[0];
+	    e->nnz = head[2];
+	    e->colperm = head[3];
+	    e->symmetric = head[4];
+	    e->presolve = head[5];
+	    e->next = perm_cache_head;
+	    perm_cache_head = e;
+	}
+	SUPERLU_FREE(rec);
+	SUPERLU_FREE(mark);
+	rec = mark = NULL;
+    }
+    if ( rec ) SUPERLU_FREE(rec);
+    if ( mark ) SUPERLU_FREE(mark);
+}
+
+/*! \brief Appends the nbytes of buf to the cache file, preceded by the
+ *  file header if the file is empty, with one write() under an exclusive
+ *  lock.
+ */
+static void
+perm_cache_append(char *buf, size_t nbytes)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    int     fd;
+    off_t   size;
+    ssize_t done;
+
+    fd = open(perm_cache_filename, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if ( fd < 0 ) return;
+    if ( flock(fd, LOCK_EX) == 0 ) {
+	/* buf starts with room for the header; skip it unless the file is
+	   still empty. */
+	size = lseek(fd, 0, SEEK_END);
+	if ( size > 0 ) {
+	    buf += 8 + sizeof(int);
+	    nbytes -= 8 + sizeof(int);
+	}
+	if ( size >= 0 ) {
+	    done = write(fd, buf, nbytes);
+	    (void) done;    /* failure to write is not an error */
+	}
+	flock(fd, LOCK_UN);
+    }
+    close(fd);
+#else
+    FILE *fp;
+
+    if ( !(fp = fopen(perm_cache_filename, "ab")) ) return;
+    fseek(fp, 0L, SEEK_END);
+    if ( ftell(fp) > 0 ) {
+	buf += 8 + sizeof(int);
+	nbytes -= 8 + sizeof(int);
+    }
+    fwrite(buf, 1, nbytes, fp);
+    fclose(fp);
+#endif
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PERM_CACHE_FILE makes the cache persistent in the file filename: the
+ * entries already in the file are read, and new entries are appended to
+ * it. The file is created when the first entry is stored. Entries written
+ * with a different size of int_t are ignored. filename = NULL keeps the
+ * cache in memory only.
+ * </pre>
+ */
+void
+perm_cache_file(char *filename)
+{
+    FILE *fp;
+
+#pragma omp critical (perm_cache)
+    {
+    if ( perm_cache_filename ) {
+	SUPERLU_FREE(perm_cache_filename);
+	perm_cache_filename = NULL;
+    }
+    if ( filename ) {
+	perm_cache_filename = (char *) SUPERLU_MALLOC(strlen(filename) + 1);
+	if ( !perm_cache_filename )
+	    ABORT("SUPERLU_MALLOC fails for perm_cache_filename");
+	strcpy(perm_cache_filename, filename);
+	if ( (fp = fopen(filename, "rb")) ) {
+	    perm_cache_load(fp);
+	    fclose(fp);
+	}
+    }
+    }
+}
+
+/*! \brief Frees the entries in memory, and forgets the cache file. The
+ *  file itself is not removed.
+ */
+void
+perm_cache_clear(void)
+{
+    perm_cache_entry_t *e;
+    rowperm_cache_entry_t *r;
+
+#pragma omp critical (perm_cache)
+    {
+    while ( (e = perm_cache_head) ) {
+	perm_cache_head = e->next;
+	SUPERLU_FREE(e->perm_c);
+	SUPERLU_FREE(e);
+    }
+    while ( (r = rowperm_cache_head) ) {
+	rowperm_cache_head = r->next;
+	SUPERLU_FREE(r->perm);
+	SUPERLU_FREE(r->R);
+	SUPERLU_FREE(r);
+    }
+    if ( perm_cache_filename ) {
+	SUPERLU_FREE(perm_cache_filename);
+	perm_cache_filename = NULL;
+    }
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PERM_CACHE_LOOKUP looks for the ordering of a matrix with the pattern of
+ * A (in SLU_NC format), ordered with options->ColPerm, SymmetricMode and
+ * Presolve. If there is one, it is copied to perm_c[] and etree[], which
+ * are then as on exit from sp_preorder(), and 1 is returned; otherwise 0
+ * is returned. *hash is set to the hash of the pattern, for the call to
+ * PERM_CACHE_STORE.
+ * </pre>
+ */
+int_t
+perm_cache_lookup(superlu_options_t *options, SuperMatrix *A,
+		  unsigned long long *hash, int_t *perm_c, int_t *etree)
+{
+    perm_cache_entry_t *e;
+    perm_cache_key_t hash2;
+    int_t found = 0, n = A->ncol, nnz = ((NCformat *) A->Store)->nnz;
+
+    *hash = perm_cache_hash(A);
+    hash2 = perm_cache_hash2(A);
+#pragma omp critical (perm_cache)
+    {
+    for (e = perm_cache_head; e; e = e->next)
+	if ( e->hash == *hash && e->m == A->nrow && e->n == n &&
+	     e->nnz == nnz && e->colperm == (int_t) options->ColPerm &&
+	     e->symmetric == (int_t) options->SymmetricMode &&
+	     e->presolve == (int_t) options->Presolve &&
+	     perm_cache_same(e->hash2, e->colptr, A, hash2) ) {
+	    memcpy(perm_c, e->perm_c, n * sizeof(int_t));
+	    memcpy(etree, e->etree, n * sizeof(int_t));
+	    found = 1;
+	    break;
+	}
+    }
+    return found;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PERM_CACHE_STORE adds perm_c[] and etree[], as on exit from
+ * sp_preorder(), to the cache under the pattern of A, with the hash from
+ * PERM_CACHE_LOOKUP. The entry is also appended to the cache file if
+ * there is one; failure to write it is not an error.
+ * </pre>
+ */
+void
+perm_cache_store(superlu_options_t *options, SuperMatrix *A,
+		 unsigned long long hash, int_t *perm_c, int_t *etree)
+{
+    perm_cache_entry_t *e;
+    perm_cache_key_t hashes[2];
+    int_t  n = A->ncol, *head;
+    int    isize = sizeof(int_t);
+    size_t nbytes;
+    char   *buf;
+
+    e = perm_cache_new(n);
+    e->hash = hash;
+    e->hash2 = perm_cache_hash2(A);
+    e->m = A->nrow;
+    e->nnz = ((NCformat *) A->Store)->nnz;
+    e->colperm = options->ColPerm;
+    e->symmetric = options->SymmetricMode;
+    e->presolve = options->Presolve;
+    memcpy(e->perm_c, perm_c, n * sizeof(int_t));
+    memcpy(e->etree, etree, n * sizeof(int_t));
+    memcpy(e->colptr, ((NCformat *) A->Store)->colptr,
+	   (n + 1) * sizeof(int_t));
+
+#pragma omp critical (perm_cache)
+    {
+    e->next = perm_cache_head;
+    perm_cache_head = e;
+    if ( perm_cache_filename ) {
+	/* The file header, then the record. */
+	nbytes = 8 + sizeof(int) + sizeof(hashes)
+	         + PERM_CACHE_NINT(n) * sizeof(int_t);
+	if ( (buf = (char *) SUPERLU_MALLOC(nbytes)) ) {
+	    memcpy(buf, perm_cache_magic, 8);
+	    memcpy(buf + 8, &isize, sizeof(int));
+	    hashes[0] = e->hash;
+	    hashes[1] = e->hash2;
+	    memcpy(buf + 8 + sizeof(int), hashes, sizeof(hashes));
+	    head = (int_t *) (buf + 8 + sizeof(int) + sizeof(hashes));
+	    head[0] = e->m;
+	    head[1] = n;
+	    head[2] = e->nnz;
+	    head[3] = e->colperm;
+	    head[4] = e->symmetric;
+	    head[5] = e->presolve;
+	    memcpy(&head[PERM_CACHE_NHEAD], e->perm_c,
+		   (3 * (size_t) n + 1) * sizeof(int_t));
+	    perm_cache_append(buf, nbytes);
+	    SUPERLU_FREE(buf);
+	}
+    }
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * ROWPERM_CACHE_LOOKUP looks for the row permutation perm[] and the
+ * scaling factors R[], C[] and equed last stored for a matrix with the
+ * pattern of A (in SLU_NC format) and options->RowPerm. If there are,
+ * they are copied out and 1 is returned; otherwise 0 is returned.
+ * </pre>
+ */
+int_t
+rowperm_cache_lookup(superlu_options_t *options, SuperMatrix *A,
+		     int_t *perm, double *R, double *C, char *equed)
+{
+    rowperm_cache_entry_t *r;
+    perm_cache_key_t hash = perm_cache_hash(A), hash2 = perm_cache_hash2(A);
+    int_t found = 0, n = A->ncol, nnz = ((NCformat *) A->Store)->nnz;
+
+#pragma omp critical (perm_cache)
+    {
+    for (r = rowperm_cache_head; r; r = r->next)
+	if ( r->hash == hash && r->m == A->nrow && r->n == n &&
+	     r->nnz == nnz && r->rowperm == (int_t) options->RowPerm &&
+	     perm_cache_same(r->hash2, r->colptr, A, hash2) ) {
+	    memcpy(perm, r->perm, n * sizeof(int_t));
+	    memcpy(R, r->R, A->nrow * sizeof(double));
+	    memcpy(C, r->C, n * sizeof(double));
+	    *equed = r->equed;
+	    found = 1;
+	    break;
+	}
+    }
+    return found;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * ROWPERM_CACHE_STORE keeps perm[], R[], C[] and equed under the pattern
+ * of A and options->RowPerm, replacing those stored before for them.
+ * </pre>
+ */
+void
+rowperm_cache_store(superlu_options_t *options, SuperMatrix *A,
+		    int_t *perm, double *R, double *C, char equed)
+{
+    rowperm_cache_entry_t *r;
+    perm_cache_key_t hash = perm_cache_hash(A), hash2 = perm_cache_hash2(A);
+    int_t  m = A->nrow, n = A->ncol, nnz = ((NCformat *) A->Store)->nnz;
+
+#pragma omp critical (perm_cache)
+    {
+    for (r = rowperm_cache_head; r; r = r->next)
+	if ( r->hash == hash && r->m == m && r->n == n && r->nnz == nnz &&
+	     r->rowperm == (int_t) options->RowPerm &&
+	     perm_cache_same(r->hash2, r->colptr, A, hash2) ) break;
+    if ( !r ) {
+	r = (rowperm_cache_entry_t *)
+	    SUPERLU_MALLOC(sizeof(rowperm_cache_entry_t));
+	if ( !r ) ABORT("SUPERLU_MALLOC fails for rowperm_cache_entry_t");
+	if ( !(r->perm = intMalloc(2 * n + 1)) )
+	    ABORT("SUPERLU_MALLOC fails for rowperm_cache perm[]");
+	r->colptr = r->perm + n;
+	memcpy(r->colptr, ((NCformat *) A->Store)->colptr,
+	       (n + 1) * sizeof(int_t));
+	if ( !(r->R = (double *)
+	      SUPERLU_MALLOC(SUPERLU_MAX(m + n, 1) * sizeof(double))) )
+	    ABORT("SUPERLU_MALLOC fails for rowperm_cache R[]");
+	r->C = r->R + m;
+	r->hash = hash;
+	r->hash2 = hash2;
+	r->m = m;
+	r->n = n;
+	r->nnz = nnz;
+	r->rowperm = options->RowPerm;
+	r->next = rowperm_cache_head;
+	rowperm_cache_head = r;
+    }
+    memcpy(r->perm, perm, n * sizeof(int_t));
+    memcpy(r->R, R, m * sizeof(double));
+    memcpy(r->C, C, n * sizeof(double));
+    r->equed = equed;
+    }
+}
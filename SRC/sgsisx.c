@@ -611,7 +611,9 @@ sgsisx(superlu_options_t *options, SuperMatrix *A, int_t *perm_c, int_t *perm_r,
 	 *   permc_spec = MY_PERMC: the ordering already supplied in perm_c[]
 	 */
 	permc_spec = options->ColPerm;
-	if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
+	if ( permc_spec == AUTO && options->Fact == DOFACT )
+	    get_perm_c_auto(AA, perm_c, stat);
+	else if ( permc_spec != MY_PERMC && options->Fact == DOFACT )
 	    get_perm_c(permc_spec, AA, perm_c);
 	utime[COLPERM] = SuperLU_timer_() - t0;
 
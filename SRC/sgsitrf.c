@@ -261,6 +261,7 @@ sgsitrf(superlu_options_t *options, SuperMatrix *A, int_t relax, int_t panel_siz
     xa_end   = Astore->colend;
 
     /* Allocate storage common to the factor routines */
+    Glu->work = options->LUWorkspace;
     *info = sLUMemInit(fact, work, lwork, m, n, Astore->nnz, panel_size,
 		       gamma, L, U, Glu, &iwork, &swork);
     if ( *info ) return;
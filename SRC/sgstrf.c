@@ -252,6 +252,8 @@ sgstrf (superlu_options_t *options, SuperMatrix *A,
     xa_end   = Astore->colend;
 
     /* Allocate storage common to the factor routines */
+    Glu->work = options->LUWorkspace;
+    Glu->amalg = sp_ienv(10);
     *info = sLUMemInit(fact, work, lwork, m, n, Astore->nnz,
                        panel_size, fill_ratio, L, U, Glu, &iwork, &swork);
     if ( *info ) return;
@@ -103,6 +103,60 @@ typedef int int_t; /* default */
 #include "slu_util.h"
 
 
+/*! \brief Working arrays used by the column and panel kernels of dgstrf.
+ *
+ * The integer arrays are carved out of iwork[] by SetIWork(), and the
+ * real arrays out of dwork[] by dSetRWork(). The threaded factorization
+ * keeps one of these per thread.
+ */
+typedef struct {
+    int_t  *iwork;
+    double *dwork;
+    int_t  *segrep, *parent, *xplore, *repfnz, *panel_lsub, *xprune, *marker;
+    double *dense, *tempv;
+} dLUWork_t;
+
+/*! \brief Work arrays of dgstrs_sparse(), kept across solves with the
+ *  same factors. Set up by dgstrs_sparse_init().
+ */
+typedef struct {
+    int_t  n, nsuper;
+    int_t  *iperm_c;    /* inverse of perm_c */
+    double *z, *work;   /* z is zero between calls */
+    int_t  *marker;     /* zero between calls */
+    int_t  *parent, *xplore, *topoL, *topoU;
+} dSpSolve_t;
+
+/*! \brief Block upper triangular form B = Pr*A*Pc' of A, and the LU
+ *  factors of its diagonal blocks, from dgsbtf().
+ */
+typedef struct {
+    int_t   n;
+    int_t   nblocks;
+    int_t   *r;         /* block b is rows and columns r[b]:r[b+1]-1 of B */
+    int_t   *perm_r;    /* perm_r[i] = k: row i of A is row k of B */
+    int_t   *perm_c;    /* perm_c[j] = k: column j of A is column k of B */
+    SuperMatrix B;      /* Pr*A*Pc', SLU_NC */
+    SuperMatrix *L, *U; /* factors of the blocks of order > 1 */
+    int_t   **bperm_r, **bperm_c; /* and their permutations */
+    double  *diag;      /* the blocks of order 1 */
+    trans_t trans;      /* TRANS: the factors are of transpose(A) */
+} dBTF_t;
+
+/*! \brief One system A*X = B (or A'*X = B) of a stream solved by
+ *  dgspipe().
+ */
+typedef struct {
+    SuperMatrix *A;       /* the matrix, SLU_NC or SLU_NR */
+    SuperMatrix *B, *X;   /* right-hand sides and solution, SLU_DN */
+    double  *ferr, *berr; /* error bounds, B->ncol each */
+    double  rcond;        /* reciprocal condition number estimate */
+    double  rpg;          /* reciprocal pivot growth */
+    char    equed;        /* the equilibration done, as for dgssvx */
+    int_t   info;         /* as for dgssvx */
+} dPipeJob_t;
+
+
 /* -------- Prototypes -------- */
 
 #ifdef __cplusplus
@@ -119,6 +173,18 @@ dgssvx(superlu_options_t *, SuperMatrix *, int_t *, int_t *, int_t *,
        void *, int_t, SuperMatrix *, SuperMatrix *,
        double *, double *, double *, double *,
        GlobalLU_t *, mem_usage_t *, SuperLUStat_t *, int_t *);
+extern void
+dsgssv(superlu_options_t *, SuperMatrix *, int_t *, int_t *, SuperMatrix *,
+       SuperMatrix *, SuperMatrix *, SuperMatrix *, int_t *,
+       SuperLUStat_t *, int_t *);
+extern void
+dgsbtf(superlu_options_t *, SuperMatrix *, dBTF_t *, SuperLUStat_t *,
+       int_t *);
+extern void
+dgsbtrs(trans_t, dBTF_t *, SuperMatrix *, SuperLUStat_t *, int_t *);
+extern void    dDestroy_BTF(dBTF_t *);
+extern void
+dgspipe(superlu_options_t *, int_t, dPipeJob_t *, SuperLUStat_t *, int_t *);
     /* ILU */
 extern void
 dgsisv(superlu_options_t *, SuperMatrix *, int *, int *, SuperMatrix *,
@@ -158,6 +224,15 @@ extern void    dgstrf (superlu_options_t*, SuperMatrix*,
                        int_t, int_t, int_t*, void *, int_t, int_t *, int_t *, 
                        SuperMatrix *, SuperMatrix *, GlobalLU_t *,
 		       SuperLUStat_t*, int_t *);
+extern int_t     dgstrf_cols (superlu_options_t*, SuperMatrix*, int_t, int_t,
+                              int_t, int_t *, int_t *, int_t *, int_t *,
+                              int_t *, dLUWork_t *, GlobalLU_t *,
+                              SuperLUStat_t*, int_t *);
+extern int_t     dgsrefact (superlu_options_t*, SuperMatrix*, int_t *,
+                            SuperMatrix *, SuperMatrix *, SuperLUStat_t*);
+extern int_t     dpgstrf (superlu_options_t*, SuperMatrix*, int_t, int_t *,
+                          int_t *, int_t *, int_t *, int_t *, int_t *,
+                          dLUWork_t *, GlobalLU_t *, SuperLUStat_t*, int_t *);
 extern int_t     dsnode_dfs (const int_t, const int_t, const int_t *, const int_t *,
 			     const int_t *, int_t *, int_t *, GlobalLU_t *);
 extern int_t     dsnode_bmod (const int_t, const int_t, const int_t, double *,
@@ -185,12 +260,23 @@ extern void    dFillRHS (trans_t, int_t, double *, int_t, SuperMatrix *,
 			  SuperMatrix *);
 extern void    dgstrs (trans_t, SuperMatrix *, SuperMatrix *, int_t *, int_t *,
                         SuperMatrix *, SuperLUStat_t*, int_t *);
+extern void    dpgstrs (superlu_options_t *, trans_t, SuperMatrix *,
+                         SuperMatrix *, int_t *, int_t *, SuperMatrix *,
+                         SuperLUStat_t*, int_t *);
+extern void    dgstrs_sparse_init (SuperMatrix *, int_t *, dSpSolve_t *);
+extern void    dgstrs_sparse_free (dSpSolve_t *);
+extern void    dgstrs_sparse (SuperMatrix *, SuperMatrix *, int_t *,
+                               dSpSolve_t *, int_t, int_t *, double *,
+                               double *, int_t *, int_t *, SuperLUStat_t*,
+                               int_t *);
 /* ILU */
 extern void    dgsitrf (superlu_options_t*, SuperMatrix*, int_t, int_t, int_t*,
 		        void *, int_t, int_t *, int_t *, SuperMatrix *, SuperMatrix *,
                         GlobalLU_t *, SuperLUStat_t*, int_t *);
 extern int     dldperm(int_t, int_t, int_t, int_t [], int_t [], double [],
                         int_t [],	double [], double []);
+extern int     dhwpm(int_t, int_t, int_t, int_t [], int_t [], double [],
+                     int_t []);
 extern int_t     ilu_dsnode_dfs (const int_t, const int_t, const int_t *, const int_t *,
 			       const int_t *, int_t *, GlobalLU_t *);
 extern void    ilu_dpanel_dfs (const int_t, const int_t, const int_t, SuperMatrix *,
@@ -218,6 +304,8 @@ extern void    dlaqgs (SuperMatrix *, double *, double *, double,
                         double, double, char *);
 extern void    dgscon (char *, SuperMatrix *, SuperMatrix *, 
 		         double, double *, SuperLUStat_t*, int_t *);
+extern int     dlaconb (int, int, double *, double *, int *, double *, int *,
+                        int [4]);
 extern double   dPivotGrowth(int_t, SuperMatrix *, int_t *, 
                             SuperMatrix *, SuperMatrix *);
 extern void    dgsrfs (trans_t, SuperMatrix *, SuperMatrix *,
@@ -239,9 +327,18 @@ extern         double dmach(char *);   /* from C99 standard, in float.h */
 extern int_t     dLUMemInit (fact_t, void *, int_t, int_t, int_t, int_t, int_t,
                             double, SuperMatrix *, SuperMatrix *,
                             GlobalLU_t *, int_t **, double **);
+extern int_t     dLUMemInitSize (fact_t, void *, int_t, int_t, int_t, int_t,
+                                 int_t, int_t, int_t, int_t, SuperMatrix *,
+                                 SuperMatrix *, GlobalLU_t *, int_t **,
+                                 double **);
+extern double    dLUStackSize (int_t, int_t, int_t, int_t, int_t, int_t);
+extern int_t     dLUWorkInit (int_t, int_t, int_t, int_t **, double **,
+                              GlobalLU_t *);
 extern void    dSetRWork (int_t, int_t, double *, double **, double **);
 extern void    dLUWorkFree (int_t *, double *, GlobalLU_t *);
 extern int_t     dLUMemXpand (int_t, int_t, MemType, int_t *, GlobalLU_t *);
+extern int_t     dLUSubtreeMemInit (int_t, int_t, double, GlobalLU_t *);
+extern void    dLUSubtreeMemFree (GlobalLU_t *);
 
 extern double  *doubleMalloc(int_t);
 extern double  *doubleCalloc(int_t);
@@ -67,6 +67,12 @@ at the top-level directory.
    USER_ABORT(msg); }
 
 
+/* The L\U factor arrays are grown in place by USER_REALLOC, so a
+   USER_MALLOC/USER_FREE replacement must provide a matching one. */
+#if ( defined(USER_MALLOC) || defined(USER_FREE) ) && !defined(USER_REALLOC)
+#error "USER_MALLOC and USER_FREE need a matching USER_REALLOC"
+#endif
+
 #ifndef USER_MALLOC
 #if 1
 #define USER_MALLOC(size) superlu_malloc(size)
@@ -84,6 +90,12 @@ at the top-level directory.
 
 #define SUPERLU_FREE(addr) USER_FREE(addr)
 
+#ifndef USER_REALLOC
+#define USER_REALLOC(addr, size) superlu_realloc(addr, size)
+#endif
+
+#define SUPERLU_REALLOC(addr, size) USER_REALLOC(addr, size)
+
 #define CHECK_MALLOC(where) {                 \
     extern int superlu_malloc_total;        \
     printf("%s: malloc_total %d Bytes\n",     \
@@ -146,6 +158,30 @@ at the top-level directory.
 typedef float    flops_t;
 typedef unsigned char Logical;
 
+/*! \brief Work arrays of the factor routines, kept across calls.
+ *
+ * iwork[] and dwork[] are carved up by SetIWork() and [sdcz]SetRWork();
+ * isize and dsize are their allocated lengths in bytes.
+ */
+typedef struct {
+    int_t  *iwork;
+    void   *dwork;
+    int_t  isize;
+    int_t  dsize;
+} LUWorkspace_t;
+
+/*! \brief State of the out-of-core factorization; see ooc.c. */
+typedef struct OOCState OOCState_t;
+
+/*! \brief Prefetch of an out-of-core array in the solve; see ooc_stream(). */
+typedef struct {
+    char   *base;   /* NULL if the array is in memory */
+    size_t len;
+    size_t next;    /* prefetched up to (from, if down) this byte */
+    size_t done;    /* dropped below (above, if down) this byte */
+    int    down;
+} ooc_stream_t;
+
 /* 
  *-- This contains the options used to control the solution process.
  *
@@ -180,9 +216,19 @@ typedef unsigned char Logical;
  *        Specifies what type of column permutation to use to reduce fill.
  *        = NATURAL: use the natural ordering 
  *        = MMD_ATA: use minimum degree ordering on structure of A'*A
+ *          without its dense rows (see get_perm_c())
  *        = MMD_AT_PLUS_A: use minimum degree ordering on structure of A'+A
+ *        = AMD_ATA: use approximate minimum degree ordering on structure
+ *          of A'*A without its dense rows
+ *        = AMD_AT_PLUS_A: use approximate minimum degree ordering on
+ *          structure of A'+A
  *        = COLAMD: use approximate minimum degree column ordering
+ *        = METIS_AT_PLUS_A: use nested dissection ordering on structure
+ *          of A'+A (built in; METIS is not needed)
  *        = MY_PERMC: use the ordering specified by the user
+ *        = AUTO: compute NATURAL, MMD_ATA, COLAMD, MMD_AT_PLUS_A and
+ *          METIS_AT_PLUS_A, and use the one whose LU factorization is
+ *          predicted to take the fewest flops (see get_perm_c_auto())
  *         
  * Trans  (trans_t)
  *        Specifies the form of the system of equations:
@@ -215,7 +261,11 @@ typedef unsigned char Logical;
  * RowPerm (rowperm_t) (only for SuperLU_DIST or ILU)
  *        Specifies whether to permute rows of the original matrix.
  *        = NO: not to permute the rows
- *        = LargeDiag: make the diagonal large relative to the off-diagonal
+ *        = LargeDiag_MC64: make the diagonal large relative to the
+ *              off-diagonal, by a maximum product matching (HSL MC64)
+ *        = LargeDiag_HWPM: the same, by an approximate heavy-weight
+ *              perfect matching that is faster and partly multithreaded;
+ *              see dhwpm.c (only in dgsisx)
  *        = MY_PERMR: use the permutation given by the user
  *
  * ILU_DropRule (int)
@@ -274,6 +324,100 @@ typedef unsigned char Logical;
  *
  * PrintStat (yes_no_t)
  *        Specifies whether to print the solver's statistics.
+ *
+ * nthreads (int)
+ *        Number of threads used by the LU factorization and the triangular
+ *        solves. If nthreads > 1, independent subtrees of the column
+ *        elimination tree are factored concurrently, and the remaining
+ *        columns are factored serially. The factorization is only threaded
+ *        with system malloc'd storage (lwork = 0).
+ *        ( Default: 1 )
+ *
+ * Refactor (yes_no_t)
+ *        Specifies whether to keep the structure of L and U when
+ *        Fact = SamePattern_SameRowPerm. If YES, only the numerical values
+ *        of L and U are recomputed, using the row subscripts and the
+ *        supernode partition of the previous factorization. If a pivot
+ *        falls below DiagPivotThresh times the largest entry in its
+ *        column, the matrix is factorized again as for Refactor = NO.
+ *        ( Default: NO )
+ *
+ * SymbolicFact (yes_no_t)
+ *        Specifies whether to size the storage of L and U by a symbolic
+ *        factorization of A before the numerical factorization, rather
+ *        than by the fill ratio sp_ienv(6). The symbolic bound holds for
+ *        any row pivoting, so the storage is allocated once and never
+ *        expanded. Only used for square A. The size of work[] that
+ *        dgstrf returns for lwork = -1 is always computed this way.
+ *        Supernode amalgamation (sp_ienv(10)) is turned off, as its
+ *        explicit zeros are not part of the bound.
+ *        ( Default: NO )
+ *
+ * SplitRHS (yes_no_t)
+ *        Specifies how the triangular solves are threaded when
+ *        nthreads > 1 and there is more than one right-hand side.
+ *        = NO:  the supernodes of L and U are solved level by level, with
+ *               the supernodes of a level in parallel.
+ *        = YES: the right-hand sides are divided among the threads, and
+ *               each block is solved serially. Best for many right-hand
+ *               sides.
+ *        ( Default: NO )
+ *
+ * PermCache (yes_no_t)
+ *        Specifies whether xGSSVX and xGSISX look up the column ordering
+ *        and the column elimination tree in a cache keyed by the sparsity
+ *        pattern when Fact = DOFACT, and add them to it when they are not
+ *        found. A hit skips get_perm_c() and sp_coletree(). The cache is
+ *        kept in memory, and in a file after perm_cache_file(); see
+ *        perm_cache.c. Not used when ColPerm = MY_PERMC.
+ *        When Fact = SamePattern, dgsisx also reuses the row permutation
+ *        and the scaling factors of RowPerm from the last factorization
+ *        with the same pattern, which are kept in memory only.
+ *        ( Default: NO )
+ *
+ * Presolve (yes_no_t)
+ *        Specifies whether dgssvx takes the row and column singletons and
+ *        the dense rows and columns out of A before the column ordering
+ *        ColPerm, which then orders the remaining core only. The
+ *        singletons are ordered first, where they cause no fill as
+ *        long as partial pivoting takes their pivots, and the dense
+ *        columns after the core; see get_perm_c_presolve().
+ *        ( Default: NO )
+ *
+ * LUWorkspace (LUWorkspace_t*)
+ *        If not NULL, xGSTRF and xGSITRF take their O(m) work arrays from
+ *        this workspace, set up by LUWorkspaceInit(), instead of
+ *        allocating and freeing them on each call. The workspace grows to
+ *        the largest problem seen and is released by LUWorkspaceFree().
+ *        Repeated factorizations of the same size then allocate no work
+ *        arrays. Only the allocations are saved: the arrays are still
+ *        initialized in O(m) time on each call. It must not be shared by
+ *        concurrent factorizations, and is not used when lwork > 0.
+ *        ( Default: NULL )
+ *
+ * MemBudget (double)
+ *        If > 0, a hard cap on the bytes that dgstrf and dgsitrf may
+ *        allocate for the L\U factors and their work arrays with
+ *        lwork = 0. dgstrf projects the need from a symbolic
+ *        factorization for square A and from sp_ienv(6) otherwise. While
+ *        the projection exceeds the budget, it halves panel_size. It also
+ *        factors serially, as the threaded factorization needs private
+ *        storage per subtree. The initial sizes are cut to fit, and
+ *        expansions stop at the budget rather than at 1.5 times the
+ *        current size. A budget too small for the factors makes the
+ *        factorization fail with info > A->ncol, as a failed malloc
+ *        does, even if the memory is there.
+ *        ( Default: 0 )
+ *
+ * OutOfCore (yes_no_t)
+ *        Specifies whether dgstrf keeps the values of L and U in a
+ *        scratch file rather than in memory, for square A and lwork = 0.
+ *        The file is mapped and the parts of L and U that the remaining
+ *        columns do not use are written out and dropped from memory as
+ *        the factorization proceeds; dgstrs reads them back ahead of the
+ *        solve. The row indices stay in memory. The factorization is
+ *        serial. See ooc.c and ooc_scratch_dir() for the directory.
+ *        ( Default: NO )
  */
 typedef struct {
     fact_t        Fact;
@@ -303,6 +447,15 @@ typedef struct {
     yes_no_t      lookahead_etree; /* use etree computed from the
 				      serial symbolic factorization */
     yes_no_t      SymPattern;      /* symmetric factorization          */
+    int           nthreads;        /* threads used in the factorization */
+    yes_no_t      Refactor;        /* numeric-only SamePattern_SameRowPerm */
+    yes_no_t      SymbolicFact;    /* size L\U by symbolic factorization */
+    yes_no_t      SplitRHS;        /* thread the solves over columns of B */
+    yes_no_t      PermCache;       /* reuse orderings of seen patterns */
+    yes_no_t      Presolve;        /* order singletons and dense parts apart */
+    LUWorkspace_t *LUWorkspace;    /* work arrays kept across calls */
+    double        MemBudget;       /* bytes for the L\U storage; 0 = none */
+    yes_no_t      OutOfCore;       /* keep the L\U values in a file */
 } superlu_options_t;
 
 /*! \brief Headers for 4 types of dynamatically managed memory */
@@ -326,6 +479,11 @@ typedef struct {
     int_t     TinyPivots;   /* number of tiny pivots */
     int_t     RefineSteps;  /* number of iterative refinement steps */
     int_t     expansions;   /* number of memory expansions */
+    colperm_t ColPermChosen; /* ordering chosen by ColPerm = AUTO */
+    double  *ColPermNnz;  /* predicted nnz(L+U) for each ColPerm < AUTO */
+    flops_t *ColPermOps;  /* predicted factor flops for each ColPerm < AUTO */
+    double  OOCWrite;     /* bytes written by OutOfCore */
+    double  OOCRead;      /* bytes read back by OutOfCore */
 } SuperLUStat_t;
 
 typedef struct {
@@ -352,6 +510,10 @@ typedef struct {
     int_t     num_expansions;
     ExpHeader *expanders; /* Array of pointers to 4 types of memory */
     LU_stack_t stack;     /* use user supplied memory */
+    LUWorkspace_t *work;  /* options->LUWorkspace, or NULL */
+    double    budget;     /* options->MemBudget; see dLUMemInitSize() */
+    OOCState_t *ooc;      /* options->OutOfCore, or NULL; see ooc.c */
+    int_t     amalg;      /* amalgamation budget, sp_ienv(10) or 0 */
 } GlobalLU_t;
 
 
@@ -372,15 +534,42 @@ extern void    Destroy_SuperNode_Matrix(SuperMatrix *);
 extern void    Destroy_CompCol_Permuted(SuperMatrix *);
 extern void    Destroy_Dense_Matrix(SuperMatrix *);
 extern void    get_perm_c(int_t, SuperMatrix *, int_t *);
+extern void    get_perm_c_auto(SuperMatrix *, int_t *, SuperLUStat_t *);
+extern void    get_perm_c_presolve(int_t, SuperMatrix *, int_t *,
+				   SuperLUStat_t *);
+extern int_t   perm_cache_lookup(superlu_options_t *, SuperMatrix *,
+				 unsigned long long *, int_t *, int_t *);
+extern void    perm_cache_store(superlu_options_t *, SuperMatrix *,
+				unsigned long long, int_t *, int_t *);
+extern int_t   rowperm_cache_lookup(superlu_options_t *, SuperMatrix *,
+				     int_t *, double *, double *, char *);
+extern void    rowperm_cache_store(superlu_options_t *, SuperMatrix *,
+				    int_t *, double *, double *, char);
+extern void    perm_cache_file(char *);
+extern void    perm_cache_clear(void);
 extern void    set_default_options(superlu_options_t *options);
 extern void    ilu_set_default_options(superlu_options_t *options);
 extern void    sp_preorder (superlu_options_t *, SuperMatrix*, int_t*, int_t*,
 			    SuperMatrix*);
 extern void    superlu_abort_and_exit(char*);
-extern void    *superlu_malloc (int_t);
+extern void    *superlu_malloc (size_t);
+extern void    *superlu_realloc (void *, size_t);
 extern int_t     *intMalloc (int_t);
 extern int_t     *intCalloc (int_t);
 extern void    superlu_free (void*);
+extern void    LUWorkspaceInit (LUWorkspace_t *);
+extern void    LUWorkspaceFree (LUWorkspace_t *);
+extern int_t   LUWorkspaceReserve (LUWorkspace_t *, int_t, int_t);
+extern void    ooc_scratch_dir (char *);
+extern void    *ooc_malloc (size_t);
+extern void    *ooc_realloc (void *, size_t);
+extern int     ooc_owns (void *);
+extern void    ooc_free (void *);
+extern OOCState_t *ooc_init (SuperMatrix *, int_t *, int_t);
+extern void    ooc_retire (OOCState_t *, int_t, GlobalLU_t *, SuperLUStat_t *);
+extern void    ooc_finish (OOCState_t *, GlobalLU_t *, SuperLUStat_t *);
+extern void    ooc_stream_init (ooc_stream_t *, void *, size_t, int);
+extern void    ooc_stream (ooc_stream_t *, size_t, SuperLUStat_t *);
 extern void    SetIWork (int_t, int_t, int_t, int_t *, int_t **, int_t **, int_t **,
                          int_t **, int_t **, int_t **, int_t **);
 extern int_t     sp_coletree (int_t *, int_t *, int_t *, int_t, int_t, int_t *);
@@ -394,6 +583,11 @@ extern void    ilu_heap_relax_snode (const int_t, int_t *, const int_t, int_t *,
 extern void    resetrep_col (const int_t, const int_t *, int_t *);
 extern int     spcoletree (int *, int *, int *, int, int, int *);
 extern int_t     *TreePostorder (int_t, int_t *);
+extern int_t     etree_subtrees (int_t, int_t *, int_t, int_t, int_t *, int_t *);
+extern int_t     sp_colcnt_ata (int_t, int_t, int_t *, int_t *, int_t *,
+                                int_t *, int_t *);
+extern int_t     sp_symbfact_size (int_t, int_t *, int_t *, int_t *, int_t *,
+                                   int_t *, int_t, int_t *, int_t *, int_t *);
 extern double  SuperLU_timer_ ();
 extern int     sp_ienv (int);
 extern int     xerbla_ (char *, int *);
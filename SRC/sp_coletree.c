@@ -428,3 +428,277 @@ sp_symetree(
 	finalize_disjoint_sets (pp);
 	return 0;
 } /* SP_SYMETREE */
+
+
+/*! \brief Partition a postordered column etree into independent subtrees.
+ *
+ * <pre>
+ * In a postordered etree, the subtree rooted at column j occupies the
+ * contiguous columns j-size(j)+1, ..., j. Columns in disjoint subtrees
+ * of the column etree touch disjoint sets of rows of A, so their columns
+ * of L and U can be computed independently of each other.
+ *
+ * The maximal subtrees having at most maxsize columns are selected;
+ * those with fewer than minsize columns are left out. On return,
+ * tfirst[k] and tlast[k] are the first and last columns of the k-th
+ * subtree, k = 0, ..., ntasks-1, sorted by decreasing size. Both arrays
+ * must be of length at least n. The return value is ntasks.
+ * </pre>
+ */
+int_t
+etree_subtrees(
+	       int_t n,        /* number of columns */
+	       int_t *et,      /* postordered column etree */
+	       int_t minsize,  /* smallest subtree to keep */
+	       int_t maxsize,  /* largest subtree to keep */
+	       int_t *tfirst,  /* out - first column of each subtree */
+	       int_t *tlast    /* out - last column (root) of each subtree */
+	       )
+{
+    int_t *size, *count, j, p, s, k, ntasks;
+
+    if ( n <= 0 || maxsize < minsize ) return 0;
+
+    size  = mxCallocInt(n);
+    count = mxCallocInt(maxsize + 2);
+
+    /* Children are numbered before their parent in a postorder. */
+    for (j = 0; j < n; ++j) {
+	++size[j];
+	p = et[j];
+	if ( p < n ) size[p] += size[j];
+    }
+
+    /* Count the roots of the maximal subtrees by size. */
+    for (j = 0; j < n; ++j) {
+	s = size[j];
+	p = et[j];
+	if ( s >= minsize && s <= maxsize && (p >= n || size[p] > maxsize) )
+	    ++count[s];
+    }
+
+    /* Bucket offsets, largest subtrees first. */
+    ntasks = 0;
+    for (s = maxsize; s >= minsize; --s) {
+	k = count[s];
+	count[s] = ntasks;
+	ntasks += k;
+    }
+
+    for (j = 0; j < n; ++j) {
+	s = size[j];
+	p = et[j];
+	if ( s >= minsize && s <= maxsize && (p >= n || size[p] > maxsize) ) {
+	    k = count[s]++;
+	    tfirst[k] = j - s + 1;
+	    tlast[k]  = j;
+	}
+    }
+
+    SUPERLU_FREE(size);
+    SUPERLU_FREE(count);
+    return ntasks;
+}
+
+
+/*! \brief Find the least common ancestor of j and the previous leaf of
+ * the row subtree of i; used by sp_colcnt_ata().
+ */
+static int_t
+skel_leaf(int_t i, int_t j, int_t *first, int_t *maxfirst, int_t *prevleaf,
+	  int_t *ancestor, int_t *jleaf)
+{
+    int_t q, s, sparent, jprev;
+
+    *jleaf = 0;
+    if ( i <= j || first[j] <= maxfirst[i] ) return EMPTY; /* not a leaf */
+    maxfirst[i] = first[j];
+    jprev = prevleaf[i];
+    prevleaf[i] = j;
+    *jleaf = (jprev == EMPTY) ? 1 : 2;
+    if ( *jleaf == 1 ) return i;  /* first leaf: root of the row subtree */
+    for (q = jprev; q != ancestor[q]; q = ancestor[q]) ;
+    for (s = jprev; s != q; s = sparent) {  /* path compression */
+	sparent = ancestor[s];
+	ancestor[s] = q;
+    }
+    return q;
+}
+
+/*! \brief Column counts of the Cholesky factor of A'*A, without forming A'*A.
+ *
+ * <pre>
+ * On return, colcnt[j] is the number of nonzeros in column j of the
+ * Cholesky factor of A'*A, counting the diagonal; that is the number of
+ * nonzeros in row j of R, where A = Q*R. Since the structures of L and U
+ * in Pr*A = L*U with partial pivoting are contained in those of R' and
+ * R, these are upper bounds for the columns of L and the rows of U
+ * (George and Ng, 1987). The return value is nnz(R).
+ *
+ * The column etree must be postordered, as computed by sp_preorder().
+ * The algorithm is the row-subtree skeleton method of Gilbert, Ng and
+ * Peyton (1994), with the row cliques of A standing for A'*A.
+ * </pre>
+ */
+int_t
+sp_colcnt_ata(
+	      int_t m,          /* number of rows */
+	      int_t n,          /* number of columns */
+	      int_t *colbeg,    /* column start pointers of A */
+	      int_t *colend,    /* column end pointers of A */
+	      int_t *rowind,    /* row indices of A */
+	      int_t *et,        /* postordered column etree */
+	      int_t *colcnt     /* out - column counts, length n */
+	      )
+{
+    int_t *rowptr, *colind, *head, *next;
+    int_t *first, *maxfirst, *prevleaf, *ancestor;
+    int_t i, j, k, p, q, jleaf, nnz;
+
+    /* Row-wise structure of A */
+    rowptr = mxCallocInt(m+1);
+    for (j = 0; j < n; ++j)
+	for (p = colbeg[j]; p < colend[j]; ++p) ++rowptr[rowind[p]+1];
+    for (i = 0; i < m; ++i) rowptr[i+1] += rowptr[i];
+    colind = mxCallocInt(SUPERLU_MAX(rowptr[m], 1));
+    next   = mxCallocInt(SUPERLU_MAX(m, 1));
+    for (i = 0; i < m; ++i) next[i] = rowptr[i];
+    for (j = 0; j < n; ++j)
+	for (p = colbeg[j]; p < colend[j]; ++p) colind[next[rowind[p]]++] = j;
+
+    first    = mxCallocInt(n);
+    maxfirst = mxCallocInt(n);
+    prevleaf = mxCallocInt(n);
+    ancestor = mxCallocInt(n);
+    head     = mxCallocInt(n+1);
+
+    /* first[j] is the first descendant of j; leaves start with count 1. */
+    for (j = 0; j < n; ++j) first[j] = EMPTY;
+    for (k = 0; k < n; ++k) {
+	colcnt[k] = (first[k] == EMPTY);
+	for (j = k; j < n && first[j] == EMPTY; j = et[j]) first[j] = k;
+    }
+
+    /* Link each row of A to its first column, the leaf of its clique. */
+    for (j = 0; j <= n; ++j) head[j] = EMPTY;
+    for (i = 0; i < m; ++i) {
+	k = (rowptr[i] < rowptr[i+1]) ? colind[rowptr[i]] : n;
+	next[i] = head[k];
+	head[k] = i;
+    }
+
+    for (j = 0; j < n; ++j) {
+	maxfirst[j] = prevleaf[j] = EMPTY;
+	ancestor[j] = j;
+    }
+
+    for (j = 0; j < n; ++j) {
+	if ( et[j] < n ) --colcnt[et[j]];
+	for (i = head[j]; i != EMPTY; i = next[i]) {
+	    for (p = rowptr[i]; p < rowptr[i+1]; ++p) {
+		q = skel_leaf(colind[p], j, first, maxfirst, prevleaf,
+			      ancestor, &jleaf);
+		if ( jleaf >= 1 ) ++colcnt[j];  /* entry is in the skeleton */
+		if ( jleaf == 2 ) --colcnt[q];  /* overlap counted at q */
+	    }
+	}
+	if ( et[j] < n ) ancestor[j] = et[j];
+    }
+
+    nnz = 0;
+    for (j = 0; j < n; ++j) {
+	if ( et[j] < n ) colcnt[et[j]] += colcnt[j];
+	nnz += colcnt[j];
+    }
+
+    SUPERLU_FREE(rowptr);
+    SUPERLU_FREE(colind);
+    SUPERLU_FREE(next);
+    SUPERLU_FREE(first);
+    SUPERLU_FREE(maxfirst);
+    SUPERLU_FREE(prevleaf);
+    SUPERLU_FREE(ancestor);
+    SUPERLU_FREE(head);
+    return nnz;
+}
+
+/*! \brief Storage needed by the L\U factors, from a symbolic factorization.
+ *
+ * <pre>
+ * Computes sizes of lsub[], ucol[]/usub[] and lusup[] that are large
+ * enough for the factorization of the n-by-n matrix A by dgstrf() and
+ * its other-precision versions, whatever the row pivots are.
+ *
+ * The column counts of R bound the columns of L and U (sp_colcnt_ata()).
+ * A relaxed supernode stores the union of the row structures of its
+ * columns of A, which is counted exactly. Any other supernode with
+ * first column f stores |L(:,f)| <= colcnt[f] rows in each of its
+ * columns. Consecutive columns f, f+1 of a supernode have R(f,f+1) != 0,
+ * so et[f] = f+1 and each column j is charged with the largest colcnt[f]
+ * over the chain of at most maxsuper columns ending at j.
+ *
+ * Returns nnz(R).
+ * </pre>
+ */
+int_t
+sp_symbfact_size(
+		 int_t n,          /* order of A */
+		 int_t *colbeg,    /* column start pointers of A */
+		 int_t *colend,    /* column end pointers of A */
+		 int_t *rowind,    /* row indices of A */
+		 int_t *et,        /* postordered column etree */
+		 int_t *relax_end, /* ends of the relaxed supernodes */
+		 int_t maxsuper,   /* most columns in a supernode */
+		 int_t *nzlmax,    /* out - size of lsub[] */
+		 int_t *nzumax,    /* out - size of ucol[] and usub[] */
+		 int_t *nzlumax    /* out - size of lusup[] */
+		 )
+{
+    int_t *colcnt, *marker, *chain;
+    int_t j, k, p, r, kcol, nnzR, chead, ctail;
+
+    colcnt = mxCallocInt(n);
+    marker = mxCallocInt(n);
+    chain  = mxCallocInt(n);
+    nnzR   = sp_colcnt_ata(n, n, colbeg, colend, rowind, et, colcnt);
+
+    *nzlmax = *nzlumax = 0;
+    *nzumax = nnzR - n;   /* strictly upper part of R */
+    for (j = 0; j < n; ++j) marker[j] = EMPTY;
+
+    chead = ctail = 0;    /* chain[chead:ctail-1]: decreasing colcnt */
+    for (j = 0; j < n; ) {
+	if ( relax_end[j] != EMPTY ) {
+	    kcol = relax_end[j];
+	    r = 0;
+	    for (k = j; k <= kcol; ++k)
+		for (p = colbeg[k]; p < colend[k]; ++p)
+		    if ( marker[rowind[p]] != j ) {
+			marker[rowind[p]] = j;
+			++r;
+		    }
+	    *nzlmax  += (kcol > j) ? 2 * r : r;
+	    *nzlumax += r * (kcol - j + 1);
+	    chead = ctail = 0;
+	    j = kcol + 1;
+	} else {
+	    /* Sliding window maximum of colcnt over the chain */
+	    if ( j == 0 || et[j-1] != j ) chead = ctail = 0;
+	    if ( ctail > chead && chain[chead] <= j - maxsuper ) ++chead;
+	    while ( ctail > chead && colcnt[chain[ctail-1]] <= colcnt[j] )
+		--ctail;
+	    chain[ctail++] = j;
+	    *nzlmax  += colcnt[j];
+	    *nzlumax += colcnt[chain[chead]];
+	    ++j;
+	}
+    }
+    *nzlmax  = SUPERLU_MAX(*nzlmax, 1);
+    *nzumax  = SUPERLU_MAX(*nzumax, 1);
+    *nzlumax = SUPERLU_MAX(*nzlumax, 1);
+
+    SUPERLU_FREE(colcnt);
+    SUPERLU_FREE(marker);
+    SUPERLU_FREE(chain);
+    return nnzR;
+}
@@ -57,7 +57,21 @@ extern int input_error(char *, int *);
 	    = 4: the minimum row dimension for 2-D blocking to be used;
 	    = 5: the minimum column dimension for 2-D blocking to be used;
 	    = 6: the estimated fills factor for L and U, compared with A;
-	    = 7: the maximum size for a supernode in ILU.
+	    = 7: the maximum size for a supernode in ILU;
+	    = 8: the number of vectors t used at a time by the block 1-norm
+	         estimator in condition estimation (xGSCON). A larger t
+	         gives a more reliable estimate in fewer iterations, at the
+	         cost of more work per iteration;
+	    = 9: the same, per right-hand side, for the forward error
+	         bounds in iterative refinement (xGSRFS);
+	    = 10: the budget for supernode amalgamation in complete LU, in
+	         percent: column j joins the supernode of j-1 although
+	         their structures differ, if the explicit zeros this adds
+	         are at most this percentage of the entries the supernode
+	         grows by (see dcolumn_dfs). 0 turns it off; 20 to 50
+	         about doubles the supernode width of 3-D grid problems,
+	         for a few more entries in L. Not used with
+	         options->SymbolicFact = YES.
 	    
    (SP_IENV) (output) int
             >= 0: the value of the parameter specified by ISPEC   
@@ -79,6 +93,9 @@ sp_ienv(int ispec)
 	case 5: return (100);
         case 6: return (30);
         case 7: return (10);
+        case 8: return (2);
+        case 9: return (1);
+        case 10: return (0);
     }
 
     /* Invalid value for ISPEC */
@@ -57,6 +57,15 @@ void set_default_options(superlu_options_t *options)
     options->PivotGrowth = NO;
     options->ConditionNumber = NO;
     options->PrintStat = YES;
+    options->nthreads = 1;
+    options->Refactor = NO;
+    options->SymbolicFact = NO;
+    options->SplitRHS = NO;
+    options->PermCache = NO;
+    options->Presolve = NO;
+    options->LUWorkspace = NULL;
+    options->MemBudget = 0.;
+    options->OutOfCore = NO;
 }
 
 /*! \brief Set the default values for the options argument for ILU.
@@ -91,6 +100,15 @@ void print_options(superlu_options_t *options)
     printf("\tSymmetricMode\t%4d\n", options->SymmetricMode);
     printf("\tPivotGrowth\t%4d\n", options->PivotGrowth);
     printf("\tConditionNumber\t%4d\n", options->ConditionNumber);
+    printf("\tnthreads\t%4d\n", options->nthreads);
+    printf("\tRefactor\t%4d\n", options->Refactor);
+    printf("\tSymbolicFact\t%4d\n", options->SymbolicFact);
+    printf("\tSplitRHS\t%4d\n", options->SplitRHS);
+    printf("\tPermCache\t%4d\n", options->PermCache);
+    printf("\tPresolve\t%4d\n", options->Presolve);
+    printf("\tLUWorkspace\t%4d\n", options->LUWorkspace != NULL);
+    printf("\tMemBudget\t%.3g\n", options->MemBudget);
+    printf("\tOutOfCore\t%4d\n", options->OutOfCore);
     printf("..\n");
 }
 
@@ -322,6 +340,13 @@ StatInit(SuperLUStat_t *stat)
     stat->TinyPivots = 0;
     stat->RefineSteps = 0;
     stat->expansions = 0;
+    stat->OOCWrite = stat->OOCRead = 0.;
+    stat->ColPermChosen = AUTO;
+    stat->ColPermNnz = (double *) SUPERLU_MALLOC(AUTO * sizeof(double));
+    stat->ColPermOps = (flops_t *) SUPERLU_MALLOC(AUTO * sizeof(flops_t));
+    if ( !stat->ColPermNnz || !stat->ColPermOps )
+	ABORT("SUPERLU_MALLOC fails for stat->ColPermNnz/ColPermOps");
+    for (i = 0; i < AUTO; ++i) stat->ColPermNnz[i] = stat->ColPermOps[i] = -1.;
 #if ( PRNTlevel >= 1 )
     printf(".. parameters in sp_ienv():\n");
     printf("\t 1: panel size \t %4d \n"
@@ -355,6 +380,14 @@ StatPrint(SuperLUStat_t *stat)
 	     ops[SOLVE]*1e-6/utime[SOLVE]);
 
     printf("Number of memory expansions: %d\n", stat->expansions);
+    if ( stat->OOCWrite != 0. || stat->OOCRead != 0. )
+	printf("Out-of-core I/O: written %.2f MB, read %.2f MB\n",
+	       stat->OOCWrite * 1e-6, stat->OOCRead * 1e-6);
+
+    if ( stat->ColPermChosen != AUTO )
+	printf("ColPerm = AUTO chose %d: predicted nnz(L+U) %e, flops %e\n",
+	       stat->ColPermChosen, stat->ColPermNnz[stat->ColPermChosen],
+	       stat->ColPermOps[stat->ColPermChosen]);
 
 }
 
@@ -365,6 +398,8 @@ StatFree(SuperLUStat_t *stat)
     SUPERLU_FREE(stat->panel_histo);
     SUPERLU_FREE(stat->utime);
     SUPERLU_FREE(stat->ops);
+    SUPERLU_FREE(stat->ColPermNnz);
+    SUPERLU_FREE(stat->ColPermOps);
 }
 
 
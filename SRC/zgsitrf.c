@@ -262,6 +262,7 @@ zgsitrf(superlu_options_t *options, SuperMatrix *A, int_t relax, int_t panel_siz
     xa_end   = Astore->colend;
 
     /* Allocate storage common to the factor routines */
+    Glu->work = options->LUWorkspace;
     *info = zLUMemInit(fact, work, lwork, m, n, Astore->nnz, panel_size,
 		       gamma, L, U, Glu, &iwork, &zwork);
     if ( *info ) return;
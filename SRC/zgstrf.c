@@ -252,6 +252,8 @@ zgstrf (superlu_options_t *options, SuperMatrix *A,
     xa_end   = Astore->colend;
 
     /* Allocate storage common to the factor routines */
+    Glu->work = options->LUWorkspace;
+    Glu->amalg = sp_ienv(10);
     *info = zLUMemInit(fact, work, lwork, m, n, Astore->nnz,
                        panel_size, fill_ratio, L, U, Glu, &iwork, &zwork);
     if ( *info ) return;
@@ -0,0 +1,56 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dcolumn_dfs_test.c
+ * Purpose:             Test program for the supernode amalgamation in
+ *                      dcolumn_dfs, under the budgets set by SUPERLU_AMALG
+ *                      through sp_ienv(10).
+ */
+#include "dxutil.h"
+
+#define NAMALG 3
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    static char    *amalg[NAMALG] = {"0", "25", "100"};
+    char           test[16];
+    int_t          nnz_amalg[NAMALG];
+    int            nfail, i;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* The explicit zeros of the amalgamated supernodes can only add to
+       L\U as the budget grows; the grid has some to amalgamate. */
+    for (i = 0; i < NAMALG; ++i) {
+	setenv("SUPERLU_AMALG", amalg[i], 1);
+	sprintf(test, "amalg_%s", amalg[i]);
+	nfail += dcheck(test, dsolve(&options, 0, x), b_save, x);
+	nnz_amalg[i] = nnz_lu;
+	if ( i > 0 && nnz_amalg[i] < nnz_amalg[i-1] ) {
+	    printf("%10s: nnz(L+U) %d below %d\n", test,
+		   (int) nnz_amalg[i], (int) nnz_amalg[i-1]);
+	    ++nfail;
+	}
+    }
+    if ( k > 0 && nnz_amalg[NAMALG-1] == nnz_amalg[0] ) {
+	printf("amalg: no supernode was amalgamated\n");
+	++nfail;
+    }
+
+    return dx_finish("amalg", nfail);
+}
@@ -35,7 +35,8 @@ at the top-level directory.
 static void
 parse_command_line(int argc, char *argv[], char *matrix_type,
 		   int_t *n, int *w, int *relax, int *nrhs, int *maxsuper,
-		   int *rowblk, int *colblk, int *lwork, double *u, FILE **fp);
+		   int *rowblk, int *colblk, int *lwork, double *u,
+		   int *nthreads, FILE **fp);
 
 int main(int argc, char *argv[])
 {
@@ -76,7 +77,7 @@ int main(int argc, char *argv[])
     double         rpg, rcond;
     int            i, j, k1;
     double         rowcnd, colcnd, amax;
-    int            maxsuper, rowblk, colblk;
+    int            maxsuper, rowblk, colblk, nthreads;
     int            prefact, equil, iequed;
     int            nt, nrun, nfail, nerrs, imat, fimat, nimat;
     int            nfact, ifact, itran;
@@ -134,10 +135,11 @@ int main(int argc, char *argv[])
     panel_size = sp_ienv(1);
     relax      = sp_ienv(2);
     u          = 1.0;
+    nthreads   = 1;
     strcpy(matrix_type, "LA");
     parse_command_line(argc, argv, matrix_type, &n,
 		       &panel_size, &relax, &nrhs, &maxsuper,
-		       &rowblk, &colblk, &lwork, &u, &fp);
+		       &rowblk, &colblk, &lwork, &u, &nthreads, &fp);
     if ( lwork > 0 ) {
 	work = SUPERLU_MALLOC(lwork);
 	if ( !work ) {
@@ -149,6 +151,7 @@ int main(int argc, char *argv[])
     /* Set the default input options. */
     set_default_options(&options);
     options.DiagPivotThresh = u;
+    options.nthreads = nthreads;
     options.PrintStat = NO;
     options.PivotGrowth = YES;
     options.ConditionNumber = YES;
@@ -528,17 +531,19 @@ int main(int argc, char *argv[])
 static void
 parse_command_line(int argc, char *argv[], char *matrix_type,
 		   int_t *n, int *w, int *relax, int *nrhs, int *maxsuper,
-		   int *rowblk, int *colblk, int *lwork, double *u, FILE **fp)
+		   int *rowblk, int *colblk, int *lwork, double *u,
+		   int *nthreads, FILE **fp)
 {
     int c;
     extern char *optarg;
 
-    while ( (c = getopt(argc, argv, "ht:n:w:r:s:m:b:c:l:u:f:")) != EOF ) {
+    while ( (c = getopt(argc, argv, "ht:n:w:r:s:m:b:c:l:u:p:f:")) != EOF ) {
 	switch (c) {
 	  case 'h':
 	    printf("Options:\n");
 	    printf("\t-w <int> - panel size\n");
 	    printf("\t-r <int> - granularity of relaxed supernodes\n");
+	    printf("\t-p <int> - number of threads in the factorization\n");
 	    exit(1);
 	    break;
 	  case 't': strcpy(matrix_type, optarg);
@@ -561,6 +566,8 @@ parse_command_line(int argc, char *argv[], char *matrix_type,
 	            break;
 	  case 'u': *u = atof(optarg); 
 	            break;
+	  case 'p': *nthreads = atoi(optarg); 
+	            break;
           case 'f':
                     if ( !(*fp = fopen(optarg, "r")) ) {
                         ABORT("File does not exist");
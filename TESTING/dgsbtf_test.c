@@ -0,0 +1,91 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dgsbtf_test.c
+ * Purpose:             Test program for dgsbtf and dgsbtrs, the solution by
+ *                      the block upper triangular form of a reducible matrix.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Solve A*X = B and A'*X = B by dgsbtf and dgsbtrs, with A made
+ *  reducible by dreduce_grid().
+ */
+static int
+dbtf_test(superlu_options_t *options)
+{
+    SuperMatrix   B;
+    SuperLUStat_t stat;
+    dBTF_t        btf;
+    double        *b, *r, resid;
+    int_t         info;
+    int           nfail = 0;
+
+    if ( !(b = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b[].");
+    if ( !(r = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for r[].");
+    if ( dreduce_grid("btf") ) {
+	nfail = 1;
+	goto done;
+    }
+
+    StatInit(&stat);
+    dgsbtf(options, &A, &btf, &stat, &info);
+    if ( !info && btf.nblocks != 2 * k - 1 ) {
+	printf("btf: %d blocks, expected %d\n", btf.nblocks, 2 * k - 1);
+	++nfail;
+    }
+
+    /* A*X = B */
+    memcpy(x, b_save, n * nrhs * sizeof(double));
+    dCreate_Dense_Matrix(&B, n, nrhs, x, n, SLU_DN, SLU_D, SLU_GE);
+    if ( !info ) dgsbtrs(NOTRANS, &btf, &B, &stat, &info);
+    nfail += dcheck("btf", info, b_save, x);
+
+    /* A'*X = B */
+    if ( !info ) {
+	sp_dgemm("T", "N", n, nrhs, n, 1.0, &A, xact, n, 0.0, b, n);
+	memcpy(x, b, n * nrhs * sizeof(double));
+	dgsbtrs(TRANS, &btf, &B, &stat, &info);
+	if ( info ) {
+	    printf(FMT2, "btf_trans", info);
+	    ++nfail;
+	} else {
+	    memcpy(r, b, n * nrhs * sizeof(double));
+	    dgst02(TRANS, n, n, nrhs, &A, x, n, r, n, &resid);
+	    printf(FMT1, "btf_trans", n, nrhs, resid);
+	    nfail += resid >= THRESH;
+	}
+    }
+    StatFree(&stat);
+
+    dDestroy_BTF(&btf);
+    Destroy_SuperMatrix_Store(&B);
+done:
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(r);
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+    nfail += dbtf_test(&options);
+    return dx_finish("dgsbtf", nfail);
+}
@@ -0,0 +1,96 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dgspipe_test.c
+ * Purpose:             Test program for dgspipe, which solves a stream of
+ *                      systems in a three-stage pipeline.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Solve NPIPE copies of A*X = B by dgspipe, of which the one
+ *  numbered NPIPE/2 has an invalid X and must be rejected with info = -14.
+ */
+#define NPIPE 4
+static int
+dpipe_test(superlu_options_t *options)
+{
+    SuperMatrix   Ak[NPIPE], Bk[NPIPE], Xk[NPIPE];
+    dPipeJob_t    jobs[NPIPE];
+    SuperLUStat_t stat;
+    NCformat      *Astore = A.Store;
+    double        *a, *b, *xk;
+    int_t         *asub, *xa, info, i;
+    int           nfail = 0;
+    char          name[16];
+
+    for (i = 0; i < NPIPE; ++i) {
+	if ( !(a = doubleMalloc(nnz)) ) ABORT("Malloc fails for a[].");
+	if ( !(asub = intMalloc(nnz)) ) ABORT("Malloc fails for asub[].");
+	if ( !(xa = intMalloc(n + 1)) ) ABORT("Malloc fails for xa[].");
+	if ( !(b = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b[].");
+	if ( !(xk = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for xk[].");
+	memcpy(a, a_save, nnz * sizeof(double));
+	memcpy(asub, Astore->rowind, nnz * sizeof(int_t));
+	memcpy(xa, Astore->colptr, (n + 1) * sizeof(int_t));
+	memcpy(b, b_save, n * nrhs * sizeof(double));
+	dCreate_CompCol_Matrix(&Ak[i], n, n, nnz, a, asub, xa,
+			       SLU_NC, SLU_D, SLU_GE);
+	dCreate_Dense_Matrix(&Bk[i], n, nrhs, b, n, SLU_DN, SLU_D, SLU_GE);
+	dCreate_Dense_Matrix(&Xk[i], n, nrhs, xk, i == NPIPE/2 ? n - 1 : n,
+			     SLU_DN, SLU_D, SLU_GE);
+	jobs[i].A = &Ak[i];
+	jobs[i].B = &Bk[i];
+	jobs[i].X = &Xk[i];
+	if ( !(jobs[i].ferr = doubleMalloc(nrhs)) ||
+	     !(jobs[i].berr = doubleMalloc(nrhs)) )
+	    ABORT("Malloc fails for ferr[] or berr[].");
+    }
+
+    StatInit(&stat);
+    dgspipe(options, NPIPE, jobs, &stat, &info);
+    StatFree(&stat);
+
+    for (i = 0; i < NPIPE; ++i) {
+	sprintf(name, "job %d", (int) i);
+	xk = ((DNformat *) Xk[i].Store)->nzval;
+	if ( info ) {
+	    nfail += dcheck(name, info, b_save, xk);
+	} else if ( i == NPIPE/2 ) {
+	    printf(FMT2, name, jobs[i].info);
+	    nfail += jobs[i].info != -14;
+	} else {
+	    nfail += dcheck(name, jobs[i].info, b_save, xk);
+	}
+	Destroy_CompCol_Matrix(&Ak[i]);
+	Destroy_Dense_Matrix(&Bk[i]);
+	Destroy_Dense_Matrix(&Xk[i]);
+	SUPERLU_FREE(jobs[i].ferr);
+	SUPERLU_FREE(jobs[i].berr);
+    }
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+    nfail += dpipe_test(&options);
+    return dx_finish("dgspipe", nfail);
+}
@@ -0,0 +1,159 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dgsrefact_test.c
+ * Purpose:             Test program for dgsrefact, the numeric-only
+ *                      refactorization with Fact = SamePattern_SameRowPerm
+ *                      and Refactor = YES.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/* The factors and permutations kept from one dgssvx to the next. */
+static SuperMatrix L, U;
+static GlobalLU_t  Glu;
+static double      *R, *C;
+static int_t       *perm_r, *perm_c, *etree;
+static char        equed[1];
+
+/*! \brief Solve A*X = B with dgssvx for the current values of A,
+ *  keeping the factors for the next call. */
+static int_t
+dsolve_keep(superlu_options_t *options)
+{
+    SuperMatrix   B, X;
+    SuperLUStat_t stat;
+    double        *b, ferr[1], berr[1], rpg, rcond;
+    int_t         info;
+
+    if ( !(b = doubleMalloc(n)) ) ABORT("Malloc fails for b[].");
+    memcpy(b, b_save, n * sizeof(double));
+    dCreate_Dense_Matrix(&B, n, 1, b, n, SLU_DN, SLU_D, SLU_GE);
+    dCreate_Dense_Matrix(&X, n, 1, x, n, SLU_DN, SLU_D, SLU_GE);
+
+    StatInit(&stat);
+    dgssvx(options, &A, perm_c, perm_r, etree, equed, R, C, &L, &U,
+	   NULL, 0, &B, &X, &rpg, &rcond, ferr, berr, &Glu, &mem_usage,
+	   &stat, &info);
+    StatFree(&stat);
+
+    Destroy_SuperMatrix_Store(&B);
+    Destroy_SuperMatrix_Store(&X);
+    SUPERLU_FREE(b);
+    return info;
+}
+
+/*! \brief Refactor the factors of the previous dsolve_keep() for the
+ *  current values of A by dgsrefact itself; return its value. */
+static int_t
+drefactor(superlu_options_t *options)
+{
+    SuperMatrix   AC;
+    SuperLUStat_t stat;
+    int_t         info;
+
+    sp_preorder(options, &A, perm_c, etree, &AC);
+    StatInit(&stat);
+    info = dgsrefact(options, &AC, perm_r, &L, &U, &stat);
+    StatFree(&stat);
+    Destroy_CompCol_Permuted(&AC);
+    return info;
+}
+
+/*! \brief Check the solution x of A*X = B for the first right-hand
+ *  side, and whether perm_r changed from perm_r0 as expected. */
+static int
+dcheck_refact(char *test, int_t info, int_t *perm_r0, int changed)
+{
+    int_t i;
+    int   nfail, save = nrhs;
+
+    nrhs = 1;
+    nfail = dcheck(test, info, b_save, x);
+    nrhs = save;
+    for (i = 0; i < n; ++i)
+	if ( perm_r[i] != perm_r0[i] ) break;
+    if ( (i < n) != changed ) {
+	printf("%10s: perm_r %s\n", test, changed ? "kept" : "changed");
+	++nfail;
+    }
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    NCformat       *Astore;
+    double         *a;
+    int_t          *asub, *xa, *perm_r0, info, i, j;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+    Astore = A.Store;
+    a = Astore->nzval;
+    asub = Astore->rowind;
+    xa = Astore->colptr;
+
+    if ( !(perm_r = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    if ( !(perm_r0 = intMalloc(n)) ) ABORT("Malloc fails for perm_r0[].");
+    if ( !(etree = intMalloc(n)) ) ABORT("Malloc fails for etree[].");
+    if ( !(R = doubleMalloc(n)) ) ABORT("Malloc fails for R[].");
+    if ( !(C = doubleMalloc(n)) ) ABORT("Malloc fails for C[].");
+
+    /* The first factorization, whose structure is reused. */
+    options.Equil = NO;
+    info = dsolve_keep(&options);
+    memcpy(perm_r0, perm_r, n * sizeof(int_t));
+    nfail += dcheck_refact("first", info, perm_r0, 0);
+    if ( info ) return dx_finish("dgsrefact", nfail);
+
+    /* New off-diagonal values, for which the pivots pass the threshold
+       test: by dgsrefact, and by dgssvx through dgstrf. */
+    options.Fact = SamePattern_SameRowPerm;
+    options.Refactor = YES;
+    for (j = 0; j < n; ++j)
+	for (i = xa[j]; i < xa[j+1]; ++i)
+	    if ( asub[i] != j ) a[i] = a_save[i] * (1.0 + 0.1 * (i % 3 - 1));
+    if ( (info = drefactor(&options)) != 0 ) {
+	printf("dgsrefact: rejected the pivot of column %d\n", (int) info - 1);
+	++nfail;
+    }
+    nfail += dcheck_refact("refactor", dsolve_keep(&options), perm_r0, 0);
+
+    /* Diagonal values below the off-diagonal ones, whose pivots fail the
+       threshold test: dgstrf must factor A again, pivoting. */
+    for (j = 0; j < n; ++j)
+	for (i = xa[j]; i < xa[j+1]; ++i)
+	    if ( asub[i] == j ) a[i] = 0.1 * a_save[i];
+    if ( drefactor(&options) == 0 ) {
+	printf("dgsrefact: accepted a pivot below the threshold\n");
+	++nfail;
+    }
+    nfail += dcheck_refact("rejected", dsolve_keep(&options), perm_r0, 1);
+
+    memcpy(a, a_save, nnz * sizeof(double));
+    Destroy_SuperNode_Matrix(&L);
+    Destroy_CompCol_Matrix(&U);
+    SUPERLU_FREE(perm_r);
+    SUPERLU_FREE(perm_c);
+    SUPERLU_FREE(perm_r0);
+    SUPERLU_FREE(etree);
+    SUPERLU_FREE(R);
+    SUPERLU_FREE(C);
+    return dx_finish("dgsrefact", nfail);
+}
@@ -0,0 +1,99 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dgstrs_sparse_test.c
+ * Purpose:             Test program for dgstrs_sparse, the solve with
+ *                      sparse right-hand sides.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Solve A*X = B by dgstrs_sparse with one workspace: first
+ *  for the columns j of A, whose solutions are unit vectors, and then
+ *  for the dense B.
+ */
+static int
+dsparse_test(superlu_options_t *options, double *x)
+{
+    SuperMatrix   B, L, U;
+    SuperLUStat_t stat;
+    dSpSolve_t    ws;
+    NCformat      *Astore = A.Store;
+    double        *a = Astore->nzval, *b;
+    int_t         *asub = Astore->rowind, *xa = Astore->colptr;
+    int_t         *perm_r, *perm_c, *bind, *xind, info, nzx, i, j, r;
+    int           nfail = 0;
+
+    if ( !(b = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b[].");
+    if ( !(perm_r = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    if ( !(bind = intMalloc(n)) ) ABORT("Malloc fails for bind[].");
+    if ( !(xind = intMalloc(n)) ) ABORT("Malloc fails for xind[].");
+
+    memcpy(b, b_save, n * nrhs * sizeof(double));
+    dCreate_Dense_Matrix(&B, n, nrhs, b, n, SLU_DN, SLU_D, SLU_GE);
+    StatInit(&stat);
+    dgssv(options, &A, perm_c, perm_r, &L, &U, &B, &stat, &info);
+    if ( info ) {
+	nfail = dcheck("sparse", info, b_save, x);
+    } else {
+	dgstrs_sparse_init(&L, perm_c, &ws);
+
+	/* b = A(:,j): only the reached part of x is written. */
+	for (i = 0; i < n * nrhs; ++i) b[i] = x[i] = 0.0;
+	for (r = 0; r < nrhs && !info; ++r) {
+	    j = (r + 1) * n / (nrhs + 1);
+	    for (i = xa[j]; i < xa[j+1]; ++i) b[asub[i] + r*n] = a[i];
+	    dgstrs_sparse(&L, &U, perm_r, &ws, xa[j+1] - xa[j], &asub[xa[j]],
+			  &a[xa[j]], &x[r*n], &nzx, xind, &stat, &info);
+	    for (i = 0; i < nzx; ++i)
+		if ( xind[i] < 0 || xind[i] >= n ) info = -100;
+	}
+	nfail += dcheck("sparse", info, b, x);
+
+	/* The dense B, with the same workspace. */
+	for (i = 0; i < n; ++i) bind[i] = i;
+	for (i = 0; i < n * nrhs; ++i) x[i] = 0.0;
+	for (r = 0; r < nrhs && !info; ++r)
+	    dgstrs_sparse(&L, &U, perm_r, &ws, n, bind, &b_save[r*n],
+			  &x[r*n], &nzx, NULL, &stat, &info);
+	nfail += dcheck("dense", info, b_save, x);
+
+	dgstrs_sparse_free(&ws);
+	Destroy_SuperNode_Matrix(&L);
+	Destroy_CompCol_Matrix(&U);
+    }
+    StatFree(&stat);
+
+    Destroy_SuperMatrix_Store(&B);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(perm_r);
+    SUPERLU_FREE(perm_c);
+    SUPERLU_FREE(bind);
+    SUPERLU_FREE(xind);
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+    nfail += dsparse_test(&options, x);
+    return dx_finish("dgstrs_sparse", nfail);
+}
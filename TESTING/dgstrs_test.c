@@ -0,0 +1,148 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dgstrs_test.c
+ * Purpose:             Test program for dgstrs, whose solutions of A*X = B
+ *                      and A'*X = B are compared with those of a dense LU
+ *                      factorization of A.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Solve op(A)*X = B by Gaussian elimination with partial
+ *  pivoting on the dense A; B is overwritten by X. */
+static void
+ddense_solve(trans_t trans, double *b)
+{
+    NCformat *Astore = A.Store;
+    double   *d, *col, t;
+    int_t    i, j, p, r, piv;
+
+    if ( !(d = doubleCalloc((size_t) n * n)) ) ABORT("Malloc fails for d[].");
+    for (j = 0; j < n; ++j)
+	for (p = Astore->colptr[j]; p < Astore->colptr[j+1]; ++p) {
+	    i = Astore->rowind[p];
+	    if ( trans == NOTRANS ) d[i + (size_t) j * n] = a_save[p];
+	    else d[j + (size_t) i * n] = a_save[p];
+	}
+
+    for (j = 0; j < n; ++j) {
+	col = &d[(size_t) j * n];
+	piv = j;
+	for (i = j + 1; i < n; ++i)
+	    if ( fabs(col[i]) > fabs(col[piv]) ) piv = i;
+	if ( piv != j ) {
+	    for (p = j; p < n; ++p) {
+		t = d[j + (size_t) p * n];
+		d[j + (size_t) p * n] = d[piv + (size_t) p * n];
+		d[piv + (size_t) p * n] = t;
+	    }
+	    for (r = 0; r < nrhs; ++r) {
+		t = b[j + r*n]; b[j + r*n] = b[piv + r*n]; b[piv + r*n] = t;
+	    }
+	}
+	for (i = j + 1; i < n; ++i) col[i] /= col[j];
+	for (p = j + 1; p < n; ++p) {
+	    t = d[j + (size_t) p * n];
+	    if ( t != 0.0 )
+		for (i = j + 1; i < n; ++i) d[i + (size_t) p * n] -= col[i] * t;
+	}
+	for (r = 0; r < nrhs; ++r)
+	    for (i = j + 1; i < n; ++i) b[i + r*n] -= col[i] * b[j + r*n];
+    }
+    for (r = 0; r < nrhs; ++r)
+	for (j = n - 1; j >= 0; --j) {
+	    b[j + r*n] /= d[j + (size_t) j * n];
+	    for (i = 0; i < j; ++i)
+		b[i + r*n] -= d[i + (size_t) j * n] * b[j + r*n];
+	}
+    SUPERLU_FREE(d);
+}
+
+/*! \brief Solve op(A)*X = B by dgstrs with the factors of dgssv, and
+ *  compare X with the dense solution. */
+static int
+dtrans_test(char *test, trans_t trans, SuperMatrix *L, SuperMatrix *U,
+	    int_t *perm_c, int_t *perm_r)
+{
+    SuperMatrix   B;
+    SuperLUStat_t stat;
+    double        *b, *xref, xmax, diff, eps = dmach("Epsilon");
+    int_t         info, i;
+
+    if ( !(b = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b[].");
+    if ( !(xref = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for xref[].");
+    sp_dgemm(trans == NOTRANS ? "N" : "T", "N", n, nrhs, n, 1.0, &A,
+	     xact, n, 0.0, b, n);
+    memcpy(x, b, n * nrhs * sizeof(double));
+    memcpy(xref, b, n * nrhs * sizeof(double));
+
+    dCreate_Dense_Matrix(&B, n, nrhs, x, n, SLU_DN, SLU_D, SLU_GE);
+    StatInit(&stat);
+    dgstrs(trans, L, U, perm_c, perm_r, &B, &stat, &info);
+    StatFree(&stat);
+    Destroy_SuperMatrix_Store(&B);
+    ddense_solve(trans, xref);
+
+    xmax = diff = 0.;
+    for (i = 0; i < n * nrhs; ++i) {
+	xmax = SUPERLU_MAX(xmax, fabs(xref[i]));
+	diff = SUPERLU_MAX(diff, fabs(x[i] - xref[i]));
+    }
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(xref);
+    if ( info ) {
+	printf(FMT2, test, info);
+	return 1;
+    }
+    printf("%10s: n=%d, nrhs=%d, max |X - X_dense| / max |X_dense| = %12.5g\n",
+	   test, (int) n, nrhs, diff / xmax);
+    return diff >= THRESH * n * eps * xmax;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    SuperMatrix    B, L, U;
+    SuperLUStat_t  stat;
+    int_t          *perm_r, *perm_c, info;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    if ( !(perm_r = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    memcpy(x, b_save, n * nrhs * sizeof(double));
+    dCreate_Dense_Matrix(&B, n, nrhs, x, n, SLU_DN, SLU_D, SLU_GE);
+    StatInit(&stat);
+    dgssv(&options, &A, perm_c, perm_r, &L, &U, &B, &stat, &info);
+    StatFree(&stat);
+    Destroy_SuperMatrix_Store(&B);
+
+    if ( info ) {
+	printf(FMT2, "dgssv", info);
+	++nfail;
+    } else {
+	nfail += dtrans_test("notrans", NOTRANS, &L, &U, perm_c, perm_r);
+	nfail += dtrans_test("trans", TRANS, &L, &U, perm_c, perm_r);
+	Destroy_SuperNode_Matrix(&L);
+	Destroy_CompCol_Matrix(&U);
+    }
+    SUPERLU_FREE(perm_r);
+    SUPERLU_FREE(perm_c);
+    return dx_finish("dgstrs", nfail);
+}
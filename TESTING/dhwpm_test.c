@@ -0,0 +1,45 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dhwpm_test.c
+ * Purpose:             Test program for dhwpm, the heavy-weight perfect
+ *                      matching row permutation (RowPerm = LargeDiag_HWPM)
+ *                      of dgsisx.
+ */
+#include "dxutil.h"
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* dgsisx without dropping, with the row permutations of MC64 and
+       of the heavy-weight matching. */
+    ilu_set_default_options(&options);
+    options.PrintStat = NO;
+    options.ILU_DropRule = DROP_BASIC;
+    options.ILU_DropTol = 0.0;
+    options.ILU_FillFactor = 100.0;
+    options.nthreads = nthreads;
+    nfail += dcheck("mc64", dsolve(&options, 1, x), b_save, x);
+    options.RowPerm = LargeDiag_HWPM;
+    nfail += dcheck("hwpm", dsolve(&options, 1, x), b_save, x);
+
+    return dx_finish("dhwpm", nfail);
+}
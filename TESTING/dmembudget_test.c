@@ -0,0 +1,44 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dmembudget_test.c
+ * Purpose:             Test program for options->MemBudget, a hard cap on
+ *                      the storage of L\U.
+ */
+#include "dxutil.h"
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    double         budget;
+    int_t          info;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* A memory budget with some room over what the default path used,
+       and half of that, which must fail as a malloc would. */
+    budget = mem_usage.total_needed;
+    options.MemBudget = 1.5 * budget;
+    nfail += dcheck("budget", dsolve(&options, 0, x), b_save, x);
+    options.MemBudget = 0.5 * budget;
+    info = dsolve(&options, 0, x);
+    printf(FMT2, "too_small", info);
+    nfail += info <= n;
+
+    return dx_finish("membudget", nfail);
+}
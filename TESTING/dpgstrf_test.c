@@ -0,0 +1,134 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dpgstrf_test.c
+ * Purpose:             Test program for dpgstrf, the factorization of
+ *                      independent subtrees of the etree by threads.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Factor A under the options by dgstrf; return its info. */
+static int_t
+dfactor(superlu_options_t *options, SuperMatrix *L, SuperMatrix *U,
+	int_t *perm_c, int_t *perm_r)
+{
+    SuperMatrix   AC;
+    GlobalLU_t	  Glu;
+    SuperLUStat_t stat;
+    int_t         *etree, info;
+
+    if ( !(etree = intMalloc(n)) ) ABORT("Malloc fails for etree[].");
+    get_perm_c(options->ColPerm, &A, perm_c);
+    sp_preorder(options, &A, perm_c, etree, &AC);
+    StatInit(&stat);
+    dgstrf(options, &AC, sp_ienv(2), sp_ienv(1), etree, NULL, 0,
+	   perm_c, perm_r, L, U, &Glu, &stat, &info);
+    StatFree(&stat);
+    Destroy_CompCol_Permuted(&AC);
+    SUPERLU_FREE(etree);
+    return info;
+}
+
+/*! \brief L\U as a dense n-by-n matrix, whatever the storage order of
+ *  the supernodes and their subscripts. */
+static double *
+dlu_dense(SuperMatrix *L, SuperMatrix *U)
+{
+    SCformat *Lstore = L->Store;
+    NCformat *Ustore = U->Store;
+    double   *lusup = Lstore->nzval, *uval = Ustore->nzval, *d;
+    int_t    s, i, j, p;
+
+    if ( !(d = doubleCalloc((size_t) n * n)) ) ABORT("Malloc fails for d[].");
+    for (s = 0; s <= Lstore->nsuper; ++s) {
+	for (j = L_FST_SUPC(s); j < L_FST_SUPC(s+1); ++j) {
+	    p = L_NZ_START(j);
+	    for (i = L_SUB_START(L_FST_SUPC(s));
+		 i < L_SUB_START(L_FST_SUPC(s)+1); ++i)
+		d[L_SUB(i) + (size_t) j * n] = lusup[p++];
+	    for (i = U_NZ_START(j); i < U_NZ_START(j+1); ++i)
+		d[U_SUB(i) + (size_t) j * n] = uval[i];
+	}
+    }
+    return d;
+}
+
+/*! \brief Factor A serially and with threads, and compare the pivots
+ *  and the dense L\U, which must agree up to rounding. */
+static int
+dcompare_test(superlu_options_t *options)
+{
+    SuperMatrix L[2], U[2];
+    double      *d[2], dmax, diff, eps = dmach("Epsilon");
+    int_t       *perm_c, *perm_r[2], info[2], i;
+    int         t, nfail = 0;
+
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    for (t = 0; t < 2; ++t) {
+	if ( !(perm_r[t] = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+	options->nthreads = t ? nthreads : 1;
+	info[t] = dfactor(options, &L[t], &U[t], perm_c, perm_r[t]);
+    }
+    if ( info[0] || info[1] ) {
+	printf(FMT2, "compare", info[0] ? info[0] : info[1]);
+	nfail = 1;
+    } else {
+	for (i = 0; i < n; ++i)
+	    if ( perm_r[0][i] != perm_r[1][i] ) break;
+	if ( i < n ) {
+	    printf("compare: perm_r differs at %d\n", (int) i);
+	    ++nfail;
+	}
+	d[0] = dlu_dense(&L[0], &U[0]);
+	d[1] = dlu_dense(&L[1], &U[1]);
+	dmax = diff = 0.;
+	for (i = 0; i < n * n; ++i) {
+	    dmax = SUPERLU_MAX(dmax, fabs(d[0][i]));
+	    diff = SUPERLU_MAX(diff, fabs(d[0][i] - d[1][i]));
+	}
+	printf("%10s: n=%d, max |LU - LU_serial| / max |LU_serial| = %12.5g\n",
+	       "compare", (int) n, diff / dmax);
+	nfail += diff >= THRESH * n * eps * dmax;
+	SUPERLU_FREE(d[0]);
+	SUPERLU_FREE(d[1]);
+    }
+    for (t = 0; t < 2; ++t) {
+	if ( !info[t] ) {
+	    Destroy_SuperNode_Matrix(&L[t]);
+	    Destroy_CompCol_Matrix(&U[t]);
+	}
+	SUPERLU_FREE(perm_r[t]);
+    }
+    SUPERLU_FREE(perm_c);
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* Factor independent subtrees of the etree concurrently. */
+    options.nthreads = nthreads;
+    nfail += dcheck("thread", dsolve(&options, 0, x), b_save, x);
+    nfail += dcompare_test(&options);
+
+    return dx_finish("dpgstrf", nfail);
+}
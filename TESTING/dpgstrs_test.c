@@ -0,0 +1,41 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dpgstrs_test.c
+ * Purpose:             Test program for dpgstrs, the triangular solves by
+ *                      supernodes of a level, or by right-hand sides,
+ *                      concurrently.
+ */
+#include "dxutil.h"
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* Solve the supernodes of a level, then the right-hand sides,
+       concurrently. */
+    options.nthreads = nthreads;
+    options.SplitRHS = NO;
+    nfail += dcheck("level", dsolve(&options, 0, x), b_save, x);
+    options.SplitRHS = YES;
+    nfail += dcheck("splitrhs", dsolve(&options, 0, x), b_save, x);
+
+    return dx_finish("dpgstrs", nfail);
+}
@@ -0,0 +1,69 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dsgssv_test.c
+ * Purpose:             Test program for dsgssv, the factorization in single
+ *                      precision with iterative refinement in double.
+ */
+#include "dxutil.h"
+
+/*! \brief Solve A*X = B by dsgssv, which must take the single precision
+ *  factors and refine to the accuracy of dgssvx for this matrix.
+ */
+static int
+dmixed_test(superlu_options_t *options, double *x)
+{
+    SuperMatrix   B, X, L, U;
+    SuperLUStat_t stat;
+    int_t         *perm_r, *perm_c, iter, info;
+    int           nfail = 0;
+
+    if ( !(perm_r = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    dCreate_Dense_Matrix(&B, n, nrhs, b_save, n, SLU_DN, SLU_D, SLU_GE);
+    dCreate_Dense_Matrix(&X, n, nrhs, x, n, SLU_DN, SLU_D, SLU_GE);
+
+    StatInit(&stat);
+    dsgssv(options, &A, perm_c, perm_r, &L, &U, &B, &X, &iter, &stat, &info);
+    StatFree(&stat);
+
+    nfail += dcheck("dsgssv", info, b_save, x);
+    if ( !info ) {
+	if ( iter < 0 ) {
+	    printf("dsgssv: fell back to double precision, iter=%d\n",
+		   (int) iter);
+	    ++nfail;
+	}
+	Destroy_SuperNode_Matrix(&L);
+	Destroy_CompCol_Matrix(&U);
+    }
+    Destroy_SuperMatrix_Store(&B);
+    Destroy_SuperMatrix_Store(&X);
+    SUPERLU_FREE(perm_r);
+    SUPERLU_FREE(perm_c);
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+    nfail += dmixed_test(&options, x);
+    return dx_finish("dsgssv", nfail);
+}
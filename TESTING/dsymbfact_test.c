@@ -0,0 +1,114 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dsymbfact_test.c
+ * Purpose:             Test program for the sizes of L\U computed by
+ *                      sp_symbfact_size(), which must hold the factors
+ *                      without any memory expansion, whether allocated
+ *                      by malloc or in a work[] of the size queried by
+ *                      lwork = -1.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Solve A*X = B with dgssvx, L\U in work[] of lwork bytes;
+ *  return its info, which for lwork = -1 is the query of the size. */
+static int_t
+dsolve_work(superlu_options_t *options, void *work, int_t lwork)
+{
+    SuperMatrix   B, X, L, U;
+    GlobalLU_t	  Glu;
+    SuperLUStat_t stat;
+    NCformat      *Astore = A.Store;
+    double        *b, *R, *C, *ferr, *berr, rpg, rcond;
+    int_t         *perm_r, *perm_c, *etree, info;
+    char          equed[1];
+
+    if ( !(b = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b[].");
+    if ( !(perm_r = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    if ( !(etree = intMalloc(n)) ) ABORT("Malloc fails for etree[].");
+    if ( !(R = doubleMalloc(n)) ) ABORT("Malloc fails for R[].");
+    if ( !(C = doubleMalloc(n)) ) ABORT("Malloc fails for C[].");
+    if ( !(ferr = doubleMalloc(nrhs)) ) ABORT("Malloc fails for ferr[].");
+    if ( !(berr = doubleMalloc(nrhs)) ) ABORT("Malloc fails for berr[].");
+
+    memcpy(Astore->nzval, a_save, nnz * sizeof(double));
+    memcpy(b, b_save, n * nrhs * sizeof(double));
+    dCreate_Dense_Matrix(&B, n, nrhs, b, n, SLU_DN, SLU_D, SLU_GE);
+    dCreate_Dense_Matrix(&X, n, nrhs, x, n, SLU_DN, SLU_D, SLU_GE);
+
+    StatInit(&stat);
+    dgssvx(options, &A, perm_c, perm_r, etree, equed, R, C, &L, &U,
+	   work, lwork, &B, &X, &rpg, &rcond, ferr, berr, &Glu, &mem_usage,
+	   &stat, &info);
+    expansions = stat.expansions;
+    StatFree(&stat);
+
+    memcpy(Astore->nzval, a_save, nnz * sizeof(double));
+    if ( lwork > 0 && (info == 0 || info == n + 1) ) {
+	Destroy_SuperMatrix_Store(&L);
+	Destroy_SuperMatrix_Store(&U);     /* the values are in work[] */
+    }
+    Destroy_SuperMatrix_Store(&B);
+    Destroy_SuperMatrix_Store(&X);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(perm_r);
+    SUPERLU_FREE(perm_c);
+    SUPERLU_FREE(etree);
+    SUPERLU_FREE(R);
+    SUPERLU_FREE(C);
+    SUPERLU_FREE(ferr);
+    SUPERLU_FREE(berr);
+    return info;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    void           *work;
+    int_t          lwork, info;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* Storage sized by the symbolic factorization, with system malloc */
+    options.SymbolicFact = YES;
+    nfail += dcheck("symbfact", dsolve(&options, 0, x), b_save, x);
+    if ( expansions ) {
+	printf("symbfact: %d memory expansions\n", expansions);
+	++nfail;
+    }
+
+    /* Storage in a work[] of the size queried by lwork = -1 */
+    info = dsolve_work(&options, NULL, -1);
+    lwork = mem_usage.total_needed;
+    printf("%10s: n=%d, lwork=%d\n", "query", (int) n, (int) lwork);
+    if ( lwork <= 0 || info != lwork + n ) {
+	printf("query: info=%d\n", (int) info);
+	return dx_finish("symbfact", nfail + 1);
+    }
+    if ( !(work = SUPERLU_MALLOC(lwork)) ) ABORT("Malloc fails for work[].");
+    nfail += dcheck("lwork", dsolve_work(&options, work, lwork), b_save, x);
+    if ( expansions ) {
+	printf("lwork: %d memory expansions\n", expansions);
+	++nfail;
+    }
+    SUPERLU_FREE(work);
+
+    return dx_finish("symbfact", nfail);
+}
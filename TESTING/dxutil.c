@@ -0,0 +1,275 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dxutil.c
+ * Purpose:             The test matrix and the checks shared by the test
+ *                      programs of the optional solution paths. Each
+ *                      program solves A*X = B by one path and checks its
+ *                      residual, and that of the default dgssvx, against
+ *                      THRESH. The matrix is read from a Harwell-Boeing
+ *                      file (-f), or is a convection-diffusion operator
+ *                      on a k-by-k grid (-n k).
+ */
+#include <string.h>
+#include <unistd.h>
+#include "dxutil.h"
+
+static void
+parse_command_line(int argc, char *argv[], FILE **fp);
+
+SuperMatrix A;
+double      *a_save, *b_save, *xact, *x;
+int_t       n, nnz, k;
+int         nrhs, nthreads;
+mem_usage_t mem_usage;
+double      ooc_written;
+int         expansions;
+int_t       nnz_lu;
+
+/*! \brief Solve A*X = B with dgssvx under the options, or with dgsisx
+ *  if ilu is set. */
+int_t
+dsolve(superlu_options_t *options, int ilu, double *x)
+{
+    SuperMatrix   B, X, L, U;
+    GlobalLU_t	  Glu;
+    SuperLUStat_t stat;
+    NCformat      *Astore = A.Store;
+    double        *b, *R, *C, *ferr, *berr, rpg, rcond;
+    int_t         *perm_r, *perm_c, *etree, info;
+    char          equed[1];
+
+    if ( !(b = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b[].");
+    if ( !(perm_r = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    if ( !(etree = intMalloc(n)) ) ABORT("Malloc fails for etree[].");
+    if ( !(R = doubleMalloc(n)) ) ABORT("Malloc fails for R[].");
+    if ( !(C = doubleMalloc(n)) ) ABORT("Malloc fails for C[].");
+    if ( !(ferr = doubleMalloc(nrhs)) ) ABORT("Malloc fails for ferr[].");
+    if ( !(berr = doubleMalloc(nrhs)) ) ABORT("Malloc fails for berr[].");
+
+    memcpy(Astore->nzval, a_save, nnz * sizeof(double));
+    memcpy(b, b_save, n * nrhs * sizeof(double));
+    dCreate_Dense_Matrix(&B, n, nrhs, b, n, SLU_DN, SLU_D, SLU_GE);
+    dCreate_Dense_Matrix(&X, n, nrhs, x, n, SLU_DN, SLU_D, SLU_GE);
+
+    StatInit(&stat);
+    if ( ilu )
+	dgsisx(options, &A, perm_c, perm_r, etree, equed, R, C, &L, &U,
+	       NULL, 0, &B, &X, &rpg, &rcond, &Glu, &mem_usage, &stat, &info);
+    else
+	dgssvx(options, &A, perm_c, perm_r, etree, equed, R, C, &L, &U,
+	       NULL, 0, &B, &X, &rpg, &rcond, ferr, berr, &Glu, &mem_usage,
+	       &stat, &info);
+    ooc_written = stat.OOCWrite;
+    expansions = stat.expansions;
+    StatFree(&stat);
+
+    memcpy(Astore->nzval, a_save, nnz * sizeof(double));
+    nnz_lu = 0;
+    if ( info == 0 || info == n + 1 ) {
+	nnz_lu = ((SCformat *) L.Store)->nnz + ((NCformat *) U.Store)->nnz;
+	Destroy_SuperNode_Matrix(&L);
+	Destroy_CompCol_Matrix(&U);
+    }
+    Destroy_SuperMatrix_Store(&B);
+    Destroy_SuperMatrix_Store(&X);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(perm_r);
+    SUPERLU_FREE(perm_c);
+    SUPERLU_FREE(etree);
+    SUPERLU_FREE(R);
+    SUPERLU_FREE(C);
+    SUPERLU_FREE(ferr);
+    SUPERLU_FREE(berr);
+    return info;
+}
+
+/*! \brief Check the solution x of A*X = B of the path named test;
+ *  return 1 if it fails. */
+int
+dcheck(char *test, int_t info, double *b, double *x)
+{
+    double *r, resid;
+
+    if ( info ) {
+	printf(FMT2, test, info);
+	return 1;
+    }
+    if ( !(r = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for r[].");
+    memcpy(r, b, n * nrhs * sizeof(double));
+    dgst02(NOTRANS, n, n, nrhs, &A, x, n, r, n, &resid);
+    SUPERLU_FREE(r);
+    printf(FMT1, test, n, nrhs, resid);
+    return resid >= THRESH;
+}
+
+/*! \brief Set up the test matrix and B = A*xact from the command line,
+ *  and solve by the default path under the default options; return the
+ *  number of failures.
+ */
+int
+dx_init(int argc, char *argv[], superlu_options_t *options)
+{
+    FILE  *fp = NULL;
+    double *a;
+    int_t *asub, *xa, m;
+
+    k        = 30;
+    nrhs     = 2;
+    nthreads = 4;
+    parse_command_line(argc, argv, &fp);
+
+    if ( fp ) {
+	dreadhb(fp, &m, &n, &nnz, &a, &asub, &xa);   /* closes fp */
+	if ( m != n ) ABORT("The matrix must be square.");
+	k = 0;
+    } else {
+	n = k * k;
+	dgrid_matrix(k, &nnz, &a, &asub, &xa);
+    }
+    dCreate_CompCol_Matrix(&A, n, n, nnz, a, asub, xa,
+			   SLU_NC, SLU_D, SLU_GE);
+    if ( !(a_save = doubleMalloc(nnz)) ) ABORT("Malloc fails for a_save[].");
+    memcpy(a_save, a, nnz * sizeof(double));
+
+    /* Generate the right-hand sides from a known solution. */
+    if ( !(xact = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for xact[].");
+    if ( !(b_save = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b_save[].");
+    if ( !(x = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for x[].");
+    dGenXtrue(n, nrhs, xact, n);
+    sp_dgemm("N", "N", n, nrhs, n, 1.0, &A, xact, n, 0.0, b_save, n);
+
+    /* The default path. */
+    set_default_options(options);
+    options->PrintStat = NO;
+    return dcheck("default", dsolve(options, 0, x), b_save, x);
+}
+
+/*! \brief Report the result of the test program and free the test
+ *  matrix; return the exit status. */
+int
+dx_finish(char *test, int nfail)
+{
+    printf("%s: %s\n", test, nfail ? "FAILED" : "passed");
+
+    Destroy_CompCol_Matrix(&A);
+    SUPERLU_FREE(a_save);
+    SUPERLU_FREE(b_save);
+    SUPERLU_FREE(xact);
+    SUPERLU_FREE(x);
+    return nfail != 0;
+}
+
+/*! \brief The 5-point convection-diffusion operator on a k-by-k grid,
+ *  in column-compressed form with the row subscripts sorted.
+ */
+void
+dgrid_matrix(int_t k, int_t *nnz, double **a, int_t **asub, int_t **xa)
+{
+    int_t i, j, col, p;
+
+    *a = doubleMalloc(5 * k * k);
+    *asub = intMalloc(5 * k * k);
+    *xa = intMalloc(k * k + 1);
+    if ( !*a || !*asub || !*xa ) ABORT("Malloc fails for the grid matrix.");
+
+    p = 0;
+    for (j = 0; j < k; ++j) {
+	for (i = 0; i < k; ++i) {
+	    col = i + j * k;
+	    (*xa)[col] = p;
+	    if ( j > 0 ) { (*asub)[p] = col - k; (*a)[p++] = -1.3; }
+	    if ( i > 0 ) { (*asub)[p] = col - 1; (*a)[p++] = -1.1; }
+	    (*asub)[p] = col; (*a)[p++] = 4.0;
+	    if ( i < k-1 ) { (*asub)[p] = col + 1; (*a)[p++] = -0.9; }
+	    if ( j < k-1 ) { (*asub)[p] = col + k; (*a)[p++] = -0.7; }
+	}
+    }
+    (*xa)[k * k] = p;
+    *nnz = p;
+}
+
+/*! \brief Make the generated matrix reducible, and B = A*xact for a
+ *  new xact: the couplings of each grid line to the next, and within the
+ *  first line, are dropped. The first line is then k column singletons,
+ *  and the other lines are k-1 tridiagonal diagonal blocks.
+ */
+int
+dreduce_grid(char *test)
+{
+    NCformat      *Astore = A.Store;
+    double        *a = Astore->nzval;
+    int_t         *asub = Astore->rowind, *xa = Astore->colptr;
+    int_t         i, j, p;
+
+    if ( k == 0 ) {
+	printf("%s: needs the generated matrix\n", test);
+	return 1;
+    }
+    p = 0;
+    for (j = 0; j < n; ++j) {
+	i = xa[j];
+	xa[j] = p;
+	for (; i < xa[j+1]; ++i) {
+	    if ( asub[i] / k > j / k ) continue;
+	    if ( j < k && asub[i] != j ) continue;
+	    asub[p] = asub[i];
+	    a[p++] = a[i];
+	}
+    }
+    xa[n] = nnz = Astore->nnz = p;
+    memcpy(a_save, a, nnz * sizeof(double));
+
+    dGenXtrue(n, nrhs, xact, n);
+    sp_dgemm("N", "N", n, nrhs, n, 1.0, &A, xact, n, 0.0, b_save, n);
+    return 0;
+}
+
+/*
+ * Parse command line options to get the matrix, etc.
+ */
+static void
+parse_command_line(int argc, char *argv[], FILE **fp)
+{
+    int c;
+    extern char *optarg;
+
+    while ( (c = getopt(argc, argv, "hn:s:p:f:")) != EOF ) {
+	switch (c) {
+	  case 'h':
+	    printf("Options:\n");
+	    printf("\t-n <int> - grid size of the generated matrix\n");
+	    printf("\t-s <int> - number of right-hand sides\n");
+	    printf("\t-p <int> - number of threads\n");
+	    printf("\t-f <file> - Harwell-Boeing matrix to use\n");
+	    exit(1);
+	    break;
+	  case 'n': k = atoi(optarg);
+	            break;
+	  case 's': nrhs = atoi(optarg);
+	            break;
+	  case 'p': nthreads = atoi(optarg);
+	            break;
+          case 'f':
+                    if ( !(*fp = fopen(optarg, "r")) ) {
+                        ABORT("File does not exist");
+                    }
+                    break;
+  	}
+    }
+}
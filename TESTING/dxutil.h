@@ -0,0 +1,56 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		dxutil.h
+ * Purpose:             The test matrix and the checks shared by the test
+ *                      programs of the optional solution paths.
+ */
+#ifndef __SUPERLU_DXUTIL
+#define __SUPERLU_DXUTIL
+
+#include "slu_ddefs.h"
+
+#define THRESH    20.0
+#define FMT1      "%10s: n=%d, nrhs=%d, residual=%12.5g\n"
+#define FMT2      "%10s: info=%d\n"
+
+/* The test matrix, and the values of A and B to restore before each
+   solve, as dgssvx may scale them. k is the grid size of the generated
+   matrix, and 0 for a matrix read from a file. */
+extern SuperMatrix A;
+extern double      *a_save, *b_save, *xact, *x;
+extern int_t       n, nnz, k;
+extern int         nrhs, nthreads;
+
+/* Of the last dsolve() */
+extern mem_usage_t mem_usage;
+extern double      ooc_written;   /* stat.OOCWrite */
+extern int         expansions;    /* stat.expansions */
+extern int_t       nnz_lu;        /* nnz(L) + nnz(U) */
+
+extern int   dgst02(trans_t, int, int, int, SuperMatrix *, double *, int,
+		    double *, int, double *);
+
+extern int   dx_init(int argc, char *argv[], superlu_options_t *options);
+extern int   dx_finish(char *test, int nfail);
+extern int_t dsolve(superlu_options_t *options, int ilu, double *x);
+extern int   dcheck(char *test, int_t info, double *b, double *x);
+extern void  dgrid_matrix(int_t k, int_t *nnz, double **a, int_t **asub,
+			  int_t **xa);
+extern int   dreduce_grid(char *test);
+
+#endif /* __SUPERLU_DXUTIL */
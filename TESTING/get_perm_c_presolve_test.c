@@ -0,0 +1,47 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		get_perm_c_presolve_test.c
+ * Purpose:             Test program for get_perm_c_presolve, which orders the
+ *                      singletons and the dense rows and columns apart from the core.
+ */
+#include "dxutil.h"
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* Order the core left by the singletons only, on the grid and on
+       a reducible matrix with column singletons. */
+    options.Presolve = YES;
+    nfail += dcheck("colamd", dsolve(&options, 0, x), b_save, x);
+    options.ColPerm = AMD_AT_PLUS_A;
+    nfail += dcheck("amd_at+a", dsolve(&options, 0, x), b_save, x);
+    if ( dreduce_grid("presolve") ) {
+	++nfail;
+    } else {
+	options.ColPerm = COLAMD;
+	nfail += dcheck("reduced", dsolve(&options, 0, x), b_save, x);
+	options.ColPerm = AMD_AT_PLUS_A;
+	nfail += dcheck("reduced_sym", dsolve(&options, 0, x), b_save, x);
+    }
+
+    return dx_finish("presolve", nfail);
+}
@@ -0,0 +1,154 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		get_perm_c_test.c
+ * Purpose:             Test program for the column orderings of get_perm_c:
+ *                      each must be a permutation, give a good solution, and
+ *                      on the grid, less fill than the natural ordering.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Order A by get_perm_c(colperm) and check that perm_c is a
+ *  permutation, then solve A*X = B under the ordering; with nnz_natural
+ *  > 0, L+U must have fewer nonzeros. */
+static int
+dorder_test(superlu_options_t *options, colperm_t colperm, char *test,
+	    int_t nnz_natural)
+{
+    int_t *perm_c, *mark, i;
+    int   nfail = 0;
+
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    if ( !(mark = intCalloc(n)) ) ABORT("Malloc fails for mark[].");
+    get_perm_c(colperm, &A, perm_c);
+    for (i = 0; i < n; ++i) {
+	if ( perm_c[i] < 0 || perm_c[i] >= n || mark[perm_c[i]]++ ) {
+	    printf("%10s: perm_c is not a permutation\n", test);
+	    ++nfail;
+	    break;
+	}
+    }
+    SUPERLU_FREE(perm_c);
+    SUPERLU_FREE(mark);
+
+    options->ColPerm = colperm;
+    nfail += dcheck(test, dsolve(options, 0, x), b_save, x);
+    printf("%10s: nnz(L+U)=%ld\n", test, (long) nnz_lu);
+    if ( nnz_natural > 0 && nnz_lu >= nnz_natural ) {
+	printf("%10s: no less fill than the natural ordering\n", test);
+	++nfail;
+    }
+    return nfail;
+}
+
+/*! \brief Border the test matrix with d dense rows of small values,
+ *  and d columns with entries in those rows only, and solve A*X = B
+ *  under the orderings on A'*A. These leave the dense rows out of A'*A,
+ *  which isolates the border columns; minimum degree would order them
+ *  first, and get_perm_c must defer them to the end.
+ */
+static int
+ddense_test(superlu_options_t *options, int_t d)
+{
+    static colperm_t colperm[] = {MMD_ATA, AMD_ATA};
+    static char      *name[] = {"mmd_dense", "amd_dense"};
+    NCformat *Astore = A.Store;
+    double   *a;
+    int_t    *asub, *xa, *perm_c, nold = n, nnz_natural, i, j, p, t;
+    int      nfail = 0;
+
+    n = nold + d;
+    nnz = Astore->nnz + n * d;
+    a = doubleMalloc(nnz);
+    asub = intMalloc(nnz);
+    xa = intMalloc(n + 1);
+    if ( !a || !asub || !xa ) ABORT("Malloc fails for the bordered matrix.");
+    p = 0;
+    for (j = 0; j < n; ++j) {
+	xa[j] = p;
+	if ( j < nold ) {
+	    for (i = Astore->colptr[j]; i < Astore->colptr[j+1]; ++i) {
+		asub[p] = Astore->rowind[i];
+		a[p++] = a_save[i];
+	    }
+	}
+	for (i = nold; i < n; ++i) {
+	    asub[p] = i;
+	    a[p++] = (i == j) ? 4.0 : 0.01;
+	}
+    }
+    xa[n] = p;
+    Destroy_CompCol_Matrix(&A);
+    dCreate_CompCol_Matrix(&A, n, n, nnz, a, asub, xa,
+			   SLU_NC, SLU_D, SLU_GE);
+
+    SUPERLU_FREE(a_save);
+    SUPERLU_FREE(xact);
+    SUPERLU_FREE(b_save);
+    SUPERLU_FREE(x);
+    if ( !(a_save = doubleMalloc(nnz)) ) ABORT("Malloc fails for a_save[].");
+    if ( !(xact = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for xact[].");
+    if ( !(b_save = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for b_save[].");
+    if ( !(x = doubleMalloc(n * nrhs)) ) ABORT("Malloc fails for x[].");
+    memcpy(a_save, a, nnz * sizeof(double));
+    dGenXtrue(n, nrhs, xact, n);
+    sp_dgemm("N", "N", n, nrhs, n, 1.0, &A, xact, n, 0.0, b_save, n);
+
+    nfail += dorder_test(options, NATURAL, "natural", 0);
+    nnz_natural = k ? nnz_lu : 0;
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+    for (t = 0; t < 2; ++t) {
+	get_perm_c(colperm[t], &A, perm_c);
+	for (j = nold; j < n; ++j)
+	    if ( perm_c[j] < nold ) {
+		printf("%10s: border column %d ordered at %d\n", name[t],
+		       (int) j, (int) perm_c[j]);
+		++nfail;
+	    }
+	nfail += dorder_test(options, colperm[t], name[t], nnz_natural);
+    }
+    SUPERLU_FREE(perm_c);
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int_t          nnz_natural;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    nfail += dorder_test(&options, NATURAL, "natural", 0);
+    nnz_natural = k ? nnz_lu : 0;
+
+    /* Nested dissection on A'+A */
+    nfail += dorder_test(&options, METIS_AT_PLUS_A, "nd", nnz_natural);
+
+    /* Approximate minimum degree on A'*A and A'+A */
+    nfail += dorder_test(&options, AMD_ATA, "amd_ata", nnz_natural);
+    nfail += dorder_test(&options, AMD_AT_PLUS_A, "amd_at+a", nnz_natural);
+
+    /* The cheapest predicted of several orderings */
+    nfail += dorder_test(&options, AUTO, "auto", nnz_natural);
+
+    /* Dense rows, left out of A'*A; this replaces A. */
+    nfail += ddense_test(&options, 3);
+
+    return dx_finish("get_perm_c", nfail);
+}
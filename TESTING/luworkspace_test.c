@@ -0,0 +1,163 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		luworkspace_test.c
+ * Purpose:             Test program for options->LUWorkspace: factors computed
+ *                      with a workspace reused across problems of different sizes
+ *                      must be bit-identical to those computed without one.
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Factor the matrix M under the options by dgstrf, or by
+ *  dgsitrf if ilu is set; return its info. */
+static int_t
+dfactor(superlu_options_t *options, SuperMatrix *M, int ilu,
+	SuperMatrix *L, SuperMatrix *U, int_t *perm_r)
+{
+    SuperMatrix   AC;
+    GlobalLU_t	  Glu;
+    SuperLUStat_t stat;
+    int_t         *perm_c, *etree, info;
+
+    if ( !(perm_c = intMalloc(M->ncol)) ) ABORT("Malloc fails for perm_c[].");
+    if ( !(etree = intMalloc(M->ncol)) ) ABORT("Malloc fails for etree[].");
+    get_perm_c(options->ColPerm, M, perm_c);
+    sp_preorder(options, M, perm_c, etree, &AC);
+    StatInit(&stat);
+    if ( ilu )
+	dgsitrf(options, &AC, sp_ienv(2), sp_ienv(1), etree, NULL, 0,
+		perm_c, perm_r, L, U, &Glu, &stat, &info);
+    else
+	dgstrf(options, &AC, sp_ienv(2), sp_ienv(1), etree, NULL, 0,
+	       perm_c, perm_r, L, U, &Glu, &stat, &info);
+    StatFree(&stat);
+    Destroy_CompCol_Permuted(&AC);
+    SUPERLU_FREE(perm_c);
+    SUPERLU_FREE(etree);
+    return info;
+}
+
+/*! \brief Factor a k-by-k grid matrix into the workspace, leaving its
+ *  work arrays sized and filled by a problem other than A. */
+static int_t
+dfactor_grid(superlu_options_t *options, int_t kk, int ilu)
+{
+    SuperMatrix M, L, U;
+    double      *a;
+    int_t       *asub, *xa, *perm_r, nz, info;
+
+    dgrid_matrix(kk, &nz, &a, &asub, &xa);
+    dCreate_CompCol_Matrix(&M, kk * kk, kk * kk, nz, a, asub, xa,
+			   SLU_NC, SLU_D, SLU_GE);
+    if ( !(perm_r = intMalloc(kk * kk)) ) ABORT("Malloc fails for perm_r[].");
+    info = dfactor(options, &M, ilu, &L, &U, perm_r);
+    if ( info == 0 ) {
+	Destroy_SuperNode_Matrix(&L);
+	Destroy_CompCol_Matrix(&U);
+    }
+    Destroy_CompCol_Matrix(&M);
+    SUPERLU_FREE(perm_r);
+    return info;
+}
+
+/*! \brief Whether two factorizations of A are bit-identical, over the
+ *  extents of the arrays given by their column pointers. */
+static int
+dsame_factors(SuperMatrix *L0, SuperMatrix *U0, int_t *perm_r0,
+	      SuperMatrix *L1, SuperMatrix *U1, int_t *perm_r1)
+{
+    SCformat *L0store = L0->Store, *L1store = L1->Store;
+    NCformat *U0store = U0->Store, *U1store = U1->Store;
+    int_t    nsuper = L0store->nsuper, nlu, nsub, nu;
+
+    if ( nsuper != L1store->nsuper
+	 || memcmp(L0store->nzval_colptr, L1store->nzval_colptr,
+		   (n + 1) * sizeof(int_t))
+	 || memcmp(L0store->rowind_colptr, L1store->rowind_colptr,
+		   (n + 1) * sizeof(int_t))
+	 || memcmp(U0store->colptr, U1store->colptr, (n + 1) * sizeof(int_t)) )
+	return 0;
+    nlu = L0store->nzval_colptr[n];
+    nsub = L0store->rowind_colptr[n];
+    nu = U0store->colptr[n];
+    return !memcmp(perm_r0, perm_r1, n * sizeof(int_t))
+	&& !memcmp(L0store->nzval, L1store->nzval, nlu * sizeof(double))
+	&& !memcmp(L0store->rowind, L1store->rowind, nsub * sizeof(int_t))
+	&& !memcmp(L0store->col_to_sup, L1store->col_to_sup,
+		   n * sizeof(int_t))
+	&& !memcmp(L0store->sup_to_col, L1store->sup_to_col,
+		   (nsuper + 2) * sizeof(int_t))
+	&& !memcmp(U0store->nzval, U1store->nzval, nu * sizeof(double))
+	&& !memcmp(U0store->rowind, U1store->rowind, nu * sizeof(int_t));
+}
+
+/*! \brief Factor A without a workspace, and with one that a larger and
+ *  a smaller problem used before; the factors must be bit-identical. */
+static int
+dworkspace_test(superlu_options_t *options, char *test, int ilu)
+{
+    SuperMatrix   L[2], U[2];
+    LUWorkspace_t ws;
+    int_t         *perm_r[2], info[2], kk = k ? k : 10;
+    int           t, nfail = 0;
+
+    LUWorkspaceInit(&ws);
+    for (t = 0; t < 2; ++t) {
+	if ( !(perm_r[t] = intMalloc(n)) ) ABORT("Malloc fails for perm_r[].");
+	options->LUWorkspace = t ? &ws : NULL;
+	if ( t && (dfactor_grid(options, kk + 7, ilu)
+		   || dfactor_grid(options, kk / 2 + 1, ilu)) )
+	    ABORT("The grid matrix must factor.");
+	info[t] = dfactor(options, &A, ilu, &L[t], &U[t], perm_r[t]);
+    }
+    options->LUWorkspace = NULL;
+    LUWorkspaceFree(&ws);
+
+    if ( info[0] || info[1] ) {
+	printf(FMT2, test, info[0] ? info[0] : info[1]);
+	nfail = 1;
+    } else if ( !dsame_factors(&L[0], &U[0], perm_r[0],
+			       &L[1], &U[1], perm_r[1]) ) {
+	printf("%10s: the factors differ with the workspace\n", test);
+	nfail = 1;
+    } else {
+	printf("%10s: n=%d, identical factors\n", test, (int) n);
+    }
+    for (t = 0; t < 2; ++t) {
+	if ( !info[t] ) {
+	    Destroy_SuperNode_Matrix(&L[t]);
+	    Destroy_CompCol_Matrix(&U[t]);
+	}
+	SUPERLU_FREE(perm_r[t]);
+    }
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    nfail += dworkspace_test(&options, "gstrf", 0);
+    ilu_set_default_options(&options);
+    nfail += dworkspace_test(&options, "gsitrf", 1);
+
+    return dx_finish("luworkspace", nfail);
+}
@@ -0,0 +1,45 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		ooc_test.c
+ * Purpose:             Test program for options->OutOfCore, which keeps the
+ *                      values of L and U in a scratch file (ooc.c).
+ */
+#include "dxutil.h"
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+
+    /* The values of L and U in a scratch file, serially and with
+       threads freeing their storage concurrently. */
+    options.OutOfCore = YES;
+    nfail += dcheck("serial", dsolve(&options, 0, x), b_save, x);
+#if defined(__linux__)
+    if ( ooc_written == 0. ) {
+	printf("ooc: nothing was written to the scratch file\n");
+	++nfail;
+    }
+#endif
+    options.nthreads = nthreads;
+    nfail += dcheck("ooc", dsolve(&options, 0, x), b_save, x);
+
+    return dx_finish("ooc", nfail);
+}
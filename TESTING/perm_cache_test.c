@@ -0,0 +1,81 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*
+ * -- SuperLU routine (version 5.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ */
+/*
+ * File name:		perm_cache_test.c
+ * Purpose:             Test program for the cache of column orderings and
+ *                      etrees by sparsity pattern (perm_cache.c).
+ */
+#include <string.h>
+#include "dxutil.h"
+
+/*! \brief Solve A*X = B with PermCache = YES: with the entry stored by
+ *  a first solve, then with the entry read back from the cache file,
+ *  after a corrupt copy of it and a truncated record were appended.
+ */
+static int
+dcache_test(superlu_options_t *options, double *x)
+{
+    char   *file = "perm_cache_test.bin";
+    char   *rec;
+    long   size, start;
+    int_t  *perm_c;
+    int    nfail = 0;
+    FILE   *fp;
+
+    remove(file);
+    perm_cache_clear();
+    perm_cache_file(file);
+    options->PermCache = YES;
+    nfail += dcheck("store", dsolve(options, 0, x), b_save, x);
+    nfail += dcheck("memory", dsolve(options, 0, x), b_save, x);
+
+    /* The file holds the header and one record. Append the record with
+       two entries of perm_c[] equal, and half of it. */
+    if ( !(fp = fopen(file, "r+b")) ) return nfail + 1;
+    fseek(fp, 0L, SEEK_END);
+    size = ftell(fp);
+    start = 8 + sizeof(int);
+    if ( !(rec = SUPERLU_MALLOC(size - start)) ) ABORT("Malloc fails for rec.");
+    fseek(fp, start, SEEK_SET);
+    if ( fread(rec, 1, size - start, fp) != (size_t) (size - start) )
+	++nfail;
+    perm_c = (int_t *) (rec + 2 * sizeof(unsigned long long)) + 6;
+    perm_c[1] = perm_c[0];
+    fseek(fp, 0L, SEEK_END);
+    fwrite(rec, 1, size - start, fp);
+    fwrite(rec, 1, (size - start) / 2, fp);
+    fclose(fp);
+    SUPERLU_FREE(rec);
+
+    perm_cache_clear();
+    perm_cache_file(file);
+    nfail += dcheck("file", dsolve(options, 0, x), b_save, x);
+
+    perm_cache_clear();
+    remove(file);
+    return nfail;
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_options_t options;
+    int            nfail;
+
+    nfail = dx_init(argc, argv, &options);
+    nfail += dcache_test(&options, x);
+    return dx_finish("perm_cache", nfail);
+}
@@ -12,6 +12,7 @@ at the top-level directory.
  * File name:		sp_ienv.c
  * History:             Modified from lapack routine ILAENV
  */
+#include <stdlib.h>
 #include "slu_Cnames.h"
 
 int
@@ -46,6 +47,13 @@ sp_ienv(int ispec)
 	    = 4: the minimum row dimension for 2-D blocking to be used;
 	    = 5: the minimum column dimension for 2-D blocking to be used;
 	    = 6: the estimated fills factor for L and U, compared with A;
+	    = 8: the number of vectors t used at a time by the block 1-norm
+	         estimator in condition estimation (xGSCON);
+	    = 9: the same, per right-hand side, for the forward error
+	         bounds in iterative refinement (xGSRFS);
+	    = 10: the budget for supernode amalgamation, in percent;
+	         0 (off) unless the environment variable SUPERLU_AMALG
+		 sets it, so that the tests can be run both ways;
 	    
    (SP_IENV) (output) int
             >= 0: the value of the parameter specified by ISPEC   
@@ -61,6 +69,12 @@ sp_ienv(int ispec)
 	case 4: return (20);
 	case 5: return (10);
         case 6: return (2);
+        case 8: return (2);
+        case 9: return (2);
+        case 10: {
+	    char *amalg = getenv("SUPERLU_AMALG");
+	    return (amalg ? atoi(amalg) : 0);
+	}
     }
 
     /* Invalid value for ISPEC */